@@ -0,0 +1,90 @@
+// Capture parser throughput per format, scalar vs SIMD kernels.
+//
+//   bench_capture_parse [megabytes_per_format=256] [capture files...]
+//
+// Without files, a synthetic corpus in each supported format is generated
+// (see synthetic_capture.h) and parsed through the mmap reader. Given files
+// are benchmarked as-is with their detected format.
+
+#include "synthetic_capture.h"
+
+#include "idrive/capture.h"
+#include "idrive/mapped_file.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+constexpr int REPEATS = 3;
+
+double bestSeconds(const idrive::MappedFile &file, idrive::CaptureFormat format, idrive::ParseKernel kernel,
+                   std::vector<idrive::Frame> &frames) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        frames.clear();
+        auto start = std::chrono::steady_clock::now();
+        idrive::parseCapture(file.begin(), file.end(), format, frames, nullptr, kernel);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+bool sameFrames(const std::vector<idrive::Frame> &a, const std::vector<idrive::Frame> &b) {
+    return a.size() == b.size() &&
+           (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(idrive::Frame)) == 0);
+}
+
+void benchFile(const std::string &label, const std::string &path) {
+    idrive::MappedFile file;
+    if (!file.open(path)) {
+        std::fprintf(stderr, "%s\n", file.error().c_str());
+        return;
+    }
+    idrive::CaptureFormat format = idrive::detectFormat(file.data(), file.size());
+
+    std::vector<idrive::Frame> scalarFrames, simdFrames;
+    double scalar = bestSeconds(file, format, idrive::ParseKernel::Scalar, scalarFrames);
+    double simd = bestSeconds(file, format, idrive::ParseKernel::Simd, simdFrames);
+    double gb = file.size() / 1e9;
+
+    std::printf("%-24s %-8s %9.1f %11zu %9.2f %9.2f %6.2fx %s\n",
+                label.c_str(), idrive::formatName(format), file.size() / 1e6, simdFrames.size(),
+                gb / scalar, gb / simd, scalar / simd, sameFrames(scalarFrames, simdFrames) ? "ok" : "MISMATCH");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    size_t megabytes = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 256;
+    if (megabytes == 0) megabytes = 256;
+
+    std::printf("SIMD level: %s, best of %d runs\n", idrive::simdLevelName(), REPEATS);
+    std::printf("%-24s %-8s %9s %11s %9s %9s %7s\n",
+                "input", "format", "MB", "frames", "scalar", "simd", "gain");
+    std::printf("%-24s %-8s %9s %11s %9s %9s\n", "", "", "", "", "GB/s", "GB/s");
+
+    if (argc > 2) {
+        for (int i = 2; i < argc; i++) benchFile(argv[i], argv[i]);
+        return 0;
+    }
+
+    static const idrive::CaptureFormat FORMATS[] = {
+        idrive::CaptureFormat::Putty, idrive::CaptureFormat::IdsNotes,
+        idrive::CaptureFormat::DeviceRaw, idrive::CaptureFormat::Candump,
+    };
+    for (auto format : FORMATS) {
+        std::string path = bench::writeTemp(bench::synthesize(format, megabytes << 20));
+        benchFile(std::string("synthetic ") + idrive::formatName(format), path);
+        ::unlink(path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Column store query latency against a plain scan of the frame array.
+//
+//   bench_column_query [million_frames=50]
+//
+// Builds the store from a timed bus simulation (see synthetic_capture.h),
+// then times a handful of reverse-engineering style queries. The naive
+// column is a straightforward loop over std::vector<Frame> that tracks the
+// previous frame per ID; both must agree on the match count.
+
+#include "synthetic_capture.h"
+
+#include "idrive/capture.h"
+#include "idrive/column_store.h"
+#include "idrive/work_stealing_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace {
+
+constexpr int REPEATS = 5;
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+double bestMs(Fn &&run) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        auto start = Clock::now();
+        run();
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+struct Case {
+    const char *label;
+    idrive::SignalQuery query;
+    // Naive predicate over (frame, previous frame of the same ID or null)
+    std::function<bool(const idrive::Frame &, const idrive::Frame *)> naive;
+};
+
+size_t naiveCount(const std::vector<idrive::Frame> &frames, const Case &c) {
+    const idrive::Frame *previous = nullptr;
+    size_t matches = 0;
+    for (const idrive::Frame &frame : frames) {
+        if (frame.id != c.query.id) continue;
+        if (c.naive(frame, previous)) matches++;
+        previous = &frame;
+    }
+    return matches;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    size_t millions = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 50;
+    if (millions == 0) millions = 50;
+
+    std::vector<idrive::Frame> frames = bench::simulateBus(millions * 1000000);
+    int64_t span = frames.back().timestampUs - frames.front().timestampUs;
+    int64_t windowFrom = frames.front().timestampUs + span / 2;
+    int64_t windowTo = windowFrom + span / 10;
+
+    idrive::WorkStealingPool pool;
+    idrive::ColumnStore store;
+    idrive::ColumnStoreOptions options;
+    options.pool = &pool;
+    auto buildStart = Clock::now();
+    store.build(frames, options);
+    std::chrono::duration<double> buildSeconds = Clock::now() - buildStart;
+
+    std::printf("%zu frames, %zu IDs, build %.2fs on %u threads, columns %.0f MB, indexes %.1f MB, scans %s\n",
+                store.frameCount(), store.partitions().size(), buildSeconds.count(), pool.threadCount(),
+                store.columnBytes() / 1e6, store.indexBytes() / 1e6, idrive::columnScanLevelName());
+
+    using P = idrive::Predicate;
+    std::vector<Case> cases = {
+        {"25B b4 changed && b3==01", {0x25B, false, {P::byteChanged(4), P::byteEquals(3, 0x01)}},
+         [](const idrive::Frame &f, const idrive::Frame *prev) {
+             return prev && f.data[4] != prev->data[4] && f.data[3] == 0x01;
+         }},
+        {"0BF b2 in 40..7F && b3&F0==80", {0x0BF, false, {P::byteBetween(2, 0x40, 0x7F), P::byteMasked(3, 0xF0, 0x80)}},
+         [](const idrive::Frame &f, const idrive::Frame *) {
+             return f.data[2] >= 0x40 && f.data[2] <= 0x7F && (f.data[3] & 0xF0) == 0x80;
+         }},
+        {"0BF b0==05 in 10% window", {0x0BF, false, {P::byteEquals(0, 0x05), P::timeBetween(windowFrom, windowTo)}},
+         [&](const idrive::Frame &f, const idrive::Frame *) {
+             return f.data[0] == 0x05 && f.timestampUs >= windowFrom && f.timestampUs <= windowTo;
+         }},
+        {"567 b5!=02", {0x567, false, {!P::byteEquals(5, 0x02)}},
+         [](const idrive::Frame &f, const idrive::Frame *) { return f.data[5] != 0x02; }},
+    };
+
+    std::printf("%-32s %10s %10s %10s %9s %s\n", "query", "matches", "store ms", "naive ms", "speedup", "check");
+    for (const Case &c : cases) {
+        size_t matches = 0, expected = 0;
+        double storeMs = bestMs([&] { matches = store.run(c.query).matches; });
+        double naiveMs = bestMs([&] { expected = naiveCount(frames, c); });
+        std::printf("%-32s %10zu %10.3f %10.1f %8.0fx %s\n", c.label, matches, storeMs, naiveMs, naiveMs / storeMs,
+                    matches == expected ? "ok" : "MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+// Device stream parsing with idrive::DeviceStreamParser (device_client.h)
+// against a line-copying reader in the style of tools/serial_util.h, on a
+// synthetic serial log: RAW mode frame lines for a simulated bus mixed with
+// input events, signal reports, statistics lines and capture dumps.
+//
+//   bench_device_stream [megabytes]
+//
+// Bytes are handed over in 4 KB reads as from the tty. Throughput is
+// compared with the USB full-speed bulk ceiling the device cannot exceed.
+
+#include "synthetic_capture.h"
+
+#include "idrive/device_client.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+constexpr int    REPEATS         = 5;
+constexpr size_t READ_SIZE       = 4096;
+constexpr double USB_FS_CEILING  = 19 * 64 * 1000;  // bytes/s: 19 bulk packets of 64 bytes per 1 ms frame
+constexpr size_t CAPTURE_RECORDS = 64;
+
+using idrive::DeviceEvent;
+using idrive::DeviceEventKind;
+
+// One of each non-frame line the firmware prints, cycled between frames
+const char *const EVENT_LINES[] = {
+    "Rotation CW (12)\r\n",
+    "HOME PRESSED\r\n",
+    "HOME RELEASED\r\n",
+    "Knob UP\r\n",
+    "Knob RELEASED\r\n",
+    "SIG ZBE_TOUCHPAD.Fingers = 1 (ONE)\r\n",
+    "SIG ZBE_TOUCHPAD.TouchX = 1234\r\n",
+    "SIG ZBE_CONTROLLER.Knob = 16 (UP)\r\n",
+    "LAT 4711\r\n",
+    "SYNC 7 123456789 123456812\r\n",
+    "BUSLOAD HIGH 1s=72.4%\r\n",
+    "CYCLE LATE 0x25B observed=61234us expected=20000us\r\n",
+    "Level 3 (33%)\r\n",
+};
+
+std::string buildStream(size_t targetBytes, size_t &events, size_t &textLines) {
+    std::string out;
+    out.reserve(targetBytes + 4096);
+    auto frames = bench::simulateBus(targetBytes / 40);
+    events = textLines = 0;
+    size_t line = 0;
+    for (size_t i = 0; out.size() < targetBytes; i++) {
+        const idrive::Frame &frame = frames[i % frames.size()];
+        size_t before = out.size();
+        bench::appendFrameLine(out, idrive::CaptureFormat::DeviceRaw, frame);
+        events += static_cast<size_t>(std::count(out.begin() + static_cast<ptrdiff_t>(before), out.end(), '\n'));
+        if (i % 8 == 0) {
+            const char *text = EVENT_LINES[line++ % (sizeof(EVENT_LINES) / sizeof(EVENT_LINES[0]))];
+            out += text;
+            events++;
+            textLines += text[0] == 'L' && text[1] == 'e';
+        }
+        if (i % 20000 == 0) {
+            char header[64];
+            out.append(header, std::snprintf(header, sizeof(header), "CAPTURE BEGIN %zu 5 %zu\n", CAPTURE_RECORDS, i));
+            std::string payload(CAPTURE_RECORDS * 16, '\x5A');
+            out += payload;
+            out.append(header, std::snprintf(header, sizeof(header), "CAPTURE END %zu %08X\n", payload.size(),
+                                             idrive::device_detail::crc32(payload)));
+            events++;
+        }
+    }
+    return out;
+}
+
+template <typename Fn>
+double bestSeconds(Fn &&run) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Feeds the stream in READ_SIZE pieces, as receive() would
+size_t parseStream(const std::string &stream, uint32_t mask, uint64_t &checksum) {
+    idrive::DeviceStreamParser parser;
+    parser.setEventMask(mask);
+    size_t events = 0;
+    checksum = 0;
+    for (size_t offset = 0; offset < stream.size(); offset += READ_SIZE) {
+        size_t available;
+        char *space = parser.prepare(available);
+        size_t n = std::min({READ_SIZE, available, stream.size() - offset});
+        std::memcpy(space, stream.data() + offset, n);
+        parser.commit(n);
+        events += parser.dispatch([&](const DeviceEvent &event) {
+            checksum += static_cast<uint64_t>(event.kind);
+            if (event.kind == DeviceEventKind::Frame) checksum += event.frame.id + event.frame.data[7];
+        });
+    }
+    return events;
+}
+
+// Everything but the "Level" acks must come out as a typed event
+size_t countText(const std::string &stream) {
+    idrive::DeviceStreamParser parser;
+    size_t text = 0;
+    for (size_t offset = 0; offset < stream.size();) {
+        offset += parser.feed(stream.data() + offset, stream.size() - offset);
+        parser.dispatch([&](const DeviceEvent &event) { text += event.kind == DeviceEventKind::Text; });
+    }
+    return text;
+}
+
+// What the tools did before: a std::string per line, sscanf for frames
+uint64_t copyLines(const std::string &stream) {
+    std::string pending;
+    uint64_t checksum = 0;
+    for (size_t offset = 0; offset < stream.size(); offset += READ_SIZE) {
+        pending.append(stream, offset, READ_SIZE);
+        size_t start = 0;
+        for (size_t nl; (nl = pending.find('\n', start)) != std::string::npos; start = nl + 1) {
+            std::string line = pending.substr(start, nl - start);
+            unsigned id = 0, b0 = 0;
+            if (line[0] == '[') std::sscanf(line.c_str(), "%*[^]]] [%*[^]]] 0x%x: %x", &id, &b0);
+            checksum += id + b0;
+        }
+        pending.erase(0, start);
+    }
+    return checksum;
+}
+
+void report(const char *label, size_t bytes, size_t events, double seconds) {
+    double mbps = static_cast<double>(bytes) / seconds / 1e6;
+    std::printf("%-30s %9.1f %10.2f %9.1f %9.0fx\n", label, mbps, static_cast<double>(events) / seconds / 1e6,
+                seconds * 1e9 / static_cast<double>(events), mbps * 1e6 / USB_FS_CEILING);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    size_t expected = 0, textLines = 0;
+    std::string stream = buildStream(megabytes << 20, expected, textLines);
+    std::printf("%.1f MB device stream, %zu lines/dumps; USB FS ceiling %.2f MB/s\n\n",
+                static_cast<double>(stream.size()) / 1e6, expected, USB_FS_CEILING / 1e6);
+    std::printf("%-30s %9s %10s %9s %10s\n", "reader", "MB/s", "Mevents/s", "ns/event", "headroom");
+
+    size_t events = 0;
+    uint64_t checksum = 0;
+    double seconds = bestSeconds([&] { events = parseStream(stream, idrive::ALL_DEVICE_EVENTS, checksum); });
+    report("parser, all kinds", stream.size(), events, seconds);
+    size_t text = countText(stream);
+    if (events != expected || text != textLines) {
+        std::fprintf(stderr, "parser delivered %zu events (%zu untyped), expected %zu (%zu)\n", events, text,
+                     expected, textLines);
+        return 1;
+    }
+
+    uint32_t inputs = idrive::eventBit(DeviceEventKind::Rotation) | idrive::eventBit(DeviceEventKind::Knob) |
+                      idrive::eventBit(DeviceEventKind::Button) | idrive::eventBit(DeviceEventKind::Touch) |
+                      idrive::eventBit(DeviceEventKind::Latency);
+    seconds = bestSeconds([&] { events = parseStream(stream, inputs, checksum); });
+    report("parser, input events only", stream.size(), expected, seconds);
+
+    seconds = bestSeconds([&] { checksum = copyLines(stream); });
+    report("std::string lines + sscanf", stream.size(), expected, seconds);
+    return 0;
+}
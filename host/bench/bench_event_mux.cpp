@@ -0,0 +1,331 @@
+// Load test of the Unix-socket multiplexer (idrive/event_mux.h) with
+// hundreds of clients, some of which never read.
+//
+//   bench_event_mux [healthy] [stalled] [events/s] [seconds]
+//
+// A server thread runs EventMux the way zbe_hub does, publishing a
+// simulated bus (16 frame IDs plus button events) in 1 ms batches, as the
+// device delivers them. Healthy clients are served from one epoll thread:
+// a tenth take every event, the rest subscribe to two IDs at every=4 or to
+// buttons only. Stalled clients connect and never read. The same load is
+// run without stalled clients, with them under the drop policy and with
+// them under the disconnect policy. A stalled client must cost the server
+// nothing visible: healthy clients still get every event they asked for,
+// at the same latency, and batches are not published late. Server cost is
+// CPU ns per published event over the run and over its second half, when
+// the stalled clients' socket buffers and queues are full.
+
+#include "idrive/event_mux.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t BATCH_US        = 1000;
+constexpr uint32_t FRAME_IDS       = 16;
+constexpr uint32_t BUTTON_EVERY    = 50;  // one button event per 50 frames
+constexpr int      DRAIN_MS        = 2000;
+constexpr size_t   LATENCY_BUCKETS = 100000;  // 1 us resolution up to 100 ms
+
+enum class Subscription { All, TwoIds, Buttons };
+
+const char *const SUBSCRIBE[] = {"", "SUB kinds=frame ids=100,105 every=4\n", "SUB kinds=button\n"};
+
+struct Scenario {
+    const char              *label;
+    int                      stalled;
+    idrive::SlowClientPolicy policy;
+};
+
+struct Expected {
+    uint64_t all = 0;
+    uint64_t twoIds = 0;
+    uint64_t buttons = 0;
+};
+
+struct HealthyClient {
+    int          fd = -1;
+    Subscription subscription = Subscription::All;
+    std::string  pending;
+    bool         subscribed = false;  // "OK" seen, or nothing to wait for
+    uint64_t     received = 0;
+    uint64_t     dropNotices = 0;
+};
+
+struct Result {
+    double   serverNsPerEvent = 0;
+    double   steadyNsPerEvent = 0;  // second half, once stalled clients' buffers are full
+    double   maxLateMs = 0;
+    uint64_t p50Us = 0;
+    uint64_t p99Us = 0;
+    uint64_t maxUs = 0;
+    uint64_t missing = 0;  // events healthy clients asked for and did not get
+    uint64_t dropNotices = 0;
+    idrive::EventMuxStats stats;
+};
+
+int64_t nowNs(clockid_t clock = CLOCK_MONOTONIC) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+idrive::RingRecord makeRecord(uint64_t sequence) {
+    idrive::RingRecord record;
+    std::memset(&record, 0, sizeof(record));
+    if (sequence % BUTTON_EVERY == BUTTON_EVERY - 1) {
+        record.kind = static_cast<uint8_t>(idrive::DeviceEventKind::Button);
+        std::strcpy(record.input.label, "HOME");
+        record.input.action = static_cast<uint8_t>(sequence / BUTTON_EVERY % 2);
+        return record;
+    }
+    record.kind = static_cast<uint8_t>(idrive::DeviceEventKind::Frame);
+    record.frame.id = 0x100 + static_cast<uint32_t>(sequence % FRAME_IDS);
+    record.frame.dlc = 8;
+    for (int i = 0; i < 8; i++) record.frame.data[i] = static_cast<uint8_t>(sequence >> (i * 4));
+    return record;
+}
+
+// What each subscription should receive from `events` records
+Expected expectedCounts(uint64_t events) {
+    Expected expected;
+    uint64_t seen100 = 0, seen105 = 0;
+    for (uint64_t i = 0; i < events; i++) {
+        idrive::RingRecord record = makeRecord(i);
+        expected.all++;
+        if (record.kind == static_cast<uint8_t>(idrive::DeviceEventKind::Button)) {
+            expected.buttons++;
+        } else if (record.frame.id == 0x100) {
+            expected.twoIds += seen100++ % 4 == 0;
+        } else if (record.frame.id == 0x105) {
+            expected.twoIds += seen105++ % 4 == 0;
+        }
+    }
+    return expected;
+}
+
+int connectTo(const char *path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        std::perror("bench_event_mux: connect");
+        std::exit(1);
+    }
+    return fd;
+}
+
+// Counts complete lines and the latency of each event line
+void consumeLines(HealthyClient &client, std::vector<uint64_t> &latency) {
+    size_t start = 0;
+    for (size_t nl; (nl = client.pending.find('\n', start)) != std::string::npos; start = nl + 1) {
+        const char *line = client.pending.c_str() + start;
+        if (std::strncmp(line, "OK", 2) == 0) {
+            client.subscribed = true;
+        } else if (std::strncmp(line, "DROPPED", 7) == 0) {
+            client.dropNotices++;
+        } else {
+            char *end;
+            int64_t seconds = std::strtoll(line, &end, 10);
+            int64_t micros = std::strtoll(end + 1, nullptr, 10);
+            int64_t sentUs = seconds * 1000000 + micros;
+            int64_t lateUs = nowNs() / 1000 - sentUs;
+            latency[static_cast<size_t>(std::clamp<int64_t>(lateUs, 0, LATENCY_BUCKETS - 1))]++;
+            client.received++;
+        }
+    }
+    client.pending.erase(0, start);
+}
+
+uint64_t percentile(const std::vector<uint64_t> &histogram, uint64_t total, double fraction) {
+    if (total == 0) return 0;
+    uint64_t target = std::min(total - 1, static_cast<uint64_t>(static_cast<double>(total) * fraction));
+    uint64_t seen = 0;
+    for (size_t us = 0; us < histogram.size(); us++) {
+        seen += histogram[us];
+        if (seen > target) return us;
+    }
+    return histogram.size();
+}
+
+Result runScenario(const Scenario &scenario, int healthy, uint32_t rate, int seconds) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/tmp/idrive-mux-bench-%d.sock", static_cast<int>(::getpid()));
+    idrive::EventMux mux;
+    if (!mux.listen(path, idrive::EVENT_MUX_DEFAULT_QUEUE, scenario.policy, 4096)) {
+        std::perror("bench_event_mux: listen");
+        std::exit(1);
+    }
+
+    uint64_t events = static_cast<uint64_t>(rate) * static_cast<uint64_t>(seconds);
+    uint32_t perBatch = std::max<uint32_t>(1, rate / (1000000 / BATCH_US));
+    events = events / perBatch * perBatch;
+    std::atomic<bool> go{false};
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<bool> stop{false};
+    Result result;
+
+    // Server: what zbe_hub's loop does, with the device replaced by a timer
+    std::thread server([&] {
+        int epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, mux.fd(), &event);
+        while (!go.load()) {
+            if (::epoll_wait(epollFd, &event, 1, 1) > 0) mux.service();
+            accepted.store(mux.stats().accepted);
+        }
+        int64_t start = nowNs();
+        int64_t cpuStart = nowNs(CLOCK_THREAD_CPUTIME_ID);
+        int64_t cpuHalf = cpuStart;
+        int64_t maxLate = 0;
+        uint64_t sequence = 0;
+        for (uint64_t batch = 0; sequence < events; batch++) {
+            if (sequence == events / 2 / perBatch * perBatch) cpuHalf = nowNs(CLOCK_THREAD_CPUTIME_ID);
+            int64_t due = start + static_cast<int64_t>(batch * BATCH_US) * 1000;
+            for (int64_t now; (now = nowNs()) < due;) {
+                int timeout = static_cast<int>((due - now + 999999) / 1000000);
+                if (::epoll_wait(epollFd, &event, 1, timeout) > 0) mux.service();
+            }
+            int64_t published = nowNs();
+            maxLate = std::max(maxLate, published - due);
+            for (uint32_t i = 0; i < perBatch; i++) {
+                idrive::RingRecord record = makeRecord(sequence++);
+                record.hostNs = published;
+                mux.publish(record);
+            }
+            mux.flush();
+        }
+        int64_t cpuEnd = nowNs(CLOCK_THREAD_CPUTIME_ID);
+        result.serverNsPerEvent = static_cast<double>(cpuEnd - cpuStart) / static_cast<double>(events);
+        result.steadyNsPerEvent = static_cast<double>(cpuEnd - cpuHalf) / static_cast<double>(events - events / 2 / perBatch * perBatch);
+        result.maxLateMs = static_cast<double>(maxLate) / 1e6;
+        while (!stop.load()) {
+            if (::epoll_wait(epollFd, &event, 1, 10) > 0) mux.service();
+        }
+        ::close(epollFd);
+    });
+
+    std::vector<int> stalled;
+    for (int i = 0; i < scenario.stalled; i++) stalled.push_back(connectTo(path));
+
+    std::vector<HealthyClient> clients(static_cast<size_t>(healthy));
+    int epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    for (size_t i = 0; i < clients.size(); i++) {
+        HealthyClient &client = clients[i];
+        client.subscription = i % 10 == 0 ? Subscription::All : (i % 2 ? Subscription::TwoIds : Subscription::Buttons);
+        client.fd = connectTo(path);
+        const char *request = SUBSCRIBE[static_cast<int>(client.subscription)];
+        client.subscribed = request[0] == '\0';
+        if (!client.subscribed && ::write(client.fd, request, std::strlen(request)) < 0) std::exit(1);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = &client;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, client.fd, &event);
+    }
+
+    std::vector<uint64_t> latency(LATENCY_BUCKETS);
+    Expected expected = expectedCounts(events);
+    auto wanted = [&](const HealthyClient &client) {
+        return client.subscription == Subscription::All ? expected.all
+             : client.subscription == Subscription::TwoIds ? expected.twoIds : expected.buttons;
+    };
+    auto pump = [&](int timeoutMs) {
+        epoll_event events[64];
+        int ready = ::epoll_wait(epollFd, events, 64, timeoutMs);
+        char buffer[65536];
+        for (int i = 0; i < ready; i++) {
+            auto *client = static_cast<HealthyClient *>(events[i].data.ptr);
+            ssize_t n;
+            while ((n = ::recv(client->fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+                client->pending.append(buffer, static_cast<size_t>(n));
+            }
+            consumeLines(*client, latency);
+        }
+    };
+
+    uint64_t connected = static_cast<uint64_t>(healthy + scenario.stalled);
+    while (accepted.load() < connected ||
+           !std::all_of(clients.begin(), clients.end(), [](const HealthyClient &c) { return c.subscribed; })) {
+        pump(10);
+    }
+    go.store(true);
+    int64_t deadline = nowNs() + (static_cast<int64_t>(seconds) * 1000 + DRAIN_MS) * 1000000;
+    while (nowNs() < deadline &&
+           !std::all_of(clients.begin(), clients.end(), [&](const HealthyClient &c) { return c.received >= wanted(c); })) {
+        pump(10);
+    }
+    stop.store(true);
+    server.join();
+
+    uint64_t total = 0;
+    for (const HealthyClient &client : clients) {
+        result.missing += wanted(client) - std::min(client.received, wanted(client));
+        result.dropNotices += client.dropNotices;
+        total += client.received;
+        ::close(client.fd);
+    }
+    for (int fd : stalled) ::close(fd);
+    ::close(epollFd);
+    result.p50Us = percentile(latency, total, 0.50);
+    result.p99Us = percentile(latency, total, 0.99);
+    result.maxUs = percentile(latency, total, 1.0);
+    result.stats = mux.stats();
+    mux.close();
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    int healthy = argc > 1 ? std::atoi(argv[1]) : 200;
+    int stalled = argc > 2 ? std::atoi(argv[2]) : 300;
+    uint32_t rate = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 5000;
+    int seconds = argc > 4 ? std::atoi(argv[4]) : 4;
+
+    // Two fds per client, both ends in this process
+    rlimit limit{};
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+
+    std::printf("%d healthy clients (1/10 all events, rest 2 IDs at every=4 or buttons), %d stalled,\n"
+                "%u events/s in %u us batches for %d s\n\n",
+                healthy, stalled, rate, BATCH_US, seconds);
+    std::printf("%-22s %10s %10s %8s %8s %8s %8s %8s %10s %7s\n", "scenario", "server ns", "steady ns", "late ms",
+                "p50 us", "p99 us", "max us", "missing", "dropped", "closed");
+
+    const Scenario scenarios[] = {
+        {"healthy only", 0, idrive::SlowClientPolicy::Drop},
+        {"+ stalled, drop", stalled, idrive::SlowClientPolicy::Drop},
+        {"+ stalled, disconnect", stalled, idrive::SlowClientPolicy::Disconnect},
+    };
+    int status = 0;
+    for (const Scenario &scenario : scenarios) {
+        Result result = runScenario(scenario, healthy, rate, seconds);
+        std::printf("%-22s %10.0f %10.0f %8.2f %8llu %8llu %8llu %8llu %10llu %7llu\n", scenario.label,
+                    result.serverNsPerEvent, result.steadyNsPerEvent, result.maxLateMs, static_cast<unsigned long long>(result.p50Us),
+                    static_cast<unsigned long long>(result.p99Us), static_cast<unsigned long long>(result.maxUs),
+                    static_cast<unsigned long long>(result.missing),
+                    static_cast<unsigned long long>(result.stats.dropped),
+                    static_cast<unsigned long long>(result.stats.disconnected));
+        if (result.missing || result.dropNotices) status = 1;
+    }
+    if (status) std::fprintf(stderr, "healthy clients missed events\n");
+    return status;
+}
@@ -0,0 +1,188 @@
+// Writer cost of the shared-memory event ring (idrive/event_ring.h) as the
+// number of attached readers grows. One writer thread publishes frame
+// records as fast as it can while 0..16 reader threads, each with its own
+// mapping as a separate process would have, follow the ring; the last run
+// adds a thread that attaches and detaches continuously.
+//
+//   bench_event_ring [records] [slots]
+//
+// Writer cost is the writer thread's CPU time per record, so it stays
+// meaningful when readers and writer share cores. Readers that fall a ring
+// behind skip ahead; what they read and lost is reported per run.
+
+#include "idrive/event_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int REPEATS = 5;
+const int READER_COUNTS[] = {0, 1, 2, 4, 8, 16};
+
+struct ReaderResult {
+    uint64_t read = 0;
+    uint64_t lost = 0;
+    uint64_t torn = 0;  // records whose payload did not match their sequence
+};
+
+struct RunResult {
+    double   writerNs = 0;  // CPU ns per record
+    double   wallSeconds = 0;
+    uint64_t read = 0;
+    uint64_t lost = 0;
+    uint64_t torn = 0;
+    uint64_t attaches = 0;
+};
+
+double threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) * 1e9 + static_cast<double>(ts.tv_nsec);
+}
+
+void runReader(const char *name, std::atomic<int> &ready, const std::atomic<bool> &done, ReaderResult &result) {
+    idrive::EventRingReader reader;
+    if (!reader.attach(name)) {
+        ready++;
+        return;
+    }
+    ready++;
+    idrive::RingRecord record;
+    for (;;) {
+        if (reader.next(record)) {
+            // The writer stores the sequence in both the id and the timestamp
+            result.read++;
+            result.torn += static_cast<uint64_t>(record.frame.timestampUs) != record.frame.id;
+            continue;
+        }
+        if (done.load(std::memory_order_acquire) && reader.backlog() == 0) break;
+        std::this_thread::yield();
+    }
+    result.lost = reader.lost();
+}
+
+RunResult runOnce(const char *name, uint32_t slots, uint64_t records, int readers, bool churn) {
+    idrive::EventRingWriter writer;
+    if (!writer.create(name, slots)) {
+        std::perror("bench_event_ring: shm_open");
+        std::exit(1);
+    }
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> done{false};
+    std::vector<ReaderResult> results(static_cast<size_t>(readers));
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; r++) {
+        threads.emplace_back(runReader, name, std::ref(ready), std::cref(done),
+                             std::ref(results[static_cast<size_t>(r)]));
+    }
+    std::atomic<uint64_t> attaches{0};
+    std::thread churner;
+    if (churn) {
+        churner = std::thread([&] {
+            idrive::EventRingReader reader;
+            idrive::RingRecord record;
+            while (!done.load(std::memory_order_acquire)) {
+                if (reader.attach(name, true)) {
+                    for (int i = 0; i < 64 && reader.next(record); i++) {
+                    }
+                    reader.detach();
+                    attaches.fetch_add(1, std::memory_order_relaxed);
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+    while (ready.load() < readers) std::this_thread::yield();
+
+    idrive::RingRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.kind = static_cast<uint8_t>(idrive::DeviceEventKind::Frame);
+    record.frame.dlc = 8;
+    timespec wallStart;
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    double cpuStart = threadCpuNs();
+    for (uint64_t i = 0; i < records; i++) {
+        record.hostNs = static_cast<int64_t>(i);
+        record.frame.timestampUs = static_cast<int64_t>(i & 0xFFFFFFFF);
+        record.frame.id = static_cast<uint32_t>(i);
+        writer.publish(record);
+    }
+    double cpuEnd = threadCpuNs();
+    timespec wallEnd;
+    clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+    done.store(true, std::memory_order_release);
+    for (std::thread &thread : threads) thread.join();
+    if (churner.joinable()) churner.join();
+
+    RunResult run;
+    run.writerNs = (cpuEnd - cpuStart) / static_cast<double>(records);
+    run.wallSeconds = static_cast<double>(wallEnd.tv_sec - wallStart.tv_sec) +
+                      static_cast<double>(wallEnd.tv_nsec - wallStart.tv_nsec) / 1e9;
+    for (const ReaderResult &result : results) {
+        run.read += result.read;
+        run.lost += result.lost;
+        run.torn += result.torn;
+    }
+    run.attaches = attaches.load();
+    return run;
+}
+
+RunResult bestRun(const char *name, uint32_t slots, uint64_t records, int readers, bool churn) {
+    RunResult best;
+    best.writerNs = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        RunResult run = runOnce(name, slots, records, readers, churn);
+        if (run.torn) return run;  // always report a consistency failure
+        if (run.writerNs < best.writerNs) best = run;
+    }
+    return best;
+}
+
+void report(const char *label, uint64_t records, int readers, const RunResult &run) {
+    double perReader = readers ? static_cast<double>(records) * readers : 1;
+    std::printf("%-14s %12.1f %12.1f %9.1f%% %9.1f%% %9llu\n", label, run.writerNs,
+                static_cast<double>(records) / run.wallSeconds / 1e6,
+                readers ? 100.0 * static_cast<double>(run.read) / perReader : 0.0,
+                readers ? 100.0 * static_cast<double>(run.lost) / perReader : 0.0,
+                static_cast<unsigned long long>(run.attaches));
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    uint64_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    uint32_t slots = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 0)) : idrive::EVENT_RING_DEFAULT_SLOTS;
+    char name[64];
+    std::snprintf(name, sizeof(name), "/idrive-bench-%d", static_cast<int>(::getpid()));
+
+    std::printf("%llu records into %u slots, %u hardware threads\n\n", static_cast<unsigned long long>(records),
+                slots, std::thread::hardware_concurrency());
+    std::printf("%-14s %12s %12s %10s %10s %9s\n", "readers", "writer ns/rec", "Mrec/s wall", "read", "lost",
+                "attaches");
+
+    int status = 0;
+    for (int readers : READER_COUNTS) {
+        char label[32];
+        std::snprintf(label, sizeof(label), "%d", readers);
+        RunResult run = bestRun(name, slots, records, readers, false);
+        report(label, records, readers, run);
+        if (run.torn) status = 1;
+    }
+    RunResult run = bestRun(name, slots, records, 8, true);
+    report("8 + churn", records, 8, run);
+    if (run.torn) status = 1;
+
+    idrive::EventRingWriter::unlink(name);
+    if (status) std::fprintf(stderr, "readers returned torn records\n");
+    return status;
+}
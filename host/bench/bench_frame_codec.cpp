@@ -0,0 +1,123 @@
+// Per-ID delta codec (src/frame_codec.h): compression ratio and encode /
+// decode speed.
+//
+//   bench_frame_codec [capture files...]
+//
+// Without files, a timed bus simulation (see synthetic_capture.h) is coded.
+// Ratios are against the capture's own text size, the device's 16-byte
+// CaptureRecord and the host's 24-byte Frame. Every run is round-tripped
+// and compared frame-for-frame.
+
+#include "synthetic_capture.h"
+
+#include "idrive/capture.h"
+#include "idrive/mapped_file.h"
+
+#include "capture_format.h"
+#include "frame_codec.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int REPEATS = 5;
+
+CodecFrame toCodec(const idrive::Frame &frame) {
+    CodecFrame codec;
+    codec.timestampUs = frame.timestampUs;
+    codec.id = frame.id;
+    codec.extended = frame.flags & idrive::FRAME_EXTENDED;
+    codec.dlc = frame.dlc;
+    codec.flags = frame.flags;
+    std::memcpy(codec.data, frame.data, sizeof(codec.data));
+    return codec;
+}
+
+bool sameFrame(const CodecFrame &a, const CodecFrame &b) {
+    return a.timestampUs == b.timestampUs && a.id == b.id && a.extended == b.extended && a.dlc == b.dlc &&
+           a.flags == b.flags && std::memcmp(a.data, b.data, a.dlc) == 0;
+}
+
+template <typename Fn>
+double bestSeconds(Fn &&run) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+void benchFrames(const std::string &label, const std::vector<idrive::Frame> &source, size_t textBytes) {
+    std::vector<CodecFrame> frames;
+    frames.reserve(source.size());
+    for (const auto &frame : source) frames.push_back(toCodec(frame));
+
+    std::vector<uint8_t> encoded(frames.size() * CODEC_MAX_FRAME_BYTES);
+    size_t encodedBytes = 0;
+    double encodeSeconds = bestSeconds([&] {
+        FrameEncoder encoder;
+        encodedBytes = 0;
+        for (const auto &frame : frames) encodedBytes += encoder.encode(frame, encoded.data() + encodedBytes);
+    });
+
+    std::vector<CodecFrame> decoded(frames.size());
+    bool ok = true;
+    double decodeSeconds = bestSeconds([&] {
+        FrameDecoder decoder;
+        size_t offset = 0;
+        for (auto &frame : decoded) {
+            int used = decoder.decode(encoded.data() + offset, encodedBytes - offset, frame);
+            if (used <= 0) {
+                ok = false;
+                return;
+            }
+            offset += static_cast<size_t>(used);
+        }
+    });
+    for (size_t i = 0; ok && i < frames.size(); i++) ok = sameFrame(frames[i], decoded[i]);
+
+    double n = static_cast<double>(frames.size());
+    std::printf("%-22s %9zu %6.2f", label.c_str(), frames.size(), encodedBytes / n);
+    if (textBytes) {
+        std::printf(" %7.1fx", static_cast<double>(textBytes) / encodedBytes);
+    } else {
+        std::printf(" %8s", "-");
+    }
+    std::printf(" %7.1fx %7.1fx %8.1f %8.1f %s\n",
+                n * sizeof(CaptureRecord) / encodedBytes, n * sizeof(idrive::Frame) / encodedBytes,
+                n / encodeSeconds / 1e6, n / decodeSeconds / 1e6, ok ? "ok" : "MISMATCH");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    std::printf("%-22s %9s %6s %8s %8s %8s %8s %8s\n",
+                "input", "frames", "B/frm", "vs text", "vs 16B", "vs 24B", "enc Mf/s", "dec Mf/s");
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            idrive::MappedFile file;
+            if (!file.open(argv[i])) {
+                std::fprintf(stderr, "%s\n", file.error().c_str());
+                continue;
+            }
+            std::vector<idrive::Frame> frames;
+            if (idrive::parseDeviceDumps(file.begin(), file.end(), frames) == 0) {
+                idrive::parseCapture(file.begin(), file.end(), idrive::detectFormat(file.data(), file.size()), frames);
+            }
+            benchFrames(argv[i], frames, file.size());
+        }
+        return 0;
+    }
+
+    benchFrames("simulated bus", bench::simulateBus(4000000), 0);
+    return 0;
+}
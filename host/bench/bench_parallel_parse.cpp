@@ -0,0 +1,111 @@
+// Parallel capture ingestion scaling, 1 to N threads.
+//
+//   bench_parallel_parse [max_threads=hardware] [megabytes=1024] [capture file]
+//
+// Parses one capture (synthetic device RAW output by default, see
+// synthetic_capture.h) with parseCaptureParallel() at doubling thread counts
+// and reports throughput, speedup over one thread and parallel efficiency.
+// Every run is checked frame-for-frame against the single-threaded parser,
+// and its MARK markers (count and ordinals) likewise.
+
+#include "synthetic_capture.h"
+
+#include "idrive/capture.h"
+#include "idrive/mapped_file.h"
+#include "idrive/parallel_parse.h"
+#include "idrive/work_stealing_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+constexpr int REPEATS = 3;
+
+template <typename Fn>
+double bestSeconds(Fn &&run) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+bool sameFrames(const std::vector<idrive::Frame> &a, const std::vector<idrive::Frame> &b) {
+    return a.size() == b.size() &&
+           (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(idrive::Frame)) == 0);
+}
+
+bool sameMarkers(const std::vector<idrive::CaptureMarker> &a, const std::vector<idrive::CaptureMarker> &b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const auto &x, const auto &y) {
+               return x.number == y.number && x.ordinal == y.ordinal;
+           });
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    unsigned maxThreads = (argc > 1) ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 0;
+    if (maxThreads == 0) maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t megabytes = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 1024;
+    if (megabytes == 0) megabytes = 1024;
+
+    std::string path;
+    bool temporary = false;
+    if (argc > 3) {
+        path = argv[3];
+    } else {
+        path = bench::writeTemp(bench::synthesize(idrive::CaptureFormat::DeviceRaw, megabytes << 20));
+        temporary = true;
+    }
+
+    idrive::MappedFile file;
+    bool opened = file.open(path);
+    if (temporary) ::unlink(path.c_str());
+    if (!opened) {
+        std::fprintf(stderr, "%s\n", file.error().c_str());
+        return 1;
+    }
+    idrive::CaptureFormat format = idrive::detectFormat(file.data(), file.size());
+    double gb = file.size() / 1e9;
+
+    std::vector<idrive::Frame> reference;
+    idrive::ParseState referenceState;
+    idrive::parseCapture(file.begin(), file.end(), format, reference, nullptr, idrive::ParseKernel::Simd,
+                         &referenceState);
+
+    std::printf("%s, %s, %.1f MB, %zu frames, %zu markers, SIMD level %s, best of %d runs\n",
+                path.c_str(), idrive::formatName(format), file.size() / 1e6, reference.size(),
+                referenceState.markers.size(), idrive::simdLevelName(), REPEATS);
+    std::printf("%8s %9s %9s %8s %10s %s\n", "threads", "seconds", "GB/s", "speedup", "efficiency", "check");
+
+    double baseline = 0;
+    std::vector<idrive::Frame> frames;
+    std::vector<idrive::CaptureMarker> markers;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        idrive::WorkStealingPool pool(threads);
+        double seconds = bestSeconds([&] {
+            idrive::parseCaptureParallel(file.begin(), file.end(), format, frames, pool, nullptr,
+                                         idrive::ParallelParseOptions(), &markers);
+        });
+        bool ok = sameFrames(reference, frames) && sameMarkers(referenceState.markers, markers);
+        if (threads == 1) baseline = seconds;
+
+        double speedup = baseline / seconds;
+        std::printf("%8u %9.3f %9.2f %7.2fx %9.0f%% %s\n", threads, seconds, gb / seconds, speedup,
+                    100.0 * speedup / threads, ok ? "ok" : "MISMATCH");
+        if (threads == maxThreads) break;
+    }
+    return 0;
+}
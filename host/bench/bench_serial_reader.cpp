@@ -0,0 +1,298 @@
+// Host serial reader latency and throughput, on a pty standing in for the
+// device's USB CDC tty. Three readers follow the same stream:
+//
+//   naive   stdio fgets() per line on a tty left in canonical mode, sscanf
+//   read    DeviceClient: raw tty, VMIN=1/VTIME=0, poll() plus one large
+//           read() into the parser buffer, batch dispatch
+//   uring   DeviceClient with DeviceUringReader: a read always queued in
+//           io_uring, parsed while the next one is pending
+//
+//   bench_serial_reader [megabytes] [samples]
+//
+// Latency is from the writer's write() of a "LAT <seq>" line to the reader
+// handling the event, once on an idle line (one LAT per ms) and once with
+// the line saturated at the USB full-speed ceiling by RAW frame lines.
+// Throughput is a RAW frame stream written as fast as the pty takes it.
+// A pty has no USB latency and no low-latency flag, so this measures the
+// host side only: tty layer, wake-up, read and parse.
+
+#include "synthetic_capture.h"
+
+#include "idrive/device_client.h"
+#include "idrive/device_uring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t END_SEQUENCE   = 0xFFFFFFFF;
+constexpr int64_t  PERIOD_NS      = 1000000;
+constexpr size_t   USB_FS_CEILING = 19 * 64;  // bytes per 1 ms USB frame
+constexpr size_t   WRITE_SIZE     = 4096;
+
+enum class ReaderKind { Naive, Read, Uring };
+
+const char *const READER_NAMES[] = {"naive fgets", "DeviceClient read", "DeviceClient io_uring"};
+
+int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void sleepUntil(int64_t ns) {
+    timespec ts{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+// RAW frame lines only, one per frame
+std::string buildFrames(size_t targetBytes, size_t &frames) {
+    std::string out;
+    out.reserve(targetBytes + 128);
+    auto bus = bench::simulateBus(targetBytes / 56 + 1);
+    frames = 0;
+    for (size_t i = 0; out.size() < targetBytes; i++) {
+        const idrive::Frame &frame = bus[i % bus.size()];
+        const uint8_t *d = frame.data;
+        char line[96];
+        int n = std::snprintf(line, sizeof(line), "[%6lldms] [RAW] 0x%X: %02X %02X %02X %02X %02X %02X %02X %02X\r\n",
+                              static_cast<long long>(frame.timestampUs / 1000), frame.id, d[0], d[1], d[2], d[3],
+                              d[4], d[5], d[6], d[7]);
+        out.append(line, static_cast<size_t>(n));
+        frames++;
+    }
+    return out;
+}
+
+struct Pty {
+    int         master = -1;
+    std::string slave;
+
+    Pty() {
+        master = ::posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (master < 0 || ::grantpt(master) != 0 || ::unlockpt(master) != 0) {
+            std::perror("bench_serial_reader: posix_openpt");
+            std::exit(1);
+        }
+        slave = ::ptsname(master);
+    }
+    ~Pty() { ::close(master); }
+};
+
+bool writeAll(int fd, const char *data, size_t size) {
+    while (size) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// What the readers report back; receive times are indexed by LAT sequence
+struct Sink {
+    std::vector<int64_t> received;
+    size_t               frames = 0;
+    int64_t              endNs = 0;
+
+    // False once the end marker arrived
+    bool latency(uint32_t sequence) {
+        int64_t now = nowNs();
+        if (sequence == END_SEQUENCE) {
+            endNs = now;
+            return false;
+        }
+        if (sequence < received.size()) received[sequence] = now;
+        return true;
+    }
+};
+
+void readNaive(const char *path, std::atomic<bool> &ready, Sink &sink) {
+    int fd = ::open(path, O_RDONLY | O_NOCTTY | O_CLOEXEC);
+    termios tio{};
+    ::tcgetattr(fd, &tio);
+    tio.c_lflag &= ~ECHO;  // the one change: keep the pty from looping the stream back
+    ::tcsetattr(fd, TCSANOW, &tio);
+    FILE *in = ::fdopen(fd, "r");
+    ready = true;
+    char line[4096];
+    while (std::fgets(line, sizeof(line), in)) {
+        unsigned sequence, id, b0;
+        if (std::sscanf(line, "LAT %u", &sequence) == 1) {
+            if (!sink.latency(sequence)) break;
+        } else if (std::sscanf(line, "[%*[^]]] [%*[^]]] 0x%x: %x", &id, &b0) == 2) {
+            sink.frames++;
+        }
+    }
+    std::fclose(in);
+}
+
+void readClient(const char *path, bool uring, std::atomic<bool> &ready, Sink &sink) {
+    idrive::DeviceClient client;
+    if (!client.open(path)) {
+        std::perror("bench_serial_reader: open");
+        std::exit(1);
+    }
+    client.setEventMask(idrive::eventBit(idrive::DeviceEventKind::Frame) |
+                        idrive::eventBit(idrive::DeviceEventKind::Latency));
+    idrive::DeviceUringReader reader;
+    if (uring && !reader.start(client.fd(), client.parser())) {
+        std::perror("bench_serial_reader: io_uring");
+        std::exit(1);
+    }
+    ready = true;
+    bool running = true;
+    while (running && (uring ? reader.receive(client.parser(), -1) : client.receive(-1))) {
+        client.dispatch([&](const idrive::DeviceEvent &event) {
+            if (event.kind == idrive::DeviceEventKind::Frame) {
+                sink.frames++;
+            } else if (!sink.latency(event.latencySequence)) {
+                running = false;
+            }
+        });
+    }
+}
+
+// Runs reader against writer on a fresh pty; the writer returns its start time
+template <typename Writer>
+Sink runOnce(ReaderKind kind, size_t samples, Writer &&writer, int64_t &startNs) {
+    Pty pty;
+    Sink sink;
+    sink.received.assign(samples, 0);
+    std::atomic<bool> ready{false};
+    // The slave has to be open before the master writes, or the bytes are lost
+    std::thread thread([&] {
+        if (kind == ReaderKind::Naive) {
+            readNaive(pty.slave.c_str(), ready, sink);
+        } else {
+            readClient(pty.slave.c_str(), kind == ReaderKind::Uring, ready, sink);
+        }
+    });
+    while (!ready.load()) std::this_thread::yield();
+    usleep(10000);
+    startNs = writer(pty.master);
+    char end[32];
+    int n = std::snprintf(end, sizeof(end), "LAT %u\r\n", END_SEQUENCE);
+    writeAll(pty.master, end, static_cast<size_t>(n));
+    thread.join();
+    return sink;
+}
+
+struct Latency {
+    double p50 = 0, p99 = 0, max = 0;  // us
+    size_t missing = 0;
+};
+
+Latency summarize(const std::vector<int64_t> &sent, const std::vector<int64_t> &received) {
+    std::vector<int64_t> delays;
+    Latency latency;
+    for (size_t i = 0; i < sent.size(); i++) {
+        if (received[i] == 0) {
+            latency.missing++;
+            continue;
+        }
+        delays.push_back(received[i] - sent[i]);
+    }
+    if (delays.empty()) return latency;
+    std::sort(delays.begin(), delays.end());
+    latency.p50 = static_cast<double>(delays[delays.size() / 2]) / 1e3;
+    latency.p99 = static_cast<double>(delays[delays.size() * 99 / 100]) / 1e3;
+    latency.max = static_cast<double>(delays.back()) / 1e3;
+    return latency;
+}
+
+// One LAT line per period; with load, a USB frame's worth of RAW lines in front of each
+Latency measureLatency(ReaderKind kind, size_t samples, const std::string *load, size_t &frames) {
+    std::vector<int64_t> sent(samples);
+    int64_t start;
+    size_t loadOffset = 0;
+    size_t loadFrames = 0;
+    Sink sink = runOnce(kind, samples, [&](int master) {
+        int64_t begin = nowNs();
+        std::string chunk;
+        for (size_t i = 0; i < samples; i++) {
+            sleepUntil(begin + static_cast<int64_t>(i + 1) * PERIOD_NS);
+            chunk.clear();
+            if (load) {
+                // Whole lines only, about USB_FS_CEILING bytes
+                size_t end = load->find('\n', std::min(loadOffset + USB_FS_CEILING, load->size() - 1));
+                if (end == std::string::npos) {
+                    loadOffset = 0;
+                    end = load->find('\n', USB_FS_CEILING);
+                }
+                chunk.append(*load, loadOffset, end + 1 - loadOffset);
+                loadFrames += static_cast<size_t>(std::count(chunk.begin(), chunk.end(), '\n'));
+                loadOffset = end + 1 == load->size() ? 0 : end + 1;
+            }
+            char line[32];
+            chunk.append(line, static_cast<size_t>(std::snprintf(line, sizeof(line), "LAT %zu\r\n", i)));
+            sent[i] = nowNs();
+            writeAll(master, chunk.data(), chunk.size());
+        }
+        return begin;
+    }, start);
+    frames = sink.frames == loadFrames ? 0 : loadFrames - std::min(loadFrames, sink.frames);
+    return summarize(sent, sink.received);
+}
+
+double measureThroughput(ReaderKind kind, const std::string &stream, size_t expected, bool &complete) {
+    int64_t start;
+    Sink sink = runOnce(kind, 0, [&](int master) {
+        int64_t begin = nowNs();
+        for (size_t offset = 0; offset < stream.size(); offset += WRITE_SIZE) {
+            writeAll(master, stream.data() + offset, std::min(WRITE_SIZE, stream.size() - offset));
+        }
+        return begin;
+    }, start);
+    complete = sink.frames == expected;
+    return static_cast<double>(stream.size()) / (static_cast<double>(sink.endNs - start) / 1e9) / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+    size_t samples = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    size_t expected = 0;
+    std::string stream = buildFrames(megabytes << 20, expected);
+
+    std::printf("pty loopback; latency over %zu LAT lines at 1 kHz, idle and under %.2f MB/s of RAW frames;\n"
+                "throughput over %.1f MB of RAW frames\n\n",
+                samples, USB_FS_CEILING * 1e3 / 1e6, static_cast<double>(stream.size()) / 1e6);
+    std::printf("%-22s %27s %27s %10s\n", "", "idle latency us", "saturated latency us", "");
+    std::printf("%-22s %9s %8s %8s %9s %8s %8s %10s %9s\n", "reader", "p50", "p99", "max", "p50", "p99", "max",
+                "MB/s", "headroom");
+
+    int status = 0;
+    for (ReaderKind kind : {ReaderKind::Naive, ReaderKind::Read, ReaderKind::Uring}) {
+        size_t lostFrames = 0;
+        Latency idle = measureLatency(kind, samples, nullptr, lostFrames);
+        Latency loaded = measureLatency(kind, samples, &stream, lostFrames);
+        bool complete = false;
+        double mbps = measureThroughput(kind, stream, expected, complete);
+        std::printf("%-22s %9.1f %8.1f %8.1f %9.1f %8.1f %8.1f %10.1f %8.0fx\n", READER_NAMES[static_cast<int>(kind)],
+                    idle.p50, idle.p99, idle.max, loaded.p50, loaded.p99, loaded.max, mbps,
+                    mbps * 1e6 / (USB_FS_CEILING * 1e3));
+        if (idle.missing || loaded.missing || lostFrames || !complete) {
+            std::fprintf(stderr, "%s: %zu + %zu LAT lines missing, %zu frames lost, throughput run %s\n",
+                         READER_NAMES[static_cast<int>(kind)], idle.missing, loaded.missing, lostFrames,
+                         complete ? "complete" : "incomplete");
+            status = 1;
+        }
+    }
+    return status;
+}
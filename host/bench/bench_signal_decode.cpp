@@ -0,0 +1,175 @@
+// Signal extraction for the K-CAN messages in dbc/idrive_kcan.dbc: the
+// hand-written byte/shift code the firmware used to have, the generated
+// constexpr accessors (kcan_signals.h), a walk over the generated SIGNALS
+// table, and specs parsed at runtime from the DBC text with the firmware's
+// line parser (the serial upload path).
+//
+//   bench_signal_decode [file.dbc]
+//
+// Each decoder sums every signal of every frame of a timed bus simulation
+// (see synthetic_capture.h); all sums must agree.
+
+#include "synthetic_capture.h"
+
+#include "idrive/capture.h"
+
+#include "dbc_parse.h"
+#include "kcan_signals.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int REPEATS = 5;
+
+// Owns the strings a runtime SignalSpec points at
+struct RuntimeSignal {
+    SignalSpec  spec;
+    std::string message;
+    std::string name;
+};
+
+template <typename Fn>
+double bestSeconds(Fn &&run) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// What the decoders looked like before the DBC: byte indexes and shifts
+uint64_t sumHandWritten(const std::vector<idrive::Frame> &frames) {
+    uint64_t sum = 0;
+    for (const auto &frame : frames) {
+        const uint8_t *d = frame.data;
+        switch (frame.id) {
+            case 0x25B:
+                sum += d[0] + d[1] + d[3] + d[4] + d[5] + d[6] + d[7];
+                break;
+            case 0x0BF:
+                sum += d[0] + d[1];
+                sum += (d[2] >> 4) | (d[3] << 4);
+                sum += (d[4] >> 4) | (d[5] << 4);
+                break;
+            case 0x202:
+                sum += d[0];
+                break;
+        }
+    }
+    return sum;
+}
+
+uint64_t sumGenerated(const std::vector<idrive::Frame> &frames) {
+    namespace zbe = kcan::zbe_controller;
+    namespace pad = kcan::zbe_touchpad;
+    uint64_t sum = 0;
+    for (const auto &frame : frames) {
+        const uint8_t *d = frame.data;
+        switch (frame.id) {
+            case zbe::ID:
+                sum += zbe::sequence(d) + zbe::encoder(d) + zbe::knob(d) + zbe::backHome(d) + zbe::comOption(d) +
+                       zbe::mediaNav(d) + zbe::mapGlobe(d);
+                break;
+            case pad::ID:
+                sum += pad::counter(d) + pad::fingers(d) + pad::touchX(d) + pad::touchY(d);
+                break;
+            case kcan::idrive_brightness::ID:
+                sum += kcan::idrive_brightness::level(d);
+                break;
+        }
+    }
+    return sum;
+}
+
+template <typename Spec, typename SpecOf>
+uint64_t sumTable(const std::vector<idrive::Frame> &frames, const Spec *specs, size_t count, SpecOf specOf) {
+    uint64_t sum = 0;
+    for (const auto &frame : frames) {
+        for (size_t i = 0; i < count; i++) {
+            const SignalSpec &spec = specOf(specs[i]);
+            if (spec.messageId == frame.id) sum += static_cast<uint64_t>(extractSignalValue(spec, frame.data));
+        }
+    }
+    return sum;
+}
+
+bool loadRuntimeSignals(const char *path, std::vector<RuntimeSignal> &signals) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    DbcMessage message{};
+    DbcSignal signal{};
+    std::string line;
+    while (std::getline(in, line)) {
+        if (parseDbcLine(line.c_str(), message, signal) != DbcLineKind::Signal) continue;
+        RuntimeSignal runtime;
+        runtime.message = message.name;
+        runtime.name = signal.name;
+        runtime.spec = SignalSpec{message.id, nullptr, nullptr, signal.startBit, signal.length, signal.order,
+                                  signal.isSigned, signal.factor, signal.offset, "", nullptr, 0};
+        signals.push_back(runtime);
+    }
+    for (auto &runtime : signals) {
+        runtime.spec.message = runtime.message.c_str();
+        runtime.spec.name = runtime.name.c_str();
+    }
+    return true;
+}
+
+void report(const char *label, size_t frames, double seconds, uint64_t sum, uint64_t expected) {
+    std::printf("%-26s %10.2f %10.1f  %s\n", label, seconds * 1e9 / static_cast<double>(frames),
+                static_cast<double>(frames) / seconds / 1e6, sum == expected ? "ok" : "MISMATCH");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    const char *dbcPath = argc > 1 ? argv[1] : IDRIVE_KCAN_DBC;
+    std::vector<RuntimeSignal> runtime;
+    if (!loadRuntimeSignals(dbcPath, runtime)) {
+        std::fprintf(stderr, "cannot read %s\n", dbcPath);
+        return 1;
+    }
+
+    auto frames = bench::simulateBus(4000000);
+    // The simulation has no brightness frames; add some so every message is exercised
+    for (size_t i = 0; i < frames.size(); i += 50) {
+        frames[i].id = 0x202;
+        frames[i].dlc = 1;
+    }
+
+    std::printf("%zu frames, %u compiled signals, %zu parsed from %s\n\n", frames.size(), kcan::SIGNAL_COUNT,
+                runtime.size(), dbcPath);
+    std::printf("%-26s %10s %10s\n", "decoder", "ns/frame", "Mframes/s");
+
+    uint64_t expected = 0, sum = 0;
+    double seconds = bestSeconds([&] { expected = sumHandWritten(frames); });
+    report("hand-written shifts", frames.size(), seconds, expected, expected);
+
+    seconds = bestSeconds([&] { sum = sumGenerated(frames); });
+    report("generated accessors", frames.size(), seconds, sum, expected);
+
+    seconds = bestSeconds([&] {
+        sum = sumTable(frames, kcan::SIGNALS, kcan::SIGNAL_COUNT, [](const SignalSpec &s) -> const SignalSpec & {
+            return s;
+        });
+    });
+    report("generated SIGNALS table", frames.size(), seconds, sum, expected);
+
+    seconds = bestSeconds([&] {
+        sum = sumTable(frames, runtime.data(), runtime.size(), [](const RuntimeSignal &s) -> const SignalSpec & {
+            return s.spec;
+        });
+    });
+    report("runtime-parsed DBC", frames.size(), seconds, sum, expected);
+    return 0;
+}
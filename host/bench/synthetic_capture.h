@@ -0,0 +1,176 @@
+#pragma once
+
+// Synthetic capture corpus shared by the parser benchmarks: K-CAN traffic
+// patterns (0x25B, 0x567, 0x5E7, 0x0BF) rendered in any supported text
+// format and written to a temporary file for the mmap reader, with a
+// "MARK n" line every MARK_INTERVAL frames as the firmware's `m` prints.
+
+#include "idrive/capture.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace bench {
+
+constexpr uint64_t MARK_INTERVAL = 100000;
+
+inline void appendFrameLine(std::string &out, idrive::CaptureFormat format, const idrive::Frame &frame) {
+    char line[128];
+    int n = 0;
+    const uint8_t *d = frame.data;
+    switch (format) {
+        case idrive::CaptureFormat::Putty:
+            n = std::snprintf(line, sizeof(line),
+                              "Standard ID: 0x%03X       DLC: 8  Data: 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X\r\n",
+                              frame.id, d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7]);
+            break;
+        case idrive::CaptureFormat::IdsNotes:
+            n = std::snprintf(line, sizeof(line), "[RAW] ID:0x%03X Data: %02X %02X %02X %02X %02X %02X %02X %02X\r\n",
+                              frame.id, d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7]);
+            break;
+        case idrive::CaptureFormat::DeviceRaw:
+            n = std::snprintf(line, sizeof(line), "[%6lldms] [RAW] 0x%X: %02X %02X %02X %02X %02X %02X %02X %02X\r\n",
+                              static_cast<long long>(frame.timestampUs / 1000), frame.id,
+                              d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7]);
+            // The firmware repeats the heartbeat under its handler tag,
+            // which the parser has to drop again
+            if (frame.id == 0x567) {
+                out.append(line, static_cast<size_t>(n));
+                n = std::snprintf(line, sizeof(line), "[%6lldms] [ID_567] 0x%X: %02X %02X %02X %02X %02X %02X %02X %02X\r\n",
+                                  static_cast<long long>(frame.timestampUs / 1000), frame.id,
+                                  d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7]);
+            }
+            break;
+        case idrive::CaptureFormat::Candump:
+            n = std::snprintf(line, sizeof(line), "(%lld.%06lld) can0 %03X#%02X%02X%02X%02X%02X%02X%02X%02X\n",
+                              static_cast<long long>(frame.timestampUs / 1000000),
+                              static_cast<long long>(frame.timestampUs % 1000000), frame.id,
+                              d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7]);
+            break;
+        default:
+            break;
+    }
+    out.append(line, static_cast<size_t>(n));
+}
+
+inline std::string synthesize(idrive::CaptureFormat format, size_t targetBytes) {
+    std::mt19937 rng(42);
+    std::string out;
+    out.reserve(targetBytes + 256);
+
+    idrive::Frame frame{};
+    frame.dlc = 8;
+    uint8_t counter = 0;
+    for (uint64_t i = 0; out.size() < targetBytes; i++) {
+        frame.timestampUs = 1700000000000000LL + static_cast<int64_t>(i) * 1700;
+        switch (rng() % 4) {
+            case 0: {
+                static const uint8_t heartbeat[8] = {0x40, 0x67, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00};
+                frame.id = 0x567;
+                std::memcpy(frame.data, heartbeat, 8);
+                break;
+            }
+            case 1: {
+                static const uint8_t status[8] = {0x05, 0x67, 0x04, 0x02, 0x00, 0x00, 0xFF, 0xFF};
+                frame.id = 0x5E7;
+                std::memcpy(frame.data, status, 8);
+                break;
+            }
+            case 2: {
+                static const uint8_t idle[8] = {0x00, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0xC0, 0xC0};
+                frame.id = 0x25B;
+                std::memcpy(frame.data, idle, 8);
+                frame.data[0] = counter++;
+                frame.data[4] = (rng() % 8 == 0) ? 0x20 : 0x00;
+                break;
+            }
+            default:
+                frame.id = 0x0BF;
+                for (auto &b : frame.data) b = static_cast<uint8_t>(rng());
+                break;
+        }
+        appendFrameLine(out, format, frame);
+        if ((i + 1) % MARK_INTERVAL == 0) {
+            out += "MARK " + std::to_string((i + 1) / MARK_INTERVAL);
+            out += (format == idrive::CaptureFormat::Candump) ? "\n" : "\r\n";
+        }
+    }
+    return out;
+}
+
+inline std::string writeTemp(const std::string &content) {
+    char path[] = "/tmp/idrive_bench_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        std::exit(1);
+    }
+    size_t done = 0;
+    while (done < content.size()) {
+        ssize_t n = ::write(fd, content.data() + done, content.size() - done);
+        if (n <= 0) {
+            std::perror("write");
+            std::exit(1);
+        }
+        done += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    return path;
+}
+
+// Timed bus simulation for codec and query benchmarks: each ID on its own
+// cycle with a few tens of microseconds of arbitration jitter, rolling
+// counters in 0x25B/0x0BF, occasional touch coordinates in 0x0BF and
+// occasional button activity (byte 3 = 0x01, byte 4 toggling) in 0x25B.
+inline std::vector<idrive::Frame> simulateBus(size_t frameCount) {
+    struct Source {
+        uint32_t id;
+        int64_t  periodUs;
+        int64_t  nextUs;
+        uint8_t  data[8];
+    };
+    Source sources[] = {
+        {0x0BF, 20000, 0, {0x00, 0x01, 0x00, 0x81, 0x02, 0x7F, 0x03, 0x00}},
+        {0x25B, 100000, 3000, {0x00, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0xC0, 0xC0}},
+        {0x567, 200000, 7000, {0x40, 0x67, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00}},
+        {0x5E7, 200000, 11000, {0x05, 0x67, 0x04, 0x02, 0x00, 0x00, 0xFF, 0xFF}},
+        {0x510, 500000, 13000, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    };
+
+    std::mt19937 rng(7);
+    std::vector<idrive::Frame> frames;
+    frames.reserve(frameCount);
+    while (frames.size() < frameCount) {
+        Source *next = &sources[0];
+        for (Source &source : sources) {
+            if (source.nextUs < next->nextUs) next = &source;
+        }
+
+        idrive::Frame frame{};
+        frame.timestampUs = next->nextUs + static_cast<int64_t>(rng() % 64);
+        frame.id = next->id;
+        frame.dlc = 8;
+        frame.flags = (next->id == 0x510) ? idrive::FRAME_TX : 0;
+        if (next->id == 0x0BF || next->id == 0x25B) next->data[0]++;
+        if (next->id == 0x0BF && rng() % 16 == 0) {
+            next->data[2] = static_cast<uint8_t>(rng());
+            next->data[3] = static_cast<uint8_t>(0x80 | (rng() & 0x0F));
+        }
+        if (next->id == 0x25B && rng() % 32 == 0) {
+            next->data[3] ^= 0x01;
+            next->data[4] = (rng() % 2) ? 0x20 : 0x00;
+        }
+        std::memcpy(frame.data, next->data, 8);
+        frames.push_back(frame);
+        next->nextUs += next->periodUs;
+    }
+    return frames;
+}
+
+}  // namespace bench
@@ -0,0 +1,153 @@
+#pragma once
+
+// Correlates CAN signals with a timeline of labelled actions ("BACK held
+// from 12.5 s to 14.0 s"), the way IDs.txt was put together by hand. Each
+// frame updates per-ID byte value counts overall and per active action, so
+// one pass over a capture of any length is enough. For every (ID, byte,
+// value) and (ID, byte, bit) the action's window membership is compared
+// with the signal by the phi coefficient of their 2x2 table: 1 means the
+// value occurs exactly while the action is held.
+//
+// Windows come from a side file in seconds or from MARK lines (the
+// firmware's `m` command) recorded in the capture itself.
+
+#include "idrive/capture.h"
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace idrive {
+
+// One labelled window, start inclusive, end exclusive. A label may carry a
+// state suffix, "BACK:touched"; plain labels mean the pressed state.
+struct ActionWindow {
+    std::string label;
+    bool     byMarker = false;
+    int64_t  startUs = 0;  // time windows, on the capture clock
+    int64_t  endUs = 0;
+    uint32_t startMark = 0;  // marker windows, MARK numbers
+    uint32_t endMark = 0;
+};
+
+// Side file lines, '#' starts a comment:
+//   12.500 14.000 BACK      seconds on the capture clock
+//   M3 M4 HOME:touched      between the MARK 3 and MARK 4 lines
+bool loadActionTimeline(const std::string &path, std::vector<ActionWindow> &windows, std::string &error);
+
+// Consecutive marker pairs (1,2), (3,4), ... labelled in order
+std::vector<ActionWindow> markerPairWindows(const std::vector<std::string> &labels);
+
+struct SignalCorrelation {
+    uint32_t id;
+    bool     extended;
+    int      byte;
+    int      value;  // -1 for bit correlations
+    int      bit;    // -1 for value correlations
+    double   phi;
+    double   z;           // phi * sqrt(n), normal under independence
+    double   inShare;     // share of in-window frames carrying the signal
+    double   outShare;    // share of the other frames carrying it
+    double   onset;       // values: mean frames of the ID into a window before the value first shows
+    int      restValue;   // the byte's most common value outside the action's windows
+};
+
+struct ActionReport {
+    std::string label;
+    size_t   windows = 0;
+    uint64_t framesInWindow = 0;
+    std::vector<SignalCorrelation> signals;  // descending phi
+};
+
+struct CorrelateOptions {
+    double   minPhi = 0.3;
+    double   minZ = 5.0;
+    uint64_t minFramesInWindow = 2;  // per ID
+    size_t   maxSignals = 10;        // values and bits each, per action
+    bool     includeBits = true;
+};
+
+class ActionCorrelator {
+public:
+    // relativeTime: window times count from the first frame instead of the capture clock
+    explicit ActionCorrelator(std::vector<ActionWindow> windows, bool relativeTime = false);
+
+    // Markers must arrive no later than the first frame after them
+    void addMarkers(const CaptureMarker *markers, size_t count);
+    void add(const Frame *frames, size_t count);
+
+    uint64_t frameCount() const { return ordinal_; }
+    size_t markerCount() const { return markersSeen_; }
+
+    std::vector<ActionReport> report(const CorrelateOptions &options = CorrelateOptions()) const;
+
+private:
+    struct Counts {
+        uint64_t frames = 0;
+        std::array<std::array<uint64_t, 256>, 8> values{};
+
+        void add(const Frame &frame);
+    };
+
+    // Counts while an action is active, plus when each value first shows
+    // up in a window: a touch precedes the press it belongs to
+    struct WindowCounts : Counts {
+        uint64_t window = 0;  // window serial of the action last seen
+        uint64_t framesThisWindow = 0;
+        std::array<std::bitset<256>, 8> seenThisWindow;
+        std::array<std::array<uint64_t, 256>, 8> onsetSum{};
+        std::array<std::array<uint32_t, 256>, 8> windowsWithValue{};
+
+        void add(const Frame &frame, uint64_t windowSerial);
+    };
+
+    struct IdStats {
+        uint32_t id = 0;
+        bool     extended = false;
+        Counts   all;
+        std::vector<std::unique_ptr<WindowCounts>> actions;  // by action index, allocated on first in-window frame
+    };
+
+    struct Event {
+        int64_t timeUs;
+        size_t  action;
+        bool    open;
+    };
+
+    void apply(size_t action, bool open);
+    void applyMarker(uint32_t number);
+    void add(const Frame &frame);
+
+    std::vector<std::string> labels_;
+    std::vector<size_t> windowCounts_;
+    std::vector<uint64_t> framesInWindow_;
+    std::vector<Event> timeEvents_;  // sorted by time, closes first on ties
+    size_t nextTimeEvent_ = 0;
+    std::unordered_map<uint32_t, std::vector<Event>> markerEvents_;
+    std::vector<CaptureMarker> pendingMarkers_;
+    size_t nextMarker_ = 0;
+    size_t markersSeen_ = 0;
+
+    std::vector<uint32_t> depth_;  // open windows per action
+    std::vector<uint64_t> windowSerial_;
+    std::vector<size_t> active_;
+    std::unordered_map<uint64_t, IdStats> ids_;
+    uint64_t ordinal_ = 0;
+    bool relativeTime_;
+    int64_t originUs_ = 0;
+};
+
+// "button" entries for zbe/<variant>.spec (scripts/zbe_codegen.py), one per
+// action with a value candidate: pressed from the plain label, touched from a
+// ":touched" label on the same ID and byte, else the byte's next best value
+// split by onset (the earlier value is the touch), released from the byte's
+// resting value. touched= is left out when nothing distinct was found; the
+// generator rejects the entry until it is filled in.
+std::string buttonSpecEntries(const std::vector<ActionReport> &reports);
+
+}  // namespace idrive
@@ -0,0 +1,107 @@
+#pragma once
+
+// Capture model shared by the host analysis tools: a packed frame record,
+// the text capture formats the project has accumulated, and a parser that
+// turns a mapped capture file into a flat frame array.
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace idrive {
+
+enum FrameFlags : uint8_t {
+    FRAME_TX         = 0x01,  // sent by the device (keepalive, brightness)
+    FRAME_EXTENDED   = 0x02,  // 29-bit identifier
+    FRAME_SYNTH_TIME = 0x04,  // source had no timestamp; see SYNTHETIC_FRAME_SPACING_US
+};
+
+struct Frame {
+    int64_t  timestampUs;
+    uint32_t id;
+    uint8_t  dlc;
+    uint8_t  flags;
+    uint16_t idSequence;  // n-th frame of this ID in the capture, wraps at 65536
+    uint8_t  data[8];
+};
+
+static_assert(sizeof(Frame) == 24, "Frame must stay packed to 24 bytes");
+
+// Formats without timestamps get monotonic ones, one frame per millisecond
+constexpr int64_t SYNTHETIC_FRAME_SPACING_US = 1000;
+
+enum class CaptureFormat : uint8_t {
+    Unknown,
+    Putty,      // "Standard ID: 0x25B       DLC: 8  Data: 0x00 0xFF ..."
+    IdsNotes,   // "[RAW] ID:0x25B Data: 03 FF ..." mixed with free-text notes (IDs.txt)
+    DeviceRaw,  // firmware RAW/DEBUG output "[  1234ms] [RAW] 0x25B: 00 FF ..."
+    Candump,    // candump -l "(1600000000.123456) can0 25B#00FF..."
+};
+
+const char *formatName(CaptureFormat format);
+
+// Looks at the first few lines; notes and banners are skipped
+CaptureFormat detectFormat(const char *data, size_t size);
+
+enum class ParseKernel : uint8_t {
+    Scalar,
+    Simd,  // best of AVX2 / SSSE3 available at runtime, scalar otherwise
+};
+
+// Name of the vector level ParseKernel::Simd resolves to on this CPU
+const char *simdLevelName();
+
+struct ParseStats {
+    size_t lines   = 0;
+    size_t frames  = 0;
+    size_t skipped = 0;  // non-frame lines (notes, banners, decoded events)
+};
+
+// A "MARK n" line from the bit watch `m` command, placed between frames
+struct CaptureMarker {
+    uint32_t number;
+    size_t   ordinal;  // frames parsed before the marker
+};
+
+// State carried from one line to the next. Passing the same state to
+// consecutive parseCapture() calls continues a capture seamlessly; the
+// parallel parser gives each chunk a fresh one and stitches them afterwards.
+struct ParseState {
+    size_t ordinal = 0;  // frames emitted so far, drives synthetic timestamps
+
+    // Frames seen per ID, source of Frame::idSequence
+    std::vector<uint32_t> standardIdCounts = std::vector<uint32_t>(0x800);
+    std::unordered_map<uint32_t, uint32_t> extendedIdCounts;
+
+    // Device RAW output repeats a RAW frame under its handler tag on the
+    // next line; the previous RAW frame is kept to drop the repeat.
+    bool  havePreviousRaw = false;
+    Frame previousRaw{};
+
+    // First line of this parse was a tagged (non-RAW) device frame, i.e. a
+    // possible repeat of a RAW frame at the end of the preceding chunk
+    bool leadingTaggedFrame = false;
+    bool sawLine = false;
+
+    // Markers seen so far; the caller drains them between calls
+    std::vector<CaptureMarker> markers;
+};
+
+// Appends every frame found in [begin, end) to out. Lines are split on '\n'
+// with an optional '\r'; a final line without a newline is still parsed.
+void parseCapture(const char *begin, const char *end, CaptureFormat format, std::vector<Frame> &out,
+                  ParseStats *stats = nullptr, ParseKernel kernel = ParseKernel::Simd, ParseState *state = nullptr);
+
+// Frames seen so far for an ID, incremented by the parser
+uint32_t &idFrameCount(ParseState &state, uint32_t id, bool extended);
+
+// Extracts the binary `c` capture dumps (CAPTURE BEGIN ... CAPTURE END, see
+// src/capture_format.h) embedded in a serial log. The device's 32-bit
+// microsecond timestamps are unwrapped per dump. A dump whose END line is
+// not where the payload ends, or whose length/CRC-32 trailer does not
+// match, contributes no frames and is counted in *damaged. Returns the
+// number of good dumps.
+size_t parseDeviceDumps(const char *begin, const char *end, std::vector<Frame> &out, size_t *damaged = nullptr);
+
+}  // namespace idrive
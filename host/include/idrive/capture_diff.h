@@ -0,0 +1,95 @@
+#pragma once
+
+// Differential analysis of two captures (a baseline and a target, e.g.
+// idle vs ignition). Each capture is folded into a fixed-size profile per
+// ID while it streams past, so memory depends on the number of IDs only.
+// Comparing the profiles yields findings ranked by score:
+//
+//   new-id / gone-id  ID present in only one capture
+//   period            median inter-frame interval changed
+//   byte              byte value distribution differs (Jensen-Shannon)
+//   bit               share of frames with a bit set differs
+//
+// Profiles are time-normalised (rates, shares, distributions), so the two
+// captures need neither the same length nor a common clock. Captures
+// without timestamps (PuTTY, IDs.txt) carry the parser's synthetic 1 ms
+// spacing, which says nothing about the bus: when either side has it,
+// period findings and rates are left out.
+
+#include "idrive/capture.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace idrive {
+
+struct IdProfile {
+    static constexpr int INTERVAL_SUB_BUCKETS = 8;  // per octave
+    static constexpr int INTERVAL_BUCKETS = 40 * INTERVAL_SUB_BUCKETS;
+
+    uint32_t id = 0;
+    bool     extended = false;
+    uint64_t frames = 0;
+    int64_t  firstUs = 0;
+    int64_t  lastUs = 0;
+    uint8_t  maxDlc = 0;
+
+    std::array<std::array<uint64_t, 256>, 8> byteValues{};
+    std::array<uint64_t, 64> bitSet{};
+    std::array<uint32_t, INTERVAL_BUCKETS> intervals{};  // log-linear histogram of gaps in us
+
+    // Median gap, 0 with fewer than two frames
+    double medianIntervalUs() const;
+};
+
+class CaptureProfile {
+public:
+    void add(const Frame &frame);
+    void add(const Frame *frames, size_t count);
+
+    uint64_t frameCount() const { return frames_; }
+    double durationSeconds() const;
+
+    // Some frames carried FRAME_SYNTH_TIME; intervals and rates are meaningless
+    bool syntheticTime() const { return syntheticTime_; }
+    const IdProfile *find(uint32_t id, bool extended) const;
+    std::vector<const IdProfile *> ids() const;  // sorted by ID
+
+private:
+    std::unordered_map<uint64_t, IdProfile> ids_;
+    uint64_t frames_ = 0;
+    int64_t  firstUs_ = 0;
+    int64_t  lastUs_ = 0;
+    bool     syntheticTime_ = false;
+};
+
+struct DiffFinding {
+    enum class Kind : uint8_t { NewId, GoneId, Period, Byte, Bit };
+
+    Kind     kind;
+    uint32_t id;
+    bool     extended;
+    int      byte = -1;  // Byte, Bit
+    int      bit = -1;   // Bit
+    double   score;      // 0..1, comparable across kinds
+    std::string detail;
+};
+
+const char *diffKindName(DiffFinding::Kind kind);
+
+struct DiffOptions {
+    double   minScore = 0.05;
+    double   minZ = 4.75;     // significance of byte/bit changes, ~1e-6 one-sided
+    uint64_t minFrames = 8;   // per side, for period/byte/bit findings
+    bool     includeBits = true;
+};
+
+// Findings sorted by descending score
+std::vector<DiffFinding> diffProfiles(const CaptureProfile &baseline, const CaptureProfile &target,
+                                      const DiffOptions &options = DiffOptions());
+
+}  // namespace idrive
@@ -0,0 +1,78 @@
+#pragma once
+
+// Writes frames back out in any capture format the tools read: the text
+// formats (PuTTY, IDs.txt notes, device RAW, candump -l), SocketCAN
+// pcap/pcapng and .icap. Output goes through a fixed buffer, so converting
+// a streamed input runs in constant memory.
+//
+// Timestamps are kept where the format has them; putty and ids output drop
+// them (the parser synthesises 1 ms spacing on the way back in).
+
+#include "idrive/capture.h"
+#include "idrive/capture_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace idrive {
+
+enum class ExportFormat : uint8_t {
+    Putty,
+    IdsNotes,
+    DeviceRaw,
+    Candump,
+    Pcap,
+    Pcapng,
+    Icap,
+};
+
+// Same names as formatName() for the text formats, plus pcap, pcapng, icap
+const char *exportFormatName(ExportFormat format);
+bool parseExportFormat(const std::string &name, ExportFormat &format);
+
+// From the extension: .pcap, .pcapng, .icap, .candump; false for anything else
+bool exportFormatForPath(const std::string &path, ExportFormat &format);
+
+struct ExportOptions {
+    std::string interfaceName = "can0";  // candump and pcapng interface
+};
+
+class CaptureExporter {
+public:
+    CaptureExporter() = default;
+    ~CaptureExporter();
+
+    CaptureExporter(const CaptureExporter &) = delete;
+    CaptureExporter &operator=(const CaptureExporter &) = delete;
+
+    // path "-" writes to stdout
+    bool open(const std::string &path, ExportFormat format, const ExportOptions &options = ExportOptions());
+    bool append(const Frame *frames, size_t count);
+    bool close();
+
+    uint64_t frameCount() const { return frames_; }
+    uint64_t bytesWritten() const { return bytes_; }
+    const std::string &error() const { return error_; }
+
+private:
+    static constexpr size_t BUFFER_BYTES = 1 << 20;
+
+    void formatText(const Frame &frame);
+    bool write(const void *data, size_t size);
+    bool flush();
+    bool fail(const std::string &message);
+
+    ExportFormat format_ = ExportFormat::Candump;
+    ExportOptions options_;
+    std::FILE *file_ = nullptr;
+    bool ownsFile_ = false;
+    std::string buffer_;
+    CaptureFileWriter icap_;
+    uint64_t frames_ = 0;
+    uint64_t bytes_ = 0;
+    std::string error_;
+};
+
+}  // namespace idrive
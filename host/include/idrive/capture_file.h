@@ -0,0 +1,175 @@
+#pragma once
+
+// Indexed binary capture container (.icap). Frames are stored as fixed-size
+// records in blocks; a footer holds one index entry per block with its time
+// range and a bloom filter over the IDs it contains, so time-range and ID
+// queries binary-search the index and only touch matching blocks.
+//
+//   FileHeader
+//   block 0: framesPerBlock * Frame        (last block may be short)
+//   block 1: ...
+//   BlockIndexEntry[blockCount]
+//   FileTrailer                            (fixed size, at end of file)
+//
+// All fields are little-endian. The writer is append-only and never seeks,
+// so it can sit directly on a pipe or the device capture stream.
+
+#include "idrive/capture.h"
+#include "idrive/mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace idrive {
+
+constexpr char     CAPTURE_FILE_MAGIC[8]          = {'I', 'D', 'C', 'A', 'P', 'I', 'D', 'X'};
+constexpr char     CAPTURE_FILE_END_MAGIC[8]      = {'I', 'D', 'C', 'A', 'P', 'E', 'N', 'D'};
+constexpr uint16_t CAPTURE_FILE_VERSION           = 1;
+constexpr uint32_t DEFAULT_FRAMES_PER_BLOCK       = 4096;
+constexpr uint32_t CAPTURE_BLOOM_WORDS            = 8;  // 512 bits per block
+
+struct FileHeader {
+    char     magic[8];
+    uint16_t version;
+    uint16_t recordSize;  // sizeof(Frame)
+    uint32_t framesPerBlock;
+    uint8_t  reserved[16];
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader must stay packed to 32 bytes");
+
+struct BlockIndexEntry {
+    int64_t  firstUs;  // smallest timestamp in the block
+    int64_t  lastUs;   // largest timestamp in the block
+    uint64_t offset;   // file offset of the first record
+    uint32_t frameCount;
+    uint32_t reserved;
+    uint64_t idBloom[CAPTURE_BLOOM_WORDS];
+};
+
+static_assert(sizeof(BlockIndexEntry) == 96, "BlockIndexEntry must stay packed to 96 bytes");
+
+enum FileTrailerFlags : uint32_t {
+    CAPTURE_FILE_TIME_ORDERED = 0x01,  // block ranges are ordered and disjoint, index is binary-searchable
+};
+
+struct FileTrailer {
+    uint64_t indexOffset;
+    uint64_t frameCount;
+    uint32_t blockCount;
+    uint32_t flags;
+    char     magic[8];
+};
+
+static_assert(sizeof(FileTrailer) == 32, "FileTrailer must stay packed to 32 bytes");
+
+// Bloom filter probe shared by the writer and reader
+void bloomAdd(uint64_t (&bloom)[CAPTURE_BLOOM_WORDS], uint32_t id, bool extended);
+bool bloomMayContain(const uint64_t (&bloom)[CAPTURE_BLOOM_WORDS], uint32_t id, bool extended);
+
+class CaptureFileWriter {
+public:
+    // Receives the encoded byte stream; returns false to abort
+    using Sink = std::function<bool(const void *data, size_t size)>;
+
+    CaptureFileWriter() = default;
+    ~CaptureFileWriter();
+
+    CaptureFileWriter(const CaptureFileWriter &) = delete;
+    CaptureFileWriter &operator=(const CaptureFileWriter &) = delete;
+
+    bool open(const std::string &path, uint32_t framesPerBlock = DEFAULT_FRAMES_PER_BLOCK);
+    bool open(Sink sink, uint32_t framesPerBlock = DEFAULT_FRAMES_PER_BLOCK);
+
+    bool append(const Frame &frame);
+    bool append(const Frame *frames, size_t count);
+
+    // Flushes the last block and writes the index; the writer is reusable afterwards
+    bool close();
+
+    uint64_t frameCount() const { return frameCount_; }
+    const std::string &error() const { return error_; }
+
+private:
+    bool emit(const void *data, size_t size);
+    bool flushBlock();
+    bool fail(const std::string &message);
+
+    Sink sink_;
+    std::FILE *file_ = nullptr;
+    bool open_ = false;
+    uint32_t framesPerBlock_ = DEFAULT_FRAMES_PER_BLOCK;
+    uint64_t offset_ = 0;
+    uint64_t frameCount_ = 0;
+    bool timeOrdered_ = true;
+    std::vector<Frame> block_;
+    std::vector<BlockIndexEntry> index_;
+    std::string error_;
+};
+
+struct CaptureQuery {
+    int64_t  fromUs = INT64_MIN;  // inclusive
+    int64_t  toUs   = INT64_MAX;  // inclusive
+    bool     filterId = false;
+    uint32_t id = 0;
+    bool     extended = false;
+};
+
+struct QueryStats {
+    size_t blocksTotal   = 0;
+    size_t blocksInRange = 0;  // overlapping the time range
+    size_t blocksRead    = 0;  // after the ID bloom filter
+    size_t framesScanned = 0;
+    size_t framesMatched = 0;
+};
+
+class CaptureFileReader {
+public:
+    bool open(const std::string &path);
+
+    uint64_t frameCount() const { return trailer_.frameCount; }
+    uint32_t framesPerBlock() const { return header_.framesPerBlock; }
+    bool timeOrdered() const { return trailer_.flags & CAPTURE_FILE_TIME_ORDERED; }
+    size_t blockCount() const { return trailer_.blockCount; }
+    const BlockIndexEntry &block(size_t i) const { return index_[i]; }
+
+    // Records of one block, straight from the mapping
+    const Frame *blockFrames(size_t i) const;
+
+    // Calls visit for every matching frame in file order; return false from visit to stop
+    void query(const CaptureQuery &query, const std::function<bool(const Frame &)> &visit,
+               QueryStats *stats = nullptr) const;
+    void query(const CaptureQuery &query, std::vector<Frame> &out, QueryStats *stats = nullptr) const;
+
+    const std::string &error() const { return error_; }
+
+private:
+    bool fail(const std::string &message);
+
+    MappedFile file_;
+    FileHeader header_{};
+    FileTrailer trailer_{};
+    const BlockIndexEntry *index_ = nullptr;
+    std::string error_;
+};
+
+// Loads any capture the tools understand into frames: an .icap file, a
+// SocketCAN pcap/pcapng file, a serial log with `c` capture dumps, or a
+// text capture in a detected format. source (optional) receives a short description such as "putty".
+bool loadCapture(const std::string &path, std::vector<Frame> &frames, std::string &error,
+                 std::string *source = nullptr);
+
+// Same inputs, delivered in batches in file order with bounded memory: text
+// captures are parsed in line-aligned windows with consumed pages released,
+// .icap files one block at a time. Return false from sink to stop early.
+// markers (optional) receives the MARK lines of text captures, each batch's
+// markers appended before the batch is delivered.
+using FrameBatchSink = std::function<bool(const Frame *frames, size_t count)>;
+bool streamCapture(const std::string &path, const FrameBatchSink &sink, std::string &error,
+                   std::string *source = nullptr, std::vector<CaptureMarker> *markers = nullptr);
+
+}  // namespace idrive
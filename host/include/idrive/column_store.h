@@ -0,0 +1,119 @@
+#pragma once
+
+// Columnar, per-ID view of a capture for ad-hoc signal questions such as
+// "0x25B frames where byte 4 changed while byte 3 == 0x01". Each ID gets a
+// partition holding timestamps and every payload byte as separate arrays,
+// plus a compressed bitmap per (byte position, value). Queries are a
+// conjunction of predicates evaluated 64 rows per word: equality through
+// the bitmap indexes, everything else through vectorized column scans.
+
+#include "idrive/capture.h"
+#include "idrive/compressed_bitmap.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace idrive {
+
+class WorkStealingPool;
+
+struct IdPartition {
+    uint32_t id = 0;
+    bool     extended = false;
+    size_t   rows = 0;
+    bool     timeOrdered = true;
+
+    // Columns are padded with zeros to a multiple of 64 rows
+    std::vector<int64_t>  timestampUs;
+    std::vector<uint32_t> captureIndex;  // position in the source frame array
+    std::vector<uint8_t>  dlc;
+    std::array<std::vector<uint8_t>, 8> bytes;
+
+    // valueIndex[byte][value]; empty unless indexes were built
+    std::vector<std::array<CompressedBitmap, 256>> valueIndex;
+
+    Frame frame(size_t row) const;
+};
+
+struct Predicate {
+    enum class Kind : uint8_t {
+        ByteMasked,   // (byte & mask) == value; mask 0xFF is plain equality
+        ByteBetween,  // lo <= byte <= hi
+        ByteChanged,  // byte differs from the previous frame of this ID
+        TimeBetween,  // fromUs <= timestamp <= toUs
+    };
+
+    Kind    kind;
+    uint8_t byte = 0;
+    uint8_t a = 0;  // value / lo
+    uint8_t b = 0;  // mask / hi
+    bool    negate = false;
+    int64_t fromUs = 0;
+    int64_t toUs = 0;
+
+    static Predicate byteEquals(uint8_t byte, uint8_t value) { return {Kind::ByteMasked, byte, value, 0xFF}; }
+    static Predicate byteMasked(uint8_t byte, uint8_t mask, uint8_t value) { return {Kind::ByteMasked, byte, value, mask}; }
+    static Predicate byteBetween(uint8_t byte, uint8_t lo, uint8_t hi) { return {Kind::ByteBetween, byte, lo, hi}; }
+    static Predicate byteChanged(uint8_t byte) { return {Kind::ByteChanged, byte}; }
+    static Predicate timeBetween(int64_t fromUs, int64_t toUs) {
+        Predicate p{Kind::TimeBetween};
+        p.fromUs = fromUs;
+        p.toUs = toUs;
+        return p;
+    }
+    Predicate operator!() const {
+        Predicate p = *this;
+        p.negate = !p.negate;
+        return p;
+    }
+};
+
+struct SignalQuery {
+    uint32_t id = 0;
+    bool     extended = false;
+    std::vector<Predicate> where;  // all must hold
+};
+
+struct QueryResult {
+    const IdPartition *partition = nullptr;
+    std::vector<uint64_t> rowBits;  // bit r set when row r matches
+    size_t matches = 0;
+
+    template <typename Fn>
+    void forEachRow(Fn &&fn) const {
+        for (size_t w = 0; w < rowBits.size(); w++) {
+            for (uint64_t bits = rowBits[w]; bits; bits &= bits - 1) fn(w * 64 + __builtin_ctzll(bits));
+        }
+    }
+};
+
+struct ColumnStoreOptions {
+    bool buildIndexes = true;
+    WorkStealingPool *pool = nullptr;  // partitions are built in parallel when set
+};
+
+class ColumnStore {
+public:
+    void build(const std::vector<Frame> &frames, const ColumnStoreOptions &options = ColumnStoreOptions());
+
+    const IdPartition *partition(uint32_t id, bool extended = false) const;
+    const std::vector<IdPartition> &partitions() const { return partitions_; }
+    size_t frameCount() const { return frameCount_; }
+    size_t indexBytes() const;
+    size_t columnBytes() const;
+
+    // Unknown IDs give an empty result with a null partition
+    QueryResult run(const SignalQuery &query) const;
+
+private:
+    std::vector<IdPartition> partitions_;
+    std::vector<int32_t> standardSlot_;  // id -> partition index, -1 when absent
+    size_t frameCount_ = 0;
+};
+
+// Name of the scan kernel level in use ("avx2", "sse2", "scalar")
+const char *columnScanLevelName();
+
+}  // namespace idrive
@@ -0,0 +1,45 @@
+#pragma once
+
+// Immutable compressed row bitmap in the style of Roaring: rows are split
+// into 65536-row containers, each stored as whichever is smallest of a
+// sorted uint16 array, a 8 KB bitset or a list of runs. Byte columns of CAN
+// payloads are mostly constant or slowly changing, so run containers keep
+// the per-value indexes of those bytes close to free.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace idrive {
+
+class CompressedBitmap {
+public:
+    // rows must be strictly increasing
+    static CompressedBitmap fromSortedRows(const uint32_t *rows, size_t count);
+
+    size_t cardinality() const { return cardinality_; }
+    bool empty() const { return cardinality_ == 0; }
+
+    // Dense output over words[0, wordCount), 64 rows per word
+    void orInto(uint64_t *words, size_t wordCount) const;
+    void andInto(uint64_t *words, size_t wordCount) const;
+
+    size_t memoryBytes() const;
+
+private:
+    enum class Kind : uint8_t { Array, Bitset, Run };
+
+    struct Container {
+        uint16_t key;     // row >> 16
+        Kind     kind;
+        uint32_t offset;  // into values_ (Array, Run pairs) or words_ (Bitset)
+        uint32_t length;  // values, run pairs, or 1024 words
+    };
+
+    std::vector<Container> containers_;
+    std::vector<uint16_t> values_;  // arrays, and runs as (start, last) pairs
+    std::vector<uint64_t> words_;
+    size_t cardinality_ = 0;
+};
+
+}  // namespace idrive
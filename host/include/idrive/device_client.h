@@ -0,0 +1,846 @@
+#pragma once
+
+// Client for the firmware's serial stream, header-only so HMI code can use
+// it without the capture library.
+//
+// DeviceStreamParser turns the byte stream into typed events: frames from
+// the RAW/DEBUG modes, button/knob/rotation lines, touchpad and other
+// signal reports, statistics lines, latency and clock sync replies, and
+// binary capture dumps. Bytes are read into one reusable buffer and parsed
+// in place; every string_view in an event points into that buffer and
+// stays valid until the next prepare()/feed()/receive(). Nothing is
+// allocated per line or per event, and kinds left out of the event mask
+// are skipped after a one- or two-byte look at the line.
+//
+// DeviceClient adds the tty (raw, non-blocking, ASYNC_LOW_LATENCY where the
+// driver has it) and the serial command set. Events can be pulled:
+//
+//   while (client.receive(-1))
+//       for (DeviceEvent event; client.next(event);) ...
+//
+// or pushed to a callback with dispatch().
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
+namespace idrive {
+
+enum class DeviceEventKind : uint8_t {
+    Frame,     // "[  1234ms] [RAW] 0x25B: 00 FF ..." (debug modes 1 and 2)
+    Button,    // "HOME PRESSED" / "TOUCHED" / "RELEASED"
+    Knob,      // "Knob UP" / "Knob RELEASED"
+    Rotation,  // "Rotation CW (12)"
+    Touch,     // "SIG ZBE_TOUCHPAD.<signal> = <v>", folded into one touch state
+    Signal,    // any other "SIG <message>.<signal> = <value> [unit] (NAME)"
+    Stats,     // BUSLOAD HIGH/OK, CYCLE <anomaly>, LOOP deadline miss
+    Latency,   // "LAT <seq>", answer with ackLatency()
+    Sync,      // "SYNC <seq> <rx_us> <tx_us>"
+    Capture,   // binary CAPTURE BEGIN ... CAPTURE END dump
+    Text,      // everything else: acks, status tables, help
+};
+
+constexpr uint32_t eventBit(DeviceEventKind kind) {
+    return 1u << static_cast<unsigned>(kind);
+}
+
+constexpr uint32_t ALL_DEVICE_EVENTS = (eventBit(DeviceEventKind::Text) << 1) - 1;
+
+struct DeviceFrame {
+    int64_t          timestampUs;  // device uptime (ms resolution), or host time once clock_sync ran
+    bool             hostClock;    // "[12345678.123ms]" form
+    std::string_view tag;          // RAW, UNKNOWN, ID_567, ID_5E7, GEAR
+    uint32_t         id;
+    uint8_t          dlc;
+    uint8_t          data[8];
+};
+
+enum class ButtonAction : uint8_t {
+    Released,
+    Pressed,
+    Touched,
+};
+
+struct DeviceButton {
+    std::string_view label;  // BACK, HOME, ... as in BUTTON_MAPPINGS
+    ButtonAction     action;
+};
+
+struct DeviceKnob {
+    std::string_view position;  // CENTER, UP, ...; empty for "Knob RELEASED"
+    bool             pressed;
+};
+
+struct DeviceRotation {
+    int8_t  direction;  // +1 clockwise, -1 counter-clockwise
+    int32_t position;   // firmware step counter
+};
+
+enum class TouchField : uint8_t {
+    Fingers,
+    X,
+    Y,
+};
+
+// Touchpad state after the report in this event; see dbc/idrive_kcan.dbc
+struct DeviceTouch {
+    TouchField changed;
+    uint8_t    fingers;
+    uint16_t   x;
+    uint16_t   y;
+};
+
+struct DeviceSignal {
+    std::string_view message;
+    std::string_view name;
+    double           value;      // physical value as printed
+    std::string_view unit;       // may be empty
+    std::string_view valueName;  // VAL_ entry, may be empty
+};
+
+enum class StatsKind : uint8_t {
+    BusLoadHigh,
+    BusLoadOk,
+    CycleLate,
+    CycleMissing,
+    CycleBurst,
+    CycleResumed,
+    LoopDeadlineMiss,
+};
+
+struct DeviceStats {
+    StatsKind kind;
+    uint32_t  id;        // Cycle*: CAN ID
+    uint32_t  value;     // BusLoad*: 1s load in 0.1 %; Cycle*: observed gap us; LoopDeadlineMiss: iteration us
+    uint32_t  expected;  // Cycle*: learned period us
+};
+
+struct DeviceSync {
+    uint32_t sequence;
+    int64_t  rxUs;  // device clock when the '@' arrived
+    int64_t  txUs;  // device clock when the reply was written
+};
+
+struct DeviceCapture {
+    uint32_t         records;
+    uint32_t         trigger;    // CaptureTrigger
+    uint32_t         triggerUs;
+    bool             delta;      // frame_codec.h coding instead of 16-byte CaptureRecords
+    bool             intact;     // END line right after the payload, its length/CRC-32 trailer matching
+    std::string_view payload;    // binary records, without the END line
+};
+
+// Only the member matching kind is filled in
+struct DeviceEvent {
+    DeviceEventKind  kind;
+    std::string_view line;  // the text line (the header for Capture)
+    DeviceFrame      frame;
+    DeviceButton     button;
+    DeviceKnob       knob;
+    DeviceRotation   rotation;
+    DeviceTouch      touch;
+    DeviceSignal     signal;
+    DeviceStats      stats;
+    uint32_t         latencySequence;
+    DeviceSync       sync;
+    DeviceCapture    capture;
+};
+
+namespace device_detail {
+
+inline bool consume(std::string_view &s, std::string_view prefix) {
+    if (s.size() < prefix.size() || std::memcmp(s.data(), prefix.data(), prefix.size()) != 0) return false;
+    s.remove_prefix(prefix.size());
+    return true;
+}
+
+inline void skipSpaces(std::string_view &s) {
+    while (!s.empty() && s.front() == ' ') s.remove_prefix(1);
+}
+
+inline int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = static_cast<char>(c | 0x20);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+inline bool parseUnsigned(std::string_view &s, uint64_t &value) {
+    size_t n = 0;
+    value = 0;
+    while (n < s.size() && s[n] >= '0' && s[n] <= '9') value = value * 10 + static_cast<uint64_t>(s[n++] - '0');
+    s.remove_prefix(n);
+    return n > 0;
+}
+
+inline bool parseU32(std::string_view &s, uint32_t &value) {
+    uint64_t wide;
+    if (!parseUnsigned(s, wide)) return false;
+    value = static_cast<uint32_t>(wide);
+    return true;
+}
+
+inline bool parseSigned(std::string_view &s, int64_t &value) {
+    bool negative = consume(s, "-");
+    uint64_t magnitude;
+    if (!parseUnsigned(s, magnitude)) return false;
+    value = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+inline bool parseHex(std::string_view &s, uint32_t &value) {
+    size_t n = 0;
+    value = 0;
+    for (int digit; n < s.size() && (digit = hexDigit(s[n])) >= 0; n++) value = (value << 4) | static_cast<uint32_t>(digit);
+    s.remove_prefix(n);
+    return n > 0;
+}
+
+// The firmware prints signal values as %lld or %.3f
+inline bool parseNumber(std::string_view &s, double &value) {
+    bool negative = consume(s, "-");
+    uint64_t whole;
+    if (!parseUnsigned(s, whole)) return false;
+    value = static_cast<double>(whole);
+    if (consume(s, ".")) {
+        double scale = 0.1;
+        for (; !s.empty() && s.front() >= '0' && s.front() <= '9'; s.remove_prefix(1), scale *= 0.1) {
+            value += (s.front() - '0') * scale;
+        }
+    }
+    if (negative) value = -value;
+    return true;
+}
+
+// CRC-32 as zlib's crc32(), which the firmware puts in the CAPTURE END
+// trailer (src/capture_format.h, captureCrc32())
+inline uint32_t crc32(std::string_view data) {
+    static const uint32_t NIBBLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32_t crc = ~0u;
+    for (char c : data) {
+        crc ^= static_cast<uint8_t>(c);
+        crc = (crc >> 4) ^ NIBBLE[crc & 0x0F];
+        crc = (crc >> 4) ^ NIBBLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+// Up to (not including) the first c; the whole rest when c is missing
+inline std::string_view takeUntil(std::string_view &s, char c) {
+    size_t n = s.find(c);
+    if (n == std::string_view::npos) n = s.size();
+    std::string_view head = s.substr(0, n);
+    s.remove_prefix(n);
+    return head;
+}
+
+}  // namespace device_detail
+
+class DeviceStreamParser {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;  // a raw 2048-record dump is 32 KB
+    static constexpr size_t MAX_CAPACITY     = 1024 * 1024;
+    static constexpr size_t MIN_READ         = 4096;
+
+    explicit DeviceStreamParser(size_t capacity = DEFAULT_CAPACITY) : buffer_(capacity < MIN_READ ? MIN_READ : capacity) {}
+
+    // Only these kinds come out of next()/dispatch(); see eventBit()
+    void setEventMask(uint32_t mask) { mask_ = mask; }
+    uint32_t eventMask() const { return mask_; }
+
+    // Writable space for the next read(); invalidates earlier events
+    char *prepare(size_t &available) {
+        if (head_ == tail_) head_ = tail_ = 0;
+        if (buffer_.size() - tail_ < MIN_READ && head_ > 0) {
+            std::memmove(buffer_.data(), buffer_.data() + head_, tail_ - head_);
+            tail_ -= head_;
+            head_ = 0;
+        }
+        if (buffer_.size() - tail_ < MIN_READ && capture_ && buffer_.size() < MAX_CAPACITY) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+        if (tail_ == buffer_.size()) {
+            // A line longer than the buffer, or a dump that never ends
+            dropped_++;
+            capture_ = false;
+            head_ = tail_ = 0;
+        }
+        available = buffer_.size() - tail_;
+        return buffer_.data() + tail_;
+    }
+
+    void commit(size_t bytes) { tail_ += bytes; }
+
+    // Copies in as much of data as one prepare() allows and returns the
+    // byte count taken; for sources that are not read() into the buffer
+    size_t feed(const char *data, size_t size) {
+        size_t available;
+        char *out = prepare(available);
+        size_t n = size < available ? size : available;
+        std::memcpy(out, data, n);
+        commit(n);
+        return n;
+    }
+
+    // Next complete event, false once the buffered data is used up
+    bool next(DeviceEvent &event) {
+        for (;;) {
+            if (capture_) {
+                if (!finishCapture(event)) return false;
+                if (mask_ & eventBit(DeviceEventKind::Capture)) return true;
+                continue;
+            }
+            const char *begin = buffer_.data() + head_;
+            const char *nl = static_cast<const char *>(std::memchr(begin, '\n', tail_ - head_));
+            if (!nl) return false;
+            size_t lineStart = head_;
+            head_ = static_cast<size_t>(nl + 1 - buffer_.data());
+            if (nl > begin && nl[-1] == '\r') nl--;
+            if (parseLine(std::string_view(begin, static_cast<size_t>(nl - begin)), event)) return true;
+            if (capture_) {
+                // Keep the header buffered with the payload; offsets are relative to it
+                captureLine_ = static_cast<size_t>(nl - begin);
+                capturePayload_ = head_ - lineStart;
+                captureScan_ = capturePayload_;
+                head_ = lineStart;
+            }
+        }
+    }
+
+    // Hands every buffered event to handler(const DeviceEvent &); returns the count
+    template <typename Handler>
+    size_t dispatch(Handler &&handler) {
+        size_t count = 0;
+        for (DeviceEvent event; next(event); count++) handler(static_cast<const DeviceEvent &>(event));
+        return count;
+    }
+
+    // Forgets buffered bytes and a dump in progress (after a reconnect)
+    void reset() {
+        head_ = tail_ = 0;
+        capture_ = false;
+        touch_ = DeviceTouch{};
+    }
+
+    // Overlong lines and unterminated dumps thrown away so far
+    size_t dropped() const { return dropped_; }
+
+private:
+    bool wants(DeviceEventKind kind) const { return (mask_ & eventBit(kind)) != 0; }
+
+    bool parseLine(std::string_view line, DeviceEvent &event) {
+        using namespace device_detail;
+        event.line = line;
+        std::string_view rest = line;
+        switch (line.empty() ? '\0' : line.front()) {
+            case '[':
+                if (!wants(DeviceEventKind::Frame)) return false;
+                event.kind = DeviceEventKind::Frame;
+                if (parseFrame(rest, event.frame)) return true;
+                break;
+            case 'R':
+                if (consume(rest, "Rotation ")) {
+                    if (!wants(DeviceEventKind::Rotation)) return false;
+                    event.kind = DeviceEventKind::Rotation;
+                    if (parseRotation(rest, event.rotation)) return true;
+                }
+                break;
+            case 'K':
+                if (consume(rest, "Knob ")) {
+                    if (!wants(DeviceEventKind::Knob)) return false;
+                    event.kind = DeviceEventKind::Knob;
+                    event.knob.pressed = rest != "RELEASED";
+                    event.knob.position = event.knob.pressed ? rest : std::string_view();
+                    return true;
+                }
+                break;
+            case 'S':
+                if (consume(rest, "SIG ")) {
+                    if (parseSignal(rest, event)) return true;
+                    if (event.kind != DeviceEventKind::Text) return false;  // parsed but masked out
+                } else if (consume(rest, "SYNC ") && !consume(rest, "MAP")) {
+                    if (!wants(DeviceEventKind::Sync)) return false;
+                    event.kind = DeviceEventKind::Sync;
+                    if (parseSync(rest, event.sync)) return true;
+                }
+                break;
+            case 'L':
+                if (consume(rest, "LAT ")) {
+                    if (!wants(DeviceEventKind::Latency)) return false;
+                    event.kind = DeviceEventKind::Latency;
+                    if (parseU32(rest, event.latencySequence)) return true;
+                } else if (consume(rest, "LOOP deadline miss: ")) {
+                    if (!wants(DeviceEventKind::Stats)) return false;
+                    event.kind = DeviceEventKind::Stats;
+                    event.stats = DeviceStats{StatsKind::LoopDeadlineMiss, 0, 0, 0};
+                    if (parseU32(rest, event.stats.value)) return true;
+                }
+                break;
+            case 'C':
+                if (consume(rest, "CAPTURE BEGIN ")) {
+                    if (beginCapture(rest)) return false;  // delivered once the payload is in
+                } else if (consume(rest, "CYCLE ")) {
+                    if (!wants(DeviceEventKind::Stats)) return false;
+                    event.kind = DeviceEventKind::Stats;
+                    if (parseCycle(rest, event.stats)) return true;
+                }
+                break;
+            case 'B':
+                if (consume(rest, "BUSLOAD ")) {
+                    if (!wants(DeviceEventKind::Stats)) return false;
+                    event.kind = DeviceEventKind::Stats;
+                    if (parseBusLoad(rest, event.stats)) return true;
+                }
+                break;
+            default:
+                break;
+        }
+        rest = line;
+        if (parseButton(rest, event)) return wants(DeviceEventKind::Button);
+        event.kind = DeviceEventKind::Text;
+        return wants(DeviceEventKind::Text);
+    }
+
+    // " 1234ms] [RAW] 0x25B: 00 FF 7F" or "12345678.123ms] ..." after the '['
+    static bool parseFrame(std::string_view s, DeviceFrame &frame) {
+        using namespace device_detail;
+        s.remove_prefix(1);
+        skipSpaces(s);
+        uint64_t ms, fraction = 0;
+        if (!parseUnsigned(s, ms)) return false;
+        frame.hostClock = consume(s, ".");
+        if (frame.hostClock && !parseUnsigned(s, fraction)) return false;
+        if (!consume(s, "ms] [")) return false;
+        frame.timestampUs = static_cast<int64_t>(ms * 1000 + fraction);
+        frame.tag = takeUntil(s, ']');
+        uint32_t id;
+        if (!consume(s, "] 0x") || !parseHex(s, id) || !consume(s, ":")) return false;
+        frame.id = id;
+        frame.dlc = 0;
+        while (s.size() >= 3 && s[0] == ' ' && frame.dlc < 8) {
+            int high = hexDigit(s[1]), low = hexDigit(s[2]);
+            if (high < 0 || low < 0) return false;
+            frame.data[frame.dlc++] = static_cast<uint8_t>(high << 4 | low);
+            s.remove_prefix(3);
+        }
+        for (uint8_t i = frame.dlc; i < 8; i++) frame.data[i] = 0;
+        return s.empty();
+    }
+
+    // "CW (12)" / "CCW (-3)"
+    static bool parseRotation(std::string_view s, DeviceRotation &rotation) {
+        using namespace device_detail;
+        if (consume(s, "CW (")) {
+            rotation.direction = 1;
+        } else if (consume(s, "CCW (")) {
+            rotation.direction = -1;
+        } else {
+            return false;
+        }
+        int64_t position;
+        if (!parseSigned(s, position) || s != ")") return false;
+        rotation.position = static_cast<int32_t>(position);
+        return true;
+    }
+
+    // "<message>.<signal> = <value>[ <unit>][ (<NAME>)]"; sets kind to Text when unparsable
+    bool parseSignal(std::string_view s, DeviceEvent &event) {
+        using namespace device_detail;
+        event.kind = DeviceEventKind::Text;
+        DeviceSignal &signal = event.signal;
+        signal.message = takeUntil(s, '.');
+        if (!consume(s, ".")) return false;
+        signal.name = takeUntil(s, ' ');
+        if (!consume(s, " = ") || !parseNumber(s, signal.value)) return false;
+        signal.unit = std::string_view();
+        signal.valueName = std::string_view();
+        skipSpaces(s);
+        if (!s.empty() && s.front() != '(') {
+            size_t open = s.find(" (");
+            signal.unit = s.substr(0, open);
+            s.remove_prefix(open == std::string_view::npos ? s.size() : open + 1);
+        }
+        if (consume(s, "(")) signal.valueName = takeUntil(s, ')');
+
+        if (signal.message == "ZBE_TOUCHPAD" && updateTouch(signal, event.touch)) {
+            event.kind = DeviceEventKind::Touch;
+            if (wants(DeviceEventKind::Touch)) return true;
+        }
+        event.kind = DeviceEventKind::Signal;
+        return wants(DeviceEventKind::Signal);
+    }
+
+    bool updateTouch(const DeviceSignal &signal, DeviceTouch &touch) {
+        auto value = static_cast<uint32_t>(signal.value < 0 ? 0 : signal.value);
+        if (signal.name == "Fingers") {
+            touch_.changed = TouchField::Fingers;
+            touch_.fingers = static_cast<uint8_t>(value);
+        } else if (signal.name == "TouchX") {
+            touch_.changed = TouchField::X;
+            touch_.x = static_cast<uint16_t>(value);
+        } else if (signal.name == "TouchY") {
+            touch_.changed = TouchField::Y;
+            touch_.y = static_cast<uint16_t>(value);
+        } else {
+            return false;
+        }
+        touch = touch_;
+        return true;
+    }
+
+    static bool parseSync(std::string_view s, DeviceSync &sync) {
+        using namespace device_detail;
+        if (!parseU32(s, sync.sequence) || !consume(s, " ") || !parseSigned(s, sync.rxUs) || !consume(s, " ")) {
+            return false;
+        }
+        return parseSigned(s, sync.txUs);
+    }
+
+    // "LATE 0x25B observed=61234us expected=20000us"
+    static bool parseCycle(std::string_view s, DeviceStats &stats) {
+        using namespace device_detail;
+        if (consume(s, "LATE ")) {
+            stats.kind = StatsKind::CycleLate;
+        } else if (consume(s, "MISSING ")) {
+            stats.kind = StatsKind::CycleMissing;
+        } else if (consume(s, "BURST ")) {
+            stats.kind = StatsKind::CycleBurst;
+        } else if (consume(s, "RESUMED ")) {
+            stats.kind = StatsKind::CycleResumed;
+        } else {
+            return false;
+        }
+        return consume(s, "0x") && parseHex(s, stats.id) && consume(s, " observed=") && parseU32(s, stats.value) &&
+               consume(s, "us expected=") && parseU32(s, stats.expected);
+    }
+
+    // "HIGH 1s=72.4%"
+    static bool parseBusLoad(std::string_view s, DeviceStats &stats) {
+        using namespace device_detail;
+        if (consume(s, "HIGH 1s=")) {
+            stats.kind = StatsKind::BusLoadHigh;
+        } else if (consume(s, "OK 1s=")) {
+            stats.kind = StatsKind::BusLoadOk;
+        } else {
+            return false;
+        }
+        uint32_t whole, tenths;
+        if (!parseU32(s, whole) || !consume(s, ".") || !parseU32(s, tenths)) return false;
+        stats.id = 0;
+        stats.value = whole * 10 + tenths;
+        stats.expected = 0;
+        return true;
+    }
+
+    // "<LABEL> PRESSED|TOUCHED|RELEASED" with an upper-case label
+    static bool parseButton(std::string_view s, DeviceEvent &event) {
+        using namespace device_detail;
+        size_t n = 0;
+        while (n < s.size() && ((s[n] >= 'A' && s[n] <= 'Z') || (s[n] >= '0' && s[n] <= '9'))) n++;
+        if (n == 0 || n >= s.size() || s[n] != ' ') return false;
+        event.button.label = s.substr(0, n);
+        s.remove_prefix(n + 1);
+        if (s == "PRESSED") {
+            event.button.action = ButtonAction::Pressed;
+        } else if (s == "TOUCHED") {
+            event.button.action = ButtonAction::Touched;
+        } else if (s == "RELEASED") {
+            event.button.action = ButtonAction::Released;
+        } else {
+            return false;
+        }
+        event.kind = DeviceEventKind::Button;
+        return true;
+    }
+
+    // "<records> <trigger> <trigger_us>[ delta]"; the binary payload follows
+    bool beginCapture(std::string_view s) {
+        using namespace device_detail;
+        DeviceCapture &capture = pendingCapture_;
+        if (!parseU32(s, capture.records) || !consume(s, " ") || !parseU32(s, capture.trigger) ||
+            !consume(s, " ") || !parseU32(s, capture.triggerUs)) {
+            return false;
+        }
+        capture.delta = s == " delta";
+        capture_ = true;
+        return true;
+    }
+
+    // Raw dumps have a known length (16-byte CaptureRecords); delta dumps
+    // run until the END line
+    bool finishCapture(DeviceEvent &event) {
+        using namespace device_detail;
+        static constexpr std::string_view END = "CAPTURE END";
+        const char *base = buffer_.data() + head_;
+        size_t available = tail_ - head_;
+        size_t payloadEnd;
+        if (!pendingCapture_.delta) {
+            payloadEnd = capturePayload_ + static_cast<size_t>(pendingCapture_.records) * 16;
+            if (payloadEnd > available) return false;
+        } else {
+            std::string_view window(base + captureScan_, available - captureScan_);
+            size_t hit = window.find(END);
+            if (hit == std::string_view::npos) {
+                if (window.size() >= END.size()) captureScan_ = available - (END.size() - 1);
+                return false;
+            }
+            payloadEnd = captureScan_ + hit;
+        }
+
+        // Swallow the END line as well, once it is complete, and check its
+        // " <bytes> <crc32>" trailer; a bare END line is older firmware
+        std::string_view after(base + payloadEnd, available - payloadEnd);
+        std::string_view payload(base + capturePayload_, payloadEnd - capturePayload_);
+        size_t consumed = payloadEnd;
+        bool intact = false;
+        if (after.size() <= END.size() && END.substr(0, after.size()) == after) return false;
+        if (after.substr(0, END.size()) == END) {
+            size_t nl = after.find('\n');
+            if (nl == std::string_view::npos) return false;
+            consumed += nl + 1;
+            std::string_view trailer = after.substr(END.size(), nl - END.size());
+            if (!trailer.empty() && trailer.back() == '\r') trailer.remove_suffix(1);
+            uint32_t bytes, crc;
+            intact = trailer.empty() ||
+                     (consume(trailer, " ") && parseU32(trailer, bytes) && consume(trailer, " ") &&
+                      parseHex(trailer, crc) && trailer.empty() && bytes == payload.size() && crc == crc32(payload));
+        }
+
+        event.kind = DeviceEventKind::Capture;
+        event.line = std::string_view(base, captureLine_);
+        event.capture = pendingCapture_;
+        event.capture.intact = intact;
+        event.capture.payload = payload;
+        head_ += consumed;
+        capture_ = false;
+        return true;
+    }
+
+    std::vector<char> buffer_;
+    size_t            head_ = 0;  // first unparsed byte
+    size_t            tail_ = 0;  // end of valid data
+    uint32_t          mask_ = ALL_DEVICE_EVENTS;
+    bool              capture_ = false;  // head_ is at a CAPTURE BEGIN line whose payload is incomplete
+    DeviceCapture     pendingCapture_{};
+    size_t            captureLine_ = 0;     // header length without CR/LF
+    size_t            capturePayload_ = 0;  // payload offset from head_
+    size_t            captureScan_ = 0;     // delta dumps: where the END search resumes, from head_
+    DeviceTouch       touch_{};
+    size_t            dropped_ = 0;
+};
+
+enum class DebugMode : uint8_t {
+    Normal,  // state changes only
+    Debug,   // known frames as well
+    Raw,     // every frame
+};
+
+class DeviceClient {
+public:
+    DeviceClient() = default;
+    DeviceClient(const DeviceClient &) = delete;
+    DeviceClient &operator=(const DeviceClient &) = delete;
+    ~DeviceClient() { close(); }
+
+    // Opens the tty raw and non-blocking; false with errno set on failure
+    bool open(const char *path) {
+        close();
+        int fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) return false;
+        termios tio{};
+        if (::tcgetattr(fd, &tio) == 0) {
+            ::cfmakeraw(&tio);
+            ::cfsetispeed(&tio, B115200);
+            ::cfsetospeed(&tio, B115200);
+            // A blocking read (the io_uring path) returns as soon as one byte
+            // is there, with all that is; VTIME would add an inter-byte timer
+            // and a larger VMIN would hold short event lines back
+            tio.c_cc[VMIN] = 1;
+            tio.c_cc[VTIME] = 0;
+            if (::tcsetattr(fd, TCSANOW, &tio) != 0) {
+                int error = errno;
+                ::close(fd);
+                errno = error;
+                return false;
+            }
+            ::tcflush(fd, TCIOFLUSH);
+        }
+        lowLatency_ = setLowLatency(fd);
+        fd_ = fd;
+        parser_.reset();
+        return true;
+    }
+
+    // Takes over an already open descriptor (pipe, socket, pty), made non-blocking
+    void attach(int fd) {
+        close();
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fd_ = fd;
+        parser_.reset();
+    }
+
+    void close() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        out_.clear();
+        batching_ = false;
+    }
+
+    int fd() const { return fd_; }
+    bool isOpen() const { return fd_ >= 0; }
+    bool lowLatency() const { return lowLatency_; }
+
+    // Waits up to timeoutMs (-1 forever, 0 not at all) and does one read()
+    // into the parser's buffer. Returns false once the device is gone.
+    bool receive(int timeoutMs) {
+        if (fd_ < 0) return false;
+        if (timeoutMs != 0) {
+            pollfd pfd{fd_, POLLIN, 0};
+            int ready = ::poll(&pfd, 1, timeoutMs);
+            if (ready < 0) return errno == EINTR;
+            if (ready == 0) return true;
+        }
+        size_t available;
+        char *space = parser_.prepare(available);
+        ssize_t n = ::read(fd_, space, available);
+        if (n > 0) {
+            parser_.commit(static_cast<size_t>(n));
+            return true;
+        }
+        return n < 0 && (errno == EAGAIN || errno == EINTR);
+    }
+
+    bool next(DeviceEvent &event) { return parser_.next(event); }
+
+    template <typename Handler>
+    size_t dispatch(Handler &&handler) {
+        return parser_.dispatch(std::forward<Handler>(handler));
+    }
+
+    void setEventMask(uint32_t mask) { parser_.setEventMask(mask); }
+    DeviceStreamParser &parser() { return parser_; }
+
+    // --- Commands (see README "Serial Commands") ---
+    //
+    // Each call is written at once unless a batch is open; the firmware
+    // answers most of them with a Text line.
+
+    void beginBatch() { batching_ = true; }
+
+    bool flush() {
+        batching_ = false;
+        size_t done = 0;
+        while (done < out_.size()) {
+            ssize_t n = ::write(fd_, out_.data() + done, out_.size() - done);
+            if (n < 0 && errno == EAGAIN) {
+                pollfd pfd{fd_, POLLOUT, 0};
+                if (::poll(&pfd, 1, WRITE_TIMEOUT_MS) > 0) continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                out_.clear();
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+        out_.clear();
+        return true;
+    }
+
+    // Any command line, without the newline. The '\n' appended here ends
+    // the line for the firmware's line-buffered dispatcher, which takes CR,
+    // LF or CRLF as the terminator and sends no reply for it.
+    bool command(std::string_view text) {
+        out_.append(text.data(), text.size()).push_back('\n');
+        return send();
+    }
+
+    bool setBrightness(unsigned level) { return format("%u", level > 9 ? 9 : level); }  // 0 off .. 9 max
+    bool adjustBrightness(bool up) { return command(up ? "+" : "-"); }
+    bool setDebugMode(DebugMode mode) { return format("d%u", static_cast<unsigned>(mode)); }
+
+    // RAW/DEBUG frame lines only for the filtered IDs (empty = all)
+    bool toggleFrameFilter(uint32_t id) { return format("f%X", id); }
+    bool clearFrameFilter() { return command("fx"); }
+
+    // One standard-ID frame on the bus, acked with "TX 0x<id> sent|failed"
+    bool transmit(uint32_t id, const uint8_t *data, uint8_t len) {
+        if (id > 0x7FF || len > 8) return false;
+        char line[32];
+        int n = std::snprintf(line, sizeof(line), "x%X:", id);
+        for (uint8_t i = 0; i < len; i++) n += std::snprintf(line + n, sizeof(line) - n, "%02X", data[i]);
+        return command(std::string_view(line, static_cast<size_t>(n)));
+    }
+
+    bool sendKeepAlive() { return command("k"); }
+    bool setSignalReports(bool on) { return command(on ? "g1" : "g0"); }
+    bool uploadDbcLine(std::string_view line) {
+        out_.append("g:");
+        return command(line);
+    }
+    bool clearDbcUploads() { return command("gx"); }
+    bool setCycleReports(bool on) { return command(on ? "y1" : "y0"); }
+    bool setBusLoadThreshold(unsigned percent) { return format("u%u", percent); }
+    bool setLatencyLoopback(bool on) { return command(on ? "a1" : "a0"); }
+    bool ackLatency(uint32_t sequence) { return format("!%u", sequence); }
+    bool clockSyncPing(uint32_t sequence) { return format("@%u", sequence); }
+    bool setClockMapping(int64_t offsetUs, int64_t driftPpb, int64_t referenceUs) {
+        return format("@=%lld.%lld.%lld", static_cast<long long>(offsetUs), static_cast<long long>(driftPpb),
+                      static_cast<long long>(referenceUs));
+    }
+    bool addCaptureIdTrigger(uint32_t id) { return format("ci%X", id); }
+    bool armCapture() { return command("ca"); }
+    bool triggerCapture() { return command("cn"); }
+    bool setCaptureCompression(bool on) { return command(on ? "cz1" : "cz0"); }
+
+private:
+    static constexpr int WRITE_TIMEOUT_MS = 100;
+
+    static bool setLowLatency(int fd) {
+#ifdef __linux__
+        serial_struct serial{};
+        if (::ioctl(fd, TIOCGSERIAL, &serial) != 0) return false;
+        serial.flags |= ASYNC_LOW_LATENCY;
+        return ::ioctl(fd, TIOCSSERIAL, &serial) == 0;
+#else
+        (void)fd;
+        return false;
+#endif
+    }
+
+    template <typename... Args>
+    bool format(const char *pattern, Args... args) {
+        char line[64];
+        int n = std::snprintf(line, sizeof(line), pattern, args...);
+        return command(std::string_view(line, static_cast<size_t>(n)));
+    }
+
+    bool send() { return batching_ || flush(); }
+
+    int                fd_ = -1;
+    bool               lowLatency_ = false;
+    bool               batching_ = false;
+    std::string        out_;
+    DeviceStreamParser parser_;
+};
+
+}  // namespace idrive
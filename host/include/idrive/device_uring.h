@@ -0,0 +1,254 @@
+#pragma once
+
+// Optional io_uring read path for DeviceClient (Linux 5.6 or later).
+//
+// One IORING_OP_READ is always queued on the tty, straight into the
+// parser's buffer. When it completes the bytes are committed and the next
+// read is queued before the caller parses, so the driver can hand over
+// new data while the previous batch is being dispatched, and an idle
+// reader costs no syscall per wake-up beyond the one io_uring_enter that
+// queues the next read. Only one read is in flight at a time, which keeps
+// the byte order without linked requests.
+//
+//   idrive::DeviceUringReader reader;
+//   if (reader.start(client.fd(), client.parser()))
+//       while (reader.receive(client.parser(), -1)) client.dispatch(...);
+//
+// start() puts the tty in blocking mode, since older kernels complete
+// io_uring reads on an O_NONBLOCK file with -EAGAIN instead of waiting for
+// data; command writes on the same fd then block until queued (they are a
+// few bytes). With VMIN=1 and VTIME=0, as DeviceClient::open()
+// sets them, a queued read completes as soon as any byte arrives, with
+// everything that is available. start() fails with errno set (ENOSYS, or
+// EPERM where io_uring is disabled), in which case the caller keeps using
+// DeviceClient::receive(). Without <linux/io_uring.h> a stub that always
+// fails to start is provided instead.
+//
+// Raw syscalls are used so the header needs no liburing.
+
+#include "idrive/device_client.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define IDRIVE_HAVE_IO_URING 1
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace idrive {
+
+class DeviceUringReader {
+public:
+    DeviceUringReader() = default;
+    DeviceUringReader(const DeviceUringReader &) = delete;
+    DeviceUringReader &operator=(const DeviceUringReader &) = delete;
+    ~DeviceUringReader() { stop(); }
+
+    // Queues the first read into parser; false with errno set
+    bool start(int fd, DeviceStreamParser &parser) {
+        stop();
+        io_uring_params params{};
+        int ring = static_cast<int>(::syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params));
+        if (ring < 0) return false;
+        ringFd_ = ring;
+
+        sqSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sqSize_ = cqSize_ = std::max(sqSize_, cqSize_);
+        sqRing_ = map(sqSize_, IORING_OFF_SQ_RING);
+        cqRing_ = single ? sqRing_ : map(cqSize_, IORING_OFF_CQ_RING);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe *>(map(sqesSize_, IORING_OFF_SQES));
+        if (!sqRing_ || !cqRing_ || !sqes_) {
+            int error = errno;
+            stop();
+            errno = error;
+            return false;
+        }
+
+        auto *sq = static_cast<char *>(sqRing_);
+        sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        auto *cq = static_cast<char *>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+        fd_ = fd;
+        queued_ = false;
+        if (!queueRead(parser)) {
+            int error = errno;
+            stop();
+            errno = error;
+            return false;
+        }
+        return true;
+    }
+
+    void stop() {
+        // The queued read targets the parser's buffer: cancel it and wait
+        // for it to finish before the caller can free that buffer
+        if (queued_) cancelRead();
+        if (sqes_) ::munmap(sqes_, sqesSize_);
+        if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqSize_);
+        if (sqRing_) ::munmap(sqRing_, sqSize_);
+        if (ringFd_ >= 0) ::close(ringFd_);
+        sqes_ = nullptr;
+        sqRing_ = cqRing_ = nullptr;
+        ringFd_ = fd_ = -1;
+        queued_ = false;
+    }
+
+    bool isRunning() const { return ringFd_ >= 0; }
+
+    // Readable when a read has completed; for an epoll loop
+    int fd() const { return ringFd_; }
+
+    // Waits up to timeoutMs (-1 forever, 0 not at all) for the queued read,
+    // commits it to parser and queues the next one. Returns false once the
+    // device is gone or the read failed (errno set).
+    bool receive(DeviceStreamParser &parser, int timeoutMs) {
+        if (ringFd_ < 0) return false;
+        if (!queued_ && !queueRead(parser)) return false;
+        if (timeoutMs != 0) {
+            pollfd pfd{ringFd_, POLLIN, 0};
+            int ready = ::poll(&pfd, 1, timeoutMs);
+            if (ready < 0) return errno == EINTR;
+            if (ready == 0) return true;
+        }
+
+        unsigned head = *cqHead_;
+        if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) return true;
+        int result = cqes_[head & cqMask_].res;
+        __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+        queued_ = false;
+
+        if (result > 0) {
+            parser.commit(static_cast<size_t>(result));
+        } else if (result == 0) {
+            return false;  // hang-up
+        } else if (result != -EINTR && result != -EAGAIN) {
+            errno = -result;
+            return false;
+        }
+        return queueRead(parser);
+    }
+
+private:
+    static constexpr unsigned QUEUE_DEPTH = 4;
+    static constexpr uint64_t READ_TAG    = 1;
+    static constexpr uint64_t CANCEL_TAG  = 2;
+
+    void *map(size_t size, off_t offset) {
+        void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, offset);
+        return address == MAP_FAILED ? nullptr : address;
+    }
+
+    bool queueRead(DeviceStreamParser &parser) {
+        size_t available;
+        char *space = parser.prepare(available);
+        unsigned tail = *sqTail_;
+        unsigned index = tail & sqMask_;
+        io_uring_sqe &sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd_;
+        sqe.addr = reinterpret_cast<uint64_t>(space);
+        sqe.len = static_cast<uint32_t>(available);
+        sqe.off = static_cast<uint64_t>(-1);  // current position; ttys have none
+        sqe.user_data = READ_TAG;
+        if (!submit(tail, index)) return false;
+        queued_ = true;
+        return true;
+    }
+
+    void cancelRead() {
+        unsigned tail = *sqTail_;
+        unsigned index = tail & sqMask_;
+        io_uring_sqe &sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.addr = READ_TAG;
+        sqe.user_data = CANCEL_TAG;
+        if (!submit(tail, index)) return;
+        for (int completions = 0; completions < 2;) {
+            unsigned head = *cqHead_;
+            if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                if (::syscall(__NR_io_uring_enter, ringFd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                    errno != EINTR) {
+                    return;
+                }
+                continue;
+            }
+            __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+            completions++;
+        }
+        queued_ = false;
+    }
+
+    bool submit(unsigned tail, unsigned index) {
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        for (;;) {
+            long submitted = ::syscall(__NR_io_uring_enter, ringFd_, 1, 0, 0, nullptr, 0);
+            if (submitted == 1) return true;
+            if (submitted < 0 && errno == EINTR) continue;
+            return false;
+        }
+    }
+
+    int           ringFd_ = -1;
+    int           fd_ = -1;
+    bool          queued_ = false;
+    void         *sqRing_ = nullptr;
+    void         *cqRing_ = nullptr;
+    size_t        sqSize_ = 0;
+    size_t        cqSize_ = 0;
+    size_t        sqesSize_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+    unsigned     *sqTail_ = nullptr;
+    unsigned      sqMask_ = 0;
+    unsigned     *sqArray_ = nullptr;
+    unsigned     *cqHead_ = nullptr;
+    unsigned     *cqTail_ = nullptr;
+    unsigned      cqMask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+};
+
+}  // namespace idrive
+
+#else
+
+#include <cerrno>
+
+namespace idrive {
+
+// No io_uring here: start() fails and callers keep using receive()
+class DeviceUringReader {
+public:
+    bool start(int, DeviceStreamParser &) {
+        errno = ENOSYS;
+        return false;
+    }
+    void stop() {}
+    bool isRunning() const { return false; }
+    int fd() const { return -1; }
+    bool receive(DeviceStreamParser &, int) { return false; }
+};
+
+}  // namespace idrive
+
+#endif
@@ -0,0 +1,484 @@
+#pragma once
+
+// Unix-domain socket fan-out of ring records, for consumers that would
+// rather read lines from a socket than map the shared-memory ring
+// (zbe_hub --socket).
+//
+// Each client gets one text line per event ("<sec>.<usec> <kind> ...", see
+// formatRingRecord) and may narrow its subscription at any time:
+//
+//   SUB [kinds=frame,button,...] [ids=25B,0BF] [every=N]
+//
+// ids and every apply to frames only; every=N passes one frame in N per
+// ID. A new SUB replaces the previous one and is answered with "OK" or
+// "ERR <reason>". Clients start subscribed to everything.
+//
+// Everything runs on the caller's thread: EventMux owns an epoll instance
+// whose fd the caller adds to its own loop and services when readable.
+// Sockets are non-blocking and every client has a bounded output queue.
+// When a queue is full the slow-client policy either drops the event for
+// that client (it later reads "DROPPED <n>" before the next line it does
+// get) or disconnects it. A client waiting for socket space is not written
+// to again until epoll reports it writable, so a stalled client costs one
+// filter check and a memcpy or a drop per event and never blocks
+// publish() or the other clients.
+
+#include "idrive/event_ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace idrive {
+
+constexpr size_t EVENT_MUX_DEFAULT_QUEUE   = 256 * 1024;
+constexpr size_t EVENT_MUX_DEFAULT_CLIENTS = 1024;
+constexpr size_t EVENT_MUX_MAX_LINE        = 256;
+constexpr size_t EVENT_MUX_MAX_REQUEST     = 512;
+constexpr size_t EVENT_MUX_MAX_IDS         = 64;
+
+enum class SlowClientPolicy : uint8_t { Drop, Disconnect };
+
+inline const char *ringKindName(uint8_t kind) {
+    static const char *const NAMES[] = {"frame", "button", "knob", "rotation", "touch", "signal",
+                                        "stats", "latency", "sync", "capture", "text"};
+    return kind < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[kind] : "?";
+}
+
+// One text line for a record, newline included; returns its length
+inline size_t formatRingRecord(const RingRecord &record, char *out, size_t size) {
+    static const char *const ACTIONS[] = {"RELEASED", "PRESSED", "TOUCHED"};
+    int n = std::snprintf(out, size, "%lld.%06lld %s ", static_cast<long long>(record.hostNs / 1000000000),
+                          static_cast<long long>(record.hostNs % 1000000000 / 1000), ringKindName(record.kind));
+    auto append = [&](const char *format, auto... args) {
+        if (n >= 0 && static_cast<size_t>(n) < size) n += std::snprintf(out + n, size - static_cast<size_t>(n), format, args...);
+    };
+    switch (static_cast<DeviceEventKind>(record.kind)) {
+        case DeviceEventKind::Frame:
+            append("0x%03X:", record.frame.id);
+            for (uint8_t i = 0; i < record.frame.dlc && i < 8; i++) append(" %02X", record.frame.data[i]);
+            break;
+        case DeviceEventKind::Button:
+            append("%s %s", record.input.label, ACTIONS[record.input.action % 3]);
+            break;
+        case DeviceEventKind::Knob:
+            append("%s", record.input.action ? record.input.label : "RELEASED");
+            break;
+        case DeviceEventKind::Rotation:
+            append("%s %d", record.rotation.direction > 0 ? "CW" : "CCW", record.rotation.position);
+            break;
+        case DeviceEventKind::Touch:
+            append("%u %u %u", record.touch.fingers, record.touch.x, record.touch.y);
+            break;
+        case DeviceEventKind::Signal:
+            append("%s.%s %g", record.signal.message, record.signal.name, record.signal.value);
+            if (record.signal.unit[0]) append(" %s", record.signal.unit);
+            if (record.signal.valueName[0]) append(" (%s)", record.signal.valueName);
+            break;
+        case DeviceEventKind::Stats:
+            append("%u 0x%03X %u %u", static_cast<unsigned>(record.stats.kind), record.stats.id, record.stats.value,
+                   record.stats.expected);
+            break;
+        case DeviceEventKind::Latency:
+            append("%u", record.latencySequence);
+            break;
+        case DeviceEventKind::Sync:
+            append("%u %lld %lld", record.sync.sequence, static_cast<long long>(record.sync.rxUs),
+                   static_cast<long long>(record.sync.txUs));
+            break;
+        default:
+            break;
+    }
+    size_t length = n < 0 ? 0 : std::min(static_cast<size_t>(n), size - 2);
+    out[length++] = '\n';
+    out[length] = '\0';
+    return length;
+}
+
+struct EventFilter {
+    uint32_t              kinds = ALL_DEVICE_EVENTS;
+    uint32_t              every = 1;  // frames: one in N per ID
+    std::vector<uint32_t> ids;        // frames: only these (sorted), empty for all
+};
+
+// Parses a "SUB ..." request into filter; false with error set
+inline bool parseSubscription(std::string_view line, EventFilter &filter, const char *&error) {
+    using device_detail::consume;
+    using device_detail::parseHex;
+    using device_detail::parseU32;
+    using device_detail::takeUntil;
+
+    if (!consume(line, "SUB")) {
+        error = "unknown request";
+        return false;
+    }
+    EventFilter parsed;
+    while (!line.empty()) {
+        if (line[0] == ' ') {
+            line.remove_prefix(1);
+            continue;
+        }
+        std::string_view token = takeUntil(line, ' ');
+        if (consume(token, "kinds=")) {
+            parsed.kinds = 0;
+            while (!token.empty()) {
+                std::string_view name = takeUntil(token, ',');
+                consume(token, ",");
+                uint8_t kind = 0;
+                while (kind <= static_cast<uint8_t>(DeviceEventKind::Text) && name != ringKindName(kind)) kind++;
+                if (kind == static_cast<uint8_t>(DeviceEventKind::Capture) ||
+                    kind >= static_cast<uint8_t>(DeviceEventKind::Text)) {
+                    error = "unknown kind";
+                    return false;
+                }
+                parsed.kinds |= 1u << kind;
+            }
+        } else if (consume(token, "ids=")) {
+            while (!token.empty()) {
+                std::string_view text = takeUntil(token, ',');
+                consume(token, ",");
+                consume(text, "0x");
+                uint32_t id = 0;
+                if (!parseHex(text, id) || !text.empty() || parsed.ids.size() == EVENT_MUX_MAX_IDS) {
+                    error = "bad ids";
+                    return false;
+                }
+                parsed.ids.push_back(id);
+            }
+            std::sort(parsed.ids.begin(), parsed.ids.end());
+        } else if (consume(token, "every=")) {
+            if (!parseU32(token, parsed.every) || !token.empty() || parsed.every == 0) {
+                error = "bad every";
+                return false;
+            }
+        } else {
+            error = "unknown option";
+            return false;
+        }
+    }
+    filter = std::move(parsed);
+    return true;
+}
+
+struct EventMuxStats {
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;      // over the client limit
+    uint64_t delivered = 0;     // event lines queued, summed over clients
+    uint64_t dropped = 0;       // event lines dropped for full queues
+    uint64_t disconnected = 0;  // clients closed by the slow-client policy
+};
+
+class EventMux {
+public:
+    EventMux() = default;
+    EventMux(const EventMux &) = delete;
+    EventMux &operator=(const EventMux &) = delete;
+    ~EventMux() { close(); }
+
+    // Listens on path (a stale socket there is replaced); false with errno set
+    bool listen(const char *path, size_t queueLimit = EVENT_MUX_DEFAULT_QUEUE,
+                SlowClientPolicy policy = SlowClientPolicy::Drop, size_t maxClients = EVENT_MUX_DEFAULT_CLIENTS) {
+        close();
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (std::strlen(path) >= sizeof(address.sun_path)) {
+            errno = ENAMETOOLONG;
+            return false;
+        }
+        std::strcpy(address.sun_path, path);
+        struct stat info{};
+        if (::lstat(path, &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                errno = EEXIST;
+                return false;
+            }
+            ::unlink(path);
+        }
+
+        listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (listenFd_ < 0 || epollFd_ < 0 ||
+            ::bind(listenFd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+            ::listen(listenFd_, SOMAXCONN) != 0 || ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &event) != 0) {
+            int error = errno;
+            close();
+            errno = error;
+            return false;
+        }
+        path_ = path;
+        queueLimit_ = std::max(queueLimit, EVENT_MUX_MAX_LINE * 2);
+        policy_ = policy;
+        maxClients_ = maxClients;
+        stats_ = EventMuxStats();
+        return true;
+    }
+
+    void close() {
+        for (auto &client : clients_) ::close(client->fd);
+        clients_.clear();
+        dirty_.clear();
+        if (listenFd_ >= 0) ::close(listenFd_);
+        if (epollFd_ >= 0) ::close(epollFd_);
+        listenFd_ = epollFd_ = -1;
+        if (!path_.empty()) ::unlink(path_.c_str());
+        path_.clear();
+    }
+
+    // Add to the caller's epoll set; call service() when it is readable
+    int fd() const { return epollFd_; }
+
+    // Accepts clients, reads their requests and continues writes that were
+    // waiting for socket space. Never blocks.
+    void service() {
+        epoll_event events[64];
+        int ready;
+        while ((ready = ::epoll_wait(epollFd_, events, 64, 0)) > 0) {
+            for (int i = 0; i < ready; i++) {
+                auto *client = static_cast<Client *>(events[i].data.ptr);
+                if (!client) {
+                    acceptClients();
+                    continue;
+                }
+                if (client->closing) continue;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    client->closing = true;
+                    continue;
+                }
+                if (events[i].events & EPOLLIN) readRequests(*client);
+                if ((events[i].events & EPOLLOUT) && !client->closing) writeOut(*client);
+            }
+            if (ready < 64) break;
+        }
+        flush();
+    }
+
+    // Queues the record for every client whose filter passes it; the
+    // writes happen in flush(), once per batch
+    void publish(const RingRecord &record) {
+        char line[EVENT_MUX_MAX_LINE];
+        size_t length = 0;
+        uint32_t bit = 1u << record.kind;
+        bool frame = record.kind == static_cast<uint8_t>(DeviceEventKind::Frame);
+        for (auto &owned : clients_) {
+            Client &client = *owned;
+            if (client.closing || !(client.filter.kinds & bit)) continue;
+            if (frame && !client.passes(record.frame.id)) continue;
+            if (!length) length = formatRingRecord(record, line, sizeof(line));
+            deliver(client, line, length);
+        }
+    }
+
+    // Writes what publish() queued and closes clients marked for closing
+    void flush() {
+        for (Client *client : dirty_) {
+            client->dirty = false;
+            if (!client->closing && client->writable) writeOut(*client);
+        }
+        dirty_.clear();
+        reap();
+    }
+
+    size_t clientCount() const { return clients_.size(); }
+    const EventMuxStats &stats() const { return stats_; }
+
+private:
+    struct Client {
+        int                                    fd = -1;
+        EventFilter                            filter;
+        std::unordered_map<uint32_t, uint32_t> seen;  // frames per ID, for every=N
+        std::vector<char>                      queue;
+        size_t                                 sent = 0;
+        uint64_t                               dropped = 0;  // since the last line delivered
+        std::string                            request;
+        bool                                   reading = true;
+        bool                                   writable = true;  // false while waiting for EPOLLOUT
+        bool                                   dirty = false;
+        bool                                   closing = false;
+
+        bool passes(uint32_t id) {
+            if (!filter.ids.empty() && !std::binary_search(filter.ids.begin(), filter.ids.end(), id)) return false;
+            return filter.every == 1 || seen[id]++ % filter.every == 0;
+        }
+    };
+
+    void acceptClients() {
+        for (;;) {
+            int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            if (clients_.size() >= maxClients_) {
+                ::close(fd);
+                stats_.rejected++;
+                continue;
+            }
+            auto client = std::make_unique<Client>();
+            client->fd = fd;
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.ptr = client.get();
+            if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+                ::close(fd);
+                continue;
+            }
+            clients_.push_back(std::move(client));
+            stats_.accepted++;
+        }
+    }
+
+    void updateInterest(Client &client) {
+        epoll_event event{};
+        event.events = (client.reading ? EPOLLIN : 0u) | (client.writable ? 0u : EPOLLOUT);
+        event.data.ptr = &client;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, client.fd, &event);
+    }
+
+    void readRequests(Client &client) {
+        char buffer[EVENT_MUX_MAX_REQUEST];
+        ssize_t n;
+        while ((n = ::read(client.fd, buffer, sizeof(buffer))) > 0) {
+            client.request.append(buffer, static_cast<size_t>(n));
+            size_t start = 0;
+            for (size_t nl; (nl = client.request.find('\n', start)) != std::string::npos; start = nl + 1) {
+                std::string_view line(client.request.data() + start, nl - start);
+                if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                if (!line.empty()) handleRequest(client, line);
+            }
+            client.request.erase(0, start);
+            if (client.request.size() > EVENT_MUX_MAX_REQUEST) {
+                client.closing = true;
+                return;
+            }
+        }
+        if (n == 0) {
+            // Half-closed: keep sending, stop watching for requests
+            client.reading = false;
+            updateInterest(client);
+        } else if (errno != EAGAIN && errno != EINTR) {
+            client.closing = true;
+        }
+    }
+
+    void handleRequest(Client &client, std::string_view line) {
+        const char *error = nullptr;
+        if (parseSubscription(line, client.filter, error)) {
+            client.seen.clear();
+            reply(client, "OK\n");
+        } else {
+            char text[64];
+            int n = std::snprintf(text, sizeof(text), "ERR %s\n", error);
+            reply(client, std::string_view(text, static_cast<size_t>(n)));
+        }
+    }
+
+    void reply(Client &client, std::string_view text) {
+        if (append(client, text.data(), text.size())) markDirty(client);
+    }
+
+    void deliver(Client &client, const char *line, size_t length) {
+        // Room for the line and, after a gap, the notice; the notice is only
+        // formatted once it fits, so a full queue costs a compare per event
+        char notice[32];
+        size_t reserve = client.dropped ? sizeof(notice) : 0;
+        if (client.queue.size() - client.sent + reserve + length > queueLimit_) {
+            if (policy_ == SlowClientPolicy::Disconnect) {
+                client.closing = true;
+                stats_.disconnected++;
+            } else {
+                client.dropped++;
+                stats_.dropped++;
+            }
+            return;
+        }
+        if (client.dropped) {
+            int n = std::snprintf(notice, sizeof(notice), "DROPPED %llu\n", static_cast<unsigned long long>(client.dropped));
+            append(client, notice, static_cast<size_t>(n));
+        }
+        append(client, line, length);
+        client.dropped = 0;
+        stats_.delivered++;
+        markDirty(client);
+    }
+
+    bool append(Client &client, const char *data, size_t length) {
+        size_t pending = client.queue.size() - client.sent;
+        if (pending + length > queueLimit_) return false;
+        // Compact once the written part outweighs what is left, so each byte moves at most once
+        if (client.sent && client.sent >= pending) {
+            std::memmove(client.queue.data(), client.queue.data() + client.sent, pending);
+            client.queue.resize(pending);
+            client.sent = 0;
+        }
+        client.queue.insert(client.queue.end(), data, data + length);
+        return true;
+    }
+
+    void markDirty(Client &client) {
+        if (client.dirty || !client.writable) return;
+        client.dirty = true;
+        dirty_.push_back(&client);
+    }
+
+    void writeOut(Client &client) {
+        while (client.sent < client.queue.size()) {
+            ssize_t n = ::send(client.fd, client.queue.data() + client.sent, client.queue.size() - client.sent,
+                               MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n > 0) {
+                client.sent += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (client.writable) {
+                    client.writable = false;
+                    updateInterest(client);
+                }
+                return;
+            } else {
+                client.closing = true;
+                return;
+            }
+        }
+        client.queue.clear();
+        client.sent = 0;
+        if (!client.writable) {
+            client.writable = true;
+            updateInterest(client);
+        }
+    }
+
+    void reap() {
+        auto closing = [](const std::unique_ptr<Client> &client) { return client->closing; };
+        if (std::none_of(clients_.begin(), clients_.end(), closing)) return;
+        for (auto &client : clients_) {
+            if (client->closing) ::close(client->fd);  // also drops it from the epoll set
+        }
+        clients_.erase(std::remove_if(clients_.begin(), clients_.end(), closing), clients_.end());
+    }
+
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::vector<Client *>                dirty_;
+    std::string                          path_;
+    int                                  listenFd_ = -1;
+    int                                  epollFd_ = -1;
+    size_t                               queueLimit_ = EVENT_MUX_DEFAULT_QUEUE;
+    size_t                               maxClients_ = EVENT_MUX_DEFAULT_CLIENTS;
+    SlowClientPolicy                     policy_ = SlowClientPolicy::Drop;
+    EventMuxStats                        stats_;
+};
+
+}  // namespace idrive
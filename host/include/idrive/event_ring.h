@@ -0,0 +1,367 @@
+#pragma once
+
+// Single-writer/multi-reader event ring in POSIX shared memory, so one
+// daemon can own the tty and any number of local processes can follow the
+// stream (zbe_hub writes it, zbe_hub --tail reads it).
+//
+// The segment is a header and a power-of-two array of fixed 128-byte
+// slots. Each slot carries a version word used as a seqlock: the writer
+// marks the slot odd, copies the record in and stores 2 * (sequence + 1).
+// A reader that finds a different version than the one it expects has
+// either caught up with the writer or been lapped, and a version that
+// changes during its copy means the record was overwritten under it. The
+// writer never looks at reader state and readers map the segment
+// read-only, so readers can come and go without affecting the writer or
+// each other; a reader that falls more than a ring behind skips ahead and
+// counts the records it lost. The segment outlives the writer, so a
+// restarted writer continues the same sequence.
+//
+// Text lines and capture dumps are not published; use DeviceClient for
+// those.
+
+#include "idrive/device_client.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace idrive {
+
+constexpr uint64_t EVENT_RING_MAGIC   = 0x31474E5245425A49ULL;  // "IZBERNG1"
+constexpr uint32_t EVENT_RING_VERSION = 1;
+constexpr uint32_t EVENT_RING_DEFAULT_SLOTS = 16384;  // 2 MB, several seconds of a saturated RAW stream
+constexpr char     EVENT_RING_DEFAULT_NAME[] = "/idrive-zbe";
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring needs lock-free 64-bit atomics");
+
+struct RingFrame {
+    int64_t  timestampUs;  // as DeviceFrame
+    uint32_t id;
+    uint8_t  dlc;
+    uint8_t  hostClock;
+    uint8_t  data[8];
+};
+
+struct RingInput {
+    char    label[16];  // button label or knob position, empty for "Knob RELEASED"
+    uint8_t action;     // Button: ButtonAction; Knob: 1 pressed, 0 released
+};
+
+struct RingSignal {
+    double value;
+    char   message[32];
+    char   name[32];
+    char   valueName[16];
+    char   unit[8];
+};
+
+// One published event; the member matching kind is valid
+struct RingRecord {
+    int64_t  hostNs;    // CLOCK_MONOTONIC when the daemon parsed the event
+    uint8_t  kind;      // DeviceEventKind
+    uint8_t  reserved[7];
+    union {
+        RingFrame      frame;
+        RingInput      input;
+        DeviceRotation rotation;
+        DeviceTouch    touch;
+        RingSignal     signal;
+        DeviceStats    stats;
+        uint32_t       latencySequence;
+        DeviceSync     sync;
+    };
+};
+
+static_assert(sizeof(RingRecord) <= 120, "RingRecord must fit a 128-byte slot with its version word");
+
+struct alignas(64) EventRingSlot {
+    std::atomic<uint64_t> version;  // 0 never written, odd while written, 2 * (sequence + 1) when complete
+    RingRecord            record;
+};
+
+static_assert(sizeof(EventRingSlot) == 128, "EventRingSlot must stay two cache lines");
+
+struct alignas(64) EventRingHeader {
+    std::atomic<uint64_t> magic;  // stored last by the writer, once the layout is valid
+    uint32_t              version;
+    uint32_t              slotCount;
+    int64_t               writerPid;
+    std::atomic<uint32_t> writerOpen;  // cleared when the writer exits; readers should re-attach
+    alignas(64) std::atomic<uint64_t> head;  // sequence of the next record, on its own cache line
+};
+
+namespace ring_detail {
+
+inline size_t segmentSize(uint32_t slotCount) {
+    return sizeof(EventRingHeader) + static_cast<size_t>(slotCount) * sizeof(EventRingSlot);
+}
+
+inline void copyLabel(char *out, size_t size, std::string_view text) {
+    size_t n = std::min(text.size(), size - 1);
+    std::memcpy(out, text.data(), n);
+    std::memset(out + n, 0, size - n);
+}
+
+}  // namespace ring_detail
+
+// Converts a parsed event; false for kinds the ring does not carry
+inline bool toRingRecord(const DeviceEvent &event, int64_t hostNs, RingRecord &record) {
+    using ring_detail::copyLabel;
+    std::memset(&record, 0, sizeof(record));
+    record.hostNs = hostNs;
+    record.kind = static_cast<uint8_t>(event.kind);
+    switch (event.kind) {
+        case DeviceEventKind::Frame:
+            record.frame.timestampUs = event.frame.timestampUs;
+            record.frame.id = event.frame.id;
+            record.frame.dlc = event.frame.dlc;
+            record.frame.hostClock = event.frame.hostClock;
+            std::memcpy(record.frame.data, event.frame.data, sizeof(record.frame.data));
+            return true;
+        case DeviceEventKind::Button:
+            copyLabel(record.input.label, sizeof(record.input.label), event.button.label);
+            record.input.action = static_cast<uint8_t>(event.button.action);
+            return true;
+        case DeviceEventKind::Knob:
+            copyLabel(record.input.label, sizeof(record.input.label), event.knob.position);
+            record.input.action = event.knob.pressed ? 1 : 0;
+            return true;
+        case DeviceEventKind::Rotation:
+            record.rotation = event.rotation;
+            return true;
+        case DeviceEventKind::Touch:
+            record.touch = event.touch;
+            return true;
+        case DeviceEventKind::Signal:
+            record.signal.value = event.signal.value;
+            copyLabel(record.signal.message, sizeof(record.signal.message), event.signal.message);
+            copyLabel(record.signal.name, sizeof(record.signal.name), event.signal.name);
+            copyLabel(record.signal.valueName, sizeof(record.signal.valueName), event.signal.valueName);
+            copyLabel(record.signal.unit, sizeof(record.signal.unit), event.signal.unit);
+            return true;
+        case DeviceEventKind::Stats:
+            record.stats = event.stats;
+            return true;
+        case DeviceEventKind::Latency:
+            record.latencySequence = event.latencySequence;
+            return true;
+        case DeviceEventKind::Sync:
+            record.sync = event.sync;
+            return true;
+        default:
+            return false;
+    }
+}
+
+class EventRingWriter {
+public:
+    EventRingWriter() = default;
+    EventRingWriter(const EventRingWriter &) = delete;
+    EventRingWriter &operator=(const EventRingWriter &) = delete;
+    ~EventRingWriter() { close(); }
+
+    // Creates the segment, or takes over one with the same layout and
+    // continues its sequence so attached readers keep their place.
+    // slotCount is rounded up to a power of two; false with errno set.
+    bool create(const char *name, uint32_t slotCount = EVENT_RING_DEFAULT_SLOTS) {
+        close();
+        uint32_t slots = 1;
+        while (slots < slotCount) slots <<= 1;
+
+        int fd = ::shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        size_t size = ring_detail::segmentSize(slots);
+        struct stat info{};
+        bool reuse = ::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) == size;
+        if (!reuse && info.st_size != 0) {
+            // Different layout: never resize under mapped readers, start a new segment
+            ::close(fd);
+            ::shm_unlink(name);
+            fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+            if (fd < 0) return false;
+        }
+        if (!reuse && ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            return false;
+        }
+        void *map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int error = errno;
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            errno = error;
+            return false;
+        }
+
+        header_ = static_cast<EventRingHeader *>(map);
+        slots_ = reinterpret_cast<EventRingSlot *>(static_cast<char *>(map) + sizeof(EventRingHeader));
+        size_ = size;
+        mask_ = slots - 1;
+        reuse = reuse && header_->magic.load(std::memory_order_acquire) == EVENT_RING_MAGIC &&
+                header_->version == EVENT_RING_VERSION && header_->slotCount == slots;
+        if (reuse) {
+            head_ = header_->head.load(std::memory_order_relaxed);
+        } else {
+            header_->magic.store(0, std::memory_order_relaxed);
+            header_->version = EVENT_RING_VERSION;
+            header_->slotCount = slots;
+            header_->head.store(0, std::memory_order_relaxed);
+            for (uint32_t i = 0; i < slots; i++) slots_[i].version.store(0, std::memory_order_relaxed);
+            head_ = 0;
+        }
+        header_->writerPid = ::getpid();
+        header_->writerOpen.store(1, std::memory_order_relaxed);
+        header_->magic.store(EVENT_RING_MAGIC, std::memory_order_release);
+        return true;
+    }
+
+    // Marks the ring closed for readers; the segment stays until unlink()
+    void close() {
+        if (!header_) return;
+        header_->writerOpen.store(0, std::memory_order_release);
+        ::munmap(header_, size_);
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+
+    static bool unlink(const char *name) { return ::shm_unlink(name) == 0; }
+
+    bool isOpen() const { return header_ != nullptr; }
+    uint32_t slotCount() const { return mask_ + 1; }
+    uint64_t published() const { return head_; }
+
+    void publish(const RingRecord &record) {
+        EventRingSlot &slot = slots_[head_ & mask_];
+        slot.version.store(2 * head_ + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.record, &record, sizeof(record));
+        slot.version.store(2 * (head_ + 1), std::memory_order_release);
+        header_->head.store(++head_, std::memory_order_release);
+    }
+
+private:
+    EventRingHeader *header_ = nullptr;
+    EventRingSlot   *slots_ = nullptr;
+    size_t           size_ = 0;
+    uint64_t         mask_ = 0;
+    uint64_t         head_ = 0;
+};
+
+class EventRingReader {
+public:
+    EventRingReader() = default;
+    EventRingReader(const EventRingReader &) = delete;
+    EventRingReader &operator=(const EventRingReader &) = delete;
+    ~EventRingReader() { detach(); }
+
+    // Maps an existing ring read-only. Reading starts with the next record
+    // published, or with the oldest one still in the ring.
+    bool attach(const char *name, bool fromOldest = false) {
+        detach();
+        int fd = ::shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0) return false;
+        struct stat info{};
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(EventRingHeader)) {
+            ::close(fd);
+            errno = EINVAL;
+            return false;
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        void *map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            return false;
+        }
+
+        auto *header = static_cast<const EventRingHeader *>(map);
+        if (header->magic.load(std::memory_order_acquire) != EVENT_RING_MAGIC ||
+            header->version != EVENT_RING_VERSION || ring_detail::segmentSize(header->slotCount) != size) {
+            ::munmap(map, size);
+            ::close(fd);
+            errno = EPROTO;
+            return false;
+        }
+        fd_ = fd;  // kept to notice when the name is unlinked and recreated
+        header_ = header;
+        slots_ = reinterpret_cast<const EventRingSlot *>(static_cast<const char *>(map) + sizeof(EventRingHeader));
+        size_ = size;
+        mask_ = header->slotCount - 1;
+        uint64_t head = header->head.load(std::memory_order_acquire);
+        cursor_ = (fromOldest && head > mask_) ? head - mask_ : (fromOldest ? 0 : head);
+        lost_ = 0;
+        return true;
+    }
+
+    void detach() {
+        if (header_) ::munmap(const_cast<EventRingHeader *>(header_), size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+
+    bool isAttached() const { return header_ != nullptr; }
+
+    // Copies the next record out; false when the reader has caught up
+    bool next(RingRecord &record) {
+        for (;;) {
+            const EventRingSlot &slot = slots_[cursor_ & mask_];
+            uint64_t expected = 2 * (cursor_ + 1);
+            uint64_t version = slot.version.load(std::memory_order_acquire);
+            if (version == expected) {
+                std::memcpy(&record, &slot.record, sizeof(record));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.version.load(std::memory_order_relaxed) == expected) {
+                    cursor_++;
+                    return true;
+                }
+            } else if (version < expected) {
+                return false;  // not written yet (odd: being written for this sequence)
+            }
+            // Lapped: jump to the oldest record that is still intact
+            uint64_t head = header_->head.load(std::memory_order_acquire);
+            uint64_t oldest = head > mask_ ? head - mask_ : 0;
+            if (oldest <= cursor_) oldest = cursor_ + 1;
+            lost_ += oldest - cursor_;
+            cursor_ = oldest;
+        }
+    }
+
+    // Records overwritten before this reader got to them
+    uint64_t lost() const { return lost_; }
+
+    // Published but not yet read
+    uint64_t backlog() const { return header_->head.load(std::memory_order_acquire) - cursor_; }
+
+    // The writer exited (cleanly); a new one may have created a fresh segment
+    bool writerClosed() const { return header_->writerOpen.load(std::memory_order_acquire) == 0; }
+
+    // The segment was unlinked, e.g. replaced by a writer with another
+    // layout; nothing more will be published to it, attach again
+    bool unlinked() const {
+        struct stat info{};
+        return ::fstat(fd_, &info) == 0 && info.st_nlink == 0;
+    }
+
+private:
+    const EventRingHeader *header_ = nullptr;
+    const EventRingSlot   *slots_ = nullptr;
+    int                    fd_ = -1;
+    size_t                 size_ = 0;
+    uint64_t               mask_ = 0;
+    uint64_t               cursor_ = 0;
+    uint64_t               lost_ = 0;
+};
+
+}  // namespace idrive
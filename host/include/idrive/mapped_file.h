@@ -0,0 +1,48 @@
+#pragma once
+
+// Read-only memory mapping of a whole file, used to parse captures in place.
+
+#include <cstddef>
+#include <string>
+
+namespace idrive {
+
+class MappedFile {
+public:
+    enum class Mode {
+        Populate,  // fault the whole file in up front (fastest for files that fit in RAM)
+        Stream,    // fault lazily; release() drops consumed pages to bound resident memory
+    };
+
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // Returns false and fills error() on failure; an empty file maps fine
+    bool open(const std::string &path, Mode mode = Mode::Populate);
+    void close();
+
+    // Drops the pages wholly before upTo from the process; the data can
+    // still be read again (it is re-faulted from the page cache)
+    void release(const char *upTo);
+
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+    const char *begin() const { return data_; }
+    const char *end() const { return data_ + size_; }
+    bool isOpen() const { return open_; }
+    const std::string &error() const { return error_; }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+    std::string error_;
+};
+
+}  // namespace idrive
@@ -0,0 +1,34 @@
+#pragma once
+
+// Chunked multi-threaded front end for parseCapture(). The input is cut into
+// newline-aligned chunks that are parsed independently on a work-stealing
+// pool, then stitched so the result matches a single-threaded parse: the
+// synthetic timestamps and per-ID sequence numbers continue across chunk
+// boundaries, and a RAW/tagged repeat split between two chunks is dropped.
+// Marker ordinals are rebased the same way.
+
+#include "idrive/capture.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace idrive {
+
+class WorkStealingPool;
+
+struct ParallelParseOptions {
+    ParseKernel kernel = ParseKernel::Simd;
+    size_t chunkBytes = 0;  // 0 picks a size from the input and thread count
+};
+
+// Replaces out with every frame in [begin, end), in timestamp order (stable,
+// so file order is kept for equal timestamps). Already-ordered captures, the
+// usual case, skip the sort entirely. markers (optional) is replaced with the
+// MARK lines, their ordinals counting frames in file order as a
+// single-threaded parseCapture() would.
+void parseCaptureParallel(const char *begin, const char *end, CaptureFormat format, std::vector<Frame> &out,
+                          WorkStealingPool &pool, ParseStats *stats = nullptr,
+                          const ParallelParseOptions &options = ParallelParseOptions(),
+                          std::vector<CaptureMarker> *markers = nullptr);
+
+}  // namespace idrive
@@ -0,0 +1,51 @@
+#pragma once
+
+// pcap and pcapng captures with the SocketCAN link type (227), as written
+// by Wireshark, tcpdump and dumpcap on a can interface. Each packet is a
+// 16-byte struct can_frame:
+//
+//   can_id (big-endian; bit 31 extended, 30 RTR, 29 error), len, 3 bytes
+//   padding, 8 data bytes
+//
+// CAN FD (72-byte canfd_frame), RTR and error frames have no place in
+// Frame and are skipped. pcapng packets marked outbound (epb_flags) become
+// FRAME_TX and vice versa.
+
+#include "idrive/capture.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace idrive {
+
+constexpr uint32_t PCAP_MAGIC_US         = 0xA1B2C3D4;
+constexpr uint32_t PCAP_MAGIC_NS         = 0xA1B23C4D;
+constexpr uint32_t PCAPNG_SECTION_HEADER = 0x0A0D0D0A;
+constexpr uint32_t PCAPNG_BYTE_ORDER     = 0x1A2B3C4D;
+constexpr uint32_t LINKTYPE_CAN_SOCKETCAN = 227;
+constexpr size_t   SOCKETCAN_FRAME_SIZE   = 16;
+
+enum class PcapVariant : uint8_t { Pcap, Pcapng };
+
+// Recognises both variants in either byte order from the first bytes
+bool isPcapCapture(const char *data, size_t size, PcapVariant *variant = nullptr);
+
+struct PcapStats {
+    uint64_t packets = 0;
+    uint64_t skipped = 0;  // CAN FD, RTR, error or truncated packets
+};
+
+// Delivers the CAN frames of [begin, end) in batches in file order; return
+// false from sink to stop early. consumed (optional) is called with the
+// position up to which the input is no longer needed.
+bool parsePcap(const char *begin, const char *end, const std::function<bool(const Frame *, size_t)> &sink,
+               std::string &error, PcapStats *stats = nullptr,
+               const std::function<void(const char *)> &consumed = nullptr);
+
+// Writers append little-endian, microsecond-resolution files to out
+void appendPcapHeader(std::string &out, PcapVariant variant, const std::string &interfaceName = "can0");
+void appendPcapFrame(std::string &out, PcapVariant variant, const Frame &frame);
+
+}  // namespace idrive
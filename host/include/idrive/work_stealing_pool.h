@@ -0,0 +1,60 @@
+#pragma once
+
+// Fixed-size thread pool for coarse data-parallel jobs. Work items are
+// indices dealt round-robin onto per-worker deques; a worker pops from the
+// back of its own deque and, once empty, steals from the front of others,
+// so uneven chunks (dense vs sparse capture regions) still balance out.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace idrive {
+
+class WorkStealingPool {
+public:
+    // threads == 0 uses std::thread::hardware_concurrency(); the calling
+    // thread counts as one worker
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    // Runs task(i) for every i in [0, count) and returns when all are done
+    void parallelFor(size_t count, const std::function<void(size_t)> &task);
+
+    unsigned threadCount() const { return static_cast<unsigned>(queues_.size()); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    bool popLocal(unsigned worker, size_t &item);
+    bool steal(unsigned thief, size_t &item);
+    void drain(unsigned worker);
+    void workerLoop(unsigned worker);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)> *task_ = nullptr;
+    uint64_t generation_ = 0;
+    size_t busyWorkers_ = 0;
+    bool stopping_ = false;
+    std::atomic<size_t> remaining_{0};
+};
+
+}  // namespace idrive
@@ -0,0 +1,362 @@
+#include "idrive/action_correlate.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace idrive {
+
+namespace {
+
+uint64_t keyOf(uint32_t id, bool extended) {
+    return uint64_t(id) | (extended ? uint64_t(1) << 32 : 0);
+}
+
+// Phi coefficient of the 2x2 table (in window, carries signal) over n frames
+double phiCoefficient(double n, double inWindow, double carrying, double both) {
+    double denominator = inWindow * (n - inWindow) * carrying * (n - carrying);
+    if (denominator <= 0) return 0;
+    return (n * both - inWindow * carrying) / std::sqrt(denominator);
+}
+
+bool parseSeconds(const std::string &token, int64_t &us) {
+    char *end = nullptr;
+    double seconds = std::strtod(token.c_str(), &end);
+    if (end == token.c_str() || *end != '\0') return false;
+    us = static_cast<int64_t>(std::llround(seconds * 1e6));
+    return true;
+}
+
+bool parseMark(const std::string &token, uint32_t &number) {
+    if (token.size() < 2 || (token[0] != 'M' && token[0] != 'm')) return false;
+    char *end = nullptr;
+    unsigned long value = std::strtoul(token.c_str() + 1, &end, 10);
+    if (*end != '\0') return false;
+    number = static_cast<uint32_t>(value);
+    return true;
+}
+
+std::string baseLabel(const std::string &label) {
+    return label.substr(0, label.find(':'));
+}
+
+std::string labelState(const std::string &label) {
+    size_t colon = label.find(':');
+    return colon == std::string::npos ? "pressed" : label.substr(colon + 1);
+}
+
+// Spec labels are upper-case alphanumerics: "Knob-Left" -> "KNOBLEFT"
+std::string specLabel(const std::string &label) {
+    std::string out;
+    for (char c : label) {
+        if (std::isalnum(static_cast<unsigned char>(c))) out += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    if (out.empty() || !std::isalpha(static_cast<unsigned char>(out[0]))) out.insert(0, "ACTION");
+    return out;
+}
+
+const SignalCorrelation *firstValue(const ActionReport &report) {
+    for (const auto &signal : report.signals) {
+        if (signal.value >= 0) return &signal;
+    }
+    return nullptr;
+}
+
+const SignalCorrelation *otherValue(const ActionReport &report, const SignalCorrelation &pressed) {
+    for (const auto &signal : report.signals) {
+        if (signal.value >= 0 && signal.value != pressed.value && signal.id == pressed.id &&
+            signal.extended == pressed.extended && signal.byte == pressed.byte) {
+            return &signal;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+bool loadActionTimeline(const std::string &path, std::vector<ActionWindow> &windows, std::string &error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open";
+        return false;
+    }
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); lineNumber++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        std::string start, end, label;
+        if (!(tokens >> start)) continue;
+
+        ActionWindow window;
+        bool ok = static_cast<bool>(tokens >> end >> label);
+        if (ok && parseMark(start, window.startMark)) {
+            window.byMarker = true;
+            ok = parseMark(end, window.endMark) && window.startMark < window.endMark;
+        } else if (ok) {
+            ok = parseSeconds(start, window.startUs) && parseSeconds(end, window.endUs) &&
+                 window.startUs < window.endUs;
+        }
+        std::string extra;
+        if (!ok || tokens >> extra) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected '<start> <end> <label>'";
+            return false;
+        }
+        window.label = label;
+        windows.push_back(window);
+    }
+    return true;
+}
+
+std::vector<ActionWindow> markerPairWindows(const std::vector<std::string> &labels) {
+    std::vector<ActionWindow> windows;
+    for (size_t i = 0; i < labels.size(); i++) {
+        ActionWindow window;
+        window.label = labels[i];
+        window.byMarker = true;
+        window.startMark = static_cast<uint32_t>(2 * i + 1);
+        window.endMark = window.startMark + 1;
+        windows.push_back(window);
+    }
+    return windows;
+}
+
+void ActionCorrelator::Counts::add(const Frame &frame) {
+    frames++;
+    for (int b = 0; b < frame.dlc && b < 8; b++) values[b][frame.data[b]]++;
+}
+
+void ActionCorrelator::WindowCounts::add(const Frame &frame, uint64_t windowSerial) {
+    Counts::add(frame);
+    if (window != windowSerial) {
+        window = windowSerial;
+        framesThisWindow = 0;
+        for (auto &seen : seenThisWindow) seen.reset();
+    }
+    for (int b = 0; b < frame.dlc && b < 8; b++) {
+        uint8_t value = frame.data[b];
+        if (seenThisWindow[b][value]) continue;
+        seenThisWindow[b][value] = true;
+        onsetSum[b][value] += framesThisWindow;
+        windowsWithValue[b][value]++;
+    }
+    framesThisWindow++;
+}
+
+ActionCorrelator::ActionCorrelator(std::vector<ActionWindow> windows, bool relativeTime)
+    : relativeTime_(relativeTime) {
+    for (const auto &window : windows) {
+        auto it = std::find(labels_.begin(), labels_.end(), window.label);
+        size_t action = static_cast<size_t>(it - labels_.begin());
+        if (it == labels_.end()) {
+            labels_.push_back(window.label);
+            windowCounts_.push_back(0);
+        }
+        windowCounts_[action]++;
+
+        if (window.byMarker) {
+            markerEvents_[window.startMark].push_back({0, action, true});
+            markerEvents_[window.endMark].push_back({0, action, false});
+        } else {
+            timeEvents_.push_back({window.startUs, action, true});
+            timeEvents_.push_back({window.endUs, action, false});
+        }
+    }
+    std::sort(timeEvents_.begin(), timeEvents_.end(), [](const Event &a, const Event &b) {
+        return a.timeUs != b.timeUs ? a.timeUs < b.timeUs : !a.open && b.open;
+    });
+    depth_.assign(labels_.size(), 0);
+    windowSerial_.assign(labels_.size(), 0);
+    framesInWindow_.assign(labels_.size(), 0);
+}
+
+void ActionCorrelator::apply(size_t action, bool open) {
+    if (open) {
+        if (depth_[action]++ == 0) {
+            active_.push_back(action);
+            windowSerial_[action]++;
+        }
+    } else if (depth_[action] > 0 && --depth_[action] == 0) {
+        active_.erase(std::find(active_.begin(), active_.end(), action));
+    }
+}
+
+void ActionCorrelator::applyMarker(uint32_t number) {
+    markersSeen_++;
+    auto it = markerEvents_.find(number);
+    if (it == markerEvents_.end()) return;
+    // Closes first so "M2 M3" windows can follow "M1 M2" ones
+    for (const Event &event : it->second) {
+        if (!event.open) apply(event.action, false);
+    }
+    for (const Event &event : it->second) {
+        if (event.open) apply(event.action, true);
+    }
+}
+
+void ActionCorrelator::addMarkers(const CaptureMarker *markers, size_t count) {
+    pendingMarkers_.insert(pendingMarkers_.end(), markers, markers + count);
+}
+
+void ActionCorrelator::add(const Frame *frames, size_t count) {
+    for (size_t i = 0; i < count; i++) add(frames[i]);
+
+    // Drop applied markers so the queue stays short on long sessions
+    pendingMarkers_.erase(pendingMarkers_.begin(), pendingMarkers_.begin() + nextMarker_);
+    nextMarker_ = 0;
+}
+
+void ActionCorrelator::add(const Frame &frame) {
+    if (ordinal_ == 0 && relativeTime_) originUs_ = frame.timestampUs;
+
+    while (nextMarker_ < pendingMarkers_.size() && pendingMarkers_[nextMarker_].ordinal <= ordinal_) {
+        applyMarker(pendingMarkers_[nextMarker_++].number);
+    }
+    while (nextTimeEvent_ < timeEvents_.size() && timeEvents_[nextTimeEvent_].timeUs + originUs_ <= frame.timestampUs) {
+        const Event &event = timeEvents_[nextTimeEvent_++];
+        apply(event.action, event.open);
+    }
+    ordinal_++;
+
+    bool extended = frame.flags & FRAME_EXTENDED;
+    IdStats &stats = ids_[keyOf(frame.id, extended)];
+    if (stats.all.frames == 0) {
+        stats.id = frame.id;
+        stats.extended = extended;
+        stats.actions.resize(labels_.size());
+    }
+    stats.all.add(frame);
+
+    for (size_t action : active_) {
+        framesInWindow_[action]++;
+        auto &counts = stats.actions[action];
+        if (!counts) counts.reset(new WindowCounts());
+        counts->add(frame, windowSerial_[action]);
+    }
+}
+
+std::vector<ActionReport> ActionCorrelator::report(const CorrelateOptions &options) const {
+    std::vector<ActionReport> reports(labels_.size());
+
+    for (size_t action = 0; action < labels_.size(); action++) {
+        ActionReport &report = reports[action];
+        report.label = labels_[action];
+        report.windows = windowCounts_[action];
+        report.framesInWindow = framesInWindow_[action];
+
+        for (const auto &entry : ids_) {
+            const IdStats &stats = entry.second;
+            const WindowCounts *in = stats.actions[action].get();
+            if (!in || in->frames < options.minFramesInWindow) continue;
+
+            for (int b = 0; b < 8; b++) {
+                const auto &all = stats.all.values[b];
+                const auto &inside = in->values[b];
+                uint64_t n = 0, nIn = 0;
+                std::array<uint64_t, 8> bitAll{}, bitIn{};
+                int rest = 0;
+                for (int v = 0; v < 256; v++) {
+                    if (all[v] - inside[v] > all[rest] - inside[rest]) rest = v;
+                    n += all[v];
+                    nIn += inside[v];
+                    for (int bit = 0; bit < 8; bit++) {
+                        if (!(v & (1 << bit))) continue;
+                        bitAll[bit] += all[v];
+                        bitIn[bit] += inside[v];
+                    }
+                }
+                if (nIn < options.minFramesInWindow || nIn == n) continue;
+
+                // Values must be more common while held (a value vanishing
+                // while held is the released state); bits may go either way
+                // for active-low flags
+                auto consider = [&](int value, int bit, uint64_t carrying, uint64_t both) {
+                    double phi = phiCoefficient(static_cast<double>(n), static_cast<double>(nIn),
+                                                static_cast<double>(carrying), static_cast<double>(both));
+                    double z = phi * std::sqrt(static_cast<double>(n));
+                    if (value >= 0 && phi < 0) return;
+                    if (std::fabs(phi) < options.minPhi || std::fabs(z) < options.minZ) return;
+                    double onset = value >= 0 ? static_cast<double>(in->onsetSum[b][value]) /
+                                                    in->windowsWithValue[b][value] : 0;
+                    report.signals.push_back({stats.id, stats.extended, b, value, bit, phi, z,
+                                              static_cast<double>(both) / nIn,
+                                              static_cast<double>(carrying - both) / (n - nIn), onset, rest});
+                };
+
+                for (int v = 0; v < 256; v++) {
+                    if (inside[v] > 0) consider(v, -1, all[v], inside[v]);
+                }
+                if (options.includeBits) {
+                    for (int bit = 0; bit < 8; bit++) consider(-1, bit, bitAll[bit], bitIn[bit]);
+                }
+            }
+        }
+
+        std::sort(report.signals.begin(), report.signals.end(),
+                  [](const SignalCorrelation &a, const SignalCorrelation &b) {
+                      if (std::fabs(a.phi) != std::fabs(b.phi)) return std::fabs(a.phi) > std::fabs(b.phi);
+                      if (a.id != b.id) return a.id < b.id;
+                      if (a.byte != b.byte) return a.byte < b.byte;
+                      return a.value != b.value ? a.value < b.value : a.bit < b.bit;
+                  });
+        // Limit values and bits separately so bits cannot crowd out the
+        // values the mapping table is built from
+        size_t values = 0, bits = 0;
+        report.signals.erase(std::remove_if(report.signals.begin(), report.signals.end(),
+                                            [&](const SignalCorrelation &s) {
+                                                return (s.value >= 0 ? values++ : bits++) >= options.maxSignals;
+                                            }),
+                             report.signals.end());
+    }
+    return reports;
+}
+
+std::string buttonSpecEntries(const std::vector<ActionReport> &reports) {
+    std::vector<std::string> seen;
+    std::string out;
+    char line[256];
+
+    for (const auto &report : reports) {
+        std::string base = baseLabel(report.label);
+        if (std::find(seen.begin(), seen.end(), base) != seen.end()) continue;
+
+        const ActionReport *pressedReport = nullptr;
+        const ActionReport *touchedReport = nullptr;
+        for (const auto &candidate : reports) {
+            if (baseLabel(candidate.label) != base) continue;
+            std::string state = labelState(candidate.label);
+            if (state == "pressed") pressedReport = &candidate;
+            if (state == "touched") touchedReport = &candidate;
+        }
+        const SignalCorrelation *pressed = pressedReport ? firstValue(*pressedReport) : nullptr;
+        if (!pressed) continue;
+        seen.push_back(base);
+
+        const SignalCorrelation *touched = nullptr;
+        const char *note = "";
+        if (touchedReport) {
+            touched = otherValue(*touchedReport, *pressed);
+            if (!touched) note = ", touched label matched nothing on this byte";
+        } else {
+            touched = otherValue(*pressedReport, *pressed);
+            if (touched && touched->onset > pressed->onset) std::swap(touched, pressed);
+            if (touched) note = ", touched inferred (add a :touched window to confirm)";
+        }
+        // The resting value is the byte's idle state, never an active one
+        if (touched && touched->value == pressed->restValue) touched = nullptr;
+        if (!touched) note = *note ? note : ", no touched value: add touched= before using it";
+
+        int length = std::snprintf(line, sizeof(line), "button %s byte=%d pressed=%02X", specLabel(base).c_str(),
+                                   pressed->byte, pressed->value);
+        if (touched) length += std::snprintf(line + length, sizeof(line) - length, " touched=%02X", touched->value);
+        std::snprintf(line + length, sizeof(line) - length, " released=%02X  # 0x%03X, phi %.2f%s\n",
+                      pressed->restValue, pressed->id, pressed->phi, note);
+        out += line;
+    }
+    return out;
+}
+
+}  // namespace idrive
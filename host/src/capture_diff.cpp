@@ -0,0 +1,271 @@
+#include "idrive/capture_diff.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace idrive {
+
+namespace {
+
+uint64_t keyOf(uint32_t id, bool extended) {
+    return uint64_t(id) | (extended ? uint64_t(1) << 32 : 0);
+}
+
+// Bucket b covers [2^(b/S) ...) with S sub-buckets per octave; gaps under
+// 1 us share bucket 0
+int intervalBucket(int64_t gapUs) {
+    if (gapUs < 1) return 0;
+    double position = std::log2(static_cast<double>(gapUs)) * IdProfile::INTERVAL_SUB_BUCKETS;
+    int bucket = static_cast<int>(position);
+    return std::min(bucket, IdProfile::INTERVAL_BUCKETS - 1);
+}
+
+double bucketMidUs(int bucket) {
+    return std::exp2((bucket + 0.5) / IdProfile::INTERVAL_SUB_BUCKETS);
+}
+
+double log2Safe(double x) {
+    return x > 0 ? std::log2(x) : 0;
+}
+
+// Jensen-Shannon divergence in bits (0 = identical, 1 = disjoint)
+double jensenShannon(const std::array<uint64_t, 256> &a, uint64_t totalA, const std::array<uint64_t, 256> &b,
+                     uint64_t totalB) {
+    double divergence = 0;
+    for (int v = 0; v < 256; v++) {
+        double p = static_cast<double>(a[v]) / totalA;
+        double q = static_cast<double>(b[v]) / totalB;
+        double m = (p + q) / 2;
+        if (p > 0) divergence += 0.5 * p * log2Safe(p / m);
+        if (q > 0) divergence += 0.5 * q * log2Safe(q / m);
+    }
+    return std::min(1.0, std::max(0.0, divergence));
+}
+
+// Wilson-Hilferty normal approximation of a chi-square statistic
+double chiSquareZ(double statistic, int degrees) {
+    if (degrees <= 0) return 0;
+    double k = degrees;
+    return (std::cbrt(statistic / k) - (1 - 2 / (9 * k))) / std::sqrt(2 / (9 * k));
+}
+
+// G-test of homogeneity on the 2 x 256 table of value counts
+double byteSignificanceZ(const std::array<uint64_t, 256> &a, uint64_t totalA, const std::array<uint64_t, 256> &b,
+                         uint64_t totalB) {
+    double n = static_cast<double>(totalA + totalB);
+    double g = 0;
+    int values = 0;
+    for (int v = 0; v < 256; v++) {
+        double column = static_cast<double>(a[v] + b[v]);
+        if (column == 0) continue;
+        values++;
+        double expectedA = column * totalA / n;
+        double expectedB = column * totalB / n;
+        if (a[v]) g += a[v] * std::log(a[v] / expectedA);
+        if (b[v]) g += b[v] * std::log(b[v] / expectedB);
+    }
+    return chiSquareZ(2 * g, values - 1);
+}
+
+// Two-proportion z statistic
+double bitSignificanceZ(uint64_t setA, uint64_t totalA, uint64_t setB, uint64_t totalB) {
+    double pooled = static_cast<double>(setA + setB) / (totalA + totalB);
+    double variance = pooled * (1 - pooled) * (1.0 / totalA + 1.0 / totalB);
+    if (variance <= 0) return 0;
+    return std::fabs(static_cast<double>(setB) / totalB - static_cast<double>(setA) / totalA) / std::sqrt(variance);
+}
+
+std::string formatInterval(double us) {
+    char text[32];
+    if (us >= 1000) {
+        std::snprintf(text, sizeof(text), "%.1fms", us / 1000);
+    } else {
+        std::snprintf(text, sizeof(text), "%.0fus", us);
+    }
+    return text;
+}
+
+double ratePerSecond(const IdProfile &profile) {
+    double span = (profile.lastUs - profile.firstUs) / 1e6;
+    return (span > 0 && profile.frames > 1) ? (profile.frames - 1) / span : 0;
+}
+
+// Up to limit most frequent values that never occur in the other capture
+std::string valuesOnlyIn(const std::array<uint64_t, 256> &in, const std::array<uint64_t, 256> &other, int limit) {
+    std::vector<int> values;
+    for (int v = 0; v < 256; v++) {
+        if (in[v] && !other[v]) values.push_back(v);
+    }
+    std::sort(values.begin(), values.end(), [&](int x, int y) { return in[x] > in[y]; });
+    std::string text;
+    for (int i = 0; i < static_cast<int>(values.size()) && i < limit; i++) {
+        char item[8];
+        std::snprintf(item, sizeof(item), " %02X", values[i]);
+        text += item;
+    }
+    if (static_cast<int>(values.size()) > limit) text += " ...";
+    return text;
+}
+
+void diffBytes(const IdProfile &base, const IdProfile &target, const DiffOptions &options,
+               std::vector<DiffFinding> &out) {
+    uint8_t dlc = std::max(base.maxDlc, target.maxDlc);
+    for (int byte = 0; byte < dlc; byte++) {
+        double jsd = jensenShannon(base.byteValues[byte], base.frames, target.byteValues[byte], target.frames);
+        if (jsd >= options.minScore &&
+            byteSignificanceZ(base.byteValues[byte], base.frames, target.byteValues[byte], target.frames) >=
+                options.minZ) {
+            std::string detail = "JSD " + std::to_string(jsd).substr(0, 5);
+            std::string added = valuesOnlyIn(target.byteValues[byte], base.byteValues[byte], 6);
+            std::string removed = valuesOnlyIn(base.byteValues[byte], target.byteValues[byte], 6);
+            if (!added.empty()) detail += ", new:" + added;
+            if (!removed.empty()) detail += ", gone:" + removed;
+            out.push_back({DiffFinding::Kind::Byte, target.id, target.extended, byte, -1, jsd, detail});
+        }
+
+        if (!options.includeBits) continue;
+        for (int bit = 0; bit < 8; bit++) {
+            int index = byte * 8 + bit;
+            double p = static_cast<double>(base.bitSet[index]) / base.frames;
+            double q = static_cast<double>(target.bitSet[index]) / target.frames;
+            double delta = std::fabs(q - p);
+            if (delta < options.minScore ||
+                bitSignificanceZ(base.bitSet[index], base.frames, target.bitSet[index], target.frames) < options.minZ) {
+                continue;
+            }
+            char detail[64];
+            std::snprintf(detail, sizeof(detail), "set %.1f%% -> %.1f%%", p * 100, q * 100);
+            out.push_back({DiffFinding::Kind::Bit, target.id, target.extended, byte, bit, delta, detail});
+        }
+    }
+}
+
+}  // namespace
+
+double IdProfile::medianIntervalUs() const {
+    if (frames < 2) return 0;
+    uint64_t gaps = frames - 1;
+    uint64_t half = (gaps + 1) / 2;
+    uint64_t seen = 0;
+    for (int b = 0; b < INTERVAL_BUCKETS; b++) {
+        seen += intervals[b];
+        if (seen >= half) return bucketMidUs(b);
+    }
+    return bucketMidUs(INTERVAL_BUCKETS - 1);
+}
+
+void CaptureProfile::add(const Frame &frame) {
+    bool extended = frame.flags & FRAME_EXTENDED;
+    IdProfile &profile = ids_[keyOf(frame.id, extended)];
+
+    if (profile.frames == 0) {
+        profile.id = frame.id;
+        profile.extended = extended;
+        profile.firstUs = frame.timestampUs;
+    } else {
+        profile.intervals[intervalBucket(frame.timestampUs - profile.lastUs)]++;
+    }
+    profile.frames++;
+    profile.lastUs = frame.timestampUs;
+    profile.maxDlc = std::max<uint8_t>(profile.maxDlc, std::min<uint8_t>(frame.dlc, 8));
+
+    for (int byte = 0; byte < 8; byte++) {
+        uint8_t value = frame.data[byte];
+        profile.byteValues[byte][value]++;
+        for (uint8_t bits = value; bits; bits &= bits - 1) profile.bitSet[byte * 8 + __builtin_ctz(bits)]++;
+    }
+
+    if (frame.flags & FRAME_SYNTH_TIME) syntheticTime_ = true;
+    if (frames_ == 0) firstUs_ = frame.timestampUs;
+    frames_++;
+    lastUs_ = frame.timestampUs;
+}
+
+void CaptureProfile::add(const Frame *frames, size_t count) {
+    for (size_t i = 0; i < count; i++) add(frames[i]);
+}
+
+double CaptureProfile::durationSeconds() const {
+    return (lastUs_ - firstUs_) / 1e6;
+}
+
+const IdProfile *CaptureProfile::find(uint32_t id, bool extended) const {
+    auto it = ids_.find(keyOf(id, extended));
+    return it == ids_.end() ? nullptr : &it->second;
+}
+
+std::vector<const IdProfile *> CaptureProfile::ids() const {
+    std::vector<const IdProfile *> sorted;
+    for (const auto &entry : ids_) sorted.push_back(&entry.second);
+    std::sort(sorted.begin(), sorted.end(), [](const IdProfile *a, const IdProfile *b) {
+        return keyOf(a->id, a->extended) < keyOf(b->id, b->extended);
+    });
+    return sorted;
+}
+
+const char *diffKindName(DiffFinding::Kind kind) {
+    switch (kind) {
+        case DiffFinding::Kind::NewId:  return "new-id";
+        case DiffFinding::Kind::GoneId: return "gone-id";
+        case DiffFinding::Kind::Period: return "period";
+        case DiffFinding::Kind::Byte:   return "byte";
+        case DiffFinding::Kind::Bit:    return "bit";
+    }
+    return "?";
+}
+
+std::vector<DiffFinding> diffProfiles(const CaptureProfile &baseline, const CaptureProfile &target,
+                                      const DiffOptions &options) {
+    std::vector<DiffFinding> findings;
+    char detail[96];
+
+    // Synthetic spacing on either side would turn into period changes
+    bool timed = !baseline.syntheticTime() && !target.syntheticTime();
+
+    for (const IdProfile *profile : target.ids()) {
+        const IdProfile *base = baseline.find(profile->id, profile->extended);
+        if (!base) {
+            if (timed) {
+                std::snprintf(detail, sizeof(detail), "%llu frames, %.1f/s, period %s",
+                              static_cast<unsigned long long>(profile->frames), ratePerSecond(*profile),
+                              formatInterval(profile->medianIntervalUs()).c_str());
+            } else {
+                std::snprintf(detail, sizeof(detail), "%llu frames", static_cast<unsigned long long>(profile->frames));
+            }
+            findings.push_back({DiffFinding::Kind::NewId, profile->id, profile->extended, -1, -1, 1.0, detail});
+            continue;
+        }
+        if (base->frames < options.minFrames || profile->frames < options.minFrames) continue;
+
+        // One octave of change scores 1
+        double before = base->medianIntervalUs();
+        double after = profile->medianIntervalUs();
+        double periodScore = std::min(1.0, std::fabs(log2Safe(after) - log2Safe(before)));
+        if (timed && periodScore >= options.minScore && periodScore >= 1.0 / IdProfile::INTERVAL_SUB_BUCKETS) {
+            std::snprintf(detail, sizeof(detail), "%s -> %s", formatInterval(before).c_str(),
+                          formatInterval(after).c_str());
+            findings.push_back({DiffFinding::Kind::Period, profile->id, profile->extended, -1, -1, periodScore, detail});
+        }
+
+        diffBytes(*base, *profile, options, findings);
+    }
+
+    for (const IdProfile *profile : baseline.ids()) {
+        if (target.find(profile->id, profile->extended)) continue;
+        if (timed) {
+            std::snprintf(detail, sizeof(detail), "%llu frames in baseline, %.1f/s",
+                          static_cast<unsigned long long>(profile->frames), ratePerSecond(*profile));
+        } else {
+            std::snprintf(detail, sizeof(detail), "%llu frames in baseline",
+                          static_cast<unsigned long long>(profile->frames));
+        }
+        findings.push_back({DiffFinding::Kind::GoneId, profile->id, profile->extended, -1, -1, 1.0, detail});
+    }
+
+    std::stable_sort(findings.begin(), findings.end(),
+                     [](const DiffFinding &a, const DiffFinding &b) { return a.score > b.score; });
+    return findings;
+}
+
+}  // namespace idrive
@@ -0,0 +1,251 @@
+#include "idrive/capture_export.h"
+#include "idrive/pcap_file.h"
+
+#include <cerrno>
+#include <cstring>
+
+namespace idrive {
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+void appendHexByte(std::string &out, uint8_t value) {
+    out += HEX_DIGITS[value >> 4];
+    out += HEX_DIGITS[value & 0x0F];
+}
+
+// At least minDigits digits, no leading zeros beyond that
+void appendHex(std::string &out, uint32_t value, int minDigits) {
+    char digits[8];
+    int n = 0;
+    do {
+        digits[n++] = HEX_DIGITS[value & 0x0F];
+        value >>= 4;
+    } while (value && n < 8);
+    for (int i = n; i < minDigits; i++) out += '0';
+    while (n > 0) out += digits[--n];
+}
+
+void appendDecimal(std::string &out, uint64_t value, int width = 0, char pad = ' ') {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (int i = n; i < width; i++) out += pad;
+    while (n > 0) out += digits[--n];
+}
+
+uint32_t idDigits(const Frame &frame) {
+    return (frame.flags & FRAME_EXTENDED) ? 8 : 3;
+}
+
+bool endsWith(const std::string &s, const char *suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+}  // namespace
+
+const char *exportFormatName(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::Putty:     return formatName(CaptureFormat::Putty);
+        case ExportFormat::IdsNotes:  return formatName(CaptureFormat::IdsNotes);
+        case ExportFormat::DeviceRaw: return formatName(CaptureFormat::DeviceRaw);
+        case ExportFormat::Candump:   return formatName(CaptureFormat::Candump);
+        case ExportFormat::Pcap:      return "pcap";
+        case ExportFormat::Pcapng:    return "pcapng";
+        default:                      return "icap";
+    }
+}
+
+bool parseExportFormat(const std::string &name, ExportFormat &format) {
+    static const ExportFormat ALL[] = {
+        ExportFormat::Putty, ExportFormat::IdsNotes, ExportFormat::DeviceRaw, ExportFormat::Candump,
+        ExportFormat::Pcap,  ExportFormat::Pcapng,   ExportFormat::Icap,
+    };
+    for (ExportFormat candidate : ALL) {
+        if (name == exportFormatName(candidate)) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool exportFormatForPath(const std::string &path, ExportFormat &format) {
+    if (endsWith(path, ".pcapng")) {
+        format = ExportFormat::Pcapng;
+    } else if (endsWith(path, ".pcap")) {
+        format = ExportFormat::Pcap;
+    } else if (endsWith(path, ".icap")) {
+        format = ExportFormat::Icap;
+    } else if (endsWith(path, ".candump")) {
+        format = ExportFormat::Candump;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+CaptureExporter::~CaptureExporter() {
+    if (file_) close();
+}
+
+bool CaptureExporter::open(const std::string &path, ExportFormat format, const ExportOptions &options) {
+    if (file_) close();
+    error_.clear();
+    frames_ = 0;
+    bytes_ = 0;
+    format_ = format;
+    options_ = options;
+
+    ownsFile_ = path != "-";
+    file_ = ownsFile_ ? std::fopen(path.c_str(), "wb") : stdout;
+    if (!file_) return fail(path + ": " + std::strerror(errno));
+    buffer_.clear();
+    buffer_.reserve(BUFFER_BYTES + 256);
+
+    switch (format_) {
+        case ExportFormat::Pcap:
+            appendPcapHeader(buffer_, PcapVariant::Pcap);
+            break;
+        case ExportFormat::Pcapng:
+            appendPcapHeader(buffer_, PcapVariant::Pcapng, options_.interfaceName);
+            break;
+        case ExportFormat::Icap:
+            if (!icap_.open([this](const void *data, size_t size) { return write(data, size); })) {
+                return fail(icap_.error());
+            }
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+void CaptureExporter::formatText(const Frame &frame) {
+    std::string &out = buffer_;
+    uint8_t dlc = frame.dlc > 8 ? 8 : frame.dlc;
+    int64_t us = frame.timestampUs > 0 ? frame.timestampUs : 0;
+
+    switch (format_) {
+        case ExportFormat::Putty: {
+            // "Standard ID: 0x25B       DLC: 8  Data: 0x00 0xFF ..."
+            out += (frame.flags & FRAME_EXTENDED) ? "Extended ID: 0x" : "Standard ID: 0x";
+            size_t idStart = out.size();
+            appendHex(out, frame.id, idDigits(frame));
+            out.append(out.size() - idStart < 10 ? 10 - (out.size() - idStart) : 1, ' ');
+            out += "DLC: ";
+            appendDecimal(out, dlc);
+            out += "  Data:";
+            for (int i = 0; i < dlc; i++) {
+                out += " 0x";
+                appendHexByte(out, frame.data[i]);
+            }
+            out += "\r\n";  // PuTTY logs keep the device's line endings
+            break;
+        }
+        case ExportFormat::IdsNotes:
+            // "[RAW] ID:0x25B Data: 03 FF 7F ..."
+            out += "[RAW] ID:0x";
+            appendHex(out, frame.id, idDigits(frame));
+            out += " Data:";
+            for (int i = 0; i < dlc; i++) {
+                out += ' ';
+                appendHexByte(out, frame.data[i]);
+            }
+            out += '\n';
+            break;
+        case ExportFormat::DeviceRaw:
+            // "[  1234ms] [RAW] 0x25B: ..." as printed by the firmware, with
+            // the clock-synced microsecond fraction when there is one
+            out += '[';
+            if (us % 1000 == 0) {
+                appendDecimal(out, static_cast<uint64_t>(us / 1000), 6);
+            } else {
+                appendDecimal(out, static_cast<uint64_t>(us / 1000));
+                out += '.';
+                appendDecimal(out, static_cast<uint64_t>(us % 1000), 3, '0');
+            }
+            out += "ms] [RAW] 0x";
+            appendHex(out, frame.id, 1);
+            out += ':';
+            for (int i = 0; i < dlc; i++) {
+                out += ' ';
+                appendHexByte(out, frame.data[i]);
+            }
+            out += '\n';
+            break;
+        default:
+            // "(1700000000.123456) can0 25B#00FF7F..."
+            out += '(';
+            appendDecimal(out, static_cast<uint64_t>(us / 1000000));
+            out += '.';
+            appendDecimal(out, static_cast<uint64_t>(us % 1000000), 6, '0');
+            out += ") ";
+            out += options_.interfaceName;
+            out += ' ';
+            appendHex(out, frame.id, idDigits(frame));
+            out += '#';
+            for (int i = 0; i < dlc; i++) appendHexByte(out, frame.data[i]);
+            out += '\n';
+            break;
+    }
+}
+
+bool CaptureExporter::append(const Frame *frames, size_t count) {
+    if (!file_) return fail("exporter is not open");
+    frames_ += count;
+
+    if (format_ == ExportFormat::Icap) {
+        return icap_.append(frames, count) || fail(icap_.error());
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (format_ == ExportFormat::Pcap || format_ == ExportFormat::Pcapng) {
+            appendPcapFrame(buffer_, format_ == ExportFormat::Pcap ? PcapVariant::Pcap : PcapVariant::Pcapng,
+                            frames[i]);
+        } else {
+            formatText(frames[i]);
+        }
+        if (buffer_.size() >= BUFFER_BYTES && !flush()) return false;
+    }
+    return true;
+}
+
+bool CaptureExporter::close() {
+    if (!file_) return false;
+    bool ok = error_.empty();
+    if (format_ == ExportFormat::Icap && !icap_.close()) ok = fail(icap_.error());
+    ok = flush() && ok;
+    if (ownsFile_) {
+        if (std::fclose(file_) != 0 && ok) ok = fail(std::strerror(errno));
+    } else {
+        std::fflush(file_);
+    }
+    file_ = nullptr;
+    return ok;
+}
+
+bool CaptureExporter::write(const void *data, size_t size) {
+    buffer_.append(static_cast<const char *>(data), size);
+    return buffer_.size() < BUFFER_BYTES || flush();
+}
+
+bool CaptureExporter::flush() {
+    if (buffer_.empty()) return true;
+    size_t written = std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    bytes_ += written;
+    bool ok = written == buffer_.size();
+    buffer_.clear();
+    return ok || fail(std::string("write failed: ") + std::strerror(errno));
+}
+
+bool CaptureExporter::fail(const std::string &message) {
+    if (error_.empty()) error_ = message;
+    return false;
+}
+
+}  // namespace idrive
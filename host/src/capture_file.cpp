@@ -0,0 +1,360 @@
+#include "idrive/capture_file.h"
+#include "idrive/pcap_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace idrive {
+
+namespace {
+
+constexpr uint32_t BLOOM_BITS   = CAPTURE_BLOOM_WORDS * 64;
+constexpr int      BLOOM_PROBES = 3;
+
+// murmur3 finalizer; IDs are small and dense, so they need mixing first
+uint64_t mixId(uint32_t id, bool extended) {
+    uint64_t h = id | (extended ? (uint64_t(1) << 32) : 0);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Double hashing: probe i is h1 + i * h2
+template <typename Fn>
+void forEachProbe(uint32_t id, bool extended, Fn &&fn) {
+    uint64_t h = mixId(id, extended);
+    uint32_t h1 = static_cast<uint32_t>(h);
+    uint32_t h2 = static_cast<uint32_t>(h >> 32) | 1;
+    for (int i = 0; i < BLOOM_PROBES; i++) {
+        uint32_t bit = (h1 + static_cast<uint32_t>(i) * h2) % BLOOM_BITS;
+        if (!fn(bit / 64, uint64_t(1) << (bit % 64))) return;
+    }
+}
+
+}  // namespace
+
+void bloomAdd(uint64_t (&bloom)[CAPTURE_BLOOM_WORDS], uint32_t id, bool extended) {
+    forEachProbe(id, extended, [&](uint32_t word, uint64_t mask) {
+        bloom[word] |= mask;
+        return true;
+    });
+}
+
+bool bloomMayContain(const uint64_t (&bloom)[CAPTURE_BLOOM_WORDS], uint32_t id, bool extended) {
+    bool all = true;
+    forEachProbe(id, extended, [&](uint32_t word, uint64_t mask) {
+        all = (bloom[word] & mask) != 0;
+        return all;
+    });
+    return all;
+}
+
+// --- Writer ---
+
+CaptureFileWriter::~CaptureFileWriter() {
+    if (open_) close();
+}
+
+bool CaptureFileWriter::open(const std::string &path, uint32_t framesPerBlock) {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) return fail(path + ": " + std::strerror(errno));
+    if (!open([file](const void *data, size_t size) { return std::fwrite(data, 1, size, file) == size; },
+              framesPerBlock)) {
+        std::fclose(file);
+        return false;
+    }
+    file_ = file;
+    return true;
+}
+
+bool CaptureFileWriter::open(Sink sink, uint32_t framesPerBlock) {
+    if (open_) close();
+    if (framesPerBlock == 0) return fail("framesPerBlock must be positive");
+
+    sink_ = std::move(sink);
+    framesPerBlock_ = framesPerBlock;
+    offset_ = 0;
+    frameCount_ = 0;
+    timeOrdered_ = true;
+    block_.clear();
+    block_.reserve(framesPerBlock);
+    index_.clear();
+    error_.clear();
+
+    FileHeader header{};
+    std::memcpy(header.magic, CAPTURE_FILE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_FILE_VERSION;
+    header.recordSize = sizeof(Frame);
+    header.framesPerBlock = framesPerBlock;
+    open_ = true;
+    return emit(&header, sizeof(header));
+}
+
+bool CaptureFileWriter::append(const Frame &frame) {
+    if (!open_) return fail("writer is not open");
+    block_.push_back(frame);
+    frameCount_++;
+    return block_.size() < framesPerBlock_ || flushBlock();
+}
+
+bool CaptureFileWriter::append(const Frame *frames, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (!append(frames[i])) return false;
+    }
+    return true;
+}
+
+bool CaptureFileWriter::close() {
+    if (!open_) return error_.empty();
+
+    bool ok = flushBlock();
+    if (ok) {
+        FileTrailer trailer{};
+        trailer.indexOffset = offset_;
+        trailer.frameCount = frameCount_;
+        trailer.blockCount = static_cast<uint32_t>(index_.size());
+        trailer.flags = timeOrdered_ ? static_cast<uint32_t>(CAPTURE_FILE_TIME_ORDERED) : 0u;
+        std::memcpy(trailer.magic, CAPTURE_FILE_END_MAGIC, sizeof(trailer.magic));
+        ok = emit(index_.data(), index_.size() * sizeof(BlockIndexEntry)) && emit(&trailer, sizeof(trailer));
+    }
+
+    if (file_) {
+        if (std::fclose(file_) != 0 && ok) ok = fail(std::string("close: ") + std::strerror(errno));
+        file_ = nullptr;
+    }
+    sink_ = nullptr;
+    open_ = false;
+    return ok;
+}
+
+bool CaptureFileWriter::emit(const void *data, size_t size) {
+    if (size == 0) return true;
+    if (!sink_(data, size)) return fail("write failed");
+    offset_ += size;
+    return true;
+}
+
+bool CaptureFileWriter::flushBlock() {
+    if (block_.empty()) return true;
+
+    BlockIndexEntry entry{};
+    entry.firstUs = INT64_MAX;
+    entry.lastUs = INT64_MIN;
+    entry.offset = offset_;
+    entry.frameCount = static_cast<uint32_t>(block_.size());
+    for (const Frame &frame : block_) {
+        entry.firstUs = std::min(entry.firstUs, frame.timestampUs);
+        entry.lastUs = std::max(entry.lastUs, frame.timestampUs);
+        bloomAdd(entry.idBloom, frame.id, frame.flags & FRAME_EXTENDED);
+    }
+
+    if (!index_.empty() && (entry.firstUs < index_.back().lastUs)) timeOrdered_ = false;
+    index_.push_back(entry);
+
+    bool ok = emit(block_.data(), block_.size() * sizeof(Frame));
+    block_.clear();
+    return ok;
+}
+
+bool CaptureFileWriter::fail(const std::string &message) {
+    error_ = message;
+    return false;
+}
+
+// --- Reader ---
+
+bool CaptureFileReader::open(const std::string &path) {
+    index_ = nullptr;
+    error_.clear();
+    if (!file_.open(path)) return fail(file_.error());
+
+    size_t size = file_.size();
+    if (size < sizeof(FileHeader) + sizeof(FileTrailer)) return fail(path + ": too short for a capture file");
+
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    std::memcpy(&trailer_, file_.end() - sizeof(trailer_), sizeof(trailer_));
+    if (std::memcmp(header_.magic, CAPTURE_FILE_MAGIC, sizeof(header_.magic)) != 0) {
+        return fail(path + ": not a capture file");
+    }
+    if (std::memcmp(trailer_.magic, CAPTURE_FILE_END_MAGIC, sizeof(trailer_.magic)) != 0) {
+        return fail(path + ": missing index (truncated or still being written)");
+    }
+    if (header_.version != CAPTURE_FILE_VERSION || header_.recordSize != sizeof(Frame)) {
+        return fail(path + ": unsupported capture file version");
+    }
+
+    uint64_t indexBytes = uint64_t(trailer_.blockCount) * sizeof(BlockIndexEntry);
+    if (trailer_.indexOffset < sizeof(FileHeader) || trailer_.indexOffset % alignof(BlockIndexEntry) != 0 ||
+        trailer_.indexOffset + indexBytes + sizeof(FileTrailer) != size) {
+        return fail(path + ": corrupt index");
+    }
+    index_ = reinterpret_cast<const BlockIndexEntry *>(file_.data() + trailer_.indexOffset);
+
+    for (size_t i = 0; i < trailer_.blockCount; i++) {
+        const BlockIndexEntry &entry = index_[i];
+        if (entry.offset % alignof(Frame) != 0 ||
+            entry.offset + uint64_t(entry.frameCount) * sizeof(Frame) > trailer_.indexOffset) {
+            return fail(path + ": corrupt block index");
+        }
+    }
+    return true;
+}
+
+const Frame *CaptureFileReader::blockFrames(size_t i) const {
+    return reinterpret_cast<const Frame *>(file_.data() + index_[i].offset);
+}
+
+void CaptureFileReader::query(const CaptureQuery &query, const std::function<bool(const Frame &)> &visit,
+                              QueryStats *stats) const {
+    QueryStats local;
+    local.blocksTotal = trailer_.blockCount;
+
+    size_t first = 0;
+    size_t last = trailer_.blockCount;
+    if (timeOrdered()) {
+        // Block ranges are ordered, so the matching blocks are contiguous
+        const BlockIndexEntry *begin = index_;
+        const BlockIndexEntry *end = index_ + trailer_.blockCount;
+        first = std::partition_point(begin, end, [&](const BlockIndexEntry &e) { return e.lastUs < query.fromUs; }) - begin;
+        last = std::partition_point(begin + first, end, [&](const BlockIndexEntry &e) { return e.firstUs <= query.toUs; }) - begin;
+    }
+
+    bool stop = false;
+    for (size_t i = first; i < last && !stop; i++) {
+        const BlockIndexEntry &entry = index_[i];
+        if (entry.lastUs < query.fromUs || entry.firstUs > query.toUs) continue;
+        local.blocksInRange++;
+        if (query.filterId && !bloomMayContain(entry.idBloom, query.id, query.extended)) continue;
+        local.blocksRead++;
+
+        const Frame *frames = blockFrames(i);
+        for (uint32_t f = 0; f < entry.frameCount; f++) {
+            const Frame &frame = frames[f];
+            local.framesScanned++;
+            if (frame.timestampUs < query.fromUs || frame.timestampUs > query.toUs) continue;
+            if (query.filterId && (frame.id != query.id || bool(frame.flags & FRAME_EXTENDED) != query.extended)) {
+                continue;
+            }
+            local.framesMatched++;
+            if (!visit(frame)) {
+                stop = true;
+                break;
+            }
+        }
+    }
+
+    if (stats) *stats = local;
+}
+
+void CaptureFileReader::query(const CaptureQuery &query, std::vector<Frame> &out, QueryStats *stats) const {
+    this->query(query, [&](const Frame &frame) {
+        out.push_back(frame);
+        return true;
+    }, stats);
+}
+
+bool CaptureFileReader::fail(const std::string &message) {
+    error_ = message;
+    return false;
+}
+
+// --- Loading ---
+
+bool loadCapture(const std::string &path, std::vector<Frame> &frames, std::string &error, std::string *source) {
+    return streamCapture(path, [&](const Frame *batch, size_t count) {
+        frames.insert(frames.end(), batch, batch + count);
+        return true;
+    }, error, source);
+}
+
+bool streamCapture(const std::string &path, const FrameBatchSink &sink, std::string &error, std::string *source,
+                   std::vector<CaptureMarker> *markers) {
+    // Text windows of this size hold ~64k frames
+    constexpr size_t WINDOW_BYTES = 4 << 20;
+
+    MappedFile input;
+    if (!input.open(path, MappedFile::Mode::Stream)) {
+        error = input.error();
+        return false;
+    }
+
+    if (input.size() >= sizeof(CAPTURE_FILE_MAGIC) &&
+        std::memcmp(input.data(), CAPTURE_FILE_MAGIC, sizeof(CAPTURE_FILE_MAGIC)) == 0) {
+        input.close();
+        CaptureFileReader reader;
+        if (!reader.open(path)) {
+            error = reader.error();
+            return false;
+        }
+        if (source) *source = "icap";
+        for (size_t i = 0; i < reader.blockCount(); i++) {
+            if (!sink(reader.blockFrames(i), reader.block(i).frameCount)) break;
+        }
+        return true;
+    }
+
+    PcapVariant variant;
+    if (isPcapCapture(input.data(), input.size(), &variant)) {
+        PcapStats stats;
+        bool ok = parsePcap(input.begin(), input.end(), sink, error, &stats,
+                            [&](const char *upTo) { input.release(upTo); });
+        if (source) {
+            *source = variant == PcapVariant::Pcap ? "pcap" : "pcapng";
+            if (stats.skipped) *source += ", " + std::to_string(stats.skipped) + " non-CAN 2.0 packets skipped";
+        }
+        if (!ok) error = path + ": " + error;
+        return ok;
+    }
+
+    // Look for a dump marker window by window so the probe does not pull
+    // the whole file in; dumps are bounded by the device ring, so a log
+    // that has them is decoded in one go
+    static const char DUMP_MARKER[] = "CAPTURE BEGIN ";
+    bool hasDumps = false;
+    for (const char *p = input.begin(); p < input.end() && !hasDumps; p += WINDOW_BYTES) {
+        size_t span = std::min(WINDOW_BYTES + sizeof(DUMP_MARKER), static_cast<size_t>(input.end() - p));
+        hasDumps = memmem(p, span, DUMP_MARKER, sizeof(DUMP_MARKER) - 1) != nullptr;
+        input.release(p + std::min(WINDOW_BYTES, span));
+    }
+
+    std::vector<Frame> frames;
+    size_t damaged = 0;
+    if (hasDumps && parseDeviceDumps(input.begin(), input.end(), frames, &damaged) > 0) {
+        if (source) {
+            *source = "device dump";
+            if (damaged) *source += ", " + std::to_string(damaged) + " damaged dumps skipped";
+        }
+        sink(frames.data(), frames.size());
+        return true;
+    }
+
+    CaptureFormat format = detectFormat(input.data(), input.size());
+    if (format == CaptureFormat::Unknown) {
+        error = path + ": unrecognised capture format";
+        return false;
+    }
+    if (source) *source = formatName(format);
+
+    ParseState state;
+    for (const char *p = input.begin(); p < input.end();) {
+        const char *cut = (static_cast<size_t>(input.end() - p) > WINDOW_BYTES) ? p + WINDOW_BYTES : input.end();
+        if (cut < input.end()) {
+            const void *nl = std::memchr(cut, '\n', static_cast<size_t>(input.end() - cut));
+            cut = nl ? static_cast<const char *>(nl) + 1 : input.end();
+        }
+        frames.clear();
+        parseCapture(p, cut, format, frames, nullptr, ParseKernel::Simd, &state);
+        if (markers) markers->insert(markers->end(), state.markers.begin(), state.markers.end());
+        state.markers.clear();
+        if (!frames.empty() && !sink(frames.data(), frames.size())) break;
+        input.release(cut);
+        p = cut;
+    }
+    return true;
+}
+
+}  // namespace idrive
@@ -0,0 +1,244 @@
+#include "capture_kernels.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IDRIVE_X86_KERNELS 1
+#endif
+
+namespace idrive::detail {
+
+namespace {
+
+struct HexTable {
+    int8_t values[256];
+
+    constexpr HexTable() : values() {
+        for (int i = 0; i < 256; i++) values[i] = -1;
+        for (int i = 0; i < 10; i++) values['0' + i] = static_cast<int8_t>(i);
+        for (int i = 0; i < 6; i++) {
+            values['A' + i] = static_cast<int8_t>(10 + i);
+            values['a' + i] = static_cast<int8_t>(10 + i);
+        }
+    }
+};
+
+constexpr HexTable HEX_TABLE;
+
+// --- Scalar ---
+
+const char *scalarFindNewline(const char *p, const char *end) {
+    const void *hit = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return hit ? static_cast<const char *>(hit) : end;
+}
+
+bool scalarHexPair(const char *p, uint8_t &out) {
+    int hi = hexValue(p[0]);
+    int lo = hexValue(p[1]);
+    if ((hi | lo) < 0) return false;
+    out = static_cast<uint8_t>((hi << 4) | lo);
+    return true;
+}
+
+bool scalarDecodePrefixed8(const char *p, const char *end, uint8_t *out) {
+    if (end - p < 39) return false;
+    for (int i = 0; i < 8; i++, p += 5) {
+        if (p[0] != '0' || (p[1] | 0x20) != 'x' || !scalarHexPair(p + 2, out[i])) return false;
+        if (i < 7 && p[4] != ' ') return false;
+    }
+    return true;
+}
+
+bool scalarDecodeSpaced8(const char *p, const char *end, uint8_t *out) {
+    if (end - p < 23) return false;
+    for (int i = 0; i < 8; i++, p += 3) {
+        if (!scalarHexPair(p, out[i])) return false;
+        if (i < 7 && p[2] != ' ') return false;
+    }
+    return true;
+}
+
+bool scalarDecodePacked8(const char *p, const char *end, uint8_t *out) {
+    if (end - p < 16) return false;
+    for (int i = 0; i < 8; i++, p += 2) {
+        if (!scalarHexPair(p, out[i])) return false;
+    }
+    return true;
+}
+
+const ParseKernels SCALAR_KERNELS = {
+    "scalar",
+    scalarFindNewline,
+    scalarDecodePrefixed8,
+    scalarDecodeSpaced8,
+    scalarDecodePacked8,
+};
+
+#ifdef IDRIVE_X86_KERNELS
+
+// --- SSSE3 ---
+//
+// Each decoder gathers the 16 hex digits of an 8-byte payload into one
+// register with pshufb, checks separators against a template, validates
+// the digits, converts ASCII to nibbles and merges nibble pairs with
+// pmaddubsw. 0x80 in a shuffle control zeroes the lane.
+
+#define IDRIVE_SSSE3 __attribute__((target("ssse3")))
+#define IDRIVE_AVX2 __attribute__((target("avx2")))
+
+IDRIVE_SSSE3 inline bool allHexDigits(__m128i c) {
+    __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                    _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i isAlpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                    _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    return _mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) == 0xFFFF;
+}
+
+// 16 ASCII hex digits -> 8 bytes
+IDRIVE_SSSE3 inline void packHexDigits(__m128i c, uint8_t *out) {
+    __m128i letter = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(c, _mm_set1_epi8(0x40)), _mm_set1_epi8(0x40)),
+                                   _mm_set1_epi8(9));
+    __m128i nibbles = _mm_add_epi8(_mm_and_si128(c, _mm_set1_epi8(0x0F)), letter);
+    __m128i words = _mm_maddubs_epi16(nibbles, _mm_set1_epi16(0x0110));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(words, words));
+}
+
+// True when every byte selected by care equals the template byte
+IDRIVE_SSSE3 inline bool matchesTemplate(__m128i c, __m128i tmpl, __m128i care) {
+    __m128i diff = _mm_and_si128(_mm_xor_si128(c, tmpl), care);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xFFFF;
+}
+
+IDRIVE_SSSE3 bool ssse3DecodePrefixed8(const char *p, const char *end, uint8_t *out) {
+    if (end - p < 39) return false;
+
+    // Windows [0,16), [16,32), [23,39) cover digit positions 5k+2, 5k+3
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 23));
+
+    // Separators: "0x" at 5k, ' ' at 5k+4. Upper-case "0X" takes the scalar path.
+    __m128i tmplA = _mm_setr_epi8('0', 'x', 0, 0, ' ', '0', 'x', 0, 0, ' ', '0', 'x', 0, 0, ' ', '0');
+    __m128i careA = _mm_setr_epi8(-1, -1, 0, 0, -1, -1, -1, 0, 0, -1, -1, -1, 0, 0, -1, -1);
+    __m128i tmplB = _mm_setr_epi8('x', 0, 0, ' ', '0', 'x', 0, 0, ' ', '0', 'x', 0, 0, ' ', '0', 'x');
+    __m128i careB = _mm_setr_epi8(-1, 0, 0, -1, -1, -1, 0, 0, -1, -1, -1, 0, 0, -1, -1, -1);
+    __m128i tmplC = _mm_setr_epi8(0, ' ', '0', 'x', 0, 0, ' ', '0', 'x', 0, 0, ' ', '0', 'x', 0, 0);
+    __m128i careC = _mm_setr_epi8(0, -1, -1, -1, 0, 0, -1, -1, -1, 0, 0, -1, -1, -1, 0, 0);
+    if (!matchesTemplate(a, tmplA, careA) || !matchesTemplate(b, tmplB, careB) ||
+        !matchesTemplate(c, tmplC, careC)) {
+        return false;
+    }
+
+    const char z = static_cast<char>(0x80);
+    __m128i digits = _mm_or_si128(
+        _mm_or_si128(_mm_shuffle_epi8(a, _mm_setr_epi8(2, 3, 7, 8, 12, 13, z, z, z, z, z, z, z, z, z, z)),
+                     _mm_shuffle_epi8(b, _mm_setr_epi8(z, z, z, z, z, z, 1, 2, 6, 7, 11, 12, z, z, z, z))),
+        _mm_shuffle_epi8(c, _mm_setr_epi8(z, z, z, z, z, z, z, z, z, z, z, z, 9, 10, 14, 15)));
+
+    if (!allHexDigits(digits)) return false;
+    packHexDigits(digits, out);
+    return true;
+}
+
+IDRIVE_SSSE3 bool ssse3DecodeSpaced8(const char *p, const char *end, uint8_t *out) {
+    if (end - p < 23) return false;
+
+    // Windows [0,16) and [7,23) cover digit positions 3k, 3k+1
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 7));
+
+    __m128i tmplA = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+    __m128i careA = _mm_setr_epi8(0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0);
+    __m128i tmplB = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0);
+    __m128i careB = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0);
+    if (!matchesTemplate(a, tmplA, careA) || !matchesTemplate(b, tmplB, careB)) return false;
+
+    const char z = static_cast<char>(0x80);
+    __m128i digits = _mm_or_si128(
+        _mm_shuffle_epi8(a, _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, 12, 13, z, z, z, z, z, z)),
+        _mm_shuffle_epi8(b, _mm_setr_epi8(z, z, z, z, z, z, z, z, z, z, 8, 9, 11, 12, 14, 15)));
+
+    if (!allHexDigits(digits)) return false;
+    packHexDigits(digits, out);
+    return true;
+}
+
+IDRIVE_SSSE3 bool ssse3DecodePacked8(const char *p, const char *end, uint8_t *out) {
+    if (end - p < 16) return false;
+    __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    if (!allHexDigits(digits)) return false;
+    packHexDigits(digits, out);
+    return true;
+}
+
+IDRIVE_SSSE3 const char *sse2FindNewline(const char *p, const char *end) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return scalarFindNewline(p, end);
+}
+
+// --- AVX2 ---
+
+IDRIVE_AVX2 const char *avx2FindNewline(const char *p, const char *end) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return scalarFindNewline(p, end);
+}
+
+const ParseKernels SSSE3_KERNELS = {
+    "ssse3",
+    sse2FindNewline,
+    ssse3DecodePrefixed8,
+    ssse3DecodeSpaced8,
+    ssse3DecodePacked8,
+};
+
+// The payloads are at most 39 bytes, so the decoders stay 128-bit; AVX2
+// pays off in the newline scan that touches every byte of the file.
+const ParseKernels AVX2_KERNELS = {
+    "avx2",
+    avx2FindNewline,
+    ssse3DecodePrefixed8,
+    ssse3DecodeSpaced8,
+    ssse3DecodePacked8,
+};
+
+const ParseKernels &selectSimdKernels() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return AVX2_KERNELS;
+    if (__builtin_cpu_supports("ssse3")) return SSSE3_KERNELS;
+    return SCALAR_KERNELS;
+}
+
+#else
+
+const ParseKernels &selectSimdKernels() {
+    return SCALAR_KERNELS;
+}
+
+#endif
+
+}  // namespace
+
+const int8_t *const HEX_VALUE = HEX_TABLE.values;
+
+const ParseKernels &scalarKernels() {
+    return SCALAR_KERNELS;
+}
+
+const ParseKernels &simdKernels() {
+    static const ParseKernels &kernels = selectSimdKernels();
+    return kernels;
+}
+
+}  // namespace idrive::detail
@@ -0,0 +1,38 @@
+#pragma once
+
+// Hot loops of the capture parser, with one implementation per vector
+// level. The decode kernels look at a fixed-size window starting at p and
+// fail (so the caller falls back to the general scalar path) when the
+// window runs past end or the characters do not match the expected layout.
+
+#include <cstdint>
+
+namespace idrive::detail {
+
+struct ParseKernels {
+    const char *name;
+
+    // First '\n' in [p, end), or end
+    const char *(*findNewline)(const char *p, const char *end);
+
+    // "0xNN 0xNN ... 0xNN": 8 tokens, 39 characters (PuTTY)
+    bool (*decodePrefixed8)(const char *p, const char *end, uint8_t *out);
+
+    // "NN NN ... NN": 8 tokens, 23 characters (device RAW, IDs.txt)
+    bool (*decodeSpaced8)(const char *p, const char *end, uint8_t *out);
+
+    // "NNNNNNNNNNNNNNNN": 16 characters (candump)
+    bool (*decodePacked8)(const char *p, const char *end, uint8_t *out);
+};
+
+const ParseKernels &scalarKernels();
+const ParseKernels &simdKernels();
+
+// 256-entry table, -1 for non-hex characters
+extern const int8_t *const HEX_VALUE;
+
+inline int hexValue(char c) {
+    return HEX_VALUE[static_cast<uint8_t>(c)];
+}
+
+}  // namespace idrive::detail
@@ -0,0 +1,333 @@
+#include "idrive/capture.h"
+#include "capture_kernels.h"
+
+#include <cstring>
+
+namespace idrive {
+
+namespace {
+
+using detail::hexValue;
+using detail::ParseKernels;
+
+// --- Small cursor helpers over one line [p, end) ---
+
+bool consume(const char *&p, const char *end, const char *literal) {
+    size_t n = std::strlen(literal);
+    if (static_cast<size_t>(end - p) < n || std::memcmp(p, literal, n) != 0) return false;
+    p += n;
+    return true;
+}
+
+void skipSpaces(const char *&p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+}
+
+bool parseHex(const char *&p, const char *end, uint32_t &value, int maxDigits = 8) {
+    const char *start = p;
+    value = 0;
+    while (p < end && p - start < maxDigits) {
+        int digit = hexValue(*p);
+        if (digit < 0) break;
+        value = (value << 4) | static_cast<uint32_t>(digit);
+        p++;
+    }
+    return p > start;
+}
+
+bool parseDecimal(const char *&p, const char *end, int64_t &value, int *digits = nullptr) {
+    const char *start = p;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+    if (digits) *digits = static_cast<int>(p - start);
+    return p > start;
+}
+
+// Scalar payload tokens separated by spaces, each optionally "0x"-prefixed
+uint8_t parseTokens(const char *p, const char *end, uint8_t *data) {
+    uint8_t count = 0;
+    while (count < 8) {
+        skipSpaces(p, end);
+        if (end - p >= 2 && p[0] == '0' && (p[1] | 0x20) == 'x') p += 2;
+        if (end - p < 2) break;
+        int hi = hexValue(p[0]);
+        int lo = hexValue(p[1]);
+        if ((hi | lo) < 0) break;
+        data[count++] = static_cast<uint8_t>((hi << 4) | lo);
+        p += 2;
+    }
+    return count;
+}
+
+const char *trimRight(const char *begin, const char *end) {
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+    return end;
+}
+
+// Per-parse context; the vector decoders may read past the line up to the
+// end of the whole buffer, never beyond it.
+struct LineContext {
+    const ParseKernels &kernels;
+    const char *bufferEnd;
+};
+
+// "Standard ID: 0x567       DLC: 8  Data: 0x40 0x67 0x00 0x00 0x00 0x02 0x00 0x00"
+bool parsePuttyLine(const LineContext &ctx, const char *p, const char *end, Frame &frame) {
+    if (consume(p, end, "Extended ID: 0x")) {
+        frame.flags |= FRAME_EXTENDED;
+    } else if (!consume(p, end, "Standard ID: 0x")) {
+        return false;
+    }
+    if (!parseHex(p, end, frame.id)) return false;
+    skipSpaces(p, end);
+
+    int64_t dlc;
+    if (!consume(p, end, "DLC:")) return false;
+    skipSpaces(p, end);
+    if (!parseDecimal(p, end, dlc) || dlc > 8) return false;
+    frame.dlc = static_cast<uint8_t>(dlc);
+    skipSpaces(p, end);
+    if (!consume(p, end, "Data:")) return frame.dlc == 0;
+    skipSpaces(p, end);
+
+    if (frame.dlc == 8 && end - p == 39 && ctx.kernels.decodePrefixed8(p, ctx.bufferEnd, frame.data)) return true;
+    return parseTokens(p, end, frame.data) == frame.dlc;
+}
+
+// "[RAW] ID:0x25B Data: 03 FF 7F 00 20 00 C0 C0"
+bool parseIdsNotesLine(const LineContext &ctx, const char *p, const char *end, Frame &frame) {
+    if (!consume(p, end, "[RAW] ID:0x")) return false;
+    if (!parseHex(p, end, frame.id)) return false;
+    skipSpaces(p, end);
+    if (!consume(p, end, "Data:")) return false;
+    skipSpaces(p, end);
+
+    if (end - p == 23 && ctx.kernels.decodeSpaced8(p, ctx.bufferEnd, frame.data)) {
+        frame.dlc = 8;
+        return true;
+    }
+    frame.dlc = parseTokens(p, end, frame.data);
+    return true;
+}
+
+// "[  1234ms] [RAW] 0x25B: 00 FF 7F ..." or, once clock-synced,
+// "[12345678.123ms] [GEAR] 0x3FD: ..."
+bool parseDeviceRawLine(const LineContext &ctx, const char *p, const char *end, Frame &frame,
+                        bool &isRawType) {
+    if (!consume(p, end, "[")) return false;
+    skipSpaces(p, end);
+
+    int64_t ms, fraction = 0;
+    int fractionDigits = 0;
+    if (!parseDecimal(p, end, ms)) return false;
+    if (consume(p, end, ".")) parseDecimal(p, end, fraction, &fractionDigits);
+    if (!consume(p, end, "ms] [")) return false;
+
+    int64_t us = ms * 1000;
+    if (fractionDigits > 0) {
+        while (fractionDigits > 3) {
+            fraction /= 10;
+            fractionDigits--;
+        }
+        while (fractionDigits < 3) {
+            fraction *= 10;
+            fractionDigits++;
+        }
+        us += fraction;
+    }
+    frame.timestampUs = us;
+
+    const char *type = p;
+    const void *close = std::memchr(p, ']', static_cast<size_t>(end - p));
+    if (!close) return false;
+    p = static_cast<const char *>(close) + 1;
+    isRawType = (p - type == 4 && std::memcmp(type, "RAW]", 4) == 0);
+
+    if (!consume(p, end, " 0x") || !parseHex(p, end, frame.id) || !consume(p, end, ":")) return false;
+    skipSpaces(p, end);
+
+    if (end - p == 23 && ctx.kernels.decodeSpaced8(p, ctx.bufferEnd, frame.data)) {
+        frame.dlc = 8;
+        return true;
+    }
+    frame.dlc = parseTokens(p, end, frame.data);
+    return true;
+}
+
+// "(1600000000.123456) can0 25B#0011223344556677"
+bool parseCandumpLine(const LineContext &ctx, const char *p, const char *end, Frame &frame) {
+    int64_t seconds, fraction = 0;
+    int fractionDigits = 0;
+    if (!consume(p, end, "(") || !parseDecimal(p, end, seconds)) return false;
+    if (consume(p, end, ".")) parseDecimal(p, end, fraction, &fractionDigits);
+    if (!consume(p, end, ")")) return false;
+    while (fractionDigits > 6) {
+        fraction /= 10;
+        fractionDigits--;
+    }
+    while (fractionDigits < 6) {
+        fraction *= 10;
+        fractionDigits++;
+    }
+    frame.timestampUs = seconds * 1000000 + fraction;
+
+    skipSpaces(p, end);
+    while (p < end && *p != ' ') p++;  // interface name
+    skipSpaces(p, end);
+
+    const char *idStart = p;
+    if (!parseHex(p, end, frame.id) || !consume(p, end, "#")) return false;
+    if (p - idStart > 3 + 1) frame.flags |= FRAME_EXTENDED;
+    if (p < end && (*p == 'R' || *p == '#')) return false;  // remote or CAN FD frame
+
+    if (end - p == 16 && ctx.kernels.decodePacked8(p, ctx.bufferEnd, frame.data)) {
+        frame.dlc = 8;
+        return true;
+    }
+
+    uint8_t count = 0;
+    while (count < 8 && end - p >= 2) {
+        int hi = hexValue(p[0]);
+        int lo = hexValue(p[1]);
+        if ((hi | lo) < 0) break;
+        frame.data[count++] = static_cast<uint8_t>((hi << 4) | lo);
+        p += 2;
+    }
+    frame.dlc = count;
+    return true;
+}
+
+// "MARK 3", printed by the firmware when `m` is sent
+bool parseMarkerLine(const char *p, const char *end, uint32_t &number) {
+    int64_t value;
+    if (!consume(p, end, "MARK ") || !parseDecimal(p, end, value) || p != end) return false;
+    number = static_cast<uint32_t>(value);
+    return true;
+}
+
+bool looksLike(const char *p, const char *end, CaptureFormat format) {
+    Frame frame{};
+    LineContext ctx{detail::scalarKernels(), end};
+    bool isRawType;
+    switch (format) {
+        case CaptureFormat::Putty:     return parsePuttyLine(ctx, p, end, frame);
+        case CaptureFormat::IdsNotes:  return parseIdsNotesLine(ctx, p, end, frame);
+        case CaptureFormat::DeviceRaw: return parseDeviceRawLine(ctx, p, end, frame, isRawType);
+        case CaptureFormat::Candump:   return parseCandumpLine(ctx, p, end, frame);
+        default:                       return false;
+    }
+}
+
+}  // namespace
+
+const char *formatName(CaptureFormat format) {
+    switch (format) {
+        case CaptureFormat::Putty:     return "putty";
+        case CaptureFormat::IdsNotes:  return "ids";
+        case CaptureFormat::DeviceRaw: return "raw";
+        case CaptureFormat::Candump:   return "candump";
+        default:                       return "unknown";
+    }
+}
+
+CaptureFormat detectFormat(const char *data, size_t size) {
+    constexpr int MAX_PROBE_LINES = 64;
+    static const CaptureFormat CANDIDATES[] = {
+        CaptureFormat::Putty, CaptureFormat::IdsNotes, CaptureFormat::DeviceRaw, CaptureFormat::Candump,
+    };
+
+    const char *p = data;
+    const char *end = data + size;
+    for (int line = 0; line < MAX_PROBE_LINES && p < end; line++) {
+        const char *nl = detail::scalarKernels().findNewline(p, end);
+        const char *lineEnd = trimRight(p, nl);
+        for (CaptureFormat format : CANDIDATES) {
+            if (looksLike(p, lineEnd, format)) return format;
+        }
+        p = (nl < end) ? nl + 1 : end;
+    }
+    return CaptureFormat::Unknown;
+}
+
+const char *simdLevelName() {
+    return detail::simdKernels().name;
+}
+
+uint32_t &idFrameCount(ParseState &state, uint32_t id, bool extended) {
+    if (!extended && id < state.standardIdCounts.size()) return state.standardIdCounts[id];
+    return state.extendedIdCounts[id | (extended ? 0x80000000u : 0)];
+}
+
+void parseCapture(const char *begin, const char *end, CaptureFormat format, std::vector<Frame> &out,
+                  ParseStats *stats, ParseKernel kernel, ParseState *state) {
+    const LineContext ctx{kernel == ParseKernel::Simd ? detail::simdKernels() : detail::scalarKernels(), end};
+    ParseStats local;
+    ParseState localState;
+    ParseState &st = state ? *state : localState;
+
+    // Lines average ~60 bytes; reserving avoids most regrowth on big files
+    out.reserve(out.size() + static_cast<size_t>(end - begin) / 64);
+
+    for (const char *p = begin; p < end;) {
+        const char *nl = ctx.kernels.findNewline(p, end);
+        const char *lineEnd = (nl > p && nl[-1] == '\r') ? nl - 1 : nl;
+        local.lines++;
+
+        Frame frame{};
+        bool ok = false;
+        switch (format) {
+            case CaptureFormat::Putty:
+                ok = parsePuttyLine(ctx, p, lineEnd, frame);
+                break;
+            case CaptureFormat::IdsNotes:
+                ok = parseIdsNotesLine(ctx, p, lineEnd, frame);
+                break;
+            case CaptureFormat::DeviceRaw: {
+                // The firmware prints RAW frames a second time under their
+                // handler tag (ID_567, GEAR, UNKNOWN); keep only the first copy
+                bool isRawType = false;
+                ok = parseDeviceRawLine(ctx, p, lineEnd, frame, isRawType);
+                if (!st.sawLine) st.leadingTaggedFrame = ok && !isRawType;
+                if (ok && !isRawType && st.havePreviousRaw && st.previousRaw.id == frame.id &&
+                    st.previousRaw.timestampUs == frame.timestampUs) {
+                    ok = false;
+                }
+                st.havePreviousRaw = ok && isRawType;
+                if (st.havePreviousRaw) st.previousRaw = frame;
+                break;
+            }
+            case CaptureFormat::Candump:
+                ok = parseCandumpLine(ctx, p, lineEnd, frame);
+                break;
+            default:
+                break;
+        }
+
+        st.sawLine = true;
+
+        if (ok) {
+            if (format == CaptureFormat::Putty || format == CaptureFormat::IdsNotes) {
+                frame.timestampUs = static_cast<int64_t>(st.ordinal) * SYNTHETIC_FRAME_SPACING_US;
+                frame.flags |= FRAME_SYNTH_TIME;
+            }
+            st.ordinal++;
+            frame.idSequence = static_cast<uint16_t>(idFrameCount(st, frame.id, frame.flags & FRAME_EXTENDED)++);
+            out.push_back(frame);
+            local.frames++;
+        } else {
+            local.skipped++;
+            uint32_t number;
+            if (parseMarkerLine(p, lineEnd, number)) st.markers.push_back({number, st.ordinal});
+        }
+
+        p = (nl < end) ? nl + 1 : end;
+    }
+
+    if (stats) {
+        stats->lines += local.lines;
+        stats->frames += local.frames;
+        stats->skipped += local.skipped;
+    }
+}
+
+}  // namespace idrive
@@ -0,0 +1,203 @@
+#include "column_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IDRIVE_X86_KERNELS 1
+#endif
+
+namespace idrive::detail {
+
+namespace {
+
+inline void store(uint64_t *out, size_t w, uint64_t bits, bool negate) {
+    out[w] &= negate ? ~bits : bits;
+}
+
+// --- Scalar ---
+
+void scalarMasked(const uint8_t *col, size_t words, uint8_t mask, uint8_t value, bool negate, uint64_t *out) {
+    for (size_t w = 0; w < words; w++) {
+        uint64_t bits = 0;
+        for (int i = 0; i < 64; i++) bits |= uint64_t((col[w * 64 + i] & mask) == value) << i;
+        store(out, w, bits, negate);
+    }
+}
+
+void scalarBetween(const uint8_t *col, size_t words, uint8_t lo, uint8_t hi, bool negate, uint64_t *out) {
+    for (size_t w = 0; w < words; w++) {
+        uint64_t bits = 0;
+        for (int i = 0; i < 64; i++) {
+            uint8_t v = col[w * 64 + i];
+            bits |= uint64_t(v >= lo && v <= hi) << i;
+        }
+        store(out, w, bits, negate);
+    }
+}
+
+uint64_t scalarChangedWord(const uint8_t *col, size_t w) {
+    uint64_t bits = 0;
+    for (int i = (w == 0) ? 1 : 0; i < 64; i++) {
+        size_t r = w * 64 + i;
+        bits |= uint64_t(col[r] != col[r - 1]) << i;
+    }
+    return bits;
+}
+
+void scalarChanged(const uint8_t *col, size_t words, bool negate, uint64_t *out) {
+    for (size_t w = 0; w < words; w++) store(out, w, scalarChangedWord(col, w), negate);
+}
+
+const ScanKernels SCALAR_KERNELS = {
+    "scalar",
+    scalarMasked,
+    scalarBetween,
+    scalarChanged,
+};
+
+#ifdef IDRIVE_X86_KERNELS
+
+#define IDRIVE_AVX2 __attribute__((target("avx2")))
+
+// --- SSE2 (x86-64 baseline): four 16-row compares per word ---
+
+inline uint64_t sse2Word(const uint8_t *p, __m128i (*test)(__m128i, __m128i, __m128i), __m128i x, __m128i y) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i));
+        bits |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(test(v, x, y)))) << (16 * i);
+    }
+    return bits;
+}
+
+__m128i sse2MaskedTest(__m128i v, __m128i mask, __m128i value) {
+    return _mm_cmpeq_epi8(_mm_and_si128(v, mask), value);
+}
+
+// Unsigned range via saturating subtract: v - lo <= hi - lo
+__m128i sse2BetweenTest(__m128i v, __m128i lo, __m128i span) {
+    __m128i offset = _mm_sub_epi8(v, lo);
+    return _mm_cmpeq_epi8(_mm_subs_epu8(offset, span), _mm_setzero_si128());
+}
+
+void sse2Masked(const uint8_t *col, size_t words, uint8_t mask, uint8_t value, bool negate, uint64_t *out) {
+    __m128i m = _mm_set1_epi8(static_cast<char>(mask));
+    __m128i v = _mm_set1_epi8(static_cast<char>(value));
+    for (size_t w = 0; w < words; w++) store(out, w, sse2Word(col + w * 64, sse2MaskedTest, m, v), negate);
+}
+
+void sse2Between(const uint8_t *col, size_t words, uint8_t lo, uint8_t hi, bool negate, uint64_t *out) {
+    if (lo > hi) {
+        for (size_t w = 0; w < words; w++) store(out, w, 0, negate);
+        return;
+    }
+    __m128i l = _mm_set1_epi8(static_cast<char>(lo));
+    __m128i span = _mm_set1_epi8(static_cast<char>(hi - lo));
+    for (size_t w = 0; w < words; w++) store(out, w, sse2Word(col + w * 64, sse2BetweenTest, l, span), negate);
+}
+
+void sse2Changed(const uint8_t *col, size_t words, bool negate, uint64_t *out) {
+    if (words == 0) return;
+    store(out, 0, scalarChangedWord(col, 0), negate);
+    for (size_t w = 1; w < words; w++) {
+        const uint8_t *p = col + w * 64;
+        uint64_t same = 0;
+        for (int i = 0; i < 4; i++) {
+            __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i));
+            __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i - 1));
+            same |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(cur, prev)))) << (16 * i);
+        }
+        store(out, w, ~same, negate);
+    }
+}
+
+// --- AVX2: two 32-row compares per word ---
+
+IDRIVE_AVX2 inline uint64_t avx2Bits(__m256i lowHalf, __m256i highHalf) {
+    return uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(lowHalf))) |
+           uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(highHalf))) << 32;
+}
+
+IDRIVE_AVX2 void avx2Masked(const uint8_t *col, size_t words, uint8_t mask, uint8_t value, bool negate,
+                            uint64_t *out) {
+    __m256i m = _mm256_set1_epi8(static_cast<char>(mask));
+    __m256i v = _mm256_set1_epi8(static_cast<char>(value));
+    for (size_t w = 0; w < words; w++) {
+        const uint8_t *p = col + w * 64;
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+        store(out, w, avx2Bits(_mm256_cmpeq_epi8(_mm256_and_si256(a, m), v),
+                               _mm256_cmpeq_epi8(_mm256_and_si256(b, m), v)), negate);
+    }
+}
+
+IDRIVE_AVX2 void avx2Between(const uint8_t *col, size_t words, uint8_t lo, uint8_t hi, bool negate,
+                             uint64_t *out) {
+    if (lo > hi) {
+        for (size_t w = 0; w < words; w++) store(out, w, 0, negate);
+        return;
+    }
+    __m256i l = _mm256_set1_epi8(static_cast<char>(lo));
+    __m256i span = _mm256_set1_epi8(static_cast<char>(hi - lo));
+    __m256i zero = _mm256_setzero_si256();
+    for (size_t w = 0; w < words; w++) {
+        const uint8_t *p = col + w * 64;
+        __m256i a = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), l);
+        __m256i b = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32)), l);
+        store(out, w, avx2Bits(_mm256_cmpeq_epi8(_mm256_subs_epu8(a, span), zero),
+                               _mm256_cmpeq_epi8(_mm256_subs_epu8(b, span), zero)), negate);
+    }
+}
+
+IDRIVE_AVX2 void avx2Changed(const uint8_t *col, size_t words, bool negate, uint64_t *out) {
+    if (words == 0) return;
+    store(out, 0, scalarChangedWord(col, 0), negate);
+    for (size_t w = 1; w < words; w++) {
+        const uint8_t *p = col + w * 64;
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+        __m256i pa = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p - 1));
+        __m256i pb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 31));
+        store(out, w, ~avx2Bits(_mm256_cmpeq_epi8(a, pa), _mm256_cmpeq_epi8(b, pb)), negate);
+    }
+}
+
+const ScanKernels SSE2_KERNELS = {
+    "sse2",
+    sse2Masked,
+    sse2Between,
+    sse2Changed,
+};
+
+const ScanKernels AVX2_KERNELS = {
+    "avx2",
+    avx2Masked,
+    avx2Between,
+    avx2Changed,
+};
+
+const ScanKernels &selectSimdKernels() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return AVX2_KERNELS;
+    return SSE2_KERNELS;
+}
+
+#else
+
+const ScanKernels &selectSimdKernels() {
+    return SCALAR_KERNELS;
+}
+
+#endif
+
+}  // namespace
+
+const ScanKernels &scalarScanKernels() {
+    return SCALAR_KERNELS;
+}
+
+const ScanKernels &simdScanKernels() {
+    static const ScanKernels &kernels = selectSimdKernels();
+    return kernels;
+}
+
+}  // namespace idrive::detail
@@ -0,0 +1,29 @@
+#pragma once
+
+// Byte-column scans for the column store. Each kernel evaluates a predicate
+// over 64 rows per output word and ANDs the (optionally negated) result
+// into out; columns are zero-padded to whole words so kernels never check
+// bounds. Rows past the end are cleared by the caller.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace idrive::detail {
+
+struct ScanKernels {
+    const char *name;
+
+    // (col[r] & mask) == value
+    void (*masked)(const uint8_t *col, size_t words, uint8_t mask, uint8_t value, bool negate, uint64_t *out);
+
+    // lo <= col[r] <= hi
+    void (*between)(const uint8_t *col, size_t words, uint8_t lo, uint8_t hi, bool negate, uint64_t *out);
+
+    // col[r] != col[r - 1]; row 0 never counts as changed
+    void (*changed)(const uint8_t *col, size_t words, bool negate, uint64_t *out);
+};
+
+const ScanKernels &scalarScanKernels();
+const ScanKernels &simdScanKernels();
+
+}  // namespace idrive::detail
@@ -0,0 +1,215 @@
+#include "idrive/column_store.h"
+#include "idrive/work_stealing_pool.h"
+#include "column_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace idrive {
+
+namespace {
+
+constexpr size_t ROWS_PER_WORD = 64;
+
+size_t wordsFor(size_t rows) {
+    return (rows + ROWS_PER_WORD - 1) / ROWS_PER_WORD;
+}
+
+// Counting sort of row numbers by byte value, then one bitmap per value
+void buildValueIndex(const std::vector<uint8_t> &column, size_t rows, std::array<CompressedBitmap, 256> &index,
+                     std::vector<uint32_t> &scratch) {
+    size_t start[257] = {};
+    for (size_t r = 0; r < rows; r++) start[column[r] + 1]++;
+    for (int v = 0; v < 256; v++) start[v + 1] += start[v];
+
+    scratch.resize(rows);
+    size_t fill[256];
+    std::memcpy(fill, start, sizeof(fill));
+    for (size_t r = 0; r < rows; r++) scratch[fill[column[r]]++] = static_cast<uint32_t>(r);
+
+    for (int v = 0; v < 256; v++) {
+        index[v] = CompressedBitmap::fromSortedRows(scratch.data() + start[v], start[v + 1] - start[v]);
+    }
+}
+
+void fillPartition(IdPartition &partition, const std::vector<Frame> &frames, const std::vector<uint32_t> &rows,
+                   bool buildIndexes) {
+    size_t n = rows.size();
+    // One spare word past the end keeps the 64-byte scan loads in bounds
+    size_t padded = (wordsFor(n) + 1) * ROWS_PER_WORD;
+
+    partition.rows = n;
+    partition.timestampUs.resize(n);
+    partition.captureIndex = rows;
+    partition.dlc.assign(padded, 0);
+    for (auto &column : partition.bytes) column.assign(padded, 0);
+
+    for (size_t r = 0; r < n; r++) {
+        const Frame &frame = frames[rows[r]];
+        partition.timestampUs[r] = frame.timestampUs;
+        partition.dlc[r] = frame.dlc;
+        for (int b = 0; b < 8; b++) partition.bytes[b][r] = frame.data[b];
+        if (r > 0 && frame.timestampUs < partition.timestampUs[r - 1]) partition.timeOrdered = false;
+    }
+
+    if (!buildIndexes) return;
+    partition.valueIndex.resize(8);
+    std::vector<uint32_t> scratch;
+    for (int b = 0; b < 8; b++) buildValueIndex(partition.bytes[b], n, partition.valueIndex[b], scratch);
+}
+
+void applyTime(const IdPartition &partition, const Predicate &predicate, std::vector<uint64_t> &bits) {
+    std::vector<uint64_t> match(bits.size(), 0);
+    if (partition.timeOrdered) {
+        auto begin = partition.timestampUs.begin();
+        auto end = partition.timestampUs.end();
+        size_t first = std::lower_bound(begin, end, predicate.fromUs) - begin;
+        size_t last = std::upper_bound(begin, end, predicate.toUs) - begin;
+        for (size_t r = first; r < last;) {
+            // Whole words where possible
+            if (r % ROWS_PER_WORD == 0 && r + ROWS_PER_WORD <= last) {
+                match[r / ROWS_PER_WORD] = ~uint64_t(0);
+                r += ROWS_PER_WORD;
+            } else {
+                match[r / ROWS_PER_WORD] |= uint64_t(1) << (r % ROWS_PER_WORD);
+                r++;
+            }
+        }
+    } else {
+        for (size_t r = 0; r < partition.rows; r++) {
+            int64_t t = partition.timestampUs[r];
+            if (t >= predicate.fromUs && t <= predicate.toUs) match[r / ROWS_PER_WORD] |= uint64_t(1) << (r % ROWS_PER_WORD);
+        }
+    }
+    for (size_t w = 0; w < bits.size(); w++) bits[w] &= predicate.negate ? ~match[w] : match[w];
+}
+
+}  // namespace
+
+Frame IdPartition::frame(size_t row) const {
+    Frame frame{};
+    frame.timestampUs = timestampUs[row];
+    frame.id = id;
+    frame.dlc = dlc[row];
+    frame.flags = extended ? FRAME_EXTENDED : 0;
+    for (int b = 0; b < 8; b++) frame.data[b] = bytes[b][row];
+    return frame;
+}
+
+void ColumnStore::build(const std::vector<Frame> &frames, const ColumnStoreOptions &options) {
+    partitions_.clear();
+    standardSlot_.assign(0x800, -1);
+    frameCount_ = frames.size();
+
+    // Row lists per ID in capture order
+    std::unordered_map<uint64_t, size_t> slotOf;
+    std::vector<std::vector<uint32_t>> rows;
+    for (size_t i = 0; i < frames.size(); i++) {
+        const Frame &frame = frames[i];
+        bool extended = frame.flags & FRAME_EXTENDED;
+        uint64_t key = uint64_t(frame.id) | (extended ? uint64_t(1) << 32 : 0);
+        auto inserted = slotOf.emplace(key, partitions_.size());
+        if (inserted.second) {
+            partitions_.emplace_back();
+            partitions_.back().id = frame.id;
+            partitions_.back().extended = extended;
+            rows.emplace_back();
+            if (!extended && frame.id < standardSlot_.size()) standardSlot_[frame.id] = static_cast<int32_t>(inserted.first->second);
+        }
+        rows[inserted.first->second].push_back(static_cast<uint32_t>(i));
+    }
+
+    auto fill = [&](size_t p) {
+        fillPartition(partitions_[p], frames, rows[p], options.buildIndexes);
+        std::vector<uint32_t>().swap(rows[p]);
+    };
+    if (options.pool) {
+        options.pool->parallelFor(partitions_.size(), fill);
+    } else {
+        for (size_t p = 0; p < partitions_.size(); p++) fill(p);
+    }
+}
+
+const IdPartition *ColumnStore::partition(uint32_t id, bool extended) const {
+    if (!extended) {
+        if (id >= standardSlot_.size() || standardSlot_[id] < 0) return nullptr;
+        return &partitions_[standardSlot_[id]];
+    }
+    for (const IdPartition &p : partitions_) {
+        if (p.extended && p.id == id) return &p;
+    }
+    return nullptr;
+}
+
+size_t ColumnStore::indexBytes() const {
+    size_t total = 0;
+    for (const IdPartition &p : partitions_) {
+        for (const auto &byteIndex : p.valueIndex) {
+            for (const CompressedBitmap &bitmap : byteIndex) total += bitmap.memoryBytes();
+        }
+    }
+    return total;
+}
+
+size_t ColumnStore::columnBytes() const {
+    size_t total = 0;
+    for (const IdPartition &p : partitions_) {
+        total += p.timestampUs.size() * sizeof(int64_t) + p.captureIndex.size() * sizeof(uint32_t) + p.dlc.size();
+        for (const auto &column : p.bytes) total += column.size();
+    }
+    return total;
+}
+
+QueryResult ColumnStore::run(const SignalQuery &query) const {
+    QueryResult result;
+    result.partition = partition(query.id, query.extended);
+    if (!result.partition) return result;
+
+    const IdPartition &p = *result.partition;
+    const detail::ScanKernels &kernels = detail::simdScanKernels();
+    size_t words = wordsFor(p.rows);
+    result.rowBits.assign(words, ~uint64_t(0));
+
+    // Index lookups first: they are cheap and usually the most selective
+    std::vector<const Predicate *> scans;
+    for (const Predicate &predicate : query.where) {
+        bool indexed = predicate.kind == Predicate::Kind::ByteMasked && predicate.b == 0xFF && !predicate.negate &&
+                       !p.valueIndex.empty();
+        if (indexed) {
+            p.valueIndex[predicate.byte & 7][predicate.a].andInto(result.rowBits.data(), words);
+        } else {
+            scans.push_back(&predicate);
+        }
+    }
+
+    for (const Predicate *predicate : scans) {
+        const uint8_t *column = p.bytes[predicate->byte & 7].data();
+        switch (predicate->kind) {
+            case Predicate::Kind::ByteMasked:
+                kernels.masked(column, words, predicate->b, predicate->a & predicate->b, predicate->negate,
+                               result.rowBits.data());
+                break;
+            case Predicate::Kind::ByteBetween:
+                kernels.between(column, words, predicate->a, predicate->b, predicate->negate, result.rowBits.data());
+                break;
+            case Predicate::Kind::ByteChanged:
+                kernels.changed(column, words, predicate->negate, result.rowBits.data());
+                break;
+            case Predicate::Kind::TimeBetween:
+                applyTime(p, *predicate, result.rowBits);
+                break;
+        }
+    }
+
+    // Padding rows past the end may have matched a negated or zero test
+    if (p.rows % ROWS_PER_WORD) result.rowBits.back() &= (uint64_t(1) << (p.rows % ROWS_PER_WORD)) - 1;
+    for (uint64_t word : result.rowBits) result.matches += static_cast<size_t>(__builtin_popcountll(word));
+    return result;
+}
+
+const char *columnScanLevelName() {
+    return detail::simdScanKernels().name;
+}
+
+}  // namespace idrive
@@ -0,0 +1,148 @@
+#include "idrive/compressed_bitmap.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace idrive {
+
+namespace {
+
+constexpr uint32_t CONTAINER_ROWS  = 65536;
+constexpr uint32_t CONTAINER_WORDS = CONTAINER_ROWS / 64;
+
+void setRange(uint64_t *words, size_t wordCount, uint64_t first, uint64_t last) {
+    for (uint64_t w = first / 64; w <= last / 64 && w < wordCount; w++) {
+        uint64_t lo = (w == first / 64) ? first % 64 : 0;
+        uint64_t hi = (w == last / 64) ? last % 64 : 63;
+        uint64_t mask = (hi == 63 ? ~uint64_t(0) : ((uint64_t(1) << (hi + 1)) - 1)) & (~uint64_t(0) << lo);
+        words[w] |= mask;
+    }
+}
+
+}  // namespace
+
+CompressedBitmap CompressedBitmap::fromSortedRows(const uint32_t *rows, size_t count) {
+    CompressedBitmap bitmap;
+    bitmap.cardinality_ = count;
+
+    for (size_t begin = 0; begin < count;) {
+        uint16_t key = static_cast<uint16_t>(rows[begin] >> 16);
+        size_t end = begin;
+        size_t runs = 0;
+        while (end < count && (rows[end] >> 16) == key) {
+            if (end == begin || rows[end] != rows[end - 1] + 1) runs++;
+            end++;
+        }
+        size_t card = end - begin;
+
+        // Sizes in bytes of each representation
+        size_t arrayBytes = card * 2;
+        size_t runBytes = runs * 4;
+        size_t bitsetBytes = CONTAINER_WORDS * 8;
+
+        Container container{key, Kind::Array, 0, 0};
+        if (runBytes <= arrayBytes && runBytes <= bitsetBytes) {
+            container.kind = Kind::Run;
+            container.offset = static_cast<uint32_t>(bitmap.values_.size());
+            container.length = static_cast<uint32_t>(runs);
+            for (size_t i = begin; i < end;) {
+                size_t j = i;
+                while (j + 1 < end && rows[j + 1] == rows[j] + 1) j++;
+                bitmap.values_.push_back(static_cast<uint16_t>(rows[i]));
+                bitmap.values_.push_back(static_cast<uint16_t>(rows[j]));
+                i = j + 1;
+            }
+        } else if (arrayBytes <= bitsetBytes) {
+            container.offset = static_cast<uint32_t>(bitmap.values_.size());
+            container.length = static_cast<uint32_t>(card);
+            for (size_t i = begin; i < end; i++) bitmap.values_.push_back(static_cast<uint16_t>(rows[i]));
+        } else {
+            container.kind = Kind::Bitset;
+            container.offset = static_cast<uint32_t>(bitmap.words_.size());
+            container.length = CONTAINER_WORDS;
+            bitmap.words_.resize(bitmap.words_.size() + CONTAINER_WORDS);
+            uint64_t *words = bitmap.words_.data() + container.offset;
+            for (size_t i = begin; i < end; i++) {
+                uint16_t low = static_cast<uint16_t>(rows[i]);
+                words[low / 64] |= uint64_t(1) << (low % 64);
+            }
+        }
+        bitmap.containers_.push_back(container);
+        begin = end;
+    }
+
+    bitmap.containers_.shrink_to_fit();
+    bitmap.values_.shrink_to_fit();
+    bitmap.words_.shrink_to_fit();
+    return bitmap;
+}
+
+void CompressedBitmap::orInto(uint64_t *words, size_t wordCount) const {
+    for (const Container &container : containers_) {
+        size_t base = size_t(container.key) * CONTAINER_WORDS;
+        if (base >= wordCount) break;
+        switch (container.kind) {
+            case Kind::Array:
+                for (uint32_t i = 0; i < container.length; i++) {
+                    size_t row = base * 64 + values_[container.offset + i];
+                    if (row / 64 < wordCount) words[row / 64] |= uint64_t(1) << (row % 64);
+                }
+                break;
+            case Kind::Run:
+                for (uint32_t i = 0; i < container.length; i++) {
+                    uint64_t first = base * 64 + values_[container.offset + 2 * i];
+                    uint64_t last = base * 64 + values_[container.offset + 2 * i + 1];
+                    setRange(words, wordCount, first, last);
+                }
+                break;
+            case Kind::Bitset: {
+                size_t n = std::min<size_t>(CONTAINER_WORDS, wordCount - base);
+                const uint64_t *src = words_.data() + container.offset;
+                for (size_t w = 0; w < n; w++) words[base + w] |= src[w];
+                break;
+            }
+        }
+    }
+}
+
+void CompressedBitmap::andInto(uint64_t *words, size_t wordCount) const {
+    // Expand one container at a time so the scratch stays 8 KB
+    uint64_t scratch[CONTAINER_WORDS];
+    size_t next = 0;  // first container slot of words not yet processed
+    for (const Container &container : containers_) {
+        size_t base = size_t(container.key) * CONTAINER_WORDS;
+        if (base >= wordCount) break;
+        size_t n = std::min<size_t>(CONTAINER_WORDS, wordCount - base);
+
+        // Containers without any row clear their whole range
+        if (next < base) std::memset(words + next, 0, (base - next) * sizeof(uint64_t));
+        next = base + n;
+
+        if (container.kind == Kind::Bitset) {
+            const uint64_t *src = words_.data() + container.offset;
+            for (size_t w = 0; w < n; w++) words[base + w] &= src[w];
+            continue;
+        }
+
+        std::memset(scratch, 0, n * sizeof(uint64_t));
+        if (container.kind == Kind::Array) {
+            for (uint32_t i = 0; i < container.length; i++) {
+                uint16_t low = values_[container.offset + i];
+                if (low / 64 < n) scratch[low / 64] |= uint64_t(1) << (low % 64);
+            }
+        } else {
+            for (uint32_t i = 0; i < container.length; i++) {
+                setRange(scratch, n, values_[container.offset + 2 * i], values_[container.offset + 2 * i + 1]);
+            }
+        }
+        for (size_t w = 0; w < n; w++) words[base + w] &= scratch[w];
+    }
+    if (next < wordCount) std::memset(words + next, 0, (wordCount - next) * sizeof(uint64_t));
+}
+
+size_t CompressedBitmap::memoryBytes() const {
+    return containers_.size() * sizeof(Container) + values_.size() * sizeof(uint16_t) +
+           words_.size() * sizeof(uint64_t);
+}
+
+}  // namespace idrive
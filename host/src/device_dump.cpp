@@ -0,0 +1,123 @@
+#include "idrive/capture.h"
+
+#include "capture_format.h"
+#include "frame_codec.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace idrive {
+
+namespace {
+
+constexpr char BEGIN_MARKER[] = "CAPTURE BEGIN ";
+constexpr char END_MARKER[] = "CAPTURE END";
+
+const char *findMarker(const char *p, const char *end) {
+    size_t n = sizeof(BEGIN_MARKER) - 1;
+    while (end - p >= static_cast<ptrdiff_t>(n)) {
+        const void *hit = std::memchr(p, BEGIN_MARKER[0], static_cast<size_t>(end - p) - n + 1);
+        if (!hit) return nullptr;
+        p = static_cast<const char *>(hit);
+        if (std::memcmp(p, BEGIN_MARKER, n) == 0) return p;
+        p++;
+    }
+    return nullptr;
+}
+
+// The END line has to follow the payload directly. Its " <bytes> <crc32>"
+// trailer must match the payload; a bare END line (older firmware) is
+// accepted as is. Moves p past the line.
+bool checkTrailer(const char *&p, const char *end, const char *payload) {
+    size_t n = sizeof(END_MARKER) - 1;
+    if (static_cast<size_t>(end - p) < n || std::memcmp(p, END_MARKER, n) != 0) return false;
+    const char *payloadEnd = p;
+    const void *nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    const char *lineEnd = nl ? static_cast<const char *>(nl) : end;
+    std::string trailer(p + n, lineEnd);
+    p = nl ? lineEnd + 1 : end;
+
+    unsigned long bytes = 0, crc = 0;
+    if (std::sscanf(trailer.c_str(), " %lu %lx", &bytes, &crc) != 2) return trailer.empty() || trailer == "\r";
+    size_t size = static_cast<size_t>(payloadEnd - payload);
+    return bytes == size && crc == captureCrc32(0, reinterpret_cast<const uint8_t *>(payload), size);
+}
+
+}  // namespace
+
+size_t parseDeviceDumps(const char *begin, const char *end, std::vector<Frame> &out, size_t *damaged) {
+    size_t dumps = 0;
+    ParseState state;
+    if (damaged) *damaged = 0;
+    for (const char *p = begin; (p = findMarker(p, end)) != nullptr;) {
+        const void *nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+        if (!nl) break;
+        std::string header(p, static_cast<const char *>(nl));
+        p = static_cast<const char *>(nl) + 1;
+
+        unsigned long records = 0, trigger = 0, triggerUs = 0;
+        char encoding[16] = "";
+        if (std::sscanf(header.c_str(), "CAPTURE BEGIN %lu %lu %lu %15s", &records, &trigger, &triggerUs, encoding) < 3) {
+            continue;
+        }
+        bool delta = std::strcmp(encoding, "delta") == 0;
+        if (!delta && static_cast<size_t>(end - p) < records * sizeof(CaptureRecord)) break;  // truncated dump
+
+        const char *payload = p;
+        size_t firstFrame = out.size();
+        FrameDecoder decoder;
+        int64_t epoch = 0;
+        uint32_t previous = 0;
+        bool truncated = false;
+        for (unsigned long i = 0; i < records; i++) {
+            CaptureRecord record;
+            if (delta) {
+                CodecFrame decoded;
+                int used = decoder.decode(reinterpret_cast<const uint8_t *>(p), static_cast<size_t>(end - p), decoded);
+                if (used <= 0) {
+                    truncated = true;
+                    break;
+                }
+                p += used;
+                record.timestampUs = static_cast<uint32_t>(decoded.timestampUs);
+                record.id = static_cast<uint16_t>(decoded.id);
+                record.dlc = decoded.dlc;
+                record.flags = decoded.flags;
+                std::memcpy(record.data, decoded.data, sizeof(record.data));
+            } else {
+                std::memcpy(&record, p, sizeof(record));
+                p += sizeof(CaptureRecord);
+            }
+
+            if (i > 0 && record.timestampUs < previous && previous - record.timestampUs > 0x80000000u) {
+                epoch += int64_t(1) << 32;
+            }
+            previous = record.timestampUs;
+
+            Frame frame{};
+            frame.timestampUs = epoch + record.timestampUs;
+            frame.id = record.id;
+            frame.dlc = record.dlc > 8 ? 8 : record.dlc;
+            frame.flags = (record.flags & CAPTURE_FLAG_TX) ? FRAME_TX : 0;
+            std::memcpy(frame.data, record.data, sizeof(frame.data));
+            frame.idSequence = static_cast<uint16_t>(idFrameCount(state, frame.id, false)++);
+            out.push_back(frame);
+        }
+        if (truncated) break;
+
+        if (!checkTrailer(p, end, payload)) {
+            // Damaged, e.g. text printed into the block: drop its frames and
+            // look for the next dump right after this header
+            for (size_t i = firstFrame; i < out.size(); i++) idFrameCount(state, out[i].id, false)--;
+            out.resize(firstFrame);
+            p = payload;
+            if (damaged) ++*damaged;
+            continue;
+        }
+        dumps++;
+    }
+    return dumps;
+}
+
+}  // namespace idrive
@@ -0,0 +1,78 @@
+#include "idrive/mapped_file.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace idrive {
+
+MappedFile::MappedFile(MappedFile &&other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        open_ = std::exchange(other.open_, false);
+        error_ = std::move(other.error_);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &path, Mode mode) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error_ = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        error_ = path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        int flags = MAP_PRIVATE | (mode == Mode::Populate ? MAP_POPULATE : 0);
+        void *mapping = mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+        if (mapping == MAP_FAILED) {
+            error_ = path + ": " + std::strerror(errno);
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(mapping);
+    }
+
+    ::close(fd);
+    open_ = true;
+    return true;
+}
+
+void MappedFile::release(const char *upTo) {
+    if (!data_ || upTo <= data_) return;
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t bytes = (static_cast<size_t>(upTo - data_) / page) * page;
+    if (bytes > 0) madvise(const_cast<char *>(data_), bytes, MADV_DONTNEED);
+}
+
+void MappedFile::close() {
+    if (data_) munmap(const_cast<char *>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+}  // namespace idrive
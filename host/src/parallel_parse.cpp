@@ -0,0 +1,171 @@
+#include "idrive/parallel_parse.h"
+#include "idrive/work_stealing_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace idrive {
+
+namespace {
+
+constexpr size_t MIN_CHUNK_BYTES = 256 * 1024;
+constexpr size_t MAX_CHUNK_BYTES = 8 * 1024 * 1024;
+
+// Several chunks per thread so stealing can even out dense and sparse regions
+constexpr size_t CHUNKS_PER_THREAD = 8;
+
+struct Chunk {
+    const char *begin;
+    const char *end;
+    std::vector<Frame> frames;
+    ParseState state;
+    ParseStats stats;
+    bool sorted = true;
+
+    // Filled in while stitching
+    bool dropLeading = false;
+    size_t outputOffset = 0;
+    size_t ordinalBase = 0;
+    ParseState idBase;  // per-ID counts of all preceding chunks
+};
+
+size_t pickChunkBytes(size_t size, unsigned threads, size_t requested) {
+    if (requested) return requested;
+    size_t target = size / (static_cast<size_t>(threads) * CHUNKS_PER_THREAD);
+    return std::min(std::max(target, MIN_CHUNK_BYTES), MAX_CHUNK_BYTES);
+}
+
+std::vector<Chunk> splitChunks(const char *begin, const char *end, size_t chunkBytes) {
+    std::vector<Chunk> chunks;
+    for (const char *p = begin; p < end;) {
+        const char *cut = (static_cast<size_t>(end - p) > chunkBytes) ? p + chunkBytes : end;
+        if (cut < end) {
+            const void *nl = std::memchr(cut, '\n', static_cast<size_t>(end - cut));
+            cut = nl ? static_cast<const char *>(nl) + 1 : end;
+        }
+        chunks.emplace_back();
+        chunks.back().begin = p;
+        chunks.back().end = cut;
+        p = cut;
+    }
+    return chunks;
+}
+
+void addCounts(ParseState &into, const ParseState &from) {
+    for (size_t id = 0; id < from.standardIdCounts.size(); id++) into.standardIdCounts[id] += from.standardIdCounts[id];
+    for (const auto &entry : from.extendedIdCounts) into.extendedIdCounts[entry.first] += entry.second;
+}
+
+uint32_t &countFor(ParseState &state, const Frame &frame) {
+    return idFrameCount(state, frame.id, frame.flags & FRAME_EXTENDED);
+}
+
+bool earlier(const Frame &a, const Frame &b) {
+    return a.timestampUs < b.timestampUs;
+}
+
+}  // namespace
+
+void parseCaptureParallel(const char *begin, const char *end, CaptureFormat format, std::vector<Frame> &out,
+                          WorkStealingPool &pool, ParseStats *stats, const ParallelParseOptions &options,
+                          std::vector<CaptureMarker> *markers) {
+    out.clear();
+    if (markers) markers->clear();
+    size_t chunkBytes = pickChunkBytes(static_cast<size_t>(end - begin), pool.threadCount(), options.chunkBytes);
+    std::vector<Chunk> chunks = splitChunks(begin, end, chunkBytes);
+    if (chunks.empty()) return;
+
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        Chunk &chunk = chunks[i];
+        parseCapture(chunk.begin, chunk.end, format, chunk.frames, &chunk.stats, options.kernel, &chunk.state);
+        chunk.sorted = std::is_sorted(chunk.frames.begin(), chunk.frames.end(), earlier);
+    });
+
+    // Sequential stitch over per-chunk summaries only; frames are touched
+    // again in the parallel fix-up below
+    size_t total = 0;
+    size_t ordinal = 0;
+    ParseState running;
+    ParseStats merged;
+    bool sorted = true;
+    const Frame *lastFrame = nullptr;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        Chunk &chunk = chunks[i];
+
+        // A RAW frame at the very end of the previous chunk may be repeated
+        // under its handler tag on the first line of this one
+        if (i > 0 && chunk.state.leadingTaggedFrame && !chunk.frames.empty()) {
+            const ParseState &prev = chunks[i - 1].state;
+            const Frame &first = chunk.frames.front();
+            if (prev.havePreviousRaw && prev.previousRaw.id == first.id &&
+                prev.previousRaw.timestampUs == first.timestampUs) {
+                chunk.dropLeading = true;
+                countFor(chunk.state, first)--;
+                chunk.stats.frames--;
+                chunk.stats.skipped++;
+            }
+        }
+
+        chunk.outputOffset = total;
+        chunk.ordinalBase = ordinal;
+        chunk.idBase = running;
+
+        size_t kept = chunk.frames.size() - (chunk.dropLeading ? 1 : 0);
+        total += kept;
+        ordinal += kept;
+        addCounts(running, chunk.state);
+
+        // Chunk ordinals still count the dropped repeat, which comes before
+        // any marker since it is the chunk's first line
+        if (markers) {
+            for (const CaptureMarker &marker : chunk.state.markers) {
+                size_t local = marker.ordinal - (chunk.dropLeading ? 1 : 0);
+                markers->push_back({marker.number, chunk.ordinalBase + local});
+            }
+        }
+
+        merged.lines += chunk.stats.lines;
+        merged.frames += chunk.stats.frames;
+        merged.skipped += chunk.stats.skipped;
+
+        // Time order holds overall if each chunk is ordered and chunks do not
+        // overlap; synthetic timestamps are rebased below and always ordered
+        if (kept == 0) continue;
+        const Frame &firstKept = chunk.frames[chunk.dropLeading ? 1 : 0];
+        sorted = sorted && chunk.sorted;
+        if (lastFrame && !(firstKept.flags & FRAME_SYNTH_TIME) && earlier(firstKept, *lastFrame)) sorted = false;
+        lastFrame = &chunk.frames.back();
+    }
+
+    out.resize(total);
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        Chunk &chunk = chunks[i];
+        size_t skip = chunk.dropLeading ? 1 : 0;
+        uint32_t droppedId = skip ? chunk.frames.front().id : 0;
+        bool droppedExtended = skip && (chunk.frames.front().flags & FRAME_EXTENDED);
+        Frame *dst = out.data() + chunk.outputOffset;
+
+        for (size_t f = skip; f < chunk.frames.size(); f++) {
+            Frame frame = chunk.frames[f];
+            size_t local = f - skip;
+            if (frame.flags & FRAME_SYNTH_TIME) {
+                frame.timestampUs = static_cast<int64_t>(chunk.ordinalBase + local) * SYNTHETIC_FRAME_SPACING_US;
+            }
+            uint32_t sequence = frame.idSequence + countFor(chunk.idBase, frame);
+            if (skip && frame.id == droppedId && bool(frame.flags & FRAME_EXTENDED) == droppedExtended) sequence--;
+            frame.idSequence = static_cast<uint16_t>(sequence);
+            dst[local] = frame;
+        }
+        std::vector<Frame>().swap(chunk.frames);
+    });
+
+    if (!sorted) std::stable_sort(out.begin(), out.end(), earlier);
+
+    if (stats) {
+        stats->lines += merged.lines;
+        stats->frames += merged.frames;
+        stats->skipped += merged.skipped;
+    }
+}
+
+}  // namespace idrive
@@ -0,0 +1,368 @@
+#include "idrive/pcap_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace idrive {
+
+namespace {
+
+constexpr uint32_t CAN_EFF_FLAG = 0x80000000u;
+constexpr uint32_t CAN_RTR_FLAG = 0x40000000u;
+constexpr uint32_t CAN_ERR_FLAG = 0x20000000u;
+constexpr uint32_t CAN_EFF_MASK = 0x1FFFFFFFu;
+constexpr uint32_t CAN_SFF_MASK = 0x000007FFu;
+
+constexpr uint32_t BLOCK_INTERFACE_DESCRIPTION = 1;
+constexpr uint32_t BLOCK_PACKET_OBSOLETE       = 2;
+constexpr uint32_t BLOCK_SIMPLE_PACKET         = 3;
+constexpr uint32_t BLOCK_ENHANCED_PACKET       = 6;
+
+constexpr uint16_t OPTION_END          = 0;
+constexpr uint16_t OPTION_IF_NAME      = 2;
+constexpr uint16_t OPTION_IF_TSRESOL   = 9;
+constexpr uint16_t OPTION_EPB_FLAGS    = 2;
+constexpr uint32_t EPB_FLAGS_OUTBOUND  = 2;  // direction bits 0-1
+
+constexpr size_t    BATCH_FRAMES = 65536;
+constexpr ptrdiff_t RELEASE_BYTES = 4 << 20;
+
+uint32_t load32(const char *p, bool swap) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return swap ? __builtin_bswap32(v) : v;
+}
+
+uint16_t load16(const char *p, bool swap) {
+    uint16_t v;
+    std::memcpy(&v, p, 2);
+    return swap ? __builtin_bswap16(v) : v;
+}
+
+uint32_t loadBigEndian32(const uint8_t *p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+template <typename T>
+void put(std::string &out, T value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// Timestamp units per second of a pcapng interface
+struct TimeResolution {
+    bool     binary = false;
+    uint32_t exponent = 6;  // 10^-6 s by default
+
+    int64_t toMicros(uint64_t ticks) const {
+        if (binary) return static_cast<int64_t>((static_cast<unsigned __int128>(ticks) * 1000000) >> exponent);
+        uint32_t e = exponent;
+        if (e == 6) return static_cast<int64_t>(ticks);
+        uint64_t scale = 1;
+        if (e < 6) {
+            for (; e < 6; e++) scale *= 10;
+            return static_cast<int64_t>(ticks * scale);
+        }
+        for (; e > 6; e--) scale *= 10;
+        return static_cast<int64_t>(ticks / scale);
+    }
+};
+
+struct Interface {
+    uint32_t linkType;
+    TimeResolution resolution;
+};
+
+class FrameBatcher {
+public:
+    FrameBatcher(const std::function<bool(const Frame *, size_t)> &sink, PcapStats &stats)
+        : sink_(sink), stats_(stats) {
+        batch_.reserve(BATCH_FRAMES);
+    }
+
+    // Decodes one SocketCAN packet; returns false once the sink asks to stop
+    bool add(const uint8_t *packet, size_t length, int64_t timestampUs, bool outbound) {
+        stats_.packets++;
+        if (length < 8 || length > SOCKETCAN_FRAME_SIZE || packet[4] > 8) {
+            stats_.skipped++;
+            return true;
+        }
+        uint32_t canId = loadBigEndian32(packet);
+        if (canId & (CAN_RTR_FLAG | CAN_ERR_FLAG)) {
+            stats_.skipped++;
+            return true;
+        }
+
+        Frame frame{};
+        frame.timestampUs = timestampUs;
+        frame.flags = outbound ? FRAME_TX : 0;
+        if (canId & CAN_EFF_FLAG) {
+            frame.flags |= FRAME_EXTENDED;
+            frame.id = canId & CAN_EFF_MASK;
+        } else {
+            frame.id = canId & CAN_SFF_MASK;
+        }
+        frame.dlc = packet[4];
+        size_t available = length > 8 ? length - 8 : 0;
+        std::memcpy(frame.data, packet + 8, std::min<size_t>(frame.dlc, available));
+        frame.idSequence = static_cast<uint16_t>(idFrameCount(state_, frame.id, frame.flags & FRAME_EXTENDED)++);
+        batch_.push_back(frame);
+        return batch_.size() < BATCH_FRAMES || flush();
+    }
+
+    bool flush() {
+        if (batch_.empty()) return true;
+        bool more = sink_(batch_.data(), batch_.size());
+        batch_.clear();
+        return more;
+    }
+
+private:
+    const std::function<bool(const Frame *, size_t)> &sink_;
+    PcapStats &stats_;
+    ParseState state_;  // per-ID counters only
+    std::vector<Frame> batch_;
+};
+
+bool parseClassic(const char *begin, const char *end, FrameBatcher &batcher, std::string &error,
+                  const std::function<void(const char *)> &consumed) {
+    if (end - begin < 24) {
+        error = "truncated pcap header";
+        return false;
+    }
+    uint32_t magic = load32(begin, false);
+    bool swap = magic == __builtin_bswap32(PCAP_MAGIC_US) || magic == __builtin_bswap32(PCAP_MAGIC_NS);
+    bool nanos = load32(begin, swap) == PCAP_MAGIC_NS;
+    uint32_t linkType = load32(begin + 20, swap) & 0xFFFF;  // upper bits carry FCS info
+    if (linkType != LINKTYPE_CAN_SOCKETCAN) {
+        error = "pcap link type " + std::to_string(linkType) + " is not SocketCAN (227)";
+        return false;
+    }
+
+    const char *lastRelease = begin;
+    const char *p = begin + 24;
+    while (end - p >= 16) {
+        uint32_t seconds = load32(p, swap);
+        uint32_t fraction = load32(p + 4, swap);
+        uint32_t captured = load32(p + 8, swap);
+        if (static_cast<size_t>(end - p - 16) < captured) break;  // truncated last packet
+
+        int64_t us = int64_t(seconds) * 1000000 + (nanos ? fraction / 1000 : fraction);
+        if (!batcher.add(reinterpret_cast<const uint8_t *>(p + 16), captured, us, false)) return true;
+        p += 16 + captured;
+        if (consumed && p - lastRelease >= RELEASE_BYTES) {
+            consumed(p);
+            lastRelease = p;
+        }
+    }
+    batcher.flush();
+    return true;
+}
+
+// Walks the options of a pcapng block body; visit(code, value, length)
+template <typename Visit>
+void forEachOption(const char *p, const char *end, bool swap, Visit visit) {
+    while (end - p >= 4) {
+        uint16_t code = load16(p, swap);
+        uint16_t length = load16(p + 2, swap);
+        if (code == OPTION_END || static_cast<size_t>(end - p - 4) < length) return;
+        visit(code, p + 4, length);
+        p += 4 + ((length + 3u) & ~3u);
+    }
+}
+
+bool parseNextGeneration(const char *begin, const char *end, FrameBatcher &batcher, std::string &error,
+                         const std::function<void(const char *)> &consumed) {
+    bool swap = false;
+    std::vector<Interface> interfaces;
+    const char *lastRelease = begin;
+    int64_t lastUs = 0;
+
+    for (const char *p = begin; end - p >= 12;) {
+        uint32_t type = load32(p, false);
+        if (type == PCAPNG_SECTION_HEADER) {
+            uint32_t order = load32(p + 8, false);
+            if (order != PCAPNG_BYTE_ORDER && order != __builtin_bswap32(PCAPNG_BYTE_ORDER)) {
+                error = "bad pcapng byte-order magic";
+                return false;
+            }
+            swap = order != PCAPNG_BYTE_ORDER;
+            interfaces.clear();
+        } else {
+            type = load32(p, swap);
+        }
+
+        uint32_t length = load32(p + 4, swap);
+        if (length < 12 || (length & 3) || static_cast<size_t>(end - p) < length) {
+            if (static_cast<size_t>(end - p) < length) break;  // truncated last block
+            error = "malformed pcapng block";
+            return false;
+        }
+        const char *body = p + 8;
+        const char *bodyEnd = p + length - 4;
+
+        if (type == BLOCK_INTERFACE_DESCRIPTION && bodyEnd - body >= 8) {
+            Interface interface{load16(body, swap), TimeResolution()};
+            forEachOption(body + 8, bodyEnd, swap, [&](uint16_t code, const char *value, uint16_t size) {
+                if (code != OPTION_IF_TSRESOL || size < 1) return;
+                uint8_t raw = static_cast<uint8_t>(value[0]);
+                interface.resolution.binary = raw & 0x80;
+                interface.resolution.exponent = raw & 0x7F;
+            });
+            interfaces.push_back(interface);
+        } else if ((type == BLOCK_ENHANCED_PACKET || type == BLOCK_PACKET_OBSOLETE) && bodyEnd - body >= 20) {
+            uint32_t ifIndex = type == BLOCK_ENHANCED_PACKET ? load32(body, swap) : load16(body, swap);
+            if (ifIndex >= interfaces.size()) {
+                error = "pcapng packet references unknown interface " + std::to_string(ifIndex);
+                return false;
+            }
+            const Interface &interface = interfaces[ifIndex];
+            uint64_t ticks = (uint64_t(load32(body + 4, swap)) << 32) | load32(body + 8, swap);
+            uint32_t captured = load32(body + 12, swap);
+            const char *data = body + 20;
+            if (static_cast<size_t>(bodyEnd - data) < captured) {
+                error = "malformed pcapng packet block";
+                return false;
+            }
+            if (interface.linkType == LINKTYPE_CAN_SOCKETCAN) {
+                bool outbound = false;
+                if (type == BLOCK_ENHANCED_PACKET) {
+                    forEachOption(data + ((captured + 3u) & ~3u), bodyEnd, swap,
+                                  [&](uint16_t code, const char *value, uint16_t size) {
+                                      if (code == OPTION_EPB_FLAGS && size >= 4)
+                                          outbound = (load32(value, swap) & 3) == EPB_FLAGS_OUTBOUND;
+                                  });
+                }
+                lastUs = interface.resolution.toMicros(ticks);
+                if (!batcher.add(reinterpret_cast<const uint8_t *>(data), captured, lastUs, outbound)) return true;
+            }
+        } else if (type == BLOCK_SIMPLE_PACKET && bodyEnd - body >= 4) {
+            // No timestamp; keep the previous packet's
+            uint32_t captured = std::min<uint32_t>(load32(body, swap), static_cast<uint32_t>(bodyEnd - body - 4));
+            if (!interfaces.empty() && interfaces[0].linkType == LINKTYPE_CAN_SOCKETCAN) {
+                if (!batcher.add(reinterpret_cast<const uint8_t *>(body + 4), captured, lastUs, false)) return true;
+            }
+        }
+
+        p += length;
+        if (consumed && p - lastRelease >= RELEASE_BYTES) {
+            consumed(p);
+            lastRelease = p;
+        }
+    }
+    batcher.flush();
+    return true;
+}
+
+}  // namespace
+
+bool isPcapCapture(const char *data, size_t size, PcapVariant *variant) {
+    if (size < 4) return false;
+    uint32_t magic = load32(data, false);
+    if (magic == PCAPNG_SECTION_HEADER) {
+        if (variant) *variant = PcapVariant::Pcapng;
+        return true;
+    }
+    for (uint32_t known : {PCAP_MAGIC_US, PCAP_MAGIC_NS}) {
+        if (magic == known || magic == __builtin_bswap32(known)) {
+            if (variant) *variant = PcapVariant::Pcap;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parsePcap(const char *begin, const char *end, const std::function<bool(const Frame *, size_t)> &sink,
+               std::string &error, PcapStats *stats, const std::function<void(const char *)> &consumed) {
+    PcapVariant variant;
+    if (!isPcapCapture(begin, static_cast<size_t>(end - begin), &variant)) {
+        error = "not a pcap or pcapng capture";
+        return false;
+    }
+    PcapStats local;
+    FrameBatcher batcher(sink, stats ? *stats : local);
+    return variant == PcapVariant::Pcap ? parseClassic(begin, end, batcher, error, consumed)
+                                        : parseNextGeneration(begin, end, batcher, error, consumed);
+}
+
+void appendPcapHeader(std::string &out, PcapVariant variant, const std::string &interfaceName) {
+    if (variant == PcapVariant::Pcap) {
+        put<uint32_t>(out, PCAP_MAGIC_US);
+        put<uint16_t>(out, 2);  // version 2.4
+        put<uint16_t>(out, 4);
+        put<int32_t>(out, 0);   // thiszone
+        put<uint32_t>(out, 0);  // sigfigs
+        put<uint32_t>(out, SOCKETCAN_FRAME_SIZE);
+        put<uint32_t>(out, LINKTYPE_CAN_SOCKETCAN);
+        return;
+    }
+
+    // Section header: byte-order magic, version 1.0, unknown section length
+    put<uint32_t>(out, PCAPNG_SECTION_HEADER);
+    put<uint32_t>(out, 28);
+    put<uint32_t>(out, PCAPNG_BYTE_ORDER);
+    put<uint16_t>(out, 1);
+    put<uint16_t>(out, 0);
+    put<int64_t>(out, -1);
+    put<uint32_t>(out, 28);
+
+    // Interface description with if_name; microsecond resolution is the default
+    uint32_t nameLength = static_cast<uint32_t>(interfaceName.size());
+    uint32_t namePadded = (nameLength + 3u) & ~3u;
+    uint32_t length = 20 + (nameLength ? 4 + namePadded + 4 : 0);
+    put<uint32_t>(out, BLOCK_INTERFACE_DESCRIPTION);
+    put<uint32_t>(out, length);
+    put<uint16_t>(out, static_cast<uint16_t>(LINKTYPE_CAN_SOCKETCAN));
+    put<uint16_t>(out, 0);
+    put<uint32_t>(out, SOCKETCAN_FRAME_SIZE);
+    if (nameLength) {
+        put<uint16_t>(out, OPTION_IF_NAME);
+        put<uint16_t>(out, static_cast<uint16_t>(nameLength));
+        out += interfaceName;
+        out.append(namePadded - nameLength, '\0');
+        put<uint32_t>(out, OPTION_END);
+    }
+    put<uint32_t>(out, length);
+}
+
+void appendPcapFrame(std::string &out, PcapVariant variant, const Frame &frame) {
+    uint64_t us = frame.timestampUs > 0 ? static_cast<uint64_t>(frame.timestampUs) : 0;
+    bool outbound = frame.flags & FRAME_TX;
+
+    if (variant == PcapVariant::Pcap) {
+        put<uint32_t>(out, static_cast<uint32_t>(us / 1000000));
+        put<uint32_t>(out, static_cast<uint32_t>(us % 1000000));
+        put<uint32_t>(out, SOCKETCAN_FRAME_SIZE);
+        put<uint32_t>(out, SOCKETCAN_FRAME_SIZE);
+    } else {
+        uint32_t length = 32 + SOCKETCAN_FRAME_SIZE + (outbound ? 12 : 0);
+        put<uint32_t>(out, BLOCK_ENHANCED_PACKET);
+        put<uint32_t>(out, length);
+        put<uint32_t>(out, 0);  // interface
+        put<uint32_t>(out, static_cast<uint32_t>(us >> 32));
+        put<uint32_t>(out, static_cast<uint32_t>(us));
+        put<uint32_t>(out, SOCKETCAN_FRAME_SIZE);
+        put<uint32_t>(out, SOCKETCAN_FRAME_SIZE);
+    }
+
+    uint32_t canId = (frame.flags & FRAME_EXTENDED) ? (frame.id & CAN_EFF_MASK) | CAN_EFF_FLAG : frame.id & CAN_SFF_MASK;
+    uint8_t packet[SOCKETCAN_FRAME_SIZE] = {static_cast<uint8_t>(canId >> 24), static_cast<uint8_t>(canId >> 16),
+                                            static_cast<uint8_t>(canId >> 8), static_cast<uint8_t>(canId),
+                                            static_cast<uint8_t>(frame.dlc > 8 ? 8 : frame.dlc)};
+    std::memcpy(packet + 8, frame.data, packet[4]);
+    out.append(reinterpret_cast<const char *>(packet), sizeof(packet));
+
+    if (variant == PcapVariant::Pcapng) {
+        uint32_t length = 32 + SOCKETCAN_FRAME_SIZE;
+        if (outbound) {
+            put<uint16_t>(out, OPTION_EPB_FLAGS);
+            put<uint16_t>(out, 4);
+            put<uint32_t>(out, EPB_FLAGS_OUTBOUND);
+            put<uint32_t>(out, OPTION_END);
+            length += 12;
+        }
+        put<uint32_t>(out, length);
+    }
+}
+
+}  // namespace idrive
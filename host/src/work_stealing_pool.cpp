@@ -0,0 +1,108 @@
+#include "idrive/work_stealing_pool.h"
+
+namespace idrive {
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (unsigned i = 0; i < threads; i++) queues_.push_back(std::make_unique<WorkQueue>());
+    for (unsigned i = 1; i < threads; i++) threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto &thread : threads_) thread.join();
+}
+
+bool WorkStealingPool::popLocal(unsigned worker, size_t &item) {
+    WorkQueue &queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.items.empty()) return false;
+    item = queue.items.back();
+    queue.items.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned thief, size_t &item) {
+    size_t n = queues_.size();
+    for (size_t offset = 1; offset < n; offset++) {
+        WorkQueue &victim = *queues_[(thief + offset) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.items.empty()) continue;
+        item = victim.items.front();
+        victim.items.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::drain(unsigned worker) {
+    size_t item;
+    while (popLocal(worker, item) || steal(worker, item)) {
+        (*task_)(item);
+        remaining_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void WorkStealingPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+            busyWorkers_++;
+        }
+
+        drain(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busyWorkers_--;
+        }
+        done_.notify_all();
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t count, const std::function<void(size_t)> &task) {
+    if (count == 0) return;
+
+    // Publish the task before any index becomes visible: a worker still
+    // finishing the previous call may pick up new items as soon as they land.
+    remaining_.store(count, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+    }
+
+    // Deal indices in contiguous runs so neighbouring chunks start on the
+    // same worker (better locality); stealing takes from the far end.
+    size_t n = queues_.size();
+    for (size_t i = 0; i < count; i++) {
+        WorkQueue &queue = *queues_[i * n / count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.items.push_front(i);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_++;
+    }
+    wake_.notify_all();
+
+    drain(0);
+
+    // All items are claimed once the caller's drain returns; wait until the
+    // last in-flight item finishes and every worker has left drain()
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return remaining_.load(std::memory_order_acquire) == 0 && busyWorkers_ == 0; });
+    task_ = nullptr;
+}
+
+}  // namespace idrive
@@ -0,0 +1,42 @@
+#pragma once
+
+// Minimal checks for the host unit tests. CHECK(condition) and
+// CHECK_EQ(actual, expected) report the failing expression with its line
+// and let the test carry on; main() returns check::result() so CTest sees
+// the failure. CHECK_EQ is for integral values.
+
+#include <cstdio>
+
+namespace check {
+
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void fail(const char *file, int line, const char *expression) {
+    std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+    failures()++;
+}
+
+template <typename A, typename B>
+void equal(const char *file, int line, const char *expression, const A &actual, const B &expected) {
+    if (actual == expected) return;
+    std::fprintf(stderr, "%s:%d: CHECK_EQ(%s) failed: %lld != %lld\n", file, line, expression,
+                 static_cast<long long>(actual), static_cast<long long>(expected));
+    failures()++;
+}
+
+inline int result() {
+    if (failures()) std::fprintf(stderr, "%d check(s) failed\n", failures());
+    return failures() ? 1 : 0;
+}
+
+}  // namespace check
+
+#define CHECK(condition)                                                     \
+    do {                                                                     \
+        if (!(condition)) check::fail(__FILE__, __LINE__, #condition);       \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) check::equal(__FILE__, __LINE__, #actual ", " #expected, (actual), (expected))
@@ -0,0 +1,100 @@
+// Sliding windows of the bus load estimator (src/bus_load_window.h), fed
+// the way busLoadRecord() does: advance to the frame's bin, then add.
+
+#include "check.h"
+
+#include "bus_load_window.h"
+
+#include <cstdint>
+
+namespace {
+
+constexpr uint16_t BITS_PER_BIN = 1000;
+
+// One bin's worth of traffic every BUS_LOAD_BIN_MS from startMs up to endMs
+void feed(BusLoadWindows &windows, uint32_t startMs, uint32_t endMs) {
+    for (uint32_t ms = startMs; ms < endMs; ms += BUS_LOAD_BIN_MS) {
+        windows.advanceTo(ms / BUS_LOAD_BIN_MS);
+        windows.add(BITS_PER_BIN / 4);
+        windows.add(BITS_PER_BIN / 4);
+        windows.add(BITS_PER_BIN / 2);
+    }
+}
+
+uint32_t full(uint8_t window) {
+    return static_cast<uint32_t>(BUS_LOAD_WINDOW_BINS[window]) * BITS_PER_BIN;
+}
+
+// Traffic that starts a while after boot must settle on the exact rate in
+// every window; the 10 s window used to subtract bins it never added
+void steadyTrafficAfterLateStart() {
+    BusLoadWindows windows;
+    feed(windows, 500, 30000);
+    for (uint8_t w = 0; w < BUS_LOAD_WINDOW_COUNT; w++) CHECK_EQ(windows.bits(w), full(w));
+    CHECK_EQ(windows.peakShortWindowBits(), full(0));
+}
+
+void steadyTrafficFromBinZero() {
+    BusLoadWindows windows;
+    feed(windows, 0, 25000);
+    for (uint8_t w = 0; w < BUS_LOAD_WINDOW_COUNT; w++) CHECK_EQ(windows.bits(w), full(w));
+}
+
+// Before a window has filled it holds everything seen so far
+void windowsFillingUp() {
+    BusLoadWindows windows;
+    feed(windows, 1230, 1230 + 2000);
+    CHECK_EQ(windows.bits(0), full(0));
+    CHECK_EQ(windows.bits(1), full(1));
+    CHECK_EQ(windows.bits(2), 200u * BITS_PER_BIN);
+}
+
+// Silence ages traffic out window by window
+void trafficStops() {
+    BusLoadWindows windows;
+    feed(windows, 500, 20500);
+    windows.advanceTo(20500 / BUS_LOAD_BIN_MS + 99);  // 1 s since the last bin
+    CHECK_EQ(windows.bits(0), 0u);
+    CHECK_EQ(windows.bits(1), 0u);
+    CHECK_EQ(windows.bits(2), 900u * BITS_PER_BIN);
+
+    windows.advanceTo(20500 / BUS_LOAD_BIN_MS + 999);
+    CHECK_EQ(windows.bits(2), 0u);
+}
+
+// A gap longer than the ring clears everything, and counting resumes cleanly
+void gapLongerThanRing() {
+    BusLoadWindows windows;
+    feed(windows, 500, 4500);
+    feed(windows, 60000, 75000);
+    for (uint8_t w = 0; w < BUS_LOAD_WINDOW_COUNT; w++) CHECK_EQ(windows.bits(w), full(w));
+
+    windows.advanceTo(200000 / BUS_LOAD_BIN_MS);
+    for (uint8_t w = 0; w < BUS_LOAD_WINDOW_COUNT; w++) CHECK_EQ(windows.bits(w), 0u);
+}
+
+// Bursts in single bins with idle bins between
+void sparseBins() {
+    BusLoadWindows windows;
+    uint32_t bin = 777;
+    for (int i = 0; i < 3000; i++, bin += 7) {
+        windows.advanceTo(bin);
+        windows.add(70);
+    }
+    // Every 7th bin carries 70 bits; the current bin is always one of them
+    CHECK_EQ(windows.bits(0), 2u * 70);
+    CHECK_EQ(windows.bits(1), 15u * 70);
+    CHECK_EQ(windows.bits(2), 143u * 70);
+}
+
+}  // namespace
+
+int main() {
+    steadyTrafficAfterLateStart();
+    steadyTrafficFromBinZero();
+    windowsFillingUp();
+    trafficStops();
+    gapLongerThanRing();
+    sparseBins();
+    return check::result();
+}
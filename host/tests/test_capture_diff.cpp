@@ -0,0 +1,119 @@
+// Capture diff (idrive/capture_diff.h) between a timed capture and an
+// untimed one: the parser's synthetic 1 ms spacing must not show up as
+// period findings or rates, while payload findings still do.
+
+#include "check.h"
+
+#include "idrive/capture.h"
+#include "idrive/capture_diff.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 0x25B every 100 ms and 0x0BF every 20 ms; byte 4 of 0x25B is 0x20 in
+// every other frame when buttonActivity is set. extraId adds one more ID.
+std::string capture(idrive::CaptureFormat format, int64_t periodScale, bool buttonActivity, uint32_t extraId = 0) {
+    std::string text;
+    char line[160];
+    int n25B = 0;
+    for (int64_t ms = 0; ms < 20000; ms += 20 * periodScale) {
+        struct {
+            uint32_t id;
+            uint8_t  byte4;
+        } frames[3];
+        int count = 0;
+        frames[count++] = {0x0BF, 0x00};
+        if (ms % (100 * periodScale) == 0) {
+            frames[count++] = {0x25B, static_cast<uint8_t>(buttonActivity && (n25B++ % 2) ? 0x20 : 0x00)};
+        }
+        if (extraId && ms % (500 * periodScale) == 0) frames[count++] = {extraId, 0x00};
+
+        for (int i = 0; i < count; i++) {
+            if (format == idrive::CaptureFormat::Putty) {
+                std::snprintf(line, sizeof(line),
+                              "Standard ID: 0x%03X       DLC: 8  Data: 0x00 0xFF 0x7F 0x00 0x%02X 0x00 0xC0 0xC0\r\n",
+                              frames[i].id, frames[i].byte4);
+            } else {
+                std::snprintf(line, sizeof(line), "[%6lldms] [RAW] 0x%X: 00 FF 7F 00 %02X 00 C0 C0\r\n",
+                              static_cast<long long>(ms), frames[i].id, frames[i].byte4);
+            }
+            text += line;
+        }
+    }
+    return text;
+}
+
+idrive::CaptureProfile profile(const std::string &text, idrive::CaptureFormat format) {
+    std::vector<idrive::Frame> frames;
+    idrive::parseCapture(text.data(), text.data() + text.size(), format, frames);
+    idrive::CaptureProfile out;
+    out.add(frames.data(), frames.size());
+    return out;
+}
+
+size_t count(const std::vector<idrive::DiffFinding> &findings, idrive::DiffFinding::Kind kind) {
+    size_t n = 0;
+    for (const auto &finding : findings) n += finding.kind == kind;
+    return n;
+}
+
+bool anyRate(const std::vector<idrive::DiffFinding> &findings) {
+    for (const auto &finding : findings) {
+        if (finding.detail.find("/s") != std::string::npos || finding.detail.find("period") != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Timed baseline, untimed target with button activity and a new ID
+void timedAgainstUntimed() {
+    idrive::CaptureProfile timed = profile(capture(idrive::CaptureFormat::DeviceRaw, 1, false, 0x5E7),
+                                           idrive::CaptureFormat::DeviceRaw);
+    idrive::CaptureProfile untimed = profile(capture(idrive::CaptureFormat::Putty, 1, true, 0x567),
+                                             idrive::CaptureFormat::Putty);
+    CHECK(!timed.syntheticTime());
+    CHECK(untimed.syntheticTime());
+
+    for (int direction = 0; direction < 2; direction++) {
+        auto findings = direction ? idrive::diffProfiles(untimed, timed) : idrive::diffProfiles(timed, untimed);
+        CHECK_EQ(count(findings, idrive::DiffFinding::Kind::Period), 0u);
+        CHECK(!anyRate(findings));
+        CHECK_EQ(count(findings, idrive::DiffFinding::Kind::NewId), 1u);
+        CHECK_EQ(count(findings, idrive::DiffFinding::Kind::GoneId), 1u);
+
+        bool byte4 = false;
+        for (const auto &finding : findings) {
+            byte4 = byte4 || (finding.kind == idrive::DiffFinding::Kind::Byte && finding.id == 0x25B && finding.byte == 4);
+        }
+        CHECK(byte4);
+    }
+}
+
+// Two timed captures still report a real period change and rates
+void timedAgainstTimed() {
+    idrive::CaptureProfile fast = profile(capture(idrive::CaptureFormat::DeviceRaw, 1, false, 0x5E7),
+                                          idrive::CaptureFormat::DeviceRaw);
+    idrive::CaptureProfile slow = profile(capture(idrive::CaptureFormat::DeviceRaw, 2, false),
+                                          idrive::CaptureFormat::DeviceRaw);
+    auto findings = idrive::diffProfiles(fast, slow);
+    CHECK_EQ(count(findings, idrive::DiffFinding::Kind::Period), 2u);
+    CHECK(anyRate(findings));
+
+    // Identical untimed captures differ in nothing
+    idrive::CaptureProfile untimed = profile(capture(idrive::CaptureFormat::Putty, 1, false),
+                                             idrive::CaptureFormat::Putty);
+    CHECK(idrive::diffProfiles(untimed, untimed).empty());
+}
+
+}  // namespace
+
+int main() {
+    timedAgainstUntimed();
+    timedAgainstTimed();
+    return check::result();
+}
@@ -0,0 +1,171 @@
+// Block index of the .icap container (idrive/capture_file.h): the per-block
+// ID bloom filter and the time/ID queries that rely on it.
+
+#include "check.h"
+
+#include "idrive/capture_file.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+// A bloom filter may say yes to an absent ID but never no to a present one
+void noFalseNegatives() {
+    uint64_t bloom[idrive::CAPTURE_BLOOM_WORDS] = {};
+    for (uint32_t id = 0; id < 0x800; id += 3) idrive::bloomAdd(bloom, id, false);
+    for (uint32_t id = 0x18DA0000; id < 0x18DA0100; id++) idrive::bloomAdd(bloom, id, true);
+
+    for (uint32_t id = 0; id < 0x800; id += 3) CHECK(idrive::bloomMayContain(bloom, id, false));
+    for (uint32_t id = 0x18DA0000; id < 0x18DA0100; id++) CHECK(idrive::bloomMayContain(bloom, id, true));
+}
+
+// A block carries a handful of IDs; the filter has to reject most others.
+// 5 IDs, 3 probes, 512 bits: about 2.4e-5 expected, so 1% is a loose bound.
+void fewFalsePositives() {
+    static const uint32_t present[] = {0x0BF, 0x25B, 0x510, 0x567, 0x5E7};
+    uint64_t bloom[idrive::CAPTURE_BLOOM_WORDS] = {};
+    for (uint32_t id : present) idrive::bloomAdd(bloom, id, false);
+
+    size_t positives = 0, tested = 0;
+    for (uint32_t id = 0; id < 0x800; id++) {
+        bool isPresent = false;
+        for (uint32_t p : present) isPresent = isPresent || p == id;
+        if (isPresent) continue;
+        tested++;
+        if (idrive::bloomMayContain(bloom, id, false)) positives++;
+    }
+    CHECK(positives * 100 <= tested);
+}
+
+// Standard and extended frames with the same number are different IDs
+void extendedIsDistinct() {
+    uint64_t bloom[idrive::CAPTURE_BLOOM_WORDS] = {};
+    size_t positives = 0;
+    for (uint32_t id = 0; id < 64; id++) idrive::bloomAdd(bloom, id, false);
+    for (uint32_t id = 0x400; id < 0x800; id++) {
+        if (idrive::bloomMayContain(bloom, id, true)) positives++;
+    }
+    CHECK(positives < 0x400 / 10);
+}
+
+idrive::Frame frame(int64_t timestampUs, uint32_t id, bool extended = false) {
+    idrive::Frame f{};
+    f.timestampUs = timestampUs;
+    f.id = id;
+    f.dlc = 8;
+    f.flags = extended ? idrive::FRAME_EXTENDED : 0;
+    f.data[0] = static_cast<uint8_t>(timestampUs);
+    return f;
+}
+
+std::string tempPath() {
+    char path[] = "/tmp/idrive_test_XXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd >= 0) ::close(fd);
+    return path;
+}
+
+// Writes blocks of 64 frames, each block carrying its own rare ID next to
+// common traffic, and checks every query against a plain scan
+void queriesMatchScan() {
+    constexpr uint32_t FRAMES_PER_BLOCK = 64;
+    std::vector<idrive::Frame> frames;
+    for (int64_t i = 0; i < 20 * FRAMES_PER_BLOCK; i++) {
+        uint32_t block = static_cast<uint32_t>(i / FRAMES_PER_BLOCK);
+        if (i % FRAMES_PER_BLOCK == 7) frames.push_back(frame(i * 1000, 0x600 + block));
+        else if (i % FRAMES_PER_BLOCK == 9) frames.push_back(frame(i * 1000, 0x600 + block, true));
+        else frames.push_back(frame(i * 1000, (i % 2) ? 0x0BF : 0x25B));
+    }
+
+    std::string path = tempPath();
+    idrive::CaptureFileWriter writer;
+    CHECK(writer.open(path, FRAMES_PER_BLOCK));
+    CHECK(writer.append(frames.data(), frames.size()));
+    CHECK(writer.close());
+
+    idrive::CaptureFileReader reader;
+    bool opened = reader.open(path);
+    ::unlink(path.c_str());
+    CHECK(opened);
+    if (!opened) return;
+    CHECK_EQ(reader.blockCount(), 20u);
+    CHECK(reader.timeOrdered());
+
+    // Every block's filter holds every ID stored in it
+    for (size_t b = 0; b < reader.blockCount(); b++) {
+        const idrive::Frame *stored = reader.blockFrames(b);
+        for (uint32_t f = 0; f < reader.block(b).frameCount; f++) {
+            CHECK(idrive::bloomMayContain(reader.block(b).idBloom, stored[f].id,
+                                          stored[f].flags & idrive::FRAME_EXTENDED));
+        }
+    }
+
+    struct Case {
+        int64_t  fromUs, toUs;
+        bool     filterId;
+        uint32_t id;
+        bool     extended;
+    };
+    static const Case cases[] = {
+        {INT64_MIN, INT64_MAX, false, 0, false},
+        {100000, 300000, false, 0, false},
+        {INT64_MIN, INT64_MAX, true, 0x0BF, false},
+        {INT64_MIN, INT64_MAX, true, 0x605, false},
+        {INT64_MIN, INT64_MAX, true, 0x605, true},
+        {INT64_MIN, INT64_MAX, true, 0x7FF, false},
+        {64000, 64000 * 4 - 1, true, 0x602, false},
+        {64000, 64000 * 4 - 1, true, 0x610, false},
+        {2000000, 3000000, false, 0, false},
+    };
+    for (const Case &c : cases) {
+        idrive::CaptureQuery query;
+        query.fromUs = c.fromUs;
+        query.toUs = c.toUs;
+        query.filterId = c.filterId;
+        query.id = c.id;
+        query.extended = c.extended;
+
+        std::vector<idrive::Frame> expected;
+        for (const idrive::Frame &f : frames) {
+            if (f.timestampUs < c.fromUs || f.timestampUs > c.toUs) continue;
+            if (c.filterId && (f.id != c.id || bool(f.flags & idrive::FRAME_EXTENDED) != c.extended)) continue;
+            expected.push_back(f);
+        }
+
+        std::vector<idrive::Frame> found;
+        idrive::QueryStats stats;
+        reader.query(query, found, &stats);
+        CHECK_EQ(found.size(), expected.size());
+        CHECK(found.size() == expected.size() &&
+              (found.empty() || std::memcmp(found.data(), expected.data(), found.size() * sizeof(idrive::Frame)) == 0));
+        CHECK_EQ(stats.framesMatched, expected.size());
+        CHECK(stats.blocksRead <= stats.blocksInRange);
+    }
+
+    // A rare ID lives in one block; the filter should skip nearly all others
+    idrive::CaptureQuery rare;
+    rare.filterId = true;
+    rare.id = 0x605;
+    idrive::QueryStats stats;
+    std::vector<idrive::Frame> found;
+    reader.query(rare, found, &stats);
+    CHECK_EQ(found.size(), 1u);
+    CHECK_EQ(stats.blocksInRange, 20u);
+    CHECK(stats.blocksRead <= 2);
+}
+
+}  // namespace
+
+int main() {
+    noFalseNegatives();
+    fewFalsePositives();
+    extendedIsDistinct();
+    queriesMatchScan();
+    return check::result();
+}
@@ -0,0 +1,230 @@
+// Shared-memory event ring (idrive/event_ring.h): ordering across the wrap,
+// a lapped reader skipping to the oldest intact record and counting what it
+// lost, attaching from the oldest record, writer restarts, and a reader
+// racing the writer.
+
+#include "check.h"
+
+#include "idrive/event_ring.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t SLOTS = 64;
+
+std::string ringName(const char *test) {
+    return "/idrive-test-" + std::to_string(::getpid()) + "-" + test;
+}
+
+// Sequence number in both hostNs and the payload, so torn copies show
+void publishSequence(idrive::EventRingWriter &writer, uint64_t sequence) {
+    idrive::RingRecord record{};
+    record.hostNs = static_cast<int64_t>(sequence);
+    record.kind = static_cast<uint8_t>(idrive::DeviceEventKind::Latency);
+    record.latencySequence = static_cast<uint32_t>(sequence);
+    writer.publish(record);
+}
+
+// Reads until caught up; false if a record is out of order or torn
+bool readInOrder(idrive::EventRingReader &reader, uint64_t &expected, uint64_t &count) {
+    idrive::RingRecord record;
+    while (reader.next(record)) {
+        uint64_t sequence = static_cast<uint64_t>(record.hostNs);
+        if (record.latencySequence != static_cast<uint32_t>(sequence) || sequence != expected) return false;
+        expected++;
+        count++;
+    }
+    return true;
+}
+
+// A reader that keeps up sees every record in order across many wraps
+void keepsUpAcrossWrap() {
+    std::string name = ringName("wrap");
+    idrive::EventRingWriter writer;
+    CHECK(writer.create(name.c_str(), 50));  // rounded up to 64
+    CHECK_EQ(writer.slotCount(), SLOTS);
+
+    idrive::EventRingReader reader;
+    CHECK(reader.attach(name.c_str()));
+    idrive::RingRecord record;
+    CHECK(!reader.next(record));
+
+    uint64_t expected = 0, count = 0;
+    bool ordered = true;
+    for (uint64_t sequence = 0; sequence < 10 * SLOTS + 7; sequence++) {
+        publishSequence(writer, sequence);
+        if (sequence % (SLOTS / 2) == 0) ordered = readInOrder(reader, expected, count) && ordered;
+    }
+    ordered = readInOrder(reader, expected, count) && ordered;
+    CHECK(ordered);
+    CHECK_EQ(count, 10u * SLOTS + 7);
+    CHECK_EQ(reader.lost(), 0u);
+    CHECK_EQ(reader.backlog(), 0u);
+
+    idrive::EventRingWriter::unlink(name.c_str());
+}
+
+// A reader lapped several times resumes at the oldest intact record and
+// accounts for every record it skipped
+void lappedReaderSkipsAhead() {
+    std::string name = ringName("lap");
+    idrive::EventRingWriter writer;
+    CHECK(writer.create(name.c_str(), SLOTS));
+    idrive::EventRingReader reader;
+    CHECK(reader.attach(name.c_str()));
+
+    for (uint64_t sequence = 0; sequence < 10; sequence++) publishSequence(writer, sequence);
+    uint64_t expected = 0, count = 0;
+    CHECK(readInOrder(reader, expected, count));
+    CHECK_EQ(count, 10u);
+
+    const uint64_t total = 3 * SLOTS + 5;
+    for (uint64_t sequence = 10; sequence < total; sequence++) publishSequence(writer, sequence);
+    CHECK_EQ(reader.backlog(), total - 10);
+
+    idrive::RingRecord record;
+    CHECK(reader.next(record));
+    uint64_t oldest = total - (SLOTS - 1);
+    CHECK_EQ(static_cast<uint64_t>(record.hostNs), oldest);
+    CHECK_EQ(reader.lost(), oldest - 10);
+
+    expected = oldest + 1;
+    count = 1;
+    CHECK(readInOrder(reader, expected, count));
+    CHECK_EQ(expected, total);
+    CHECK_EQ(10 + count + reader.lost(), total);
+
+    // Lapped by exactly one record: the slot it wants now holds a newer one
+    for (uint64_t sequence = total; sequence < total + SLOTS + 1; sequence++) publishSequence(writer, sequence);
+    uint64_t lostBefore = reader.lost();
+    CHECK(reader.next(record));
+    CHECK_EQ(static_cast<uint64_t>(record.hostNs), total + 2);
+    CHECK_EQ(reader.lost() - lostBefore, 2u);
+
+    idrive::EventRingWriter::unlink(name.c_str());
+}
+
+// fromOldest starts at the first record before the wrap and at the oldest
+// intact one after it
+void attachFromOldest() {
+    std::string name = ringName("oldest");
+    idrive::EventRingWriter writer;
+    CHECK(writer.create(name.c_str(), SLOTS));
+    for (uint64_t sequence = 0; sequence < 20; sequence++) publishSequence(writer, sequence);
+
+    idrive::EventRingReader early;
+    CHECK(early.attach(name.c_str(), true));
+    uint64_t expected = 0, count = 0;
+    CHECK_EQ(early.backlog(), 20u);
+    CHECK(readInOrder(early, expected, count));
+    CHECK_EQ(count, 20u);
+
+    for (uint64_t sequence = 20; sequence < 5 * SLOTS; sequence++) publishSequence(writer, sequence);
+    idrive::EventRingReader late;
+    CHECK(late.attach(name.c_str(), true));
+    expected = 5 * SLOTS - (SLOTS - 1);
+    count = 0;
+    CHECK(readInOrder(late, expected, count));
+    CHECK_EQ(count, SLOTS - 1u);
+    CHECK_EQ(late.lost(), 0u);
+
+    idrive::EventRingWriter::unlink(name.c_str());
+}
+
+// A restarted writer with the same layout continues the sequence under
+// attached readers; one with another layout replaces the segment
+void writerRestart() {
+    std::string name = ringName("restart");
+    idrive::EventRingReader reader;
+    {
+        idrive::EventRingWriter writer;
+        CHECK(writer.create(name.c_str(), SLOTS));
+        CHECK(reader.attach(name.c_str()));
+        for (uint64_t sequence = 0; sequence < SLOTS + 3; sequence++) publishSequence(writer, sequence);
+    }
+    CHECK(reader.writerClosed());
+
+    idrive::EventRingWriter writer;
+    CHECK(writer.create(name.c_str(), SLOTS));
+    CHECK_EQ(writer.published(), SLOTS + 3u);
+    CHECK(!reader.writerClosed());
+    publishSequence(writer, SLOTS + 3);
+
+    idrive::RingRecord record;
+    uint64_t last = 0;
+    size_t count = 0;
+    while (reader.next(record)) {
+        last = static_cast<uint64_t>(record.hostNs);
+        count++;
+    }
+    CHECK_EQ(last, SLOTS + 3u);
+    CHECK_EQ(count + reader.lost(), SLOTS + 4u);
+    CHECK(!reader.unlinked());
+
+    idrive::EventRingWriter resized;
+    CHECK(resized.create(name.c_str(), 2 * SLOTS));
+    CHECK(reader.unlinked());
+    CHECK_EQ(resized.published(), 0u);
+
+    idrive::EventRingWriter::unlink(name.c_str());
+}
+
+// The writer laps a slower reader many times over; every record the reader
+// gets is intact and in order, and read + lost covers the whole stream
+void concurrentReader() {
+    std::string name = ringName("race");
+    idrive::EventRingWriter writer;
+    CHECK(writer.create(name.c_str(), SLOTS));
+    idrive::EventRingReader reader;
+    CHECK(reader.attach(name.c_str()));
+
+    constexpr uint64_t TOTAL = 400000;
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (uint64_t sequence = 0; sequence < TOTAL; sequence++) {
+            publishSequence(writer, sequence);
+            if (sequence % 1024 == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t count = 0, previous = 0;
+    bool ordered = true, first = true;
+    idrive::RingRecord record;
+    for (;;) {
+        if (!reader.next(record)) {
+            if (done.load(std::memory_order_acquire) && reader.backlog() == 0) break;
+            std::this_thread::yield();
+            continue;
+        }
+        uint64_t sequence = static_cast<uint64_t>(record.hostNs);
+        if (record.latencySequence != static_cast<uint32_t>(sequence)) ordered = false;
+        if (!first && sequence <= previous) ordered = false;
+        previous = sequence;
+        first = false;
+        count++;
+    }
+    producer.join();
+    CHECK(ordered);
+    CHECK_EQ(previous, TOTAL - 1);
+    CHECK_EQ(count + reader.lost(), TOTAL);
+
+    idrive::EventRingWriter::unlink(name.c_str());
+}
+
+}  // namespace
+
+int main() {
+    keepsUpAcrossWrap();
+    lappedReaderSkipsAhead();
+    attachFromOldest();
+    writerRestart();
+    concurrentReader();
+    return check::result();
+}
@@ -0,0 +1,271 @@
+// Per-ID delta codec (src/frame_codec.h): lossless round trips, the coded
+// size of steady traffic, streams cut mid-frame and malformed input.
+
+#include "check.h"
+
+#include "frame_codec.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+bool sameFrame(const CodecFrame &a, const CodecFrame &b) {
+    return a.timestampUs == b.timestampUs && a.id == b.id && a.extended == b.extended && a.dlc == b.dlc &&
+           a.flags == b.flags && std::memcmp(a.data, b.data, a.dlc) == 0;
+}
+
+CodecFrame makeFrame(int64_t timestampUs, uint32_t id, uint8_t dlc = 8, bool extended = false) {
+    CodecFrame frame{};
+    frame.timestampUs = timestampUs;
+    frame.id = id;
+    frame.extended = extended;
+    frame.dlc = dlc;
+    return frame;
+}
+
+std::vector<uint8_t> encodeAll(const std::vector<CodecFrame> &frames, size_t *largest = nullptr) {
+    FrameEncoder encoder;
+    std::vector<uint8_t> stream;
+    uint8_t buffer[CODEC_MAX_FRAME_BYTES];
+    for (const CodecFrame &frame : frames) {
+        size_t n = encoder.encode(frame, buffer);
+        if (largest && n > *largest) *largest = n;
+        stream.insert(stream.end(), buffer, buffer + n);
+    }
+    return stream;
+}
+
+// Decodes the whole stream; false on a malformed or truncated stream or a mismatch
+bool decodesTo(const std::vector<uint8_t> &stream, const std::vector<CodecFrame> &frames) {
+    FrameDecoder decoder;
+    size_t offset = 0;
+    for (const CodecFrame &expected : frames) {
+        CodecFrame frame{};
+        int n = decoder.decode(stream.data() + offset, stream.size() - offset, frame);
+        if (n <= 0 || !sameFrame(frame, expected)) return false;
+        offset += static_cast<size_t>(n);
+    }
+    return offset == stream.size();
+}
+
+// Mixed traffic: cyclic IDs with jitter and counters, random payloads,
+// extended IDs, short frames, changing flags and dlc, time going backwards,
+// and more IDs than context slots
+std::vector<CodecFrame> mixedTraffic(size_t count) {
+    std::mt19937 rng(11);
+    std::vector<CodecFrame> frames;
+    int64_t now = 1000;
+    uint8_t counter = 0;
+    for (size_t i = 0; i < count; i++) {
+        now += 200 + static_cast<int64_t>(rng() % 400);
+        CodecFrame frame;
+        switch (rng() % 8) {
+            case 0:
+                frame = makeFrame(now, 0x25B);
+                frame.data[0] = counter++;
+                frame.data[4] = (rng() % 8 == 0) ? 0x20 : 0x00;
+                break;
+            case 1:
+                frame = makeFrame(now, 0x0BF);
+                for (auto &b : frame.data) b = static_cast<uint8_t>(rng());
+                break;
+            case 2:
+                frame = makeFrame(now, 0x18DAF100 + rng() % 4, 8, true);
+                frame.data[1] = static_cast<uint8_t>(rng() % 3);
+                break;
+            case 3:
+                frame = makeFrame(now, 0x567, static_cast<uint8_t>(rng() % 9));
+                frame.data[0] = 0x40;
+                break;
+            case 4:
+                frame = makeFrame(now, 0x510);
+                frame.flags = static_cast<uint8_t>(rng() % 2);
+                break;
+            case 5:
+                frame = makeFrame(now - 5000, 0x5E7);  // late delivery
+                break;
+            default:
+                frame = makeFrame(now, 0x100 + rng() % 120);  // beyond the 63 slots
+                frame.data[7] = static_cast<uint8_t>(rng());
+                break;
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+void roundTripMixed() {
+    std::vector<CodecFrame> frames = mixedTraffic(20000);
+    size_t largest = 0;
+    std::vector<uint8_t> stream = encodeAll(frames, &largest);
+    CHECK(decodesTo(stream, frames));
+    CHECK(largest <= CODEC_MAX_FRAME_BYTES);
+}
+
+// The largest literal: 29-bit extended ID, full payload and a time jump
+// as large as an int64 delta gets
+void worstCaseFitsBound() {
+    std::vector<CodecFrame> frames = {makeFrame(INT64_MAX / 2, 0x1FFFFFFF, 8, true),
+                                      makeFrame(INT64_MIN / 2, 0x7FF), makeFrame(INT64_MAX / 2, 0x7FF)};
+    for (auto &b : frames[0].data) b = 0xFF;
+    frames[1].flags = 0xFF;
+    frames[2].flags = 0xFF;
+    frames[2].data[3] = 0x55;
+    size_t largest = 0;
+    std::vector<uint8_t> stream = encodeAll(frames, &largest);
+    CHECK(largest <= CODEC_MAX_FRAME_BYTES);
+    CHECK(decodesTo(stream, frames));
+}
+
+// Steady cyclic frames with a rolling counter are predicted exactly once the
+// period and the stride are known: one header byte each
+void steadyTrafficIsOneByte() {
+    FrameEncoder encoder;
+    uint8_t buffer[CODEC_MAX_FRAME_BYTES];
+    CodecFrame frame = makeFrame(0, 0x25B);
+    for (int i = 0; i < 100; i++) {
+        frame.timestampUs = 100000 * i;
+        frame.data[0] = static_cast<uint8_t>(i);
+        size_t n = encoder.encode(frame, buffer);
+        if (i == 0) CHECK_EQ(buffer[0] >> 6, CODEC_OP_LITERAL);
+        if (i >= 3) {
+            CHECK_EQ(n, 1u);
+            CHECK_EQ(buffer[0] >> 6, CODEC_OP_PREDICTED);
+        }
+    }
+
+    // Jitter costs one residual byte, a changed byte one XOR byte more
+    frame.timestampUs = 100000 * 100 + 20;
+    frame.data[0] = 100;
+    CHECK_EQ(encoder.encode(frame, buffer), 2u);
+    CHECK_EQ(buffer[0] >> 6, CODEC_OP_REPEAT);
+    frame.timestampUs = 100000 * 101;
+    frame.data[0] = 101;
+    frame.data[5] = 0x80;
+    CHECK_EQ(encoder.encode(frame, buffer), 4u);
+    CHECK_EQ(buffer[0] >> 6, CODEC_OP_XOR);
+}
+
+// dlc above 8 is clamped and bytes past dlc are not carried
+void dlcClampedAndTailIgnored() {
+    CodecFrame wide = makeFrame(10, 0x123, 12);
+    CodecFrame shortFrame = makeFrame(20, 0x124, 3);
+    for (uint8_t i = 0; i < 8; i++) shortFrame.data[i] = static_cast<uint8_t>(0xA0 + i);
+    std::vector<uint8_t> stream = encodeAll({wide, shortFrame});
+
+    FrameDecoder decoder;
+    CodecFrame frame{};
+    int n = decoder.decode(stream.data(), stream.size(), frame);
+    CHECK(n > 0);
+    CHECK_EQ(frame.dlc, 8);
+    n = decoder.decode(stream.data() + n, stream.size() - static_cast<size_t>(n), frame);
+    CHECK(n > 0);
+    CHECK_EQ(frame.dlc, 3);
+    CHECK_EQ(frame.data[2], 0xA2);
+    CHECK_EQ(frame.data[3], 0);
+}
+
+// Every proper prefix of a frame asks for more input without consuming or
+// committing anything; the full frame then decodes as usual
+void truncatedFramesWait() {
+    std::vector<CodecFrame> frames = mixedTraffic(500);
+    std::vector<uint8_t> stream = encodeAll(frames);
+
+    FrameDecoder decoder;
+    size_t offset = 0;
+    bool ok = true;
+    for (const CodecFrame &expected : frames) {
+        CodecFrame frame{};
+        size_t length = 1;
+        int n;
+        while ((n = decoder.decode(stream.data() + offset, length, frame)) == 0) {
+            if (offset + length >= stream.size()) break;
+            length++;
+        }
+        if (n <= 0 || static_cast<size_t>(n) != length || !sameFrame(frame, expected)) {
+            ok = false;
+            break;
+        }
+        offset += length;
+    }
+    CHECK(ok);
+    CHECK_EQ(offset, stream.size());
+
+    CodecFrame frame{};
+    CHECK_EQ(decoder.decode(stream.data(), 0, frame), 0);
+}
+
+void malformedStreams() {
+    CodecFrame frame{};
+
+    // Coded frame for a context no literal has bound yet
+    {
+        FrameDecoder decoder;
+        const uint8_t unbound[] = {CODEC_OP_PREDICTED << 6 | 5};
+        CHECK_EQ(decoder.decode(unbound, sizeof(unbound), frame), -1);
+        const uint8_t noContext[] = {CODEC_OP_REPEAT << 6 | CODEC_NO_CONTEXT, 0x02};
+        CHECK_EQ(decoder.decode(noContext, sizeof(noContext), frame), -1);
+    }
+
+    // Literal with dlc 9
+    {
+        FrameDecoder decoder;
+        const uint8_t literal[] = {CODEC_OP_LITERAL << 6 | 0, 0x00, 0x02, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        CHECK_EQ(decoder.decode(literal, sizeof(literal), frame), -1);
+    }
+
+    // Varint longer than 64 bits
+    {
+        FrameDecoder decoder;
+        uint8_t literal[16] = {CODEC_OP_LITERAL << 6 | 0};
+        for (size_t i = 1; i < sizeof(literal); i++) literal[i] = 0xFF;
+        CHECK_EQ(decoder.decode(literal, sizeof(literal), frame), -1);
+    }
+
+    // XOR mask naming bytes past the bound dlc
+    {
+        FrameDecoder decoder;
+        const uint8_t literal[] = {CODEC_OP_LITERAL << 6 | 2, 0x00, 0x02, 2, 0, 0x11, 0x22};
+        CHECK_EQ(decoder.decode(literal, sizeof(literal), frame), static_cast<int>(sizeof(literal)));
+        const uint8_t badMask[] = {CODEC_OP_XOR << 6 | 2, 0x00, 0x04, 0x33};
+        CHECK_EQ(decoder.decode(badMask, sizeof(badMask), frame), -1);
+        const uint8_t goodMask[] = {CODEC_OP_XOR << 6 | 2, 0x00, 0x02, 0x33};
+        CHECK_EQ(decoder.decode(goodMask, sizeof(goodMask), frame), static_cast<int>(sizeof(goodMask)));
+        CHECK_EQ(frame.data[1], 0x22 ^ 0x33);
+    }
+}
+
+// Encoder and decoder reset at the same point keep the stream decodable
+void resetBothSides() {
+    std::vector<CodecFrame> frames = mixedTraffic(300);
+    FrameEncoder encoder;
+    FrameDecoder decoder;
+    uint8_t buffer[CODEC_MAX_FRAME_BYTES];
+    bool ok = true;
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (i % 100 == 50) {
+            encoder.reset();
+            decoder.reset();
+        }
+        size_t n = encoder.encode(frames[i], buffer);
+        CodecFrame frame{};
+        if (decoder.decode(buffer, n, frame) != static_cast<int>(n) || !sameFrame(frame, frames[i])) ok = false;
+    }
+    CHECK(ok);
+}
+
+}  // namespace
+
+int main() {
+    roundTripMixed();
+    worstCaseFitsBound();
+    steadyTrafficIsOneByte();
+    dlcClampedAndTailIgnored();
+    truncatedFramesWait();
+    malformedStreams();
+    resetBothSides();
+    return check::result();
+}
@@ -0,0 +1,177 @@
+// DBC signal extraction (src/signal_decode.h) against a bit-by-bit
+// reference that walks the DBC numbering directly, for every Intel and
+// Motorola layout that fits an 8-byte payload.
+
+#include "check.h"
+
+#include "signal_decode.h"
+
+#include <cstdint>
+#include <random>
+
+namespace {
+
+bool payloadBit(const uint8_t *data, unsigned bit) {
+    return (data[bit / 8] >> (bit % 8)) & 1;
+}
+
+// Reference decoder. Intel: LSB at startBit, counting up. Motorola: MSB at
+// startBit, counting down within a byte and continuing at bit 7 of the next
+// byte. Returns false when the signal leaves the payload; lastByte is the
+// highest byte it touches.
+bool referenceRaw(const uint8_t *data, uint8_t startBit, uint8_t length, ByteOrder order, uint64_t &raw,
+                  unsigned &lastByte) {
+    raw = 0;
+    lastByte = 0;
+    unsigned bit = startBit;
+    for (unsigned i = 0; i < length; i++) {
+        if (bit >= 64) return false;
+        if (bit / 8 > lastByte) lastByte = bit / 8;
+        if (order == ByteOrder::Intel) {
+            raw |= uint64_t(payloadBit(data, bit)) << i;
+            bit++;
+        } else {
+            raw = (raw << 1) | uint64_t(payloadBit(data, bit));
+            bit = (bit % 8 == 0) ? bit + 15 : bit - 1;
+        }
+    }
+    return true;
+}
+
+void randomPayload(std::mt19937 &rng, uint8_t *data) {
+    for (int i = 0; i < 8; i++) data[i] = static_cast<uint8_t>(rng());
+}
+
+// Every (start, length, order) against the reference: fit, byte count,
+// raw and signed values
+void allLayoutsMatchReference() {
+    std::mt19937 rng(3);
+    static const ByteOrder orders[] = {ByteOrder::Intel, ByteOrder::Motorola};
+    int mismatches = 0;
+    for (ByteOrder order : orders) {
+        for (unsigned start = 0; start < 64; start++) {
+            for (unsigned length = 1; length <= 64; length++) {
+                uint8_t data[8];
+                randomPayload(rng, data);
+                uint64_t expected;
+                unsigned lastByte;
+                bool fits = referenceRaw(data, static_cast<uint8_t>(start), static_cast<uint8_t>(length), order,
+                                         expected, lastByte);
+                if (signalFits(static_cast<uint8_t>(start), static_cast<uint8_t>(length), order) != fits) {
+                    mismatches++;
+                    continue;
+                }
+                if (!fits) continue;
+
+                SignalSpec spec{};
+                spec.startBit = static_cast<uint8_t>(start);
+                spec.length = static_cast<uint8_t>(length);
+                spec.order = order;
+                if (signalBytes(spec.startBit, spec.length, order) != lastByte + 1) mismatches++;
+                if (extractSignalRaw(spec, data) != expected) mismatches++;
+
+                spec.isSigned = true;
+                int64_t signedExpected = static_cast<int64_t>(expected);
+                if (length < 64 && (expected >> (length - 1)) & 1) signedExpected -= int64_t(1) << length;
+                if (length < 64 && extractSignalValue(spec, data) != signedExpected) mismatches++;
+                if (length == 64 && extractSignalValue(spec, data) != static_cast<int64_t>(expected)) mismatches++;
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+// Hand-checked values in DBC notation
+void knownValues() {
+    const uint8_t data[8] = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0};
+    SignalSpec spec{};
+
+    // 16|16@1+ : bytes 2-3 little-endian
+    spec.startBit = 16;
+    spec.length = 16;
+    spec.order = ByteOrder::Intel;
+    CHECK_EQ(extractSignalRaw(spec, data), 0x7856u);
+
+    // 7|16@0+ : bytes 0-1 big-endian
+    spec.startBit = 7;
+    spec.order = ByteOrder::Motorola;
+    CHECK_EQ(extractSignalRaw(spec, data), 0x1234u);
+    CHECK_EQ(signalBytes(7, 16, ByteOrder::Motorola), 2);
+
+    // 3|8@0+ : low nibble of byte 0, then the high nibble of byte 1
+    spec.startBit = 3;
+    spec.length = 8;
+    CHECK_EQ(extractSignalRaw(spec, data), 0x23u);
+
+    // 12|4@1- : high nibble of byte 1 (0x3), positive; 60|4@1- (0xF) is -1
+    spec.order = ByteOrder::Intel;
+    spec.isSigned = true;
+    spec.startBit = 12;
+    spec.length = 4;
+    CHECK_EQ(extractSignalValue(spec, data), 3);
+    spec.startBit = 60;
+    CHECK_EQ(extractSignalValue(spec, data), -1);
+
+    // 39|8@0- : byte 4 = 0x9A = -102
+    spec.order = ByteOrder::Motorola;
+    spec.startBit = 39;
+    spec.length = 8;
+    CHECK_EQ(extractSignalValue(spec, data), -102);
+
+    // Motorola signals running off the end of byte 7 do not fit
+    CHECK(!signalFits(59, 8, ByteOrder::Motorola));
+    CHECK(signalFits(59, 4, ByteOrder::Motorola));
+    CHECK(!signalFits(60, 5, ByteOrder::Intel));
+}
+
+// The compile-time field the generated accessors use agrees with the
+// runtime spec path
+template <uint8_t START, uint8_t LENGTH, ByteOrder ORDER, bool SIGNED>
+bool fieldMatchesSpec(const uint8_t *data) {
+    SignalSpec spec{};
+    spec.startBit = START;
+    spec.length = LENGTH;
+    spec.order = ORDER;
+    spec.isSigned = SIGNED;
+    using Field = SignalField<START, LENGTH, ORDER, SIGNED>;
+    return Field::raw(data) == extractSignalRaw(spec, data) && Field::value(data) == extractSignalValue(spec, data);
+}
+
+void compileTimeFields() {
+    std::mt19937 rng(5);
+    bool ok = true;
+    for (int i = 0; i < 1000; i++) {
+        uint8_t data[8];
+        randomPayload(rng, data);
+        ok = ok && fieldMatchesSpec<0, 8, ByteOrder::Intel, false>(data);
+        ok = ok && fieldMatchesSpec<36, 12, ByteOrder::Intel, true>(data);
+        ok = ok && fieldMatchesSpec<0, 64, ByteOrder::Intel, true>(data);
+        ok = ok && fieldMatchesSpec<7, 64, ByteOrder::Motorola, false>(data);
+        ok = ok && fieldMatchesSpec<23, 12, ByteOrder::Motorola, true>(data);
+        ok = ok && fieldMatchesSpec<56, 1, ByteOrder::Motorola, false>(data);
+    }
+    CHECK(ok);
+}
+
+void physicalAndValueNames() {
+    static const SignalValueName names[] = {{0, "Released"}, {1, "Pressed"}};
+    SignalSpec spec{};
+    spec.factor = 0.5f;
+    spec.offset = -40.0f;
+    spec.values = names;
+    spec.valueCount = 2;
+    CHECK(signalPhysical(spec, 100) == 10.0f);
+    CHECK(signalPhysical(spec, -2) == -41.0f);
+    CHECK(signalValueName(spec, 1) == names[1].name);
+    CHECK(signalValueName(spec, 2) == nullptr);
+}
+
+}  // namespace
+
+int main() {
+    allLayoutsMatchReference();
+    knownValues();
+    compileTimeFields();
+    physicalAndValueNames();
+    return check::result();
+}
@@ -0,0 +1,118 @@
+// zbe_mappings.h, regenerated from zbe/f44.spec at build time, against the
+// hand-written tables it replaced in src/idrive_controller.cpp: the same
+// rows, and decode tables that give what the old per-descriptor compares
+// gave for every value of every byte.
+
+#include "check.h"
+
+#include "zbe_mappings.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+// Verbatim from src/idrive_controller.cpp before the tables were generated
+constexpr KnobMapping LEGACY_KNOB_MAPPINGS[] = {
+    {"CENTER", 0x01, &iDriveState::knobPressedCenter},
+    {"LEFT",   0xA0, &iDriveState::knobPressedLeft},
+    {"UP",     0x10, &iDriveState::knobPressedUp},
+    {"RIGHT",  0x40, &iDriveState::knobPressedRight},
+    {"DOWN",   0x70, &iDriveState::knobPressedDown},
+};
+
+constexpr ButtonDescriptor LEGACY_BUTTON_MAPPINGS[] = {
+    {"BACK",   4, 0x20, 0x80, &iDriveState::backButtonPressed,   &iDriveState::backButtonTouched},
+    {"HOME",   4, 0x04, 0x10, &iDriveState::homeButtonPressed,   &iDriveState::homeButtonTouched},
+    {"COM",    5, 0x08, 0x20, &iDriveState::comButtonPressed,    &iDriveState::comButtonTouched},
+    {"OPTION", 5, 0x01, 0x04, &iDriveState::optionButtonPressed, &iDriveState::optionButtonTouched},
+    {"MEDIA",  6, 0xC1, 0xC4, &iDriveState::mediaButtonPressed,  &iDriveState::mediaButtonTouched},
+    {"NAV",    6, 0xC8, 0xE0, &iDriveState::navButtonPressed,    &iDriveState::navButtonTouched},
+    {"MAP",    7, 0xC1, 0xC4, &iDriveState::mapButtonPressed,    &iDriveState::mapButtonTouched},
+    {"GLOBE",  7, 0xC8, 0xE0, &iDriveState::globeButtonPressed,  &iDriveState::globeButtonTouched},
+};
+
+// The old decodeButtonState(): pressed wins over touched
+ButtonState legacyButtonState(uint8_t raw, const ButtonDescriptor &desc) {
+    if (raw == desc.pressedValue) return ButtonState::Pressed;
+    if (raw == desc.touchedValue) return ButtonState::Touched;
+    return ButtonState::Released;
+}
+
+template <typename T, size_t N>
+constexpr size_t countOf(const T (&)[N]) {
+    return N;
+}
+
+void sameRows() {
+    CHECK_EQ(CONTROLLER_ID, 0x25Bu);
+
+    CHECK_EQ(countOf(KNOB_MAPPINGS), countOf(LEGACY_KNOB_MAPPINGS));
+    for (size_t i = 0; i < countOf(KNOB_MAPPINGS) && i < countOf(LEGACY_KNOB_MAPPINGS); i++) {
+        const KnobMapping &generated = KNOB_MAPPINGS[i];
+        const KnobMapping &legacy = LEGACY_KNOB_MAPPINGS[i];
+        CHECK(std::strcmp(generated.label, legacy.label) == 0);
+        CHECK_EQ(generated.matchValue, legacy.matchValue);
+        CHECK(generated.pressedField == legacy.pressedField);
+    }
+
+    CHECK_EQ(countOf(BUTTON_MAPPINGS), countOf(LEGACY_BUTTON_MAPPINGS));
+    for (size_t i = 0; i < countOf(BUTTON_MAPPINGS) && i < countOf(LEGACY_BUTTON_MAPPINGS); i++) {
+        const ButtonDescriptor &generated = BUTTON_MAPPINGS[i];
+        const ButtonDescriptor &legacy = LEGACY_BUTTON_MAPPINGS[i];
+        CHECK(std::strcmp(generated.label, legacy.label) == 0);
+        CHECK_EQ(generated.byteIndex, legacy.byteIndex);
+        CHECK_EQ(generated.pressedValue, legacy.pressedValue);
+        CHECK_EQ(generated.touchedValue, legacy.touchedValue);
+        CHECK(generated.pressedField == legacy.pressedField);
+        CHECK(generated.touchedField == legacy.touchedField);
+    }
+}
+
+// KNOB_DECODE[v] has bit i set exactly when the old loop pressed mapping i
+void knobDecodeMatchesLoop() {
+    int mismatches = 0;
+    for (unsigned value = 0; value < 256; value++) {
+        uint8_t expected = 0;
+        for (size_t i = 0; i < countOf(LEGACY_KNOB_MAPPINGS); i++) {
+            if (value == LEGACY_KNOB_MAPPINGS[i].matchValue) expected |= 1 << i;
+        }
+        if (KNOB_DECODE[value] != expected) mismatches++;
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+// Each button reads one byte, so checking every value of every byte covers
+// every frame: OR-ing the slots gives the old loop's states for any payload
+void buttonDecodeMatchesLoop() {
+    for (const ButtonDescriptor &desc : LEGACY_BUTTON_MAPPINGS) {
+        bool covered = false;
+        for (uint8_t byte : BUTTON_BYTES) covered = covered || byte == desc.byteIndex;
+        CHECK(covered);
+    }
+
+    int mismatches = 0;
+    for (size_t slot = 0; slot < countOf(BUTTON_BYTES); slot++) {
+        for (unsigned value = 0; value < 256; value++) {
+            uint32_t expected = 0;
+            for (size_t i = 0; i < countOf(LEGACY_BUTTON_MAPPINGS); i++) {
+                const ButtonDescriptor &desc = LEGACY_BUTTON_MAPPINGS[i];
+                if (desc.byteIndex != BUTTON_BYTES[slot]) continue;
+                ButtonState bs = legacyButtonState(static_cast<uint8_t>(value), desc);
+                if (bs == ButtonState::Pressed) expected |= uint32_t(1) << i;
+                if (bs == ButtonState::Touched) expected |= uint32_t(1) << (16 + i);
+            }
+            if (BUTTON_DECODE[slot][value] != expected) mismatches++;
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+}  // namespace
+
+int main() {
+    sameRows();
+    knobDecodeMatchesLoop();
+    buttonDecodeMatchesLoop();
+    return check::result();
+}
@@ -0,0 +1,128 @@
+// Finds the signals behind labelled actions, e.g. which byte of which ID
+// changes while BACK is held, and prints candidate "button" entries
+// for the variant's zbe/*.spec.
+//
+//   actcorr <capture> --timeline <file> [--relative] [--top N] [--min-phi P] [--no-bits]
+//   actcorr <capture> --marks BACK,HOME,... [...]
+//
+// Timeline files list "<start> <end> <label>" windows in seconds on the
+// capture clock (--relative: from the first frame) or between MARK lines,
+// "M1 M2 BACK". --marks labels consecutive MARK pairs in order: send `m`,
+// hold the button, send `m` again, next button. Labels may carry a state,
+// "BACK:touched", to pin the touched value of a button.
+//
+// The capture is streamed once, so session length does not matter.
+
+#include "idrive/action_correlate.h"
+#include "idrive/capture_file.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr,
+                 "usage: actcorr <capture> (--timeline <file> | --marks L1,L2,...) [--relative] [--top N]\n"
+                 "               [--min-phi P] [--no-bits]\n");
+    return 2;
+}
+
+std::vector<std::string> splitLabels(const char *list) {
+    std::vector<std::string> labels;
+    std::string current;
+    for (const char *p = list;; p++) {
+        if (*p == ',' || *p == '\0') {
+            if (!current.empty()) labels.push_back(current);
+            current.clear();
+            if (*p == '\0') break;
+        } else {
+            current += *p;
+        }
+    }
+    return labels;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) return usage();
+
+    std::vector<idrive::ActionWindow> windows;
+    idrive::CorrelateOptions options;
+    bool relative = false;
+    std::string error;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--timeline") == 0 && i + 1 < argc) {
+            if (!idrive::loadActionTimeline(argv[++i], windows, error)) {
+                std::fprintf(stderr, "%s\n", error.c_str());
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--marks") == 0 && i + 1 < argc) {
+            std::vector<idrive::ActionWindow> pairs = idrive::markerPairWindows(splitLabels(argv[++i]));
+            windows.insert(windows.end(), pairs.begin(), pairs.end());
+        } else if (std::strcmp(argv[i], "--relative") == 0) {
+            relative = true;
+        } else if (std::strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            options.maxSignals = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--min-phi") == 0 && i + 1 < argc) {
+            options.minPhi = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--no-bits") == 0) {
+            options.includeBits = false;
+        } else {
+            return usage();
+        }
+    }
+    if (windows.empty()) return usage();
+
+    idrive::ActionCorrelator correlator(windows, relative);
+    std::vector<idrive::CaptureMarker> markers;
+    size_t markersFed = 0;
+    std::string source;
+    bool ok = idrive::streamCapture(argv[1], [&](const idrive::Frame *frames, size_t count) {
+        correlator.addMarkers(markers.data() + markersFed, markers.size() - markersFed);
+        markersFed = markers.size();
+        correlator.add(frames, count);
+        return true;
+    }, error, &source, &markers);
+    if (!ok) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("%s: %llu frames, %zu markers (%s)\n", argv[1],
+                static_cast<unsigned long long>(correlator.frameCount()), correlator.markerCount(), source.c_str());
+
+    std::vector<idrive::ActionReport> reports = correlator.report(options);
+    for (const auto &report : reports) {
+        std::printf("\n%s: %zu window%s, %llu frames in window\n", report.label.c_str(), report.windows,
+                    report.windows == 1 ? "" : "s", static_cast<unsigned long long>(report.framesInWindow));
+        if (report.signals.empty()) {
+            std::printf("  no correlated signal\n");
+            continue;
+        }
+        std::printf("  %6s %8s  %-10s %-10s %7s %7s %6s\n", "phi", "z", "id", "signal", "in", "out", "onset");
+        for (const auto &s : report.signals) {
+            char id[16], signal[24];
+            std::snprintf(id, sizeof(id), s.extended ? "0x%08X" : "0x%03X", s.id);
+            if (s.bit >= 0) {
+                std::snprintf(signal, sizeof(signal), "b%d.%d", s.byte, s.bit);
+                std::printf("  %6.3f %8.1f  %-10s %-10s %6.1f%% %6.1f%%\n", s.phi, s.z, id, signal,
+                            s.inShare * 100, s.outShare * 100);
+            } else {
+                std::snprintf(signal, sizeof(signal), "b%d=0x%02X", s.byte, s.value);
+                std::printf("  %6.3f %8.1f  %-10s %-10s %6.1f%% %6.1f%% %6.1f\n", s.phi, s.z, id, signal,
+                            s.inShare * 100, s.outShare * 100, s.onset);
+            }
+        }
+    }
+
+    std::string entries = idrive::buttonSpecEntries(reports);
+    if (!entries.empty()) {
+        std::printf("\n# zbe/<variant>.spec: each entry goes under its controller line, followed by its captures\n%s",
+                    entries.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Converts captures between the project formats, candump logs and
+// SocketCAN pcap/pcapng, in either direction.
+//
+//   capconv <input> <output> [--to FORMAT] [--iface NAME]
+//   capconv --to FORMAT --out-dir DIR <input>... [--iface NAME]
+//
+// Inputs are anything streamCapture() reads (putty, ids, raw, candump,
+// pcap, pcapng, icap, serial logs with `c` dumps). FORMAT is one of putty,
+// ids, raw, candump, pcap, pcapng, icap; without --to it follows the output
+// extension (.pcap, .pcapng, .icap, .candump). Output "-" is stdout.
+//
+// Inputs are streamed and output is buffered, so memory stays flat and a
+// whole archive converts in one run: capconv --to pcapng --out-dir out *.log
+//
+// Output goes to a temporary file next to the target that is renamed into
+// place only when the conversion succeeds, so a failed run leaves no partial
+// or empty file behind. An output that is the input itself is refused.
+
+#include "idrive/capture_export.h"
+#include "idrive/capture_file.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr,
+                 "usage: capconv <input> <output> [--to FORMAT] [--iface NAME]\n"
+                 "       capconv --to FORMAT --out-dir DIR <input>... [--iface NAME]\n"
+                 "FORMAT: putty ids raw candump pcap pcapng icap\n");
+    return 2;
+}
+
+const char *extensionFor(idrive::ExportFormat format) {
+    switch (format) {
+        case idrive::ExportFormat::Putty:     return ".putty.log";
+        case idrive::ExportFormat::IdsNotes:  return ".ids.txt";
+        case idrive::ExportFormat::DeviceRaw: return ".raw.log";
+        case idrive::ExportFormat::Candump:   return ".candump";
+        case idrive::ExportFormat::Pcap:      return ".pcap";
+        case idrive::ExportFormat::Pcapng:    return ".pcapng";
+        default:                              return ".icap";
+    }
+}
+
+// "dir" + "/captures/idle.log" -> "dir/idle" + extension
+std::string outputPath(const std::string &dir, const std::string &input, idrive::ExportFormat format) {
+    size_t slash = input.find_last_of('/');
+    std::string name = input.substr(slash == std::string::npos ? 0 : slash + 1);
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) name.resize(dot);
+    return dir + "/" + name + extensionFor(format);
+}
+
+// Device and inode, so other spellings of the same path and hard links match
+bool sameFile(const std::string &a, const std::string &b) {
+    struct stat first{}, second{};
+    return ::stat(a.c_str(), &first) == 0 && ::stat(b.c_str(), &second) == 0 && first.st_dev == second.st_dev &&
+           first.st_ino == second.st_ino;
+}
+
+// Empty file next to output, on the same filesystem so rename() can replace
+// the output atomically; mode as fopen() would have created it
+std::string temporaryPath(const std::string &output) {
+    std::string path = output + ".XXXXXX";
+    int fd = ::mkstemp(&path[0]);
+    if (fd < 0) return std::string();
+    mode_t mask = ::umask(0);
+    ::umask(mask);
+    ::fchmod(fd, 0666 & ~mask);
+    ::close(fd);
+    return path;
+}
+
+bool convert(const std::string &input, const std::string &output, idrive::ExportFormat format,
+             const idrive::ExportOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    bool toStdout = output == "-";
+    if (!toStdout && sameFile(input, output)) {
+        std::fprintf(stderr, "%s: output is the input file, not converting\n", input.c_str());
+        return false;
+    }
+    std::string target = toStdout ? output : temporaryPath(output);
+    if (target.empty()) {
+        std::fprintf(stderr, "%s: %s\n", output.c_str(), std::strerror(errno));
+        return false;
+    }
+    auto discard = [&] {
+        if (!toStdout) ::unlink(target.c_str());
+        return false;
+    };
+
+    idrive::CaptureExporter exporter;
+    if (!exporter.open(target, format, options)) {
+        std::fprintf(stderr, "%s\n", exporter.error().c_str());
+        return discard();
+    }
+
+    std::string error, source;
+    bool ok = idrive::streamCapture(input, [&](const idrive::Frame *frames, size_t count) {
+        return exporter.append(frames, count);
+    }, error, &source);
+    if (!exporter.close()) {
+        std::fprintf(stderr, "%s: %s\n", output.c_str(), exporter.error().c_str());
+        return discard();
+    }
+    if (!ok) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return discard();
+    }
+    if (!toStdout && std::rename(target.c_str(), output.c_str()) != 0) {
+        std::fprintf(stderr, "%s: %s\n", output.c_str(), std::strerror(errno));
+        return discard();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%s (%s) -> %s (%s): %llu frames, %.1f MB in %.2fs\n", input.c_str(), source.c_str(),
+                 output.c_str(), idrive::exportFormatName(format),
+                 static_cast<unsigned long long>(exporter.frameCount()), exporter.bytesWritten() / 1e6, seconds);
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    std::vector<std::string> paths;
+    std::string outDir;
+    bool haveFormat = false;
+    idrive::ExportFormat format = idrive::ExportFormat::Candump;
+    idrive::ExportOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            if (!idrive::parseExportFormat(argv[++i], format)) return usage();
+            haveFormat = true;
+        } else if (std::strcmp(argv[i], "--out-dir") == 0 && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--iface") == 0 && i + 1 < argc) {
+            options.interfaceName = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            return usage();
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (!outDir.empty()) {
+        if (!haveFormat || paths.empty()) return usage();
+        int failures = 0;
+        for (const std::string &input : paths) {
+            if (!convert(input, outputPath(outDir, input, format), format, options)) failures++;
+        }
+        return failures ? 1 : 0;
+    }
+
+    if (paths.size() != 2) return usage();
+    if (!haveFormat && !idrive::exportFormatForPath(paths[1], format)) {
+        std::fprintf(stderr, "%s: cannot tell the output format from the extension, use --to\n", paths[1].c_str());
+        return 2;
+    }
+    return convert(paths[0], paths[1], format, options) ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+// Aligns the device clock with the host's CLOCK_MONOTONIC.
+//
+//   clock_sync /dev/ttyACM0 [seconds] [--follow]
+//
+// Sends "@<seq>" pings for the given duration (default 10 s, 10 Hz) and
+// collects the device's "SYNC <seq> <t2> <t3>" replies. Each exchange gives
+// an NTP-style offset sample
+//
+//   theta = ((t1 - t2) + (t4 - t3)) / 2,   delay = (t4 - t1) - (t3 - t2)
+//
+// where t1/t4 are host send/receive times. Only the lowest-delay quartile is
+// kept (USB CDC adds asymmetric queueing), and a least-squares line through
+// theta against device time gives offset and drift. The result is sent back
+// with "@=<offset>.<drift_ppb>.<ref>" so device output uses host time.
+// --follow repeats the procedure until interrupted.
+
+#include "serial_util.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <time.h>
+
+namespace {
+
+constexpr int PING_INTERVAL_MS = 100;
+constexpr int REPLY_TIMEOUT_MS = 50;
+
+struct SyncSample {
+    double deviceUs;  // midpoint of t2/t3
+    double thetaUs;   // host - device
+    double delayUs;
+};
+
+struct SyncFit {
+    double offsetUs;
+    double driftPpb;
+    double referenceUs;
+    double residualUs;
+    size_t used;
+};
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+int64_t hostNowUs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool ping(int fd, std::string &pending, unsigned long sequence, SyncSample &sample) {
+    int64_t t1 = hostNowUs();
+    if (!idrive::writeAll(fd, "@" + std::to_string(sequence) + "\n")) return false;
+
+    bool answered = false;
+    int64_t deadline = t1 + REPLY_TIMEOUT_MS * 1000;
+    while (!answered && hostNowUs() < deadline) {
+        idrive::pumpLines(fd, pending, 5, [&](const std::string &line) {
+            unsigned long seq;
+            long long t2, t3;
+            if (std::sscanf(line.c_str(), "SYNC %lu %lld %lld", &seq, &t2, &t3) != 3 || seq != sequence) return;
+            int64_t t4 = hostNowUs();
+            sample.deviceUs = (static_cast<double>(t2) + static_cast<double>(t3)) / 2;
+            sample.thetaUs = ((t1 - t2) + (t4 - t3)) / 2.0;
+            sample.delayUs = static_cast<double>((t4 - t1) - (t3 - t2));
+            answered = true;
+        });
+    }
+    return answered;
+}
+
+SyncFit fit(std::vector<SyncSample> samples) {
+    std::sort(samples.begin(), samples.end(),
+              [](const SyncSample &a, const SyncSample &b) { return a.delayUs < b.delayUs; });
+    size_t used = std::max<size_t>(2, samples.size() / 4);
+
+    double meanX = 0, meanY = 0;
+    for (size_t i = 0; i < used; i++) {
+        meanX += samples[i].deviceUs;
+        meanY += samples[i].thetaUs;
+    }
+    meanX /= used;
+    meanY /= used;
+
+    double sxx = 0, sxy = 0;
+    for (size_t i = 0; i < used; i++) {
+        sxx += (samples[i].deviceUs - meanX) * (samples[i].deviceUs - meanX);
+        sxy += (samples[i].deviceUs - meanX) * (samples[i].thetaUs - meanY);
+    }
+    double slope = (sxx > 0) ? sxy / sxx : 0;
+
+    double residual = 0;
+    for (size_t i = 0; i < used; i++) {
+        double predicted = meanY + slope * (samples[i].deviceUs - meanX);
+        residual = std::max(residual, std::fabs(samples[i].thetaUs - predicted));
+    }
+
+    return {meanY, slope * 1e9, meanX, residual, used};
+}
+
+bool syncOnce(int fd, int seconds, unsigned long &sequence) {
+    std::vector<SyncSample> samples;
+    std::string pending;
+    int64_t end = hostNowUs() + static_cast<int64_t>(seconds) * 1000000;
+
+    while (!stopRequested && hostNowUs() < end) {
+        SyncSample sample;
+        if (ping(fd, pending, sequence++, sample)) samples.push_back(sample);
+        usleep(PING_INTERVAL_MS * 1000);
+    }
+
+    if (samples.size() < 8) {
+        std::fprintf(stderr, "clock_sync: only %zu replies, is the firmware running?\n", samples.size());
+        return false;
+    }
+
+    SyncFit result = fit(samples);
+    std::printf("samples %zu (used %zu)  offset %.1f us  drift %.1f ppb  max residual %.1f us\n",
+                samples.size(), result.used, result.offsetUs, result.driftPpb, result.residualUs);
+
+    char command[96];
+    std::snprintf(command, sizeof(command), "@=%lld.%lld.%lld\n",
+                  std::llround(result.offsetUs), std::llround(result.driftPpb), std::llround(result.referenceUs));
+    if (!idrive::writeAll(fd, command)) return false;
+
+    int64_t deadline = hostNowUs() + 500000;
+    bool confirmed = false;
+    while (!confirmed && hostNowUs() < deadline) {
+        idrive::pumpLines(fd, pending, 50, [&](const std::string &line) {
+            if (line.rfind("SYNC MAP", 0) != 0) return;
+            std::printf("%s (host now %lld)\n", line.c_str(), static_cast<long long>(hostNowUs()));
+            confirmed = true;
+        });
+    }
+    return confirmed;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <tty> [seconds] [--follow]\n", argv[0]);
+        return 2;
+    }
+
+    int seconds = 10;
+    bool follow = false;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--follow") == 0) {
+            follow = true;
+        } else {
+            seconds = std::max(1, std::atoi(argv[i]));
+        }
+    }
+
+    int fd = idrive::openSerial(argv[1]);
+    if (fd < 0) {
+        std::fprintf(stderr, "clock_sync: %s: %s\n", argv[1], std::strerror(errno));
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    unsigned long sequence = 0;
+    bool ok;
+    do {
+        ok = syncOnce(fd, seconds, sequence);
+    } while (follow && ok && !stopRequested);
+
+    ::close(fd);
+    return ok ? 0 : 1;
+}
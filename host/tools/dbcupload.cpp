@@ -0,0 +1,128 @@
+// Loads a DBC into the firmware's runtime signal decoder without
+// reflashing.
+//
+//   dbcupload <tty> <file.dbc> [--keep] [--report]
+//
+// BO_ and SG_ lines are checked with the firmware's own parser
+// (src/dbc_parse.cpp) before anything is sent; other lines (VAL_, CM_,
+// attributes, multiplexed signals) stay on the host. The previous upload is
+// dropped with "gx" unless --keep is given, then each line goes out as
+// "g:<line>" and the device's "DBC ..." ack is awaited before the next, so
+// the 128-byte line buffer on the device never overruns. --report turns on
+// the SIG change reports ("g1") at the end.
+
+#include "serial_util.h"
+
+#include "dbc_parse.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <time.h>
+
+namespace {
+
+constexpr size_t DEVICE_LINE_LENGTH = 127;  // DBC_LINE_LENGTH - 1 in serial_commands.cpp
+constexpr int    ACK_TIMEOUT_MS     = 1000;
+
+int usage() {
+    std::fprintf(stderr, "usage: dbcupload <tty> <file.dbc> [--keep] [--report]\n");
+    return 2;
+}
+
+int64_t nowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Sends one command and returns the device's "DBC ..." reply, or "" on timeout
+std::string sendLine(int fd, std::string &pending, const std::string &line) {
+    if (!idrive::writeAll(fd, "g:" + line + "\n")) return "";
+    std::string ack;
+    int64_t deadline = nowMs() + ACK_TIMEOUT_MS;
+    while (ack.empty() && nowMs() < deadline) {
+        bool open = idrive::pumpLines(fd, pending, 20, [&](const std::string &reply) {
+            if (ack.empty() && reply.compare(0, 4, "DBC ") == 0) ack = reply;
+        });
+        if (!open) break;
+    }
+    return ack;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 3) return usage();
+    bool keep = false, report = false;
+    for (int i = 3; i < argc; i++) {
+        if (std::strcmp(argv[i], "--keep") == 0) {
+            keep = true;
+        } else if (std::strcmp(argv[i], "--report") == 0) {
+            report = true;
+        } else {
+            return usage();
+        }
+    }
+
+    std::ifstream in(argv[2]);
+    if (!in) {
+        std::fprintf(stderr, "dbcupload: cannot read %s\n", argv[2]);
+        return 1;
+    }
+
+    // Validate the whole file first so a typo never leaves a half-loaded table
+    std::vector<std::string> lines;
+    std::string line;
+    DbcMessage message{};
+    DbcSignal signal{};
+    bool ok = true;
+    for (unsigned number = 1; std::getline(in, line); number++) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        DbcLineKind kind = parseDbcLine(line.c_str(), message, signal);
+        if (kind == DbcLineKind::Other) continue;
+        if (kind == DbcLineKind::Invalid) {
+            std::fprintf(stderr, "%s:%u: cannot parse: %s\n", argv[2], number, line.c_str());
+            ok = false;
+        } else if (line.size() > DEVICE_LINE_LENGTH) {
+            std::fprintf(stderr, "%s:%u: longer than %zu bytes\n", argv[2], number, DEVICE_LINE_LENGTH);
+            ok = false;
+        }
+        lines.push_back(line);
+    }
+    if (!ok) return 1;
+
+    int fd = idrive::openSerial(argv[1]);
+    if (fd < 0) {
+        std::fprintf(stderr, "dbcupload: %s: %s\n", argv[1], std::strerror(errno));
+        return 1;
+    }
+
+    std::string pending;
+    if (!keep) idrive::writeAll(fd, "gx\n");
+
+    size_t signals = 0;
+    for (const auto &definition : lines) {
+        std::string ack = sendLine(fd, pending, definition);
+        if (ack.empty()) {
+            std::fprintf(stderr, "dbcupload: no reply to: %s\n", definition.c_str());
+            ::close(fd);
+            return 1;
+        }
+        std::printf("%s\n", ack.c_str());
+        if (ack.compare(0, 10, "DBC ERROR ") == 0) {
+            ::close(fd);
+            return 1;
+        }
+        if (ack.compare(0, 8, "DBC SG_ ") == 0) signals++;
+    }
+    if (report) idrive::writeAll(fd, "g1\n");
+    ::close(fd);
+
+    std::printf("%zu signals uploaded\n", signals);
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Packs captures into the indexed binary container and queries them.
+//
+//   icap pack <capture> <out.icap> [frames_per_block]
+//   icap info <file.icap>
+//   icap query <file.icap> [--from T] [--to T] [--id 0x0BF[x]] [--count]
+//
+// pack accepts any text capture the parser recognises, or a serial log
+// containing binary `c` capture dumps. Times are microseconds, or take an
+// "s"/"ms" suffix (--from 3712s --to 3713.5s). An "x" after the ID selects
+// a 29-bit identifier. query prints one candump-style line per frame and
+// reports how many blocks the index let it skip on stderr.
+
+#include "idrive/capture.h"
+#include "idrive/capture_file.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr,
+                 "usage: icap pack <capture> <out.icap> [frames_per_block]\n"
+                 "       icap info <file.icap>\n"
+                 "       icap query <file.icap> [--from T] [--to T] [--id 0xID[x]] [--count]\n");
+    return 2;
+}
+
+bool parseTime(const char *text, int64_t &us) {
+    char *end = nullptr;
+    double value = std::strtod(text, &end);
+    if (end == text) return false;
+    double scale = 1;
+    if (std::strcmp(end, "s") == 0) {
+        scale = 1e6;
+    } else if (std::strcmp(end, "ms") == 0) {
+        scale = 1e3;
+    } else if (*end != '\0' && std::strcmp(end, "us") != 0) {
+        return false;
+    }
+    us = static_cast<int64_t>(value * scale);
+    return true;
+}
+
+bool parseId(const char *text, uint32_t &id, bool &extended) {
+    char *end = nullptr;
+    unsigned long value = std::strtoul(text, &end, 16);
+    if (end == text) return false;
+    extended = (*end == 'x' || *end == 'X');
+    if (extended) end++;
+    id = static_cast<uint32_t>(value);
+    return *end == '\0' && value <= (extended ? 0x1FFFFFFFul : 0x7FFul);
+}
+
+void printFrame(const idrive::Frame &frame) {
+    std::printf("(%" PRId64 ".%06" PRId64 ") %s %0*X#", frame.timestampUs / 1000000, frame.timestampUs % 1000000,
+                (frame.flags & idrive::FRAME_TX) ? "tx" : "rx", (frame.flags & idrive::FRAME_EXTENDED) ? 8 : 3,
+                frame.id);
+    for (uint8_t i = 0; i < frame.dlc && i < 8; i++) std::printf("%02X", frame.data[i]);
+    std::printf("\n");
+}
+
+int pack(int argc, char **argv) {
+    if (argc < 4) return usage();
+    uint32_t framesPerBlock = (argc > 4) ? static_cast<uint32_t>(std::strtoul(argv[4], nullptr, 10))
+                                         : idrive::DEFAULT_FRAMES_PER_BLOCK;
+
+    std::vector<idrive::Frame> frames;
+    std::string error, source;
+    if (!idrive::loadCapture(argv[2], frames, error, &source)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    idrive::CaptureFileWriter writer;
+    if (!writer.open(argv[3], framesPerBlock) || !writer.append(frames.data(), frames.size()) || !writer.close()) {
+        std::fprintf(stderr, "%s: %s\n", argv[3], writer.error().c_str());
+        return 1;
+    }
+    std::fprintf(stderr, "%s: %zu frames (%s) -> %s\n", argv[2], frames.size(), source.c_str(), argv[3]);
+    return 0;
+}
+
+int info(int argc, char **argv) {
+    if (argc < 3) return usage();
+    idrive::CaptureFileReader reader;
+    if (!reader.open(argv[2])) {
+        std::fprintf(stderr, "%s\n", reader.error().c_str());
+        return 1;
+    }
+
+    std::printf("frames:      %" PRIu64 "\n", reader.frameCount());
+    std::printf("blocks:      %zu x %u frames\n", reader.blockCount(), reader.framesPerBlock());
+    std::printf("time order:  %s\n", reader.timeOrdered() ? "yes (binary-searchable)" : "no (linear index scan)");
+    if (reader.blockCount() > 0) {
+        const idrive::BlockIndexEntry &first = reader.block(0);
+        const idrive::BlockIndexEntry &last = reader.block(reader.blockCount() - 1);
+        std::printf("time range:  %.6fs .. %.6fs\n", first.firstUs / 1e6, last.lastUs / 1e6);
+    }
+    return 0;
+}
+
+int query(int argc, char **argv) {
+    if (argc < 3) return usage();
+    idrive::CaptureQuery q;
+    bool countOnly = false;
+    for (int i = 3; i < argc; i++) {
+        bool haveValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--from") == 0 && haveValue) {
+            if (!parseTime(argv[++i], q.fromUs)) return usage();
+        } else if (std::strcmp(argv[i], "--to") == 0 && haveValue) {
+            if (!parseTime(argv[++i], q.toUs)) return usage();
+        } else if (std::strcmp(argv[i], "--id") == 0 && haveValue) {
+            if (!parseId(argv[++i], q.id, q.extended)) return usage();
+            q.filterId = true;
+        } else if (std::strcmp(argv[i], "--count") == 0) {
+            countOnly = true;
+        } else {
+            return usage();
+        }
+    }
+
+    idrive::CaptureFileReader reader;
+    if (!reader.open(argv[2])) {
+        std::fprintf(stderr, "%s\n", reader.error().c_str());
+        return 1;
+    }
+
+    idrive::QueryStats stats;
+    reader.query(q, [&](const idrive::Frame &frame) {
+        if (!countOnly) printFrame(frame);
+        return true;
+    }, &stats);
+
+    if (countOnly) std::printf("%zu\n", stats.framesMatched);
+    std::fprintf(stderr, "%zu frames matched, blocks: %zu total, %zu in range, %zu read, %zu frames scanned\n",
+                 stats.framesMatched, stats.blocksTotal, stats.blocksInRange, stats.blocksRead, stats.framesScanned);
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) return usage();
+    if (std::strcmp(argv[1], "pack") == 0) return pack(argc, argv);
+    if (std::strcmp(argv[1], "info") == 0) return info(argc, argv);
+    if (std::strcmp(argv[1], "query") == 0) return query(argc, argv);
+    return usage();
+}
@@ -0,0 +1,85 @@
+// Host side of the firmware's latency loopback mode ('a1').
+//
+//   latency_probe /dev/ttyACM0 [seconds]
+//
+// Enables loopback, echoes "!<seq>" for every "LAT <seq>" line as soon as it
+// is read, and after the run (default 30 s, or Ctrl-C) disables loopback and
+// prints the device's per-stage percentile table. Press buttons / turn the
+// knob while it runs.
+
+#include "serial_util.h"
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using idrive::openSerial;
+using idrive::pumpLines;
+using idrive::writeAll;
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <tty> [seconds]\n", argv[0]);
+        return 2;
+    }
+    int seconds = (argc > 2) ? std::atoi(argv[2]) : 30;
+
+    int fd = openSerial(argv[1]);
+    if (fd < 0) {
+        std::fprintf(stderr, "latency_probe: %s: %s\n", argv[1], std::strerror(errno));
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    // Start from clean device-side histograms
+    writeAll(fd, "a\na1\n");
+
+    unsigned long acked = 0;
+    std::string pending;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+
+    while (!stopRequested && std::chrono::steady_clock::now() < deadline) {
+        bool ok = pumpLines(fd, pending, 100, [&](const std::string &line) {
+            unsigned long sequence;
+            if (std::sscanf(line.c_str(), "LAT %lu", &sequence) == 1) {
+                writeAll(fd, "!" + std::to_string(sequence) + "\n");
+                acked++;
+            } else if (!line.empty()) {
+                std::printf("%s\n", line.c_str());
+            }
+        });
+        if (!ok) break;
+    }
+
+    writeAll(fd, "a0\na\n");
+
+    // Print the device's table, which follows the loopback-off reply
+    bool inTable = false;
+    auto tableDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < tableDeadline) {
+        pumpLines(fd, pending, 100, [&](const std::string &line) {
+            if (line.rfind("Input latency", 0) == 0) inTable = true;
+            if (inTable) std::printf("%s\n", line.c_str());
+        });
+    }
+
+    std::printf("acked %lu events\n", acked);
+    ::close(fd);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+// Minimal tty helpers shared by the small host tools: raw-mode open, full
+// writes and poll-driven line splitting.
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
+namespace idrive {
+
+inline int openSerial(const char *path) {
+    int fd = ::open(path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    termios tio{};
+    if (tcgetattr(fd, &tio) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+// Asks the driver to hand received bytes to readers immediately instead of
+// batching them (ASYNC_LOW_LATENCY). Drivers without TIOCSSERIAL, such as
+// ptys, keep their default; returns whether the flag took.
+inline bool setSerialLowLatency(int fd) {
+#ifdef __linux__
+    serial_struct serial{};
+    if (::ioctl(fd, TIOCGSERIAL, &serial) != 0) return false;
+    serial.flags |= ASYNC_LOW_LATENCY;
+    return ::ioctl(fd, TIOCSSERIAL, &serial) == 0;
+#else
+    (void)fd;
+    return false;
+#endif
+}
+
+inline bool writeAll(int fd, const std::string &text) {
+    size_t done = 0;
+    while (done < text.size()) {
+        ssize_t n = ::write(fd, text.data() + done, text.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Waits up to timeoutMs for input and hands every complete line (without
+// the CR/LF) to onLine. Returns false on a hard read error or hang-up.
+template <typename LineHandler>
+bool pumpLines(int fd, std::string &pending, int timeoutMs, LineHandler onLine) {
+    pollfd pfd{fd, POLLIN, 0};
+    int ready = ::poll(&pfd, 1, timeoutMs);
+    if (ready < 0) return errno == EINTR;
+    if (ready == 0) return true;
+
+    char buf[4096];
+    ssize_t n = ::read(fd, buf, sizeof(buf));
+    if (n == 0) return false;
+    if (n < 0) return errno == EINTR || errno == EAGAIN;
+    pending.append(buf, static_cast<size_t>(n));
+
+    size_t start = 0;
+    for (size_t nl; (nl = pending.find('\n', start)) != std::string::npos; start = nl + 1) {
+        size_t end = (nl > start && pending[nl - 1] == '\r') ? nl - 1 : nl;
+        onLine(pending.substr(start, end - start));
+    }
+    pending.erase(0, start);
+    return true;
+}
+
+}  // namespace idrive
@@ -0,0 +1,165 @@
+// Ad-hoc signal queries over a capture through the column store.
+//
+//   sigquery <capture> <id> [predicate...] [--limit N] [--count]
+//
+// Predicates (all must hold, byte positions 0-7, values hex):
+//   b3=01        byte 3 equals 0x01          b3!=01      differs from 0x01
+//   b3&F0=10     masked compare              b2=40..7F   inclusive range
+//   b4~          byte 4 changed since the previous frame of this ID
+//   b4!~         byte 4 unchanged
+//   t=12.5s..14s time window (s, ms or plain microseconds)
+//
+// Example: 0x25B frames where byte 4 changed while byte 3 == 0x01
+//   sigquery putty.log 25B b4~ b3=01
+
+#include "idrive/capture.h"
+#include "idrive/capture_file.h"
+#include "idrive/column_store.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr, "usage: sigquery <capture> <id> [b<n>=<v> | b<n>!=<v> | b<n>&<m>=<v> | b<n>=<lo>..<hi> |\n"
+                         "                               b<n>~ | b<n>!~ | t=<from>..<to>]... [--limit N] [--count]\n");
+    return 2;
+}
+
+bool parseHexByte(const std::string &text, uint8_t &value) {
+    char *end = nullptr;
+    unsigned long v = std::strtoul(text.c_str(), &end, 16);
+    if (text.empty() || *end != '\0' || v > 0xFF) return false;
+    value = static_cast<uint8_t>(v);
+    return true;
+}
+
+bool parseTime(const std::string &text, int64_t &us) {
+    char *end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (end == text.c_str()) return false;
+    std::string unit(end);
+    double scale = (unit == "s") ? 1e6 : (unit == "ms") ? 1e3 : (unit.empty() || unit == "us") ? 1 : 0;
+    if (scale == 0) return false;
+    us = static_cast<int64_t>(value * scale);
+    return true;
+}
+
+bool splitRange(const std::string &text, std::string &lo, std::string &hi) {
+    size_t dots = text.find("..");
+    if (dots == std::string::npos) return false;
+    lo = text.substr(0, dots);
+    hi = text.substr(dots + 2);
+    return true;
+}
+
+bool parsePredicate(const std::string &text, idrive::Predicate &predicate) {
+    std::string lo, hi;
+    if (text.compare(0, 2, "t=") == 0) {
+        int64_t from, to;
+        if (!splitRange(text.substr(2), lo, hi) || !parseTime(lo, from) || !parseTime(hi, to)) return false;
+        predicate = idrive::Predicate::timeBetween(from, to);
+        return true;
+    }
+
+    if (text.size() < 3 || text[0] != 'b' || text[1] < '0' || text[1] > '7') return false;
+    uint8_t byte = static_cast<uint8_t>(text[1] - '0');
+    std::string rest = text.substr(2);
+
+    if (rest == "~" || rest == "!~") {
+        predicate = idrive::Predicate::byteChanged(byte);
+        if (rest == "!~") predicate = !predicate;
+        return true;
+    }
+
+    uint8_t a, b;
+    if (rest.compare(0, 2, "!=") == 0) {
+        if (!parseHexByte(rest.substr(2), a)) return false;
+        predicate = !idrive::Predicate::byteEquals(byte, a);
+        return true;
+    }
+    if (rest[0] == '&') {
+        size_t eq = rest.find('=');
+        if (eq == std::string::npos || !parseHexByte(rest.substr(1, eq - 1), b) || !parseHexByte(rest.substr(eq + 1), a)) {
+            return false;
+        }
+        predicate = idrive::Predicate::byteMasked(byte, b, a);
+        return true;
+    }
+    if (rest[0] != '=') return false;
+    if (splitRange(rest.substr(1), lo, hi)) {
+        if (!parseHexByte(lo, a) || !parseHexByte(hi, b)) return false;
+        predicate = idrive::Predicate::byteBetween(byte, a, b);
+        return true;
+    }
+    if (!parseHexByte(rest.substr(1), a)) return false;
+    predicate = idrive::Predicate::byteEquals(byte, a);
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 3) return usage();
+
+    idrive::SignalQuery query;
+    char *end = nullptr;
+    unsigned long id = std::strtoul(argv[2], &end, 16);
+    if (*end == 'x' || *end == 'X') {
+        query.extended = true;
+        end++;
+    }
+    if (*end != '\0') return usage();
+    query.id = static_cast<uint32_t>(id);
+
+    size_t limit = SIZE_MAX;
+    bool countOnly = false;
+    for (int i = 3; i < argc; i++) {
+        if (std::strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+            limit = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--count") == 0) {
+            countOnly = true;
+        } else {
+            idrive::Predicate predicate = idrive::Predicate::byteChanged(0);
+            if (!parsePredicate(argv[i], predicate)) {
+                std::fprintf(stderr, "bad predicate: %s\n", argv[i]);
+                return usage();
+            }
+            query.where.push_back(predicate);
+        }
+    }
+
+    std::vector<idrive::Frame> frames;
+    std::string error;
+    if (!idrive::loadCapture(argv[1], frames, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    idrive::ColumnStore store;
+    store.build(frames);
+
+    auto start = std::chrono::steady_clock::now();
+    idrive::QueryResult result = store.run(query);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (!countOnly && result.partition) {
+        size_t printed = 0;
+        const idrive::IdPartition &p = *result.partition;
+        result.forEachRow([&](size_t row) {
+            if (printed++ >= limit) return;
+            std::printf("%12.6f  #%-8u", p.timestampUs[row] / 1e6, p.captureIndex[row]);
+            for (uint8_t i = 0; i < p.dlc[row] && i < 8; i++) std::printf(" %02X", p.bytes[i][row]);
+            std::printf("\n");
+        });
+    }
+    std::printf("%zu of %zu frames of 0x%03" PRIX32 " matched (%.3f ms)\n", result.matches,
+                result.partition ? result.partition->rows : 0, query.id, elapsed.count());
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Converts the firmware's 't' trace dump into Chrome trace-event JSON, which
+// loads directly in chrome://tracing and ui.perfetto.dev.
+//
+//   trace2chrome [serial_log.txt] > trace.json
+//
+// Any non-trace lines in the input are ignored, so a raw serial log can be
+// passed as-is. Every TRACE BEGIN/END block becomes its own process track.
+
+#include "trace_format.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct DumpState {
+    int      pid        = 0;
+    uint32_t cpuMhz     = 160;
+    bool     haveCycles = false;
+    uint32_t lastCycles = 0;
+    uint64_t cycles64   = 0;
+    std::vector<uint8_t> openEvents;
+};
+
+const char *eventName(uint8_t event) {
+    if (event < static_cast<uint8_t>(TraceEvent::Count)) return TRACE_EVENT_NAMES[event];
+    return "unknown";
+}
+
+bool eventCarriesId(uint8_t event) {
+    return event != static_cast<uint8_t>(TraceEvent::SerialCommand);
+}
+
+// Cycle counts are 32-bit; the keepalive guarantees events far more often
+// than the ~26 s wrap period, so a forward delta is always the right answer.
+double unwrapToMicros(DumpState &dump, uint32_t cycles) {
+    if (dump.haveCycles) {
+        dump.cycles64 += static_cast<uint32_t>(cycles - dump.lastCycles);
+    } else {
+        dump.haveCycles = true;
+    }
+    dump.lastCycles = cycles;
+    return static_cast<double>(dump.cycles64) / dump.cpuMhz;
+}
+
+void writeEvent(bool &first, DumpState &dump, uint32_t cycles, uint8_t event, uint8_t phase,
+                uint32_t id, uint32_t arg) {
+    const char *ph;
+    switch (static_cast<TracePhase>(phase)) {
+        case TracePhase::Begin:
+            dump.openEvents.push_back(event);
+            ph = "B";
+            break;
+        case TracePhase::End:
+            // The ring may start in the middle of a scope; drop orphaned ends
+            if (dump.openEvents.empty() || dump.openEvents.back() != event) return;
+            dump.openEvents.pop_back();
+            ph = "E";
+            break;
+        default:
+            ph = "i";
+            break;
+    }
+
+    double ts = unwrapToMicros(dump, cycles);
+
+    char name[48];
+    if (eventCarriesId(event) && id != 0) {
+        std::snprintf(name, sizeof(name), "%s 0x%03" PRIX32, eventName(event), id);
+    } else if (!eventCarriesId(event)) {
+        std::snprintf(name, sizeof(name), "%s '%c'", eventName(event),
+                      (arg >= 0x20 && arg < 0x7F && arg != '"' && arg != '\\') ? static_cast<char>(arg) : '?');
+    } else {
+        std::snprintf(name, sizeof(name), "%s", eventName(event));
+    }
+
+    std::printf("%s\n  {\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%d,\"tid\":1",
+                first ? "" : ",", name, eventName(event), ph, ts, dump.pid);
+    if (*ph == 'i') std::printf(",\"s\":\"t\"");
+    if (*ph != 'E') std::printf(",\"args\":{\"id\":\"0x%03" PRIX32 "\",\"arg\":%" PRIu32 "}", id, arg);
+    std::printf("}");
+    first = false;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    std::ifstream file;
+    std::istream *in = &std::cin;
+    if (argc > 1) {
+        file.open(argv[1]);
+        if (!file) {
+            std::fprintf(stderr, "trace2chrome: cannot open %s\n", argv[1]);
+            return 1;
+        }
+        in = &file;
+    }
+
+    std::printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    bool first = true;
+    bool inDump = false;
+    int dumps = 0;
+    DumpState dump;
+    std::string line;
+
+    while (std::getline(*in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        unsigned long count, mhz;
+        if (std::sscanf(line.c_str(), "TRACE BEGIN %lu %lu", &count, &mhz) == 2) {
+            dump = DumpState();
+            dump.pid = ++dumps;
+            dump.cpuMhz = mhz ? static_cast<uint32_t>(mhz) : 160;
+            inDump = true;
+            std::printf("%s\n  {\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"iDrive dump %d\"}}",
+                        first ? "" : ",", dump.pid, dump.pid);
+            first = false;
+            continue;
+        }
+        if (!inDump) continue;
+        if (line == "TRACE END") {
+            inDump = false;
+            continue;
+        }
+
+        uint32_t cycles, id, arg;
+        unsigned event, phase;
+        if (std::sscanf(line.c_str(), "T %" SCNx32 " %u %u %" SCNx32 " %" SCNx32,
+                        &cycles, &event, &phase, &id, &arg) != 5) {
+            continue;
+        }
+        writeEvent(first, dump, cycles, static_cast<uint8_t>(event), static_cast<uint8_t>(phase), id, arg);
+    }
+
+    std::printf("\n]}\n");
+
+    if (dumps == 0) {
+        std::fprintf(stderr, "trace2chrome: no TRACE BEGIN block found\n");
+        return 1;
+    }
+    return 0;
+}
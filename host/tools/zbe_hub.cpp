@@ -0,0 +1,377 @@
+// Owns the device tty and republishes its stream to any number of local
+// consumers through the shared-memory event ring (idrive/event_ring.h).
+//
+//   zbe_hub <tty> [--shm NAME] [--slots N] [--raw] [--signals] [--rt] [--uring]
+//           [--socket PATH [--client-queue KB] [--slow drop|disconnect]
+//           [--max-clients N]]
+//   zbe_hub --tail [--shm NAME] [--from-oldest]
+//
+// Frames, input events, signal reports, statistics and LAT/SYNC replies
+// are parsed with idrive::DeviceClient and published in arrival order with
+// the host time they were read. --raw switches the firmware to RAW mode
+// ('d2') so every frame is published, --signals turns on signal reports
+// ('g1'); both are switched back off at exit. If the device goes away it
+// is reopened and publishing continues on the same ring. --uring keeps a
+// read queued on the tty through io_uring (idrive/device_uring.h) instead
+// of poll() and read() per wake-up. SIGUSR1 prints
+// counters. The segment is left in place at exit so a restarted hub
+// continues the same sequence and readers keep their place.
+//
+// --socket also serves the events as text lines to Unix-socket clients,
+// each with its own subscription filter (idrive/event_mux.h). Every client
+// has a bounded queue (--client-queue, 256 KB by default); a client that
+// does not keep up loses events (--slow drop, the default) or is
+// disconnected (--slow disconnect), without holding up the device reader
+// or the other clients.
+//
+// --tail attaches as a reader and prints the records, reporting overruns;
+// it follows the hub across restarts.
+
+#include "idrive/device_uring.h"
+#include "idrive/event_mux.h"
+#include "idrive/event_ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <sched.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int REOPEN_INTERVAL_MS = 500;
+constexpr int TAIL_POLL_US       = 1000;
+constexpr int RT_PRIORITY        = 50;
+
+using idrive::DeviceEvent;
+using idrive::DeviceEventKind;
+using idrive::RingRecord;
+
+struct Options {
+    const char *tty = nullptr;
+    const char *shm = idrive::EVENT_RING_DEFAULT_NAME;
+    uint32_t slots = idrive::EVENT_RING_DEFAULT_SLOTS;
+    bool raw = false;
+    bool signals = false;
+    bool realtime = false;
+    bool uring = false;
+    bool tail = false;
+    bool fromOldest = false;
+    const char *socket = nullptr;
+    size_t clientQueue = idrive::EVENT_MUX_DEFAULT_QUEUE;
+    idrive::SlowClientPolicy slowPolicy = idrive::SlowClientPolicy::Drop;
+    size_t maxClients = idrive::EVENT_MUX_DEFAULT_CLIENTS;
+};
+
+int usage() {
+    std::fprintf(stderr,
+                 "usage: zbe_hub <tty> [--shm NAME] [--slots N] [--raw] [--signals] [--rt] [--uring]\n"
+                 "               [--socket PATH [--client-queue KB] [--slow drop|disconnect] [--max-clients N]]\n"
+                 "       zbe_hub --tail [--shm NAME] [--from-oldest]\n");
+    return 2;
+}
+
+int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+volatile sig_atomic_t tailRunning = 1;
+
+void stopTail(int) {
+    tailRunning = 0;
+}
+
+void printRecord(const RingRecord &record) {
+    char line[idrive::EVENT_MUX_MAX_LINE];
+    std::fwrite(line, 1, idrive::formatRingRecord(record, line, sizeof(line)), stdout);
+}
+
+int runTail(const Options &options) {
+    signal(SIGINT, stopTail);
+    signal(SIGTERM, stopTail);
+
+    idrive::EventRingReader reader;
+    bool warned = false;
+    bool replaced = false;
+    bool closed = false;
+    uint64_t reportedLost = 0;
+    while (tailRunning) {
+        if (!reader.isAttached()) {
+            // A replacement segment only holds records this reader has not seen
+            if (!reader.attach(options.shm, options.fromOldest || replaced)) {
+                if (!warned) std::fprintf(stderr, "zbe_hub: %s: %s, waiting\n", options.shm, std::strerror(errno));
+                warned = true;
+                usleep(REOPEN_INTERVAL_MS * 1000);
+                continue;
+            }
+            warned = false;
+            closed = false;
+            reportedLost = 0;
+            std::fprintf(stderr, "zbe_hub: following %s\n", options.shm);
+        }
+
+        RingRecord record;
+        size_t count = 0;
+        while (reader.next(record)) {
+            printRecord(record);
+            count++;
+        }
+        if (reader.lost() != reportedLost) {
+            std::fprintf(stderr, "zbe_hub: overrun, %llu records lost\n",
+                         static_cast<unsigned long long>(reader.lost() - reportedLost));
+            reportedLost = reader.lost();
+        }
+        if (count == 0) {
+            std::fflush(stdout);
+            // A restarted hub reuses the segment, so only a replaced one needs a new attach
+            if (reader.writerClosed() != closed) {
+                closed = !closed;
+                std::fprintf(stderr, "zbe_hub: writer %s\n", closed ? "closed, waiting" : "back");
+            }
+            if (reader.unlinked()) {
+                reader.detach();
+                replaced = true;
+                continue;
+            }
+            usleep(closed ? REOPEN_INTERVAL_MS * 1000 : TAIL_POLL_US);
+        }
+    }
+    return 0;
+}
+
+// Returns the fd to watch: the tty, or the io_uring instance reading it
+int openDevice(const Options &options, idrive::DeviceClient &client, idrive::DeviceUringReader &reader, int epollFd) {
+    if (!client.open(options.tty)) return -1;
+
+    int watched = client.fd();
+    if (options.uring) {
+        if (reader.start(client.fd(), client.parser())) {
+            watched = reader.fd();
+        } else {
+            std::fprintf(stderr, "zbe_hub: io_uring: %s, using read()\n", std::strerror(errno));
+        }
+    }
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = watched;
+    if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, watched, &event) != 0) {
+        reader.stop();
+        client.close();
+        return -1;
+    }
+    client.beginBatch();
+    if (options.raw) client.setDebugMode(idrive::DebugMode::Raw);
+    if (options.signals) client.setSignalReports(true);
+    client.flush();
+    std::fprintf(stderr, "zbe_hub: reading %s%s%s\n", options.tty, client.lowLatency() ? " (low latency)" : "",
+                 reader.isRunning() ? " through io_uring" : "");
+    return watched;
+}
+
+struct HubCounters {
+    uint64_t published[static_cast<size_t>(DeviceEventKind::Text) + 1] = {};
+    uint64_t reopened = 0;
+};
+
+void printCounters(const HubCounters &counters, const idrive::EventRingWriter &ring, idrive::DeviceClient &client,
+                   const idrive::EventMux &mux) {
+    std::fprintf(stderr, "zbe_hub: ring sequence %llu (%u slots), reopened %llu, %zu parser overflows;",
+                 static_cast<unsigned long long>(ring.published()), ring.slotCount(),
+                 static_cast<unsigned long long>(counters.reopened),
+                 client.parser().dropped());
+    for (size_t kind = 0; kind < sizeof(counters.published) / sizeof(counters.published[0]); kind++) {
+        if (counters.published[kind]) {
+            std::fprintf(stderr, " %s %llu", idrive::ringKindName(static_cast<uint8_t>(kind)),
+                         static_cast<unsigned long long>(counters.published[kind]));
+        }
+    }
+    std::fprintf(stderr, "\n");
+    if (mux.fd() < 0) return;
+    const idrive::EventMuxStats &stats = mux.stats();
+    std::fprintf(stderr, "zbe_hub: %zu socket clients (%llu accepted, %llu rejected), %llu lines delivered, %llu dropped, "
+                 "%llu slow clients disconnected\n",
+                 mux.clientCount(), static_cast<unsigned long long>(stats.accepted),
+                 static_cast<unsigned long long>(stats.rejected), static_cast<unsigned long long>(stats.delivered),
+                 static_cast<unsigned long long>(stats.dropped), static_cast<unsigned long long>(stats.disconnected));
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (std::strcmp(arg, "--raw") == 0) {
+            options.raw = true;
+        } else if (std::strcmp(arg, "--signals") == 0) {
+            options.signals = true;
+        } else if (std::strcmp(arg, "--rt") == 0) {
+            options.realtime = true;
+        } else if (std::strcmp(arg, "--uring") == 0) {
+            options.uring = true;
+        } else if (std::strcmp(arg, "--tail") == 0) {
+            options.tail = true;
+        } else if (std::strcmp(arg, "--from-oldest") == 0) {
+            options.fromOldest = true;
+        } else if (std::strcmp(arg, "--shm") == 0 && i + 1 < argc) {
+            options.shm = argv[++i];
+        } else if (std::strcmp(arg, "--slots") == 0 && i + 1 < argc) {
+            options.slots = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+            if (options.slots < 2 || options.slots > (1u << 24)) return usage();
+        } else if (std::strcmp(arg, "--socket") == 0 && i + 1 < argc) {
+            options.socket = argv[++i];
+        } else if (std::strcmp(arg, "--client-queue") == 0 && i + 1 < argc) {
+            options.clientQueue = std::strtoul(argv[++i], nullptr, 10) * 1024;
+            if (options.clientQueue == 0) return usage();
+        } else if (std::strcmp(arg, "--slow") == 0 && i + 1 < argc) {
+            const char *policy = argv[++i];
+            if (std::strcmp(policy, "drop") == 0) {
+                options.slowPolicy = idrive::SlowClientPolicy::Drop;
+            } else if (std::strcmp(policy, "disconnect") == 0) {
+                options.slowPolicy = idrive::SlowClientPolicy::Disconnect;
+            } else {
+                return usage();
+            }
+        } else if (std::strcmp(arg, "--max-clients") == 0 && i + 1 < argc) {
+            options.maxClients = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg[0] != '-' && !options.tty) {
+            options.tty = arg;
+        } else {
+            return usage();
+        }
+    }
+    if (options.tail) return runTail(options);
+    if (!options.tty) return usage();
+
+    if (options.realtime) {
+        sched_param param{};
+        param.sched_priority = RT_PRIORITY;
+        if (::sched_setscheduler(0, SCHED_FIFO, &param) != 0 || ::mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            std::fprintf(stderr, "zbe_hub: --rt: %s (continuing without)\n", std::strerror(errno));
+        }
+    }
+
+    idrive::EventRingWriter ring;
+    if (!ring.create(options.shm, options.slots)) {
+        std::fprintf(stderr, "zbe_hub: %s: %s\n", options.shm, std::strerror(errno));
+        return 1;
+    }
+    std::fprintf(stderr, "zbe_hub: publishing to %s (%u slots)\n", options.shm, ring.slotCount());
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    int signalFd = ::signalfd(-1, &signals, SFD_CLOEXEC);
+    int epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_event signalEvent{};
+    signalEvent.events = EPOLLIN;
+    signalEvent.data.fd = signalFd;
+    if (signalFd < 0 || epollFd < 0 || ::epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &signalEvent) != 0) {
+        std::fprintf(stderr, "zbe_hub: epoll setup: %s\n", std::strerror(errno));
+        return 1;
+    }
+
+    idrive::EventMux mux;
+    if (options.socket) {
+        // One fd per client; the usual soft limit of 1024 is too close
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < options.maxClients + 64) {
+            limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, options.maxClients + 64);
+            ::setrlimit(RLIMIT_NOFILE, &limit);
+        }
+        epoll_event muxEvent{};
+        muxEvent.events = EPOLLIN;
+        muxEvent.data.fd = -1;
+        if (!mux.listen(options.socket, options.clientQueue, options.slowPolicy, options.maxClients) ||
+            ::epoll_ctl(epollFd, EPOLL_CTL_ADD, mux.fd(), &muxEvent) != 0) {
+            std::fprintf(stderr, "zbe_hub: %s: %s\n", options.socket, std::strerror(errno));
+            return 1;
+        }
+        std::fprintf(stderr, "zbe_hub: serving %s\n", options.socket);
+    }
+
+    idrive::DeviceClient client;
+    idrive::DeviceUringReader reader;
+    int deviceFd = -1;
+    client.setEventMask(idrive::ALL_DEVICE_EVENTS & ~idrive::eventBit(DeviceEventKind::Text) &
+                        ~idrive::eventBit(DeviceEventKind::Capture));
+    HubCounters counters;
+    bool running = true;
+    bool warned = false;
+
+    while (running) {
+        if (!client.isOpen()) {
+            deviceFd = openDevice(options, client, reader, epollFd);
+            if (deviceFd < 0 && !warned) {
+                std::fprintf(stderr, "zbe_hub: %s: %s, retrying\n", options.tty, std::strerror(errno));
+            }
+            warned = deviceFd < 0;
+        }
+
+        epoll_event events[4];
+        int ready = ::epoll_wait(epollFd, events, 4, client.isOpen() ? -1 : REOPEN_INTERVAL_MS);
+        if (ready < 0 && errno != EINTR) break;
+
+        for (int e = 0; e < ready; e++) {
+            if (events[e].data.fd == signalFd) {
+                signalfd_siginfo info;
+                if (::read(signalFd, &info, sizeof(info)) != sizeof(info)) continue;
+                if (info.ssi_signo == SIGUSR1) {
+                    printCounters(counters, ring, client, mux);
+                } else {
+                    running = false;
+                }
+                continue;
+            }
+            if (events[e].data.fd == -1) {
+                mux.service();
+                continue;
+            }
+
+            bool lost = reader.isRunning() ? !reader.receive(client.parser(), 0) : !client.receive(0);
+            int64_t readNs = nowNs();
+            client.dispatch([&](const DeviceEvent &event) {
+                RingRecord record;
+                if (!idrive::toRingRecord(event, readNs, record)) return;
+                ring.publish(record);
+                mux.publish(record);
+                counters.published[static_cast<size_t>(event.kind)]++;
+            });
+            mux.flush();
+            if (events[e].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) lost = true;
+            if (lost) {
+                std::fprintf(stderr, "zbe_hub: %s went away\n", options.tty);
+                ::epoll_ctl(epollFd, EPOLL_CTL_DEL, deviceFd, nullptr);
+                reader.stop();
+                client.close();
+                counters.reopened++;
+            }
+        }
+    }
+
+    reader.stop();
+    if (client.isOpen()) {
+        client.beginBatch();
+        if (options.raw) client.setDebugMode(idrive::DebugMode::Normal);
+        if (options.signals) client.setSignalReports(false);
+        client.flush();
+        client.close();
+    }
+    printCounters(counters, ring, client, mux);
+    return 0;
+}
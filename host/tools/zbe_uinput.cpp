@@ -0,0 +1,503 @@
+// Exposes the controller as a native Linux input device through uinput, so
+// the HMI gets key presses and wheel events instead of scraping serial text.
+//
+//   zbe_uinput <tty> [--touch] [--invert-wheel] [--key LABEL=CODE]...
+//              [--name NAME] [--rt] [--loopback] [--dry-run]
+//
+// "Rotation CW/CCW" lines become REL_WHEEL steps. The eight buttons and the
+// five knob directions become keys, held while PRESSED (TOUCHED is not a
+// press); --key rebinds a label to another evdev code. --touch turns on the
+// firmware's signal reports ('g1') and maps the ZBE_TOUCHPAD signals of
+// dbc/idrive_kcan.dbc to ABS_X/ABS_Y/BTN_TOUCH plus REL_WHEEL/REL_HWHEEL
+// touch scrolling. The touchpad layout in the DBC is still provisional.
+//
+// The stream is read and parsed by idrive::DeviceClient (device_client.h)
+// with only the input event kinds enabled, and watched with epoll next to a
+// signalfd. Everything decoded from one wake-up goes out in a single
+// write() ending in SYN_REPORT. The time from the wake-up to that write
+// returning is kept in a histogram, which is printed on SIGUSR1 and at exit.
+// --loopback answers the firmware's LAT lines once the events are written
+// ('a1'), so the device's 'a' table covers USB and the evdev write too.
+// --rt asks for SCHED_FIFO and locks memory. Each open puts the firmware in
+// normal mode ('d0'), since raw mode stops the input lines. If the device
+// goes away it is reopened. --dry-run prints the events instead of
+// creating the device.
+
+#include "idrive/device_client.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int    REOPEN_INTERVAL_MS = 500;
+constexpr int    TOUCH_RANGE        = 4095;  // 12-bit TouchX/TouchY
+constexpr int    TOUCH_SCROLL_STEP  = 160;   // touch units per wheel detent
+constexpr size_t LATENCY_BUCKETS    = 5000;  // 1 us each, the last one collects the rest
+constexpr int    RT_PRIORITY        = 50;
+
+struct KeyBinding {
+    const char *label;
+    uint16_t    code;
+};
+
+// Labels as printed by logButtonChange() / logKnobChange()
+KeyBinding buttonKeys[] = {
+    {"BACK", KEY_BACK},   {"HOME", KEY_HOMEPAGE},    {"COM", KEY_PHONE},  {"OPTION", KEY_OPTION},
+    {"MEDIA", KEY_MEDIA}, {"NAV", KEY_NAV_CHART},    {"MAP", KEY_NAV_INFO}, {"GLOBE", KEY_WWW},
+};
+KeyBinding knobKeys[] = {
+    {"CENTER", KEY_ENTER}, {"LEFT", KEY_LEFT}, {"UP", KEY_UP}, {"RIGHT", KEY_RIGHT}, {"DOWN", KEY_DOWN},
+};
+
+struct Options {
+    const char *tty = nullptr;
+    const char *name = "BMW iDrive Controller";
+    bool touch = false;
+    bool invertWheel = false;
+    bool realtime = false;
+    bool loopback = false;
+    bool dryRun = false;
+};
+
+int usage() {
+    std::fprintf(stderr,
+                 "usage: zbe_uinput <tty> [--touch] [--invert-wheel] [--key LABEL=CODE]...\n"
+                 "                  [--name NAME] [--rt] [--loopback] [--dry-run]\n");
+    return 2;
+}
+
+int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+template <size_t N>
+bool rebindIn(KeyBinding (&table)[N], const std::string &label, uint16_t code) {
+    for (auto &binding : table) {
+        if (label == binding.label) {
+            binding.code = code;
+            return true;
+        }
+    }
+    return false;
+}
+
+// "--key GLOBE=0x166"
+bool rebind(const char *spec) {
+    const char *eq = std::strchr(spec, '=');
+    if (!eq) return false;
+    std::string label(spec, eq);
+    char *end = nullptr;
+    unsigned long code = std::strtoul(eq + 1, &end, 0);
+    if (*end || code == 0 || code >= KEY_CNT) return false;
+    return rebindIn(buttonKeys, label, static_cast<uint16_t>(code)) ||
+           rebindIn(knobKeys, label, static_cast<uint16_t>(code));
+}
+
+class LatencyHistogram {
+public:
+    LatencyHistogram() : buckets_(LATENCY_BUCKETS, 0) {}
+
+    void record(int64_t ns) {
+        size_t us = static_cast<size_t>(std::max<int64_t>(ns, 0) / 1000);
+        buckets_[std::min(us, LATENCY_BUCKETS - 1)]++;
+        maxNs_ = std::max(maxNs_, ns);
+        count_++;
+    }
+
+    void print() const {
+        if (count_ == 0) {
+            std::fprintf(stderr, "zbe_uinput: no events yet\n");
+            return;
+        }
+        std::fprintf(stderr, "zbe_uinput: %llu writes, tty wake-up -> evdev written (us): p50 %zu  p90 %zu  "
+                             "p99 %zu  p99.9 %zu  max %.1f\n",
+                     static_cast<unsigned long long>(count_), percentile(0.5), percentile(0.9), percentile(0.99),
+                     percentile(0.999), static_cast<double>(maxNs_) / 1000);
+    }
+
+private:
+    size_t percentile(double q) const {
+        uint64_t target = static_cast<uint64_t>(q * static_cast<double>(count_ - 1)) + 1, seen = 0;
+        for (size_t us = 0; us < buckets_.size(); us++) {
+            seen += buckets_[us];
+            if (seen >= target) return us;
+        }
+        return buckets_.size() - 1;
+    }
+
+    std::vector<uint64_t> buckets_;
+    uint64_t count_ = 0;
+    int64_t maxNs_ = 0;
+};
+
+// Collects the events of one wake-up and writes them with one syscall
+class InputSink {
+public:
+    ~InputSink() {
+        if (fd_ >= 0) {
+            ::ioctl(fd_, UI_DEV_DESTROY);
+            ::close(fd_);
+        }
+    }
+
+    bool open(const Options &options) {
+        dryRun_ = options.dryRun;
+        events_.reserve(256);
+        if (dryRun_) return true;
+
+        fd_ = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd_ < 0) {
+            std::fprintf(stderr, "zbe_uinput: /dev/uinput: %s\n", std::strerror(errno));
+            return false;
+        }
+        bool ok = ::ioctl(fd_, UI_SET_EVBIT, EV_KEY) == 0 && ::ioctl(fd_, UI_SET_EVBIT, EV_REL) == 0 &&
+                  ::ioctl(fd_, UI_SET_EVBIT, EV_SYN) == 0 && ::ioctl(fd_, UI_SET_RELBIT, REL_WHEEL) == 0;
+        for (const auto &binding : buttonKeys) ok = ok && ::ioctl(fd_, UI_SET_KEYBIT, binding.code) == 0;
+        for (const auto &binding : knobKeys) ok = ok && ::ioctl(fd_, UI_SET_KEYBIT, binding.code) == 0;
+        if (options.touch) {
+            ok = ok && ::ioctl(fd_, UI_SET_RELBIT, REL_HWHEEL) == 0 && ::ioctl(fd_, UI_SET_EVBIT, EV_ABS) == 0 &&
+                 ::ioctl(fd_, UI_SET_KEYBIT, BTN_TOUCH) == 0 && ::ioctl(fd_, UI_SET_PROPBIT, INPUT_PROP_POINTER) == 0;
+            for (uint16_t axis : {ABS_X, ABS_Y}) {
+                uinput_abs_setup abs{};
+                abs.code = axis;
+                abs.absinfo.maximum = TOUCH_RANGE;
+                ok = ok && ::ioctl(fd_, UI_ABS_SETUP, &abs) == 0;
+            }
+        }
+
+        uinput_setup setup{};
+        setup.id.bustype = BUS_VIRTUAL;
+        std::snprintf(setup.name, sizeof(setup.name), "%s", options.name);
+        ok = ok && ::ioctl(fd_, UI_DEV_SETUP, &setup) == 0 && ::ioctl(fd_, UI_DEV_CREATE) == 0;
+        if (!ok) std::fprintf(stderr, "zbe_uinput: uinput setup: %s\n", std::strerror(errno));
+        return ok;
+    }
+
+    void key(uint16_t code, bool down) {
+        if (code < keyDown_.size() && keyDown_[code] == down) return;
+        if (code < keyDown_.size()) keyDown_[code] = down;
+        add(EV_KEY, code, down ? 1 : 0);
+    }
+
+    void rel(uint16_t code, int value) { add(EV_REL, code, value); }
+    void abs(uint16_t code, int value) { add(EV_ABS, code, value); }
+
+    bool pending() const { return !events_.empty(); }
+
+    bool flush() {
+        if (events_.empty()) return true;
+        add(EV_SYN, SYN_REPORT, 0);
+        bool ok = true;
+        if (dryRun_) {
+            for (const auto &event : events_) {
+                if (event.type != EV_SYN) std::printf("type %u code %u value %d\n", event.type, event.code, event.value);
+            }
+            std::printf("sync\n");
+            std::fflush(stdout);
+        } else {
+            size_t bytes = events_.size() * sizeof(input_event);
+            ok = ::write(fd_, events_.data(), bytes) == static_cast<ssize_t>(bytes);
+            if (!ok) std::fprintf(stderr, "zbe_uinput: uinput write: %s\n", std::strerror(errno));
+        }
+        events_.clear();
+        return ok;
+    }
+
+private:
+    void add(uint16_t type, uint16_t code, int32_t value) {
+        input_event event{};
+        event.type = type;
+        event.code = code;
+        event.value = value;
+        events_.push_back(event);
+    }
+
+    int fd_ = -1;
+    bool dryRun_ = false;
+    std::vector<input_event> events_;
+    std::vector<bool> keyDown_ = std::vector<bool>(KEY_CNT, false);
+};
+
+using idrive::DeviceEvent;
+using idrive::DeviceEventKind;
+
+// Turns the firmware's events into input events
+class EventDecoder {
+public:
+    EventDecoder(const Options &options, InputSink &sink) : options_(options), sink_(sink) { acks_.reserve(64); }
+
+    // The event kinds this decoder needs from the stream
+    uint32_t eventMask() const {
+        uint32_t mask = idrive::eventBit(DeviceEventKind::Rotation) | idrive::eventBit(DeviceEventKind::Knob) |
+                        idrive::eventBit(DeviceEventKind::Button);
+        if (options_.touch) mask |= idrive::eventBit(DeviceEventKind::Touch);
+        if (options_.loopback) mask |= idrive::eventBit(DeviceEventKind::Latency);
+        return mask;
+    }
+
+    void event(const DeviceEvent &event) {
+        switch (event.kind) {
+            case DeviceEventKind::Rotation:
+                sink_.rel(REL_WHEEL, ((event.rotation.direction > 0) != options_.invertWheel) ? -1 : 1);
+                break;
+            case DeviceEventKind::Knob:
+                knob(event.knob);
+                break;
+            case DeviceEventKind::Button:
+                button(event.button);
+                break;
+            case DeviceEventKind::Touch:
+                touch(event.touch);
+                break;
+            case DeviceEventKind::Latency:
+                acks_.push_back(event.latencySequence);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // LAT sequences owed a "!<seq>" reply since the last call
+    std::vector<uint32_t> &acks() { return acks_; }
+
+    void releaseAll() {
+        for (const auto &binding : buttonKeys) sink_.key(binding.code, false);
+        for (const auto &binding : knobKeys) sink_.key(binding.code, false);
+        if (touching_) sink_.key(BTN_TOUCH, false);
+        touching_ = false;
+    }
+
+private:
+    // The firmware reports releases first, and "Knob RELEASED" carries no label
+    void knob(const idrive::DeviceKnob &knob) {
+        for (const auto &binding : knobKeys) {
+            if (!knob.pressed) {
+                sink_.key(binding.code, false);
+            } else if (knob.position == binding.label) {
+                sink_.key(binding.code, true);
+            }
+        }
+    }
+
+    // TOUCHED is not a press
+    void button(const idrive::DeviceButton &button) {
+        for (const auto &binding : buttonKeys) {
+            if (button.label == binding.label) {
+                sink_.key(binding.code, button.action == idrive::ButtonAction::Pressed);
+                return;
+            }
+        }
+    }
+
+    void touch(const idrive::DeviceTouch &touch) {
+        switch (touch.changed) {
+            case idrive::TouchField::Fingers: {
+                bool down = touch.fingers > 0;
+                if (down != touching_) {
+                    touching_ = down;
+                    haveAnchor_[0] = haveAnchor_[1] = false;
+                    sink_.key(BTN_TOUCH, down);
+                }
+                break;
+            }
+            case idrive::TouchField::X:
+                sink_.abs(ABS_X, touch.x);
+                scroll(0, touch.x, REL_HWHEEL, 1);
+                break;
+            case idrive::TouchField::Y:
+                sink_.abs(ABS_Y, touch.y);
+                scroll(1, touch.y, REL_WHEEL, options_.invertWheel ? 1 : -1);
+                break;
+        }
+    }
+
+    // One wheel detent per TOUCH_SCROLL_STEP of finger travel
+    void scroll(int axis, int position, uint16_t code, int direction) {
+        if (!touching_) return;
+        if (!haveAnchor_[axis]) {
+            anchor_[axis] = position;
+            haveAnchor_[axis] = true;
+            return;
+        }
+        int steps = (position - anchor_[axis]) / TOUCH_SCROLL_STEP;
+        if (steps == 0) return;
+        anchor_[axis] += steps * TOUCH_SCROLL_STEP;
+        sink_.rel(code, steps * direction);
+    }
+
+    const Options &options_;
+    InputSink &sink_;
+    std::vector<uint32_t> acks_;
+    bool touching_ = false;
+    bool haveAnchor_[2] = {false, false};
+    int anchor_[2] = {0, 0};
+};
+
+bool openDevice(const Options &options, idrive::DeviceClient &client, int epollFd) {
+    if (!client.open(options.tty)) return false;
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = client.fd();
+    if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, client.fd(), &event) != 0) {
+        client.close();
+        return false;
+    }
+    // Button, knob and rotation lines stop in raw mode ('d2'), which an
+    // earlier session may have left on; normal mode also drops frame lines
+    client.beginBatch();
+    client.setDebugMode(idrive::DebugMode::Normal);
+    if (options.touch) client.setSignalReports(true);
+    if (options.loopback) client.setLatencyLoopback(true);
+    client.flush();
+    std::fprintf(stderr, "zbe_uinput: reading %s%s\n", options.tty, client.lowLatency() ? " (low latency)" : "");
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (std::strcmp(arg, "--touch") == 0) {
+            options.touch = true;
+        } else if (std::strcmp(arg, "--invert-wheel") == 0) {
+            options.invertWheel = true;
+        } else if (std::strcmp(arg, "--rt") == 0) {
+            options.realtime = true;
+        } else if (std::strcmp(arg, "--loopback") == 0) {
+            options.loopback = true;
+        } else if (std::strcmp(arg, "--dry-run") == 0) {
+            options.dryRun = true;
+        } else if (std::strcmp(arg, "--name") == 0 && i + 1 < argc) {
+            options.name = argv[++i];
+        } else if (std::strcmp(arg, "--key") == 0 && i + 1 < argc) {
+            if (!rebind(argv[++i])) {
+                std::fprintf(stderr, "zbe_uinput: bad binding %s (LABEL=CODE, e.g. GLOBE=0x166)\n", argv[i]);
+                return 2;
+            }
+        } else if (arg[0] != '-' && !options.tty) {
+            options.tty = arg;
+        } else {
+            return usage();
+        }
+    }
+    if (!options.tty) return usage();
+
+    if (options.realtime) {
+        sched_param param{};
+        param.sched_priority = RT_PRIORITY;
+        if (::sched_setscheduler(0, SCHED_FIFO, &param) != 0 || ::mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            std::fprintf(stderr, "zbe_uinput: --rt: %s (continuing without)\n", std::strerror(errno));
+        }
+    }
+
+    InputSink sink;
+    if (!sink.open(options)) return 1;
+    EventDecoder decoder(options, sink);
+    LatencyHistogram latency;
+    idrive::DeviceClient client;
+    client.setEventMask(decoder.eventMask());
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    int signalFd = ::signalfd(-1, &signals, SFD_CLOEXEC);
+    int epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_event signalEvent{};
+    signalEvent.events = EPOLLIN;
+    signalEvent.data.fd = signalFd;
+    if (signalFd < 0 || epollFd < 0 || ::epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &signalEvent) != 0) {
+        std::fprintf(stderr, "zbe_uinput: epoll setup: %s\n", std::strerror(errno));
+        return 1;
+    }
+
+    bool running = true;
+    bool warned = false;
+
+    while (running) {
+        if (!client.isOpen()) {
+            bool opened = openDevice(options, client, epollFd);
+            if (!opened && !warned) {
+                std::fprintf(stderr, "zbe_uinput: %s: %s, retrying\n", options.tty, std::strerror(errno));
+            }
+            warned = !opened;
+        }
+
+        epoll_event events[4];
+        int ready = ::epoll_wait(epollFd, events, 4, client.isOpen() ? -1 : REOPEN_INTERVAL_MS);
+        int64_t wakeNs = nowNs();
+        if (ready < 0 && errno != EINTR) break;
+
+        for (int e = 0; e < ready; e++) {
+            if (events[e].data.fd == signalFd) {
+                signalfd_siginfo info;
+                if (::read(signalFd, &info, sizeof(info)) != sizeof(info)) continue;
+                if (info.ssi_signo == SIGUSR1) {
+                    latency.print();
+                } else {
+                    running = false;
+                }
+                continue;
+            }
+
+            // One read per wake-up (epoll is level-triggered), decoded in place
+            bool lost = !client.receive(0);
+            client.dispatch([&](const DeviceEvent &event) { decoder.event(event); });
+            if (events[e].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) lost = true;
+
+            if (sink.pending()) {
+                sink.flush();
+                latency.record(nowNs() - wakeNs);
+            }
+            if (!decoder.acks().empty()) {
+                client.beginBatch();
+                for (uint32_t sequence : decoder.acks()) client.ackLatency(sequence);
+                client.flush();
+                decoder.acks().clear();
+            }
+            if (lost) {
+                std::fprintf(stderr, "zbe_uinput: %s went away\n", options.tty);
+                ::epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd(), nullptr);
+                client.close();
+                decoder.releaseAll();
+                sink.flush();
+            }
+        }
+    }
+
+    if (client.isOpen()) {
+        client.beginBatch();
+        if (options.touch) client.setSignalReports(false);
+        if (options.loopback) client.setLatencyLoopback(false);
+        client.flush();
+        client.close();
+    }
+    decoder.releaseAll();
+    sink.flush();
+    latency.print();
+    return 0;
+}
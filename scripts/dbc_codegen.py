@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""Generates constexpr signal decoders from a DBC file.
+
+    dbc_codegen.py <input.dbc> <output.h>
+
+For every BO_ the header gets a namespace with the message ID, one
+SignalField alias and one inline accessor per SG_, and an enum per VAL_
+table; all signals are also listed in kcan::SIGNALS for table-driven code.
+The extraction itself lives in src/signal_decode.h.
+
+Run at build time by scripts/generate_tables.py (PlatformIO) and by the
+host CMake project. Layout mistakes (signals overlapping or running past
+the DLC, unknown VAL_ targets, values that do not fit) fail the build.
+The output is only rewritten when it changes.
+"""
+
+import os
+import re
+import sys
+
+MESSAGE_RE = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)")
+SIGNAL_RE = re.compile(
+    r"^SG_\s+(\w+)\s*(M|m\d+)?\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+    r"\(\s*([^,\s]+)\s*,\s*([^)\s]+)\s*\)\s*\[[^\]]*\]\s*\"([^\"]*)\""
+)
+VALUE_RE = re.compile(r"^VAL_\s+(\d+)\s+(\w+)\s+(.*);")
+VALUE_PAIR_RE = re.compile(r"(-?\d+)\s+\"([^\"]*)\"")
+COMMENT_RE = re.compile(r"^CM_\s+BO_\s+(\d+)\s+\"([^\"]*)\"\s*;")
+
+
+class DbcError(Exception):
+    pass
+
+
+class Signal:
+    def __init__(self, name, start, length, intel, signed, factor, offset, unit):
+        self.name = name
+        self.start = start
+        self.length = length
+        self.intel = intel
+        self.signed = signed
+        self.factor = factor
+        self.offset = offset
+        self.unit = unit
+        self.values = []
+
+    def bits(self):
+        """Payload bit positions (byte * 8 + bit) the signal occupies."""
+        if self.intel:
+            return set(range(self.start, self.start + self.length))
+        # Motorola: walk from the MSB down the sawtooth numbering
+        positions, bit = set(), self.start
+        for _ in range(self.length):
+            positions.add(bit)
+            bit = bit - 1 if bit % 8 else bit + 15
+        return positions
+
+    def fits(self):
+        if not 1 <= self.length <= 64 or self.start > 63:
+            return False
+        if self.intel:
+            return self.start + self.length <= 64
+        return (7 - self.start // 8) * 8 + self.start % 8 + 1 >= self.length
+
+    def scaled(self):
+        return self.factor != 1.0 or self.offset != 0.0
+
+
+class Message:
+    def __init__(self, can_id, name, dlc, sender):
+        self.extended = bool(can_id & 0x80000000)
+        self.id = can_id & 0x1FFFFFFF
+        self.name = name
+        self.dlc = dlc
+        self.sender = sender
+        self.comment = ""
+        self.signals = []
+
+
+def parse_dbc(text, path):
+    messages, by_raw_id, current = [], {}, None
+    for number, raw in enumerate(text.splitlines(), 1):
+        line = raw.strip()
+        where = "%s:%d" % (path, number)
+        if line.startswith("BO_ "):
+            match = MESSAGE_RE.match(line)
+            if not match:
+                raise DbcError(where + ": cannot parse message")
+            raw_id = int(match.group(1))
+            if raw_id in by_raw_id:
+                raise DbcError(where + ": message ID 0x%X defined twice" % (raw_id & 0x1FFFFFFF))
+            current = Message(raw_id, match.group(2), int(match.group(3)), match.group(4))
+            if current.dlc > 8:
+                raise DbcError(where + ": DLC %d is not classic CAN" % current.dlc)
+            messages.append(current)
+            by_raw_id[raw_id] = current
+        elif line.startswith("SG_ "):
+            match = SIGNAL_RE.match(line)
+            if not match or current is None:
+                raise DbcError(where + ": cannot parse signal")
+            if match.group(2):
+                raise DbcError(where + ": multiplexed signals are not supported")
+            signal = Signal(match.group(1), int(match.group(3)), int(match.group(4)), match.group(5) == "1",
+                            match.group(6) == "-", float(match.group(7)), float(match.group(8)), match.group(9))
+            check_signal(current, signal, where)
+            current.signals.append(signal)
+        elif line.startswith("VAL_ "):
+            match = VALUE_RE.match(line)
+            if not match:
+                raise DbcError(where + ": cannot parse value table")
+            message = by_raw_id.get(int(match.group(1)))
+            signal = next((s for s in message.signals if s.name == match.group(2)), None) if message else None
+            if signal is None:
+                raise DbcError(where + ": value table for unknown signal %s" % match.group(2))
+            for value, name in VALUE_PAIR_RE.findall(match.group(3)):
+                value = int(value)
+                low = -(1 << (signal.length - 1)) if signal.signed else 0
+                high = (1 << (signal.length - 1)) - 1 if signal.signed else (1 << signal.length) - 1
+                if not low <= value <= high:
+                    raise DbcError(where + ": value %d does not fit %s" % (value, signal.name))
+                if signal.length > 32:
+                    raise DbcError(where + ": value tables need signals of 32 bits or less")
+                signal.values.append((value, name))
+        else:
+            match = COMMENT_RE.match(line)
+            if match and int(match.group(1)) in by_raw_id:
+                by_raw_id[int(match.group(1))].comment = match.group(2)
+    return messages
+
+
+def check_signal(message, signal, where):
+    if not signal.fits():
+        raise DbcError(where + ": %s runs past the 8-byte payload" % signal.name)
+    bits = signal.bits()
+    if max(bits) >= message.dlc * 8:
+        raise DbcError(where + ": %s runs past DLC %d" % (signal.name, message.dlc))
+    for other in message.signals:
+        if other.name == signal.name:
+            raise DbcError(where + ": %s defined twice in %s" % (signal.name, message.name))
+        if bits & other.bits():
+            raise DbcError(where + ": %s overlaps %s" % (signal.name, other.name))
+
+
+def camel(name, upper_first=False):
+    parts = [p for p in re.split(r"[^A-Za-z0-9]+", name) if p]
+    if not parts:
+        return "Unnamed"
+    words = []
+    for part in parts:
+        # Keep existing CamelCase, fold ALL_CAPS words
+        words.append(part[0].upper() + (part[1:].lower() if part.isupper() else part[1:]))
+    text = "".join(words)
+    if text[0].isdigit():
+        text = "V" + text
+    return text if upper_first else text[0].lower() + text[1:]
+
+
+def integer_type(length, signed):
+    for bits in (8, 16, 32, 64):
+        if length <= bits:
+            return ("int%d_t" if signed else "uint%d_t") % bits
+    return "uint64_t"
+
+
+def float_literal(value):
+    text = repr(float(value))
+    return text + "f" if "e" in text or "." in text else text + ".0f"
+
+
+def c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def generate(messages, source_name):
+    out = []
+    emit = out.append
+    emit("#pragma once")
+    emit("")
+    emit("// Generated by scripts/dbc_codegen.py from %s; edit the DBC, not this" % source_name)
+    emit("// file. Accessors take the 8-byte payload of a frame with the message's ID.")
+    emit("")
+    emit('#include "signal_decode.h"')
+    emit("")
+    emit("#include <cstdint>")
+    emit("")
+    emit("namespace kcan {")
+
+    for message in messages:
+        namespace = message.name.lower()
+        emit("")
+        emit("// %s (0x%X)%s" % (message.name, message.id, ": " + message.comment if message.comment else ""))
+        emit("namespace %s {" % namespace)
+        emit("")
+        emit("constexpr uint32_t ID       = 0x%X;" % message.id)
+        emit("constexpr bool     EXTENDED = %s;" % ("true" if message.extended else "false"))
+        emit("constexpr uint8_t  DLC      = %d;" % message.dlc)
+        if message.signals:
+            emit("")
+            width = max(len(camel(s.name, True)) for s in message.signals)
+            for s in message.signals:
+                order = "ByteOrder::Intel" if s.intel else "ByteOrder::Motorola"
+                emit("using %-*s = SignalField<%d, %d, %s, %s>;" % (width, camel(s.name, True), s.start, s.length,
+                                                                    order, "true" if s.signed else "false"))
+            emit("")
+            for s in message.signals:
+                field = camel(s.name, True)
+                accessor = camel(s.name)
+                kind = integer_type(s.length, s.signed)
+                if s.scaled():
+                    emit("inline float %s(const uint8_t *data) {" % accessor)
+                    emit("    return static_cast<float>(%s::value(data)) * %s %s %s;%s" % (
+                        field, float_literal(s.factor), "-" if s.offset < 0 else "+", float_literal(abs(s.offset)),
+                        "  // " + s.unit if s.unit else ""))
+                    emit("}")
+                    emit("inline %s %sRaw(const uint8_t *data) { return static_cast<%s>(%s::value(data)); }" % (
+                        kind, accessor, kind, field))
+                else:
+                    emit("inline %s %s(const uint8_t *data) { return static_cast<%s>(%s::value(data)); }" % (
+                        kind, accessor, kind, field))
+            for s in message.signals:
+                if not s.values:
+                    continue
+                emit("")
+                emit("enum class %sValue : %s {" % (camel(s.name, True), integer_type(s.length, s.signed)))
+                names = [camel(name, True) for _, name in s.values]
+                width = max(len(n) for n in names)
+                for (value, _), name in zip(s.values, names):
+                    emit("    %-*s = 0x%02X," % (width, name, value) if value >= 0 else
+                         "    %-*s = %d," % (width, name, value))
+                emit("};")
+        emit("")
+        emit("}  // namespace %s" % namespace)
+
+    # Flat table for the generic decoder and serial printing
+    emit("")
+    emit("// --- All signals ---")
+    for message in messages:
+        for s in message.signals:
+            if not s.values:
+                continue
+            emit("")
+            emit("constexpr SignalValueName %s_%s_VALUES[] = {" % (message.name.upper(), s.name.upper()))
+            for value, name in s.values:
+                # Tables match on the raw (unsigned, masked) field value
+                emit("    {%d, %s}," % (value & ((1 << s.length) - 1), c_string(name)))
+            emit("};")
+
+    emit("")
+    emit("constexpr SignalSpec SIGNALS[] = {")
+    for message in messages:
+        for s in message.signals:
+            values = ("%s_%s_VALUES, %d" % (message.name.upper(), s.name.upper(), len(s.values))
+                      if s.values else "nullptr, 0")
+            emit("    {0x%X, %s, %s, %d, %d, %s, %s, %s, %s, %s, %s}," % (
+                message.id, c_string(message.name), c_string(s.name), s.start, s.length,
+                "ByteOrder::Intel" if s.intel else "ByteOrder::Motorola", "true" if s.signed else "false",
+                float_literal(s.factor), float_literal(s.offset), c_string(s.unit), values))
+    emit("};")
+    emit("")
+    emit("constexpr uint8_t SIGNAL_COUNT = sizeof(SIGNALS) / sizeof(SIGNALS[0]);")
+    emit("")
+    emit("}  // namespace kcan")
+    return "\n".join(out) + "\n"
+
+
+def generate_file(dbc_path, header_path):
+    """Regenerates header_path from dbc_path; returns True when it changed."""
+    with open(dbc_path, encoding="latin-1") as f:
+        messages = parse_dbc(f.read(), dbc_path)
+    text = generate(messages, os.path.basename(dbc_path))
+    try:
+        with open(header_path, encoding="utf-8") as f:
+            if f.read() == text:
+                return False
+    except OSError:
+        pass
+    os.makedirs(os.path.dirname(os.path.abspath(header_path)), exist_ok=True)
+    with open(header_path, "w", encoding="utf-8", newline="\n") as f:
+        f.write(text)
+    return True
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("usage: dbc_codegen.py <input.dbc> <output.h>\n")
+        return 2
+    try:
+        generate_file(argv[1], argv[2])
+    except DbcError as error:
+        sys.stderr.write("dbc_codegen: %s\n" % error)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,41 @@
+"""PlatformIO pre-build script: regenerates the build-time tables.
+
+  kcan_signals.h  from dbc/idrive_kcan.dbc       (scripts/dbc_codegen.py)
+  zbe_mappings.h  from the custom_zbe_spec file  (scripts/zbe_codegen.py),
+                  default zbe/f44.spec
+
+The headers go to $BUILD_DIR/generated, which is added to the include
+path. They are only rewritten when their input changed, so unchanged builds
+stay incremental. A DBC error or a spec entry that contradicts its
+captures stops the build.
+"""
+
+import os
+import sys
+
+Import("env")  # noqa: F821 - provided by SCons
+
+project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+sys.path.insert(0, os.path.join(project_dir, "scripts"))
+
+import dbc_codegen  # noqa: E402
+import zbe_codegen  # noqa: E402
+
+generated_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")  # noqa: F821
+zbe_spec = env.GetProjectOption("custom_zbe_spec", "zbe/f44.spec")  # noqa: F821
+
+GENERATORS = [
+    (dbc_codegen, os.path.join("dbc", "idrive_kcan.dbc"), "kcan_signals.h", dbc_codegen.DbcError),
+    (zbe_codegen, zbe_spec, "zbe_mappings.h", zbe_codegen.SpecError),
+]
+
+for module, source, header, error_type in GENERATORS:
+    name = module.__name__
+    try:
+        if module.generate_file(os.path.join(project_dir, source), os.path.join(generated_dir, header)):
+            print("%s: regenerated %s from %s" % (name, header, source))
+    except error_type as error:
+        sys.stderr.write("%s: %s\n" % (name, error))
+        env.Exit(1)  # noqa: F821
+
+env.Append(CPPPATH=[generated_dir])  # noqa: F821
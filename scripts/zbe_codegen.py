@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+"""Generates the controller mapping tables from an annotated capture spec.
+
+    zbe_codegen.py <variant.spec> <output.h>
+
+The spec (see zbe/f44.spec) lists each knob position and button with the
+byte and values it claims, followed by the captures it was read from. The
+header gets KNOB_MAPPINGS and BUTTON_MAPPINGS in the layout of
+src/controller_mapping.h plus 256-entry decode tables per payload byte,
+so the firmware turns a frame into pressed/touched bitmasks with one load
+per byte.
+
+Run at build time by scripts/generate_tables.py (PlatformIO). Every entry
+is checked against its captures first; a contradiction stops the build.
+The output is only rewritten when it changes.
+"""
+
+import os
+import re
+import sys
+
+MAX_KNOB_POSITIONS = 8   # KNOB_DECODE entries are uint8_t masks
+MAX_BUTTONS = 16         # BUTTON_DECODE entries hold pressed | touched << 16
+
+CAPTURE_RE = re.compile(r"0x([0-9A-Fa-f]{1,8})\b[^:]*:\s*(?:Data:\s*)?((?:[0-9A-Fa-f]{2}\s*){1,8})$")
+FIELD_RE = re.compile(r"^(\w+)=(\S+)$")
+
+
+class SpecError(Exception):
+    pass
+
+
+class Entry:
+    def __init__(self, kind, label, byte, pressed, touched, released, where):
+        self.kind = kind
+        self.label = label
+        self.byte = byte
+        self.pressed = pressed
+        self.touched = touched
+        self.released = released
+        self.where = where
+        self.captures = []
+
+    def values(self):
+        values = {self.pressed, self.released}
+        if self.touched is not None:
+            values.add(self.touched)
+        return values
+
+    def field(self, suffix):
+        if self.kind == "knob":
+            return "knobPressed" + self.label.capitalize()
+        return self.label.lower() + "Button" + suffix
+
+
+class Spec:
+    def __init__(self):
+        self.controller_id = None
+        self.ignored = set()
+        self.knobs = []
+        self.buttons = []
+
+
+def parse_hex_byte(text, where):
+    try:
+        value = int(text, 16)
+    except ValueError:
+        raise SpecError(where + ": '%s' is not a hex byte" % text)
+    if not 0 <= value <= 0xFF:
+        raise SpecError(where + ": 0x%X does not fit a byte" % value)
+    return value
+
+
+def parse_entry(kind, words, where):
+    if len(words) < 2 or not re.match(r"^[A-Z][A-Z0-9]*$", words[1]):
+        raise SpecError(where + ": %s needs an upper-case label" % kind)
+    fields = {}
+    for word in words[2:]:
+        match = FIELD_RE.match(word)
+        if not match:
+            raise SpecError(where + ": cannot parse '%s'" % word)
+        fields[match.group(1)] = match.group(2)
+
+    required = ["byte", "pressed", "released"] + (["touched"] if kind == "button" else [])
+    missing = [name for name in required if name not in fields]
+    unknown = [name for name in fields if name not in required]
+    if missing or unknown:
+        raise SpecError(where + ": %s %s needs %s" % (kind, words[1], " ".join(n + "=" for n in required)))
+
+    byte = int(fields["byte"])
+    if not 0 <= byte <= 7:
+        raise SpecError(where + ": byte %d is outside the 8-byte payload" % byte)
+    touched = parse_hex_byte(fields["touched"], where) if kind == "button" else None
+    entry = Entry(kind, words[1], byte, parse_hex_byte(fields["pressed"], where), touched,
+                  parse_hex_byte(fields["released"], where), where)
+    if len(entry.values()) != (3 if kind == "button" else 2):
+        raise SpecError(where + ": %s %s uses the same value for two states" % (kind, entry.label))
+    return entry
+
+
+def parse_spec(text, path):
+    spec, current = Spec(), None
+    for number, raw in enumerate(text.splitlines(), 1):
+        line = raw.split("#", 1)[0].strip()
+        if not line:
+            continue
+        where = "%s:%d" % (path, number)
+        words = line.split()
+        if words[0] == "controller":
+            if len(words) < 2:
+                raise SpecError(where + ": controller needs an ID")
+            spec.controller_id = int(words[1], 16)
+            for word in words[2:]:
+                match = FIELD_RE.match(word)
+                if not match or match.group(1) != "ignore":
+                    raise SpecError(where + ": cannot parse '%s'" % word)
+                spec.ignored.update(int(b) for b in match.group(2).split(","))
+        elif words[0] in ("knob", "button"):
+            if spec.controller_id is None:
+                raise SpecError(where + ": %s before the controller line" % words[0])
+            current = parse_entry(words[0], words, where)
+            (spec.knobs if current.kind == "knob" else spec.buttons).append(current)
+        else:
+            match = CAPTURE_RE.search(line)
+            if not match:
+                raise SpecError(where + ": neither a directive nor a capture line")
+            if current is None:
+                raise SpecError(where + ": capture before the first knob/button")
+            can_id = int(match.group(1), 16)
+            if can_id != spec.controller_id:
+                raise SpecError(where + ": capture of 0x%X under controller 0x%X" % (can_id, spec.controller_id))
+            payload = [int(b, 16) for b in match.group(2).split()]
+            if len(payload) <= current.byte:
+                raise SpecError(where + ": capture has no byte %d" % current.byte)
+            current.captures.append((payload, where))
+    if spec.controller_id is None:
+        raise SpecError(path + ": no controller line")
+    return spec
+
+
+def check_entry(entry, ignored):
+    """The annotated byte takes exactly the annotated values; nothing else moves."""
+    if not entry.captures:
+        raise SpecError(entry.where + ": %s has no captures" % entry.label)
+    seen = {}
+    for payload, where in entry.captures:
+        seen.setdefault(payload[entry.byte], where)
+    names = {entry.pressed: "pressed", entry.released: "released"}
+    if entry.touched is not None:
+        names[entry.touched] = "touched"
+    for value, name in sorted(names.items()):
+        if value not in seen:
+            raise SpecError(entry.where + ": %s %s=%02X but no capture shows 0x%02X in byte %d" % (
+                entry.label, name, value, value, entry.byte))
+    for value, where in sorted(seen.items()):
+        if value not in names:
+            raise SpecError(where + ": %s byte %d is 0x%02X, which the entry does not list" % (
+                entry.label, entry.byte, value))
+
+    first = entry.captures[0][0]
+    for payload, where in entry.captures[1:]:
+        for index in range(min(len(first), len(payload))):
+            if index == entry.byte or index in ignored:
+                continue
+            if payload[index] != first[index]:
+                raise SpecError(where + ": %s byte %d changes too (0x%02X -> 0x%02X); wrong byte=?" % (
+                    entry.label, index, first[index], payload[index]))
+
+
+def check_spec(spec):
+    labels = set()
+    for entry in spec.knobs + spec.buttons:
+        if (entry.kind, entry.label) in labels:
+            raise SpecError(entry.where + ": %s %s listed twice" % (entry.kind, entry.label))
+        labels.add((entry.kind, entry.label))
+        check_entry(entry, spec.ignored)
+
+    if len(spec.knobs) > MAX_KNOB_POSITIONS or len(spec.buttons) > MAX_BUTTONS:
+        raise SpecError("at most %d knob positions and %d buttons" % (MAX_KNOB_POSITIONS, MAX_BUTTONS))
+    if len({k.byte for k in spec.knobs}) > 1:
+        raise SpecError(spec.knobs[-1].where + ": all knob positions must share one byte")
+
+    # Entries sharing a byte must agree on released and not reuse each other's values
+    by_byte = {}
+    for entry in spec.knobs + spec.buttons:
+        by_byte.setdefault(entry.byte, []).append(entry)
+    for byte, entries in by_byte.items():
+        owner = {}
+        for entry in entries:
+            if entry.released != entries[0].released:
+                raise SpecError(entry.where + ": %s released=%02X but %s on byte %d says %02X" % (
+                    entry.label, entry.released, entries[0].label, byte, entries[0].released))
+            for value in entry.values() - {entry.released}:
+                if value in owner:
+                    raise SpecError(entry.where + ": 0x%02X in byte %d is claimed by %s and %s" % (
+                        value, byte, owner[value], entry.label))
+                owner[value] = entry.label
+        if entries[0].released in owner:
+            raise SpecError(entries[0].where + ": released 0x%02X in byte %d is %s's active value" % (
+                entries[0].released, byte, owner[entries[0].released]))
+        if any(e.kind == "knob" for e in entries) and any(e.kind == "button" for e in entries):
+            raise SpecError(entries[-1].where + ": knob and buttons share byte %d" % byte)
+
+
+def emit_row(emit, row, width, indent):
+    per_line = 64 // (width + 2)
+    for start in range(0, 256, per_line):
+        emit(indent + " ".join("0x%0*X," % (width, v) for v in row[start:start + per_line]))
+
+
+def generate(spec, source_name):
+    out = []
+    emit = out.append
+    emit("#pragma once")
+    emit("")
+    emit("// Generated by scripts/zbe_codegen.py from %s; edit the spec, not this" % source_name)
+    emit("// file. Every entry was checked against the captures in the spec.")
+    emit("")
+    emit('#include "controller_mapping.h"')
+    emit("")
+    emit("#include <cstdint>")
+    emit("")
+    emit("constexpr uint32_t CONTROLLER_ID = 0x%X;" % spec.controller_id)
+
+    emit("")
+    emit("constexpr KnobMapping KNOB_MAPPINGS[] = {")
+    width = max(len(k.label) for k in spec.knobs) + 3
+    for knob in spec.knobs:
+        emit("    {%-*s 0x%02X, &iDriveState::%s}," % (width, '"%s",' % knob.label, knob.pressed, knob.field("")))
+    emit("};")
+
+    emit("")
+    emit("constexpr ButtonDescriptor BUTTON_MAPPINGS[] = {")
+    width = max(len(b.label) for b in spec.buttons) + 3
+    field_width = max(len(b.field("Pressed")) for b in spec.buttons) + 15
+    for button in spec.buttons:
+        emit("    {%-*s %d, 0x%02X, 0x%02X, %-*s &iDriveState::%s}," % (
+            width, '"%s",' % button.label, button.byte, button.pressed, button.touched,
+            field_width, "&iDriveState::%s," % button.field("Pressed"), button.field("Touched")))
+    emit("};")
+
+    knob_decode = [0] * 256
+    for index, knob in enumerate(spec.knobs):
+        knob_decode[knob.pressed] |= 1 << index
+    emit("")
+    emit("// Knob byte -> bit i set while KNOB_MAPPINGS[i] is pressed")
+    emit("constexpr uint8_t KNOB_BYTE = %d;" % spec.knobs[0].byte)
+    emit("constexpr uint8_t KNOB_DECODE[256] = {")
+    emit_row(emit, knob_decode, 2, "    ")
+    emit("};")
+
+    button_bytes = sorted({b.byte for b in spec.buttons})
+    rows = []
+    for byte in button_bytes:
+        row = [0] * 256
+        for index, button in enumerate(spec.buttons):
+            if button.byte == byte:
+                row[button.pressed] |= 1 << index
+                row[button.touched] |= 1 << (16 + index)
+        rows.append(row)
+    emit("")
+    emit("// Per byte in BUTTON_BYTES: raw value -> bit i set while BUTTON_MAPPINGS[i]")
+    emit("// is pressed, bit 16 + i while it is touched")
+    emit("constexpr uint8_t BUTTON_BYTES[] = {%s};" % ", ".join(str(b) for b in button_bytes))
+    emit("constexpr uint32_t BUTTON_DECODE[%d][256] = {" % len(button_bytes))
+    for row in rows:
+        emit("    {")
+        emit_row(emit, row, 8, "        ")
+        emit("    },")
+    emit("};")
+    return "\n".join(out) + "\n"
+
+
+def generate_file(spec_path, header_path):
+    """Regenerates header_path from spec_path; returns True when it changed."""
+    with open(spec_path, encoding="utf-8") as f:
+        spec = parse_spec(f.read(), spec_path)
+    check_spec(spec)
+    if not spec.knobs or not spec.buttons:
+        raise SpecError(spec_path + ": needs at least one knob and one button entry")
+    text = generate(spec, os.path.basename(spec_path))
+    try:
+        with open(header_path, encoding="utf-8") as f:
+            if f.read() == text:
+                return False
+    except OSError:
+        pass
+    os.makedirs(os.path.dirname(os.path.abspath(header_path)), exist_ok=True)
+    with open(header_path, "w", encoding="utf-8", newline="\n") as f:
+        f.write(text)
+    return True
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("usage: zbe_codegen.py <variant.spec> <output.h>\n")
+        return 2
+    try:
+        generate_file(argv[1], argv[2])
+    except SpecError as error:
+        sys.stderr.write("zbe_codegen: %s\n" % error)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
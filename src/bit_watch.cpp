@@ -0,0 +1,156 @@
+#include "bit_watch.h"
+
+#include <Arduino.h>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t MAX_WATCHES = 4;
+
+struct BitWindow {
+    uint32_t frames;
+    uint64_t everSet;
+    uint64_t everCleared;
+    uint64_t toggledMask;
+    uint16_t toggles[64];
+    uint8_t  minByte[8];
+    uint8_t  maxByte[8];
+
+    void reset() {
+        memset(this, 0, sizeof(*this));
+        memset(minByte, 0xFF, sizeof(minByte));
+    }
+};
+
+struct BitWatch {
+    bool      active;
+    bool      havePrevious;
+    uint16_t  id;
+    uint64_t  previous;
+    BitWindow window;
+    BitWindow baseline;
+};
+
+BitWatch watches[MAX_WATCHES];
+uint8_t markerCount = 0;
+
+BitWatch *findWatch(uint32_t id) {
+    for (auto &watch : watches) {
+        if (watch.active && watch.id == id) return &watch;
+    }
+    return nullptr;
+}
+
+void accumulate(BitWatch &watch, uint64_t payload) {
+    BitWindow &w = watch.window;
+    w.frames++;
+    w.everSet |= payload;
+    w.everCleared |= ~payload;
+
+    for (uint8_t i = 0; i < 8; i++) {
+        uint8_t value = payload >> (i * 8);
+        if (value < w.minByte[i]) w.minByte[i] = value;
+        if (value > w.maxByte[i]) w.maxByte[i] = value;
+    }
+
+    if (watch.havePrevious) {
+        uint64_t diff = payload ^ watch.previous;
+        w.toggledMask |= diff;
+        // Only visit the bits that actually flipped
+        while (diff) {
+            uint8_t bit = __builtin_ctzll(diff);
+            if (w.toggles[bit] != UINT16_MAX) w.toggles[bit]++;
+            diff &= diff - 1;
+        }
+    }
+
+    watch.previous = payload;
+    watch.havePrevious = true;
+}
+
+void printBinary(uint8_t value) {
+    for (int8_t bit = 7; bit >= 0; bit--) Serial.print((value >> bit) & 1 ? '1' : '0');
+}
+
+void printWatch(const BitWatch &watch) {
+    const BitWindow &w = watch.window;
+    const BitWindow &base = watch.baseline;
+
+    Serial.printf("\nWatch 0x%03X: %lu frames since marker %u (baseline %lu)\n",
+                  watch.id, static_cast<unsigned long>(w.frames), markerCount,
+                  static_cast<unsigned long>(base.frames));
+    Serial.println("  byte min max  ever-1   ever-0    toggles b7..b0 (* = quiet in baseline)");
+
+    for (uint8_t i = 0; i < 8; i++) {
+        uint8_t set = w.everSet >> (i * 8);
+        uint8_t cleared = w.everCleared >> (i * 8);
+        Serial.printf("  %u    %02X  %02X   ", i, w.frames ? w.minByte[i] : 0, w.maxByte[i]);
+        printBinary(set);
+        Serial.print(" ");
+        printBinary(cleared);
+        Serial.print(" ");
+
+        for (int8_t bit = 7; bit >= 0; bit--) {
+            uint8_t index = i * 8 + bit;
+            uint64_t mask = 1ULL << index;
+            bool correlated = (w.toggledMask & mask) && base.frames && !(base.toggledMask & mask);
+            Serial.printf(" %5u%c", w.toggles[index], correlated ? '*' : ' ');
+        }
+        Serial.println();
+    }
+}
+
+}  // namespace
+
+void bitWatchRecord(uint32_t id, uint8_t len, const uint8_t *data) {
+    BitWatch *watch = findWatch(id);
+    if (!watch) return;
+
+    uint8_t padded[8] = {};
+    memcpy(padded, data, len > 8 ? 8 : len);
+    uint64_t payload;
+    memcpy(&payload, padded, sizeof(payload));
+    accumulate(*watch, payload);
+}
+
+void toggleBitWatch(uint32_t id) {
+    BitWatch *existing = findWatch(id);
+    if (existing) {
+        existing->active = false;
+        Serial.printf("Bit watch 0x%03lX removed\n", static_cast<unsigned long>(id));
+        return;
+    }
+
+    for (auto &watch : watches) {
+        if (watch.active) continue;
+        watch.active = true;
+        watch.havePrevious = false;
+        watch.id = static_cast<uint16_t>(id);
+        watch.window.reset();
+        watch.baseline.reset();
+        Serial.printf("Bit watch 0x%03lX added\n", static_cast<unsigned long>(id));
+        return;
+    }
+    Serial.printf("Bit watch full (%u IDs)\n", MAX_WATCHES);
+}
+
+void bitWatchMarker() {
+    markerCount++;
+    for (auto &watch : watches) {
+        if (!watch.active) continue;
+        watch.baseline = watch.window;
+        watch.window.reset();
+    }
+    Serial.print("MARK ");
+    Serial.println(markerCount);
+}
+
+void printBitWatch() {
+    bool any = false;
+    for (const auto &watch : watches) {
+        if (!watch.active) continue;
+        printWatch(watch);
+        any = true;
+    }
+    if (!any) Serial.println("No bit watches (b<hex id> to add)");
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Bit-level toggle accumulator for reverse-engineering unknown signals.
+// For each watched ID it keeps per-bit toggle counts, ever-set/ever-cleared
+// masks and per-byte min/max. 'm' starts a new window (the previous one
+// becomes the baseline), so the dump after an action shows which bits moved
+// during the action but were quiet before it.
+void bitWatchRecord(uint32_t id, uint8_t len, const uint8_t *data);
+
+void toggleBitWatch(uint32_t id);
+void bitWatchMarker();
+void printBitWatch();
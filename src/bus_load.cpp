@@ -0,0 +1,173 @@
+#include "bus_load.h"
+#include "bus_load_window.h"
+#include "can_protocol.h"
+
+#include <Arduino.h>
+
+namespace {
+
+constexpr uint8_t  DEFAULT_THRESHOLD = 70;
+constexpr uint8_t  HYSTERESIS        = 5;
+constexpr uint8_t  THRESHOLD_WINDOW  = 1;     // index of the 1 s window
+
+// Bits after the CRC that are never stuffed: CRC delimiter, ACK slot and
+// delimiter, 7-bit EOF and the 3-bit intermission.
+constexpr uint8_t UNSTUFFED_TRAILER_BITS = 1 + 2 + 7 + 3;
+
+// Frame length without stuff bits
+uint16_t unstuffedBits(uint8_t len) {
+    return 1 + 11 + 3 + 4 + len * 8 + 15 + UNSTUFFED_TRAILER_BITS;
+}
+
+const char *const WINDOW_NAMES[BUS_LOAD_WINDOW_COUNT] = {"100ms", "1s", "10s"};
+
+BusLoadWindows windows;
+
+uint32_t totalFrames = 0;
+uint64_t totalBits = 0;
+uint32_t totalStuffBits = 0;
+
+uint8_t thresholdPercent = DEFAULT_THRESHOLD;
+bool aboveThreshold = false;
+
+// Serialises the stuffed region of a standard data frame (SOF .. CRC) and
+// counts stuff bits, computing the CRC-15 on the way.
+class StuffCounter {
+public:
+    void push(uint32_t value, uint8_t bits) {
+        for (int8_t i = bits - 1; i >= 0; i--) pushBit((value >> i) & 1);
+    }
+
+    void pushCrc() {
+        uint16_t crc = crc_;
+        for (int8_t i = 14; i >= 0; i--) pushStuffedOnly((crc >> i) & 1);
+    }
+
+    uint16_t stuffBits() const { return stuffBits_; }
+
+private:
+    void pushBit(uint8_t bit) {
+        uint8_t feedback = bit ^ ((crc_ >> 14) & 1);
+        crc_ = (crc_ << 1) & 0x7FFF;
+        if (feedback) crc_ ^= 0x4599;
+        pushStuffedOnly(bit);
+    }
+
+    void pushStuffedOnly(uint8_t bit) {
+        if (bit == lastBit_) {
+            runLength_++;
+        } else {
+            lastBit_ = bit;
+            runLength_ = 1;
+        }
+        if (runLength_ == 5) {
+            // Stuff bit of opposite polarity starts a new run of length 1
+            stuffBits_++;
+            lastBit_ ^= 1;
+            runLength_ = 1;
+        }
+    }
+
+    uint16_t crc_       = 0;
+    uint8_t  lastBit_   = 2;
+    uint8_t  runLength_ = 0;
+    uint16_t stuffBits_ = 0;
+};
+
+uint32_t capacityBits(uint8_t window) {
+    uint64_t bits = static_cast<uint64_t>(CAN_BITRATE) * BUS_LOAD_WINDOW_BINS[window] * BUS_LOAD_BIN_MS / 1000;
+    return static_cast<uint32_t>(bits);
+}
+
+uint32_t percentTimes10(uint8_t window) {
+    return static_cast<uint32_t>(windows.bits(window) * 1000ULL / capacityBits(window));
+}
+
+void advanceToNow() {
+    windows.advanceTo(millis() / BUS_LOAD_BIN_MS);
+}
+
+void printPercent(uint32_t tenths) {
+    Serial.print(tenths / 10);
+    Serial.print(".");
+    Serial.print(tenths % 10);
+    Serial.print("%");
+}
+
+void checkThreshold() {
+    uint32_t load = percentTimes10(THRESHOLD_WINDOW);
+    if (!aboveThreshold && load >= thresholdPercent * 10U) {
+        aboveThreshold = true;
+        Serial.print("BUSLOAD HIGH 1s=");
+        printPercent(load);
+        Serial.println();
+    } else if (aboveThreshold && load + HYSTERESIS * 10U < thresholdPercent * 10U) {
+        aboveThreshold = false;
+        Serial.print("BUSLOAD OK 1s=");
+        printPercent(load);
+        Serial.println();
+    }
+}
+
+}  // namespace
+
+uint16_t canFrameWireBits(uint32_t id, uint8_t len, const uint8_t *data) {
+    if (len > 8) len = 8;
+
+    StuffCounter frame;
+    frame.push(0, 1);         // SOF
+    frame.push(id, 11);       // base identifier
+    frame.push(0, 3);         // RTR, IDE, r0
+    frame.push(len, 4);       // DLC
+    for (uint8_t i = 0; i < len; i++) frame.push(data[i], 8);
+    frame.pushCrc();
+
+    return unstuffedBits(len) + frame.stuffBits();
+}
+
+void busLoadRecord(uint32_t id, uint8_t len, const uint8_t *data) {
+    uint16_t bits = canFrameWireBits(id, len, data);
+
+    advanceToNow();
+    windows.add(bits);
+
+    totalFrames++;
+    totalBits += bits;
+    totalStuffBits += bits - unstuffedBits(len > 8 ? 8 : len);
+}
+
+void updateBusLoad() {
+    if (!windows.started()) return;
+    advanceToNow();
+    checkThreshold();
+}
+
+void busLoadSetThreshold(uint8_t percent) {
+    thresholdPercent = percent;
+    aboveThreshold = false;
+    Serial.print("Bus load threshold: ");
+    Serial.print(thresholdPercent);
+    Serial.println("%");
+}
+
+void printBusLoad() {
+    if (windows.started()) advanceToNow();
+
+    Serial.printf("\nBus load @ %lu kbps:\n", static_cast<unsigned long>(CAN_BITRATE / 1000));
+    for (uint8_t w = 0; w < BUS_LOAD_WINDOW_COUNT; w++) {
+        Serial.printf("  %-6s ", WINDOW_NAMES[w]);
+        printPercent(percentTimes10(w));
+        Serial.printf("  (%lu bits)\n", static_cast<unsigned long>(windows.bits(w)));
+    }
+
+    Serial.print("  peak 100ms ");
+    printPercent(static_cast<uint32_t>(windows.peakShortWindowBits() * 1000ULL / capacityBits(0)));
+    Serial.println();
+
+    Serial.printf("  frames %lu, avg %lu bits/frame, avg %lu.%lu stuff bits/frame\n",
+                  static_cast<unsigned long>(totalFrames),
+                  static_cast<unsigned long>(totalFrames ? totalBits / totalFrames : 0),
+                  static_cast<unsigned long>(totalFrames ? totalStuffBits / totalFrames : 0),
+                  static_cast<unsigned long>(totalFrames ? (totalStuffBits * 10ULL / totalFrames) % 10 : 0));
+    Serial.printf("  threshold %u%% (%s)\n", thresholdPercent, aboveThreshold ? "HIGH" : "ok");
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+// Bus utilisation from the on-wire length of every received and sent frame
+// (header, payload, CRC, exact stuff bits, ACK/EOF/IFS), over sliding
+// 100 ms / 1 s / 10 s windows at the K-CAN bitrate. Crossing the threshold
+// on the 1 s window prints a BUSLOAD HIGH/OK line.
+void busLoadRecord(uint32_t id, uint8_t len, const uint8_t *data);
+void updateBusLoad();
+
+uint16_t canFrameWireBits(uint32_t id, uint8_t len, const uint8_t *data);
+
+void busLoadSetThreshold(uint8_t percent);
+void printBusLoad();
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+// Sliding-window bit counts behind the bus load estimator (bus_load.cpp):
+// 10 ms bins in a 10 s ring and running sums over the last 10, 100 and
+// 1000 bins. No Arduino dependency, so the host unit tests build it too.
+//
+// Bins are numbered absolutely (millis() / BUS_LOAD_BIN_MS). Each step of
+// advanceTo() drops the bin that leaves a window from that window's sum,
+// but only once the window has filled since the first bin: earlier bins
+// were never added to it.
+
+constexpr uint32_t BUS_LOAD_BIN_MS        = 10;
+constexpr uint16_t BUS_LOAD_BIN_COUNT     = 1000;  // 10 s of 10 ms bins
+constexpr uint16_t BUS_LOAD_WINDOW_BINS[] = {10, 100, 1000};
+constexpr uint8_t  BUS_LOAD_WINDOW_COUNT  = sizeof(BUS_LOAD_WINDOW_BINS) / sizeof(BUS_LOAD_WINDOW_BINS[0]);
+
+class BusLoadWindows {
+public:
+    void advanceTo(uint32_t bin) {
+        if (!started_) {
+            firstBin_ = currentBin_ = bin;
+            started_ = true;
+            return;
+        }
+
+        uint32_t steps = bin - currentBin_;
+        if (steps > BUS_LOAD_BIN_COUNT) steps = BUS_LOAD_BIN_COUNT;  // everything has aged out
+
+        for (uint32_t s = 0; s < steps; s++) {
+            if (windowBits_[0] > peakBits_) peakBits_ = windowBits_[0];  // ends on a complete bin
+            currentBin_++;
+            uint32_t age = currentBin_ - firstBin_;
+            for (uint8_t w = 0; w < BUS_LOAD_WINDOW_COUNT; w++) {
+                uint16_t span = BUS_LOAD_WINDOW_BINS[w];
+                if (age >= span) windowBits_[w] -= bins_[(currentBin_ + BUS_LOAD_BIN_COUNT - span) % BUS_LOAD_BIN_COUNT];
+            }
+            bins_[currentBin_ % BUS_LOAD_BIN_COUNT] = 0;
+        }
+        currentBin_ = bin;
+    }
+
+    // Adds a frame's bits to the current bin; call advanceTo() first
+    void add(uint16_t bits) {
+        bins_[currentBin_ % BUS_LOAD_BIN_COUNT] += bits;
+        for (uint8_t w = 0; w < BUS_LOAD_WINDOW_COUNT; w++) windowBits_[w] += bits;
+    }
+
+    bool started() const { return started_; }
+    uint32_t bits(uint8_t window) const { return windowBits_[window]; }
+    uint32_t peakShortWindowBits() const { return peakBits_; }  // highest completed 100 ms window
+
+private:
+    uint16_t bins_[BUS_LOAD_BIN_COUNT] = {};
+    uint32_t windowBits_[BUS_LOAD_WINDOW_COUNT] = {};
+    uint32_t currentBin_ = 0;
+    uint32_t firstBin_ = 0;
+    uint32_t peakBits_ = 0;
+    bool     started_ = false;
+};
@@ -11,6 +11,9 @@ constexpr uint16_t ID_GEAR          = 0x3FD;
 constexpr uint16_t ID_KEEPALIVE     = 0x510;
 constexpr uint16_t ID_BRIGHTNESS    = 0x202;
 
+// K-CAN bitrate (bits per second)
+constexpr uint32_t CAN_BITRATE = 500000;
+
 // Timing intervals (milliseconds)
 constexpr uint32_t KEEPALIVE_INTERVAL_MS = 500;
 
@@ -1,21 +1,62 @@
 #include "can_rx.h"
+#include "bit_watch.h"
+#include "bus_load.h"
 #include "can_protocol.h"
+#include "capture.h"
+#include "clock_sync.h"
+#include "cycle_monitor.h"
 #include "idrive_controller.h"
+#include "kcan_signals.h"
+#include "latency.h"
+#include "loop_monitor.h"
+#include "profiler.h"
+#include "signal_monitor.h"
+#include "sniffer.h"
+#include "trace.h"
 #include "twai_driver.h"
+#include "zbe_mappings.h"
 
 #include <Arduino.h>
 
 namespace {
 
-void printRawMessage(const char *type, unsigned long id, uint8_t len, uint8_t *data, unsigned long timestamp) {
+constexpr uint8_t FRAME_FILTER_SIZE = 16;
+
+uint32_t frameFilter[FRAME_FILTER_SIZE];
+uint8_t frameFilterCount = 0;
+
+bool frameFilterPasses(uint32_t id) {
+    if (frameFilterCount == 0) return true;
+    for (uint8_t i = 0; i < frameFilterCount; i++) {
+        if (frameFilter[i] == id) return true;
+    }
+    return false;
+}
+
+// Device uptime in ms, or host monotonic time in ms with a microsecond
+// fraction once the host has sent a clock mapping
+void printFrameTimestamp(int64_t timestampUs) {
     Serial.print("[");
-    if (timestamp < 100000) Serial.print(" ");
-    if (timestamp < 10000) Serial.print(" ");
-    if (timestamp < 1000) Serial.print(" ");
-    if (timestamp < 100) Serial.print(" ");
-    if (timestamp < 10) Serial.print(" ");
-    Serial.print(timestamp);
-    Serial.print("ms] [");
+    if (clockSyncValid()) {
+        int64_t hostUs = toHostTimeUs(timestampUs);
+        Serial.printf("%lld.%03d", static_cast<long long>(hostUs / 1000), static_cast<int>(hostUs % 1000));
+    } else {
+        unsigned long timestamp = static_cast<unsigned long>(timestampUs / 1000);
+        if (timestamp < 100000) Serial.print(" ");
+        if (timestamp < 10000) Serial.print(" ");
+        if (timestamp < 1000) Serial.print(" ");
+        if (timestamp < 100) Serial.print(" ");
+        if (timestamp < 10) Serial.print(" ");
+        Serial.print(timestamp);
+    }
+    Serial.print("ms]");
+}
+
+void printRawMessage(const char *type, unsigned long id, uint8_t len, uint8_t *data, int64_t timestampUs) {
+    if (!frameFilterPasses(id) || captureStreaming()) return;
+    TraceScope logTrace(TraceEvent::Log, id);
+    printFrameTimestamp(timestampUs);
+    Serial.print(" [");
     Serial.print(type);
     Serial.print("] 0x");
     Serial.print(id, HEX);
@@ -29,62 +70,111 @@ void printRawMessage(const char *type, unsigned long id, uint8_t len, uint8_t *d
     Serial.println();
 }
 
-void handleHeartbeat567(uint8_t *data, unsigned long timestamp) {
+void handleHeartbeat567(uint8_t *data, int64_t timestampUs) {
+    PROFILE_ZONE("handle_567");
     if (debugMode >= 1) {
-        printRawMessage("ID_567", ID_HEARTBEAT_567, 8, data, timestamp);
+        printRawMessage("ID_567", ID_HEARTBEAT_567, 8, data, timestampUs);
     }
-    state.last567Time = timestamp;
+    state.last567Time = static_cast<unsigned long>(timestampUs / 1000);
 }
 
+namespace zbe = kcan::zbe_controller;
+static_assert(zbe::Knob::SHIFT == KNOB_BYTE * 8 && zbe::ID == CONTROLLER_ID,
+              "dbc/idrive_kcan.dbc and the ZBE spec disagree on the knob byte");
+
 void handleController(uint8_t *data) {
-    updateKnobStates(data[3]);
+    PROFILE_ZONE("decode_25B");
+    updateKnobStates(zbe::knob(data));
     updateButtonStates(data);
-    updateRotation(data[0], data[1]);
+    updateRotation(zbe::sequence(data), zbe::encoder(data));
 }
 
-void handleHeartbeat5E7(uint8_t *data, unsigned long timestamp) {
+void handleHeartbeat5E7(uint8_t *data, int64_t timestampUs) {
+    PROFILE_ZONE("handle_5E7");
     if (debugMode >= 1) {
-        printRawMessage("ID_5E7", ID_HEARTBEAT_5E7, 8, data, timestamp);
+        printRawMessage("ID_5E7", ID_HEARTBEAT_5E7, 8, data, timestampUs);
     }
 }
 
-void handleGearIndication(uint8_t *data, unsigned long timestamp) {
+void handleGearIndication(uint8_t *data, int64_t timestampUs) {
+    PROFILE_ZONE("handle_3FD");
     if (debugMode >= 1) {
-        printRawMessage("GEAR", ID_GEAR, 8, data, timestamp);
+        printRawMessage("GEAR", ID_GEAR, 8, data, timestampUs);
     }
 }
 
 }  // namespace
 
+void frameFilterToggle(uint32_t id) {
+    for (uint8_t i = 0; i < frameFilterCount; i++) {
+        if (frameFilter[i] == id) {
+            frameFilter[i] = frameFilter[--frameFilterCount];
+            printFrameFilter();
+            return;
+        }
+    }
+    if (frameFilterCount == FRAME_FILTER_SIZE) {
+        Serial.println("Frame filter full");
+        return;
+    }
+    frameFilter[frameFilterCount++] = id;
+    printFrameFilter();
+}
+
+void frameFilterClear() {
+    frameFilterCount = 0;
+    printFrameFilter();
+}
+
+void printFrameFilter() {
+    Serial.print("Frame filter:");
+    if (frameFilterCount == 0) Serial.print(" off (all IDs)");
+    for (uint8_t i = 0; i < frameFilterCount; i++) Serial.printf(" %03lX", static_cast<unsigned long>(frameFilter[i]));
+    Serial.println();
+}
+
 void processCanMessages() {
     uint32_t rxId;
     uint8_t len;
     uint8_t rxBuf[8];
 
     if (!twai_receive(&rxId, &len, rxBuf)) return;
+    int64_t rxTimeUs = deviceTimeUs();
+    uint32_t rxUs = static_cast<uint32_t>(rxTimeUs);
+    latencyFrameReceived(rxUs);
+    loopMonitorNoteFrame(rxId);
+    traceRecord(TraceEvent::FrameRx, TracePhase::Instant, rxId, len);
 
-    unsigned long now = millis();
+    PROFILE_ZONE("process_rx");
+    snifferRecord(rxId, len, rxBuf, rxUs);
+    bitWatchRecord(rxId, len, rxBuf);
+    captureRecord(rxId, len, rxBuf, rxUs, false);
+    cycleMonitorRecord(rxId, rxUs);
+    busLoadRecord(rxId, len, rxBuf);
+    signalMonitorRecord(rxId, len, rxBuf);
 
     if (debugMode == 2 && rxId != ID_DATA_STREAM) {
-        printRawMessage("RAW", rxId, len, rxBuf, now);
+        printRawMessage("RAW", rxId, len, rxBuf, rxTimeUs);
     }
 
+    TraceScope decodeTrace(TraceEvent::Decode, rxId);
+
     switch (rxId) {
         case ID_HEARTBEAT_567:
-            handleHeartbeat567(rxBuf, now);
+            handleHeartbeat567(rxBuf, rxTimeUs);
             break;
         case ID_CONTROLLER:
             handleController(rxBuf);
             break;
         case ID_HEARTBEAT_5E7:
-            handleHeartbeat5E7(rxBuf, now);
+            handleHeartbeat5E7(rxBuf, rxTimeUs);
             break;
         case ID_GEAR:
-            handleGearIndication(rxBuf, now);
+            handleGearIndication(rxBuf, rxTimeUs);
             break;
         default:
             if (debugMode == 2 && rxId != ID_DATA_STREAM) {
-                printRawMessage("UNKNOWN", rxId, len, rxBuf, now);
+                printRawMessage("UNKNOWN", rxId, len, rxBuf, rxTimeUs);
             }
             break;
     }
@@ -1,3 +1,11 @@
 #pragma once
 
+#include <cstdint>
+
 void processCanMessages();
+
+// RAW/DEBUG frame lines are limited to the listed IDs; an empty filter
+// prints every ID. Decoding, capture and statistics are not affected.
+void frameFilterToggle(uint32_t id);
+void frameFilterClear();
+void printFrameFilter();
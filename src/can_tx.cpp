@@ -1,11 +1,13 @@
 #include "can_tx.h"
 #include "can_protocol.h"
 #include "idrive_controller.h"
+#include "profiler.h"
 #include "twai_driver.h"
 
 #include <Arduino.h>
 
 void sendKeepAlive() {
+    PROFILE_ZONE("tx_keepalive");
     twai_send(ID_KEEPALIVE, 8, KEEPALIVE_FRAME);
     state.lastKeepAliveTime = millis();
 }
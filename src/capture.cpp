@@ -0,0 +1,275 @@
+#include "capture.h"
+#include "capture_format.h"
+#include "frame_codec.h"
+#include "profiler.h"
+#include "twai_driver.h"
+
+#include <Arduino.h>
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t CAPTURE_CAPACITY        = 2048;  // 32 KB, several seconds of K-CAN
+constexpr uint32_t DEFAULT_PRE_MS          = 3000;
+constexpr uint32_t DEFAULT_POST_MS         = 1000;
+constexpr uint8_t  STREAM_RECORDS_PER_LOOP = 64;
+constexpr uint32_t HEALTH_POLL_MS          = 50;
+
+static_assert((CAPTURE_CAPACITY & (CAPTURE_CAPACITY - 1)) == 0, "CAPTURE_CAPACITY must be a power of two");
+
+enum class CaptureState : uint8_t {
+    Idle,         // recording, triggers ignored
+    Armed,        // recording, triggers checked
+    PostTrigger,  // recording the post-trigger window
+    Streaming,    // frozen, dump in progress
+};
+
+struct TriggerConfig {
+    bool     idEnabled      = false;
+    uint16_t id             = 0;
+    bool     payloadEnabled = false;
+    uint16_t payloadId      = 0;
+    uint8_t  byteIndex      = 0;
+    uint8_t  value          = 0;
+    uint8_t  mask           = 0xFF;
+    bool     onEvent        = false;
+    bool     onBusError     = false;
+};
+
+const char *const TRIGGER_NAMES[] = {"none", "id", "payload", "event", "bus_error", "manual"};
+
+CaptureRecord ring[CAPTURE_CAPACITY];
+uint32_t head = 0;
+
+CaptureState captureState = CaptureState::Idle;
+TriggerConfig triggers;
+uint32_t preMs  = DEFAULT_PRE_MS;
+uint32_t postMs = DEFAULT_POST_MS;
+
+CaptureTrigger firedTrigger = CaptureTrigger::None;
+uint32_t triggerUs = 0;
+uint32_t streamCursor = 0;
+uint32_t streamEnd = 0;
+uint32_t streamBytes = 0;  // payload written so far, and its CRC, for the END trailer
+uint32_t streamCrc = 0;
+
+// Delta-coded dumps (see frame_codec.h); the encoder is reset per dump so
+// every dump decodes on its own
+bool compressDumps = false;
+FrameEncoder dumpEncoder;
+
+unsigned long lastHealthPollMs = 0;
+uint32_t lastErrorTotal = 0;
+
+uint32_t busErrorTotal() {
+    TwaiHealth health;
+    if (!twai_get_health(&health)) return lastErrorTotal;
+    return health.busErrors + health.rxMissed + health.rxOverrun + (health.busOff ? 1 : 0);
+}
+
+void fire(CaptureTrigger trigger, uint32_t atUs) {
+    firedTrigger = trigger;
+    triggerUs = atUs;
+    captureState = CaptureState::PostTrigger;
+}
+
+bool matchesFrameTrigger(uint32_t id, uint8_t len, const uint8_t *data, CaptureTrigger &trigger) {
+    if (triggers.idEnabled && id == triggers.id) {
+        trigger = CaptureTrigger::IdSeen;
+        return true;
+    }
+    if (triggers.payloadEnabled && id == triggers.payloadId && triggers.byteIndex < len &&
+        (data[triggers.byteIndex] & triggers.mask) == (triggers.value & triggers.mask)) {
+        trigger = CaptureTrigger::PayloadMatch;
+        return true;
+    }
+    return false;
+}
+
+// Walks back from the newest record to the first one inside the pre window
+void beginStreaming() {
+    uint32_t preUs = preMs * 1000;
+    uint32_t oldest = (head > CAPTURE_CAPACITY) ? head - CAPTURE_CAPACITY : 0;
+    uint32_t start = head;
+
+    while (start > oldest) {
+        const CaptureRecord &record = ring[(start - 1) & (CAPTURE_CAPACITY - 1)];
+        bool afterTrigger = static_cast<int32_t>(record.timestampUs - triggerUs) >= 0;
+        if (!afterTrigger && triggerUs - record.timestampUs > preUs) break;
+        start--;
+    }
+
+    streamCursor = start;
+    streamEnd = head;
+    streamBytes = 0;
+    streamCrc = 0;
+    captureState = CaptureState::Streaming;
+
+    dumpEncoder.reset();
+    Serial.printf("CAPTURE BEGIN %lu %u %lu%s\n",
+                  static_cast<unsigned long>(streamEnd - streamCursor),
+                  static_cast<unsigned>(firedTrigger),
+                  static_cast<unsigned long>(triggerUs),
+                  compressDumps ? " delta" : "");
+}
+
+void writePayload(const uint8_t *data, size_t size) {
+    Serial.write(data, size);
+    streamBytes += size;
+    streamCrc = captureCrc32(streamCrc, data, size);
+}
+
+void writeEncoded(const CaptureRecord &record) {
+    PROFILE_ZONE("capture_encode");
+    CodecFrame frame;
+    frame.timestampUs = record.timestampUs;
+    frame.id = record.id;
+    frame.extended = false;
+    frame.dlc = record.dlc;
+    frame.flags = record.flags;
+    memcpy(frame.data, record.data, sizeof(frame.data));
+
+    uint8_t encoded[CODEC_MAX_FRAME_BYTES];
+    writePayload(encoded, dumpEncoder.encode(frame, encoded));
+}
+
+void streamChunk() {
+    for (uint8_t n = 0; n < STREAM_RECORDS_PER_LOOP && streamCursor < streamEnd; n++, streamCursor++) {
+        const CaptureRecord &record = ring[streamCursor & (CAPTURE_CAPACITY - 1)];
+        if (compressDumps) {
+            writeEncoded(record);
+        } else {
+            writePayload(reinterpret_cast<const uint8_t *>(&record), sizeof(record));
+        }
+    }
+
+    if (streamCursor < streamEnd) return;
+
+    Serial.printf("CAPTURE END %lu %08lX\n", static_cast<unsigned long>(streamBytes),
+                  static_cast<unsigned long>(streamCrc));
+    captureState = CaptureState::Idle;
+}
+
+}  // namespace
+
+void captureRecord(uint32_t id, uint8_t len, const uint8_t *data, uint32_t timestampUs, bool tx) {
+    if (captureState == CaptureState::Streaming) return;
+    if (len > 8) len = 8;
+
+    CaptureRecord &record = ring[head++ & (CAPTURE_CAPACITY - 1)];
+    record.timestampUs = timestampUs;
+    record.id = static_cast<uint16_t>(id);
+    record.dlc = len;
+    record.flags = tx ? CAPTURE_FLAG_TX : 0;
+    memcpy(record.data, data, len);
+    memset(record.data + len, 0, 8 - len);
+
+    CaptureTrigger trigger;
+    if (captureState == CaptureState::Armed && !tx && matchesFrameTrigger(id, len, data, trigger)) {
+        record.flags |= CAPTURE_FLAG_TRIGGER;
+        fire(trigger, timestampUs);
+    }
+}
+
+bool captureStreaming() {
+    return captureState == CaptureState::Streaming;
+}
+
+void captureNoteDecodedEvent() {
+    if (captureState == CaptureState::Armed && triggers.onEvent) {
+        fire(CaptureTrigger::DecodedEvent, micros());
+    }
+}
+
+void updateCapture() {
+    switch (captureState) {
+        case CaptureState::Armed: {
+            if (!triggers.onBusError) break;
+            unsigned long nowMs = millis();
+            if (nowMs - lastHealthPollMs < HEALTH_POLL_MS) break;
+            lastHealthPollMs = nowMs;
+            uint32_t total = busErrorTotal();
+            if (total != lastErrorTotal) {
+                lastErrorTotal = total;
+                fire(CaptureTrigger::BusError, micros());
+            }
+            break;
+        }
+        case CaptureState::PostTrigger:
+            if (micros() - triggerUs >= postMs * 1000) beginStreaming();
+            break;
+        case CaptureState::Streaming:
+            streamChunk();
+            break;
+        default:
+            break;
+    }
+}
+
+void captureSetIdTrigger(uint32_t id) {
+    triggers.idEnabled = true;
+    triggers.id = static_cast<uint16_t>(id);
+}
+
+void captureSetPayloadTrigger(uint32_t id, uint8_t byteIndex, uint8_t value, uint8_t mask) {
+    triggers.payloadEnabled = true;
+    triggers.payloadId = static_cast<uint16_t>(id);
+    triggers.byteIndex = byteIndex;
+    triggers.value = value;
+    triggers.mask = mask;
+}
+
+void captureSetEventTrigger(bool enabled) {
+    triggers.onEvent = enabled;
+}
+
+void captureSetBusErrorTrigger(bool enabled) {
+    triggers.onBusError = enabled;
+}
+
+void captureSetCompression(bool enabled) {
+    compressDumps = enabled;
+}
+
+void captureSetWindow(uint32_t newPreMs, uint32_t newPostMs) {
+    preMs = newPreMs;
+    postMs = newPostMs;
+}
+
+void captureArm() {
+    if (captureState == CaptureState::Streaming || captureState == CaptureState::PostTrigger) return;
+    lastErrorTotal = busErrorTotal();
+    captureState = CaptureState::Armed;
+}
+
+void captureDisarm() {
+    if (captureState == CaptureState::Armed) captureState = CaptureState::Idle;
+    triggers = TriggerConfig();
+}
+
+void captureTriggerNow() {
+    if (captureState == CaptureState::Streaming || captureState == CaptureState::PostTrigger) return;
+    fire(CaptureTrigger::Manual, micros());
+}
+
+void printCaptureStatus() {
+    static const char *kStates[] = {"IDLE", "ARMED", "POST-TRIGGER", "STREAMING"};
+
+    Serial.print("Capture: ");
+    Serial.print(kStates[static_cast<uint8_t>(captureState)]);
+    Serial.printf("  window -%lums/+%lums  ring %u/%u  %s dumps\n",
+                  static_cast<unsigned long>(preMs), static_cast<unsigned long>(postMs),
+                  static_cast<unsigned>(head < CAPTURE_CAPACITY ? head : CAPTURE_CAPACITY),
+                  CAPTURE_CAPACITY, compressDumps ? "delta" : "raw");
+    if (triggers.idEnabled) Serial.printf("  trigger id 0x%03X\n", triggers.id);
+    if (triggers.payloadEnabled) {
+        Serial.printf("  trigger 0x%03X byte %u & %02X == %02X\n",
+                      triggers.payloadId, triggers.byteIndex, triggers.mask, triggers.value & triggers.mask);
+    }
+    if (triggers.onEvent) Serial.println("  trigger on decoded event");
+    if (triggers.onBusError) Serial.println("  trigger on bus error");
+    if (firedTrigger != CaptureTrigger::None) {
+        Serial.print("  last fired: ");
+        Serial.println(TRIGGER_NAMES[static_cast<uint8_t>(firedTrigger)]);
+    }
+}
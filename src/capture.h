@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// Continuously overwritten ring of the most recent frames (RX and TX). When
+// an armed trigger fires, recording continues for the post-trigger window,
+// then the ring is frozen and the pre/post window is streamed to the host as
+// a binary block (see capture_format.h).
+void captureRecord(uint32_t id, uint8_t len, const uint8_t *data, uint32_t timestampUs, bool tx);
+void captureNoteDecodedEvent();
+void updateCapture();
+
+// True from CAPTURE BEGIN to CAPTURE END. The dump is written a chunk per
+// loop() pass and owns Serial meanwhile: nothing else may print, or the
+// text would land inside the binary block.
+bool captureStreaming();
+
+void captureSetIdTrigger(uint32_t id);
+void captureSetPayloadTrigger(uint32_t id, uint8_t byteIndex, uint8_t value, uint8_t mask);
+void captureSetEventTrigger(bool enabled);
+void captureSetBusErrorTrigger(bool enabled);
+void captureSetCompression(bool enabled);
+void captureSetWindow(uint32_t preMs, uint32_t postMs);
+void captureArm();
+void captureDisarm();
+void captureTriggerNow();
+void printCaptureStatus();
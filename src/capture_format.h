@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Binary frame record used by the pre-trigger capture ring and its serial
+// dump. A dump is framed as
+//
+//   CAPTURE BEGIN <records> <trigger> <trigger_us>\n
+//   <records * sizeof(CaptureRecord) raw bytes, little-endian>
+//   CAPTURE END <payload_bytes> <crc32>\n
+//
+// With compression on (cz1) the header ends in " delta" and the records
+// are instead coded with the per-ID delta codec in frame_codec.h, one
+// encoder reset per dump; the record count is unchanged.
+//
+// The END trailer gives the payload length in decimal and its CRC-32
+// (captureCrc32() below) in 8 hex digits, so a reader can tell a damaged
+// dump from a good one. The device prints nothing else between BEGIN and
+// END. Dumps from older firmware end in a bare "CAPTURE END".
+//
+// Shared with the host tools; keep the layout packed and stable.
+
+enum CaptureFlags : uint8_t {
+    CAPTURE_FLAG_TX      = 0x01,  // frame sent by this device
+    CAPTURE_FLAG_TRIGGER = 0x02,  // frame that fired the trigger
+};
+
+enum class CaptureTrigger : uint8_t {
+    None,
+    IdSeen,
+    PayloadMatch,
+    DecodedEvent,
+    BusError,
+    Manual,
+};
+
+struct CaptureRecord {
+    uint32_t timestampUs;
+    uint16_t id;
+    uint8_t  dlc;
+    uint8_t  flags;
+    uint8_t  data[8];
+};
+
+static_assert(sizeof(CaptureRecord) == 16, "CaptureRecord must stay packed to 16 bytes");
+
+// CRC-32 as zlib's crc32() (reflected 0xEDB88320); start from 0 and feed
+// the payload in order. A nibble table keeps it small enough for the device.
+inline uint32_t captureCrc32(uint32_t crc, const uint8_t *data, size_t size) {
+    static const uint32_t kNibble[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    while (size--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ kNibble[crc & 0x0F];
+        crc = (crc >> 4) ^ kNibble[crc & 0x0F];
+    }
+    return ~crc;
+}
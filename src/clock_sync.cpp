@@ -0,0 +1,59 @@
+#include "clock_sync.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+namespace {
+
+struct ClockMapping {
+    bool    valid       = false;
+    int64_t offsetUs    = 0;
+    int64_t driftPpb    = 0;
+    int64_t referenceUs = 0;
+};
+
+ClockMapping mapping;
+
+}  // namespace
+
+int64_t deviceTimeUs() {
+    return esp_timer_get_time();
+}
+
+void clockSyncPing(uint32_t sequence, int64_t receivedUs) {
+    // Stamp the reply as late as possible so t_tx covers the formatting
+    char line[64];
+    int length = snprintf(line, sizeof(line), "SYNC %lu %lld ",
+                          static_cast<unsigned long>(sequence), static_cast<long long>(receivedUs));
+    Serial.write(reinterpret_cast<const uint8_t *>(line), length);
+    Serial.println(static_cast<long long>(deviceTimeUs()));
+}
+
+void clockSyncSetMapping(int64_t offsetUs, int64_t driftPpb, int64_t referenceUs) {
+    mapping.valid = true;
+    mapping.offsetUs = offsetUs;
+    mapping.driftPpb = driftPpb;
+    mapping.referenceUs = referenceUs;
+    printClockSync();
+}
+
+bool clockSyncValid() {
+    return mapping.valid;
+}
+
+int64_t toHostTimeUs(int64_t deviceUs) {
+    int64_t elapsed = deviceUs - mapping.referenceUs;
+    return deviceUs + mapping.offsetUs + (elapsed * mapping.driftPpb) / 1000000000LL;
+}
+
+void printClockSync() {
+    int64_t now = deviceTimeUs();
+    Serial.printf("SYNC MAP %s device=%lld", mapping.valid ? "valid" : "none", static_cast<long long>(now));
+    if (mapping.valid) {
+        Serial.printf(" host=%lld offset=%lld drift=%lldppb",
+                      static_cast<long long>(toHostTimeUs(now)),
+                      static_cast<long long>(mapping.offsetUs),
+                      static_cast<long long>(mapping.driftPpb));
+    }
+    Serial.println();
+}
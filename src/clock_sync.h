@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+// Host/device clock alignment. The host pings with "@<seq>"; the device
+// answers "SYNC <seq> <t_rx_us> <t_tx_us>" in its 64-bit microsecond clock.
+// From those NTP-style exchanges the host estimates offset and drift and
+// sends them back with "@=<offset_us>.<drift_ppb>.<ref_device_us>"; from then
+// on device timestamps are printed in the host's monotonic time base
+// (see host/tools/clock_sync).
+
+int64_t deviceTimeUs();
+
+void clockSyncPing(uint32_t sequence, int64_t receivedUs);
+void clockSyncSetMapping(int64_t offsetUs, int64_t driftPpb, int64_t referenceUs);
+bool clockSyncValid();
+int64_t toHostTimeUs(int64_t deviceUs);
+void printClockSync();
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "idrive_controller.h"
+
+#include <cstdint>
+
+// Row layouts of the controller mapping tables. The tables themselves are
+// generated from the variant's annotated capture spec (zbe/*.spec) by
+// scripts/zbe_codegen.py into zbe_mappings.h.
+
+struct KnobMapping {
+    const char *label;
+    uint8_t matchValue;
+    bool iDriveState::*pressedField;
+};
+
+enum class ButtonState : uint8_t {
+    Released,
+    Pressed,
+    Touched,
+};
+
+struct ButtonDescriptor {
+    const char *label;
+    uint8_t byteIndex;
+    uint8_t pressedValue;
+    uint8_t touchedValue;
+    bool iDriveState::*pressedField;
+    bool iDriveState::*touchedField;
+};
@@ -0,0 +1,175 @@
+#include "cycle_monitor.h"
+#include "capture.h"
+
+#include <Arduino.h>
+
+namespace {
+
+constexpr uint16_t STANDARD_ID_SPACE = 0x800;
+constexpr uint8_t  MAX_CYCLIC_IDS    = 64;
+
+// Periods are kept in Q24.8 microseconds; EMA weight 1/8 for the period and
+// 1/16 for the jitter tracks slow drift while ignoring single outliers.
+constexpr uint8_t  FRACTION_BITS         = 8;
+constexpr uint8_t  PERIOD_SHIFT          = 3;
+constexpr uint8_t  JITTER_SHIFT          = 4;
+constexpr uint8_t  LEARNING_SAMPLES      = 16;
+constexpr uint8_t  MISSING_PERIODS       = 3;
+constexpr uint32_t MISSING_POLL_MS       = 20;
+constexpr uint32_t MAX_LEARNED_PERIOD_US = 10000000;  // 10 s, keeps Q24.8 in range
+
+enum class CycleAnomaly : uint8_t {
+    Late,
+    Missing,
+    Burst,
+    Resumed,
+};
+
+struct CycleEntry {
+    uint16_t id;
+    uint8_t  samples;       // saturates at LEARNING_SAMPLES
+    bool     seen;
+    bool     locked;
+    bool     missing;
+    uint32_t lastRxUs;
+    uint32_t periodQ8;
+    uint32_t jitterQ8;
+    uint16_t lateCount;
+    uint16_t missingCount;
+    uint16_t burstCount;
+};
+
+uint8_t slotOf[STANDARD_ID_SPACE];
+CycleEntry entries[MAX_CYCLIC_IDS];
+uint8_t entryCount = 0;
+
+bool reporting = false;  // 'y1' turns CYCLE lines on, like the other monitors
+unsigned long lastMissingPollMs = 0;
+
+const char *anomalyName(CycleAnomaly anomaly) {
+    switch (anomaly) {
+        case CycleAnomaly::Late:    return "LATE";
+        case CycleAnomaly::Missing: return "MISSING";
+        case CycleAnomaly::Burst:   return "BURST";
+        default:                    return "RESUMED";
+    }
+}
+
+void report(CycleAnomaly anomaly, const CycleEntry &entry, uint32_t observedUs) {
+    if (!reporting || captureStreaming()) return;  // still counted in the y table
+    Serial.printf("CYCLE %s 0x%03X observed=%luus expected=%luus\n",
+                  anomalyName(anomaly), entry.id,
+                  static_cast<unsigned long>(observedUs),
+                  static_cast<unsigned long>(entry.periodQ8 >> FRACTION_BITS));
+}
+
+// An ID is considered cyclic once its jitter settles below a quarter period
+bool isStable(const CycleEntry &entry) {
+    return entry.samples >= LEARNING_SAMPLES && entry.jitterQ8 < (entry.periodQ8 >> 2);
+}
+
+// Late/burst tolerance: four jitters, but never tighter than 1/4 period
+uint64_t toleranceQ8(const CycleEntry &entry) {
+    uint64_t jitterBand = static_cast<uint64_t>(entry.jitterQ8) << 2;
+    uint64_t floor = entry.periodQ8 >> 2;
+    return (jitterBand > floor) ? jitterBand : floor;
+}
+
+CycleEntry *entryFor(uint32_t id) {
+    if (id >= STANDARD_ID_SPACE) return nullptr;
+    uint8_t slot = slotOf[id];
+    if (slot) return &entries[slot - 1];
+    if (entryCount >= MAX_CYCLIC_IDS) return nullptr;
+
+    CycleEntry &entry = entries[entryCount++];
+    entry = CycleEntry();
+    entry.id = static_cast<uint16_t>(id);
+    slotOf[id] = entryCount;
+    return &entry;
+}
+
+}  // namespace
+
+void cycleMonitorRecord(uint32_t id, uint32_t rxUs) {
+    CycleEntry *entry = entryFor(id);
+    if (!entry) return;
+
+    bool first = !entry->seen;
+    uint32_t period = rxUs - entry->lastRxUs;
+    entry->seen = true;
+    entry->lastRxUs = rxUs;
+    if (first || period > MAX_LEARNED_PERIOD_US) return;
+
+    if (entry->missing) {
+        entry->missing = false;
+        report(CycleAnomaly::Resumed, *entry, period);
+        return;  // the gap itself is not a period sample
+    }
+
+    uint32_t periodQ8 = period << FRACTION_BITS;
+
+    if (entry->samples == 0) {
+        entry->periodQ8 = periodQ8;
+        entry->samples = 1;
+        return;
+    }
+
+    if (entry->locked) {
+        uint64_t tolerance = toleranceQ8(*entry);
+        if (periodQ8 > entry->periodQ8 + tolerance) {
+            entry->lateCount++;
+            report(CycleAnomaly::Late, *entry, period);
+        } else if (periodQ8 + tolerance < entry->periodQ8 && periodQ8 < (entry->periodQ8 >> 1)) {
+            entry->burstCount++;
+            report(CycleAnomaly::Burst, *entry, period);
+        }
+    }
+
+    // Learned periods reach 10 s, above 2^31 in Q24.8, so differences are 64-bit
+    int64_t error = static_cast<int64_t>(periodQ8) - entry->periodQ8;
+    int64_t deviation = (error < 0) ? -error : error;
+    entry->periodQ8 = static_cast<uint32_t>(entry->periodQ8 + (error >> PERIOD_SHIFT));
+    entry->jitterQ8 = static_cast<uint32_t>(entry->jitterQ8 + ((deviation - entry->jitterQ8) >> JITTER_SHIFT));
+
+    if (entry->samples < LEARNING_SAMPLES) entry->samples++;
+    entry->locked = isStable(*entry);
+}
+
+void updateCycleMonitor() {
+    unsigned long nowMs = millis();
+    if (nowMs - lastMissingPollMs < MISSING_POLL_MS) return;
+    lastMissingPollMs = nowMs;
+
+    uint32_t nowUs = micros();
+    for (uint8_t i = 0; i < entryCount; i++) {
+        CycleEntry &entry = entries[i];
+        if (!entry.locked || entry.missing) continue;
+
+        uint32_t silentUs = nowUs - entry.lastRxUs;
+        if ((static_cast<uint64_t>(silentUs) << FRACTION_BITS) > static_cast<uint64_t>(entry.periodQ8) * MISSING_PERIODS) {
+            entry.missing = true;
+            entry.missingCount++;
+            report(CycleAnomaly::Missing, entry, silentUs);
+        }
+    }
+}
+
+void cycleMonitorSetReporting(bool enabled) {
+    reporting = enabled;
+    Serial.print("Cycle anomaly reports: ");
+    Serial.println(reporting ? "ON" : "OFF");
+}
+
+void printCycleMonitor() {
+    Serial.println("\nCycle monitor:");
+    Serial.printf("  %-5s %-8s %10s %9s %6s %7s %6s\n", "ID", "state", "period_us", "jitter_us", "late", "missing", "burst");
+    for (uint8_t i = 0; i < entryCount; i++) {
+        const CycleEntry &entry = entries[i];
+        const char *status = entry.missing ? "MISSING" : entry.locked ? "LOCKED" : "LEARN";
+        Serial.printf("  %03X   %-8s %10lu %9lu %6u %7u %6u\n",
+                      entry.id, status,
+                      static_cast<unsigned long>(entry.periodQ8 >> FRACTION_BITS),
+                      static_cast<unsigned long>(entry.jitterQ8 >> FRACTION_BITS),
+                      entry.lateCount, entry.missingCount, entry.burstCount);
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// Learns each ID's nominal period and jitter online (fixed-point EMAs) and
+// reports late, missing and burst frames once an ID has locked onto a
+// stable cycle. Event-driven IDs such as 0x25B never lock and stay quiet.
+void cycleMonitorRecord(uint32_t id, uint32_t rxUs);
+void updateCycleMonitor();
+
+void cycleMonitorSetReporting(bool enabled);
+void printCycleMonitor();
@@ -0,0 +1,120 @@
+#include "dbc_parse.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char *skipSpaces(const char *p) {
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+bool consume(const char *&p, const char *literal) {
+    size_t n = strlen(literal);
+    if (strncmp(p, literal, n) != 0) return false;
+    p += n;
+    return true;
+}
+
+bool isNameChar(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Copies a C identifier, truncating to the buffer
+bool readName(const char *&p, char *out, size_t size) {
+    p = skipSpaces(p);
+    size_t n = 0;
+    while (isNameChar(*p)) {
+        if (n + 1 < size) out[n++] = *p;
+        p++;
+    }
+    out[n] = '\0';
+    return n > 0;
+}
+
+bool readUnsigned(const char *&p, uint32_t &value) {
+    p = skipSpaces(p);
+    char *end = nullptr;
+    unsigned long parsed = strtoul(p, &end, 10);
+    if (end == p) return false;
+    value = static_cast<uint32_t>(parsed);
+    p = end;
+    return true;
+}
+
+bool readFloat(const char *&p, float &value) {
+    p = skipSpaces(p);
+    char *end = nullptr;
+    value = strtof(p, &end);
+    if (end == p) return false;
+    p = end;
+    return true;
+}
+
+bool expect(const char *&p, char c) {
+    p = skipSpaces(p);
+    if (*p != c) return false;
+    p++;
+    return true;
+}
+
+// "BO_ 603 ZBE_CONTROLLER: 8 ZBE"
+DbcLineKind parseMessage(const char *p, DbcMessage &message) {
+    uint32_t id, dlc;
+    if (!readUnsigned(p, id) || !readName(p, message.name, sizeof(message.name)) || !expect(p, ':') ||
+        !readUnsigned(p, dlc) || dlc > 8) {
+        return DbcLineKind::Invalid;
+    }
+    message.extended = (id & 0x80000000u) != 0;
+    message.id = id & 0x1FFFFFFFu;
+    message.dlc = static_cast<uint8_t>(dlc);
+    return DbcLineKind::Message;
+}
+
+// "SG_ Knob : 24|8@1+ (1,0) [0|255] "" IDRIVE"
+DbcLineKind parseSignal(const char *p, DbcSignal &signal) {
+    if (!readName(p, signal.name, sizeof(signal.name))) return DbcLineKind::Invalid;
+    p = skipSpaces(p);
+    if (*p == 'M' || *p == 'm') return DbcLineKind::Other;  // multiplexor / multiplexed
+
+    uint32_t start, length;
+    if (!expect(p, ':') || !readUnsigned(p, start) || !expect(p, '|') || !readUnsigned(p, length) ||
+        !expect(p, '@')) {
+        return DbcLineKind::Invalid;
+    }
+    if (*p != '0' && *p != '1') return DbcLineKind::Invalid;
+    signal.order = (*p++ == '1') ? ByteOrder::Intel : ByteOrder::Motorola;
+    if (*p != '+' && *p != '-') return DbcLineKind::Invalid;
+    signal.isSigned = (*p++ == '-');
+
+    if (!expect(p, '(') || !readFloat(p, signal.factor) || !expect(p, ',') || !readFloat(p, signal.offset) ||
+        !expect(p, ')')) {
+        return DbcLineKind::Invalid;
+    }
+    if (start > 63 || length > 64) return DbcLineKind::Invalid;
+    signal.startBit = static_cast<uint8_t>(start);
+    signal.length = static_cast<uint8_t>(length);
+    if (!signalFits(signal.startBit, signal.length, signal.order)) return DbcLineKind::Invalid;
+
+    // [min|max] is informational; the unit is optional for our purposes
+    signal.unit[0] = '\0';
+    const char *quote = strchr(p, '"');
+    if (quote) {
+        const char *close = strchr(quote + 1, '"');
+        size_t n = close ? static_cast<size_t>(close - quote - 1) : 0;
+        if (n >= sizeof(signal.unit)) n = sizeof(signal.unit) - 1;
+        memcpy(signal.unit, quote + 1, n);
+        signal.unit[n] = '\0';
+    }
+    return DbcLineKind::Signal;
+}
+
+}  // namespace
+
+DbcLineKind parseDbcLine(const char *line, DbcMessage &message, DbcSignal &signal) {
+    const char *p = skipSpaces(line);
+    if (consume(p, "BO_ ")) return parseMessage(p, message);
+    if (consume(p, "SG_ ")) return parseSignal(p, signal);
+    return DbcLineKind::Other;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "signal_decode.h"
+
+#include <cstdint>
+
+// Line-at-a-time parser for the DBC subset the runtime decoder needs:
+//
+//   BO_ 603 ZBE_CONTROLLER: 8 ZBE
+//    SG_ Knob : 24|8@1+ (1,0) [0|255] "" IDRIVE
+//
+// Fixed-size output and no allocation, so the firmware can take a DBC one
+// serial line at a time. Multiplexed signals and everything else in a DBC
+// (VAL_, CM_, attributes) come back as Other.
+
+constexpr uint8_t DBC_NAME_LENGTH = 32;
+constexpr uint8_t DBC_UNIT_LENGTH = 12;
+
+enum class DbcLineKind : uint8_t {
+    Other,    // blank, unsupported or not a definition
+    Message,  // BO_
+    Signal,   // SG_
+    Invalid,  // BO_/SG_ that does not parse or does not fit 8 bytes
+};
+
+struct DbcMessage {
+    uint32_t id;
+    bool     extended;  // bit 31 of the DBC ID
+    uint8_t  dlc;
+    char     name[DBC_NAME_LENGTH];
+};
+
+struct DbcSignal {
+    char      name[DBC_NAME_LENGTH];
+    uint8_t   startBit;
+    uint8_t   length;
+    ByteOrder order;
+    bool      isSigned;
+    float     factor;
+    float     offset;
+    char      unit[DBC_UNIT_LENGTH];
+};
+
+DbcLineKind parseDbcLine(const char *line, DbcMessage &message, DbcSignal &signal);
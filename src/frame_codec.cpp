@@ -0,0 +1,220 @@
+#include "frame_codec.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t STANDARD_ID_SPACE = 0x800;
+constexpr uint8_t  PERIOD_SHIFT      = 3;  // period EMA weight 1/8
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+size_t putVarint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+// Returns false on truncation; overlong encodings are rejected by the shift cap
+bool getVarint(const uint8_t *&p, const uint8_t *end, uint64_t &value, bool &malformed) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (p >= end) return false;
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    malformed = true;
+    return false;
+}
+
+void bind(CodecContext &ctx, const CodecFrame &frame) {
+    ctx.lastUs = frame.timestampUs;
+    ctx.periodUs = 0;
+    ctx.id = frame.id;
+    ctx.extended = frame.extended;
+    ctx.dlc = frame.dlc;
+    ctx.flags = frame.flags;
+    memcpy(ctx.data, frame.data, sizeof(ctx.data));
+    memset(ctx.lastDelta, 0, sizeof(ctx.lastDelta));
+    memset(ctx.stride, 0, sizeof(ctx.stride));
+}
+
+int64_t predictTime(const CodecContext &ctx) {
+    return ctx.lastUs + ctx.periodUs;
+}
+
+void predictPayload(const CodecContext &ctx, uint8_t *predicted) {
+    for (uint8_t i = 0; i < 8; i++) predicted[i] = static_cast<uint8_t>(ctx.data[i] + ctx.stride[i]);
+}
+
+// Identical on both sides; everything here must stay deterministic
+void advance(CodecContext &ctx, int64_t timestampUs, const uint8_t *data) {
+    int64_t delta = timestampUs - ctx.lastUs;
+    ctx.periodUs = (ctx.periodUs == 0) ? delta : ctx.periodUs + (delta - ctx.periodUs) / (1 << PERIOD_SHIFT);
+    ctx.lastUs = timestampUs;
+
+    for (uint8_t i = 0; i < 8; i++) {
+        uint8_t byteDelta = static_cast<uint8_t>(data[i] - ctx.data[i]);
+        ctx.stride[i] = (byteDelta == ctx.lastDelta[i]) ? byteDelta : 0;
+        ctx.lastDelta[i] = byteDelta;
+        ctx.data[i] = data[i];
+    }
+}
+
+}  // namespace
+
+void FrameEncoder::reset() {
+    contextCount_ = 0;
+    memset(slotOf_, 0, sizeof(slotOf_));
+    lastUs_ = 0;
+}
+
+uint8_t FrameEncoder::contextFor(const CodecFrame &frame) {
+    if (!frame.extended && frame.id < STANDARD_ID_SPACE) {
+        uint8_t slot = slotOf_[frame.id];
+        if (slot) return slot - 1;
+    } else {
+        for (uint8_t i = 0; i < contextCount_; i++) {
+            if (contexts_[i].extended == frame.extended && contexts_[i].id == frame.id) return i;
+        }
+    }
+    return CODEC_NO_CONTEXT;
+}
+
+size_t FrameEncoder::encode(const CodecFrame &input, uint8_t *out) {
+    CodecFrame frame = input;
+    if (frame.dlc > 8) frame.dlc = 8;
+    memset(frame.data + frame.dlc, 0, 8 - frame.dlc);
+
+    uint8_t slot = contextFor(frame);
+    size_t n = 0;
+
+    if (slot != CODEC_NO_CONTEXT && contexts_[slot].flags == frame.flags && contexts_[slot].dlc == frame.dlc) {
+        CodecContext &ctx = contexts_[slot];
+        int64_t residual = frame.timestampUs - predictTime(ctx);
+        uint8_t predicted[8];
+        predictPayload(ctx, predicted);
+
+        if (memcmp(predicted, frame.data, frame.dlc) == 0) {
+            out[n++] = static_cast<uint8_t>((residual == 0 ? CODEC_OP_PREDICTED : CODEC_OP_REPEAT) << 6 | slot);
+            if (residual != 0) n += putVarint(out + n, zigzag(residual));
+        } else {
+            out[n++] = static_cast<uint8_t>(CODEC_OP_XOR << 6 | slot);
+            n += putVarint(out + n, zigzag(residual));
+            uint8_t &mask = out[n++];
+            mask = 0;
+            for (uint8_t i = 0; i < frame.dlc; i++) {
+                uint8_t diff = predicted[i] ^ frame.data[i];
+                if (!diff) continue;
+                mask |= 1 << i;
+                out[n++] = diff;
+            }
+        }
+        advance(ctx, frame.timestampUs, frame.data);
+        lastUs_ = frame.timestampUs;
+        return n;
+    }
+
+    // Literal: new ID, or dlc/flags changed for a known one (rebinds its slot)
+    if (slot == CODEC_NO_CONTEXT && contextCount_ < CODEC_CONTEXTS) {
+        slot = contextCount_++;
+        if (!frame.extended && frame.id < STANDARD_ID_SPACE) slotOf_[frame.id] = slot + 1;
+    }
+
+    out[n++] = static_cast<uint8_t>(CODEC_OP_LITERAL << 6 | slot);
+    n += putVarint(out + n, zigzag(frame.timestampUs - lastUs_));
+    n += putVarint(out + n, static_cast<uint64_t>(frame.id) << 1 | (frame.extended ? 1 : 0));
+    out[n++] = frame.dlc;
+    out[n++] = frame.flags;
+    memcpy(out + n, frame.data, frame.dlc);
+    n += frame.dlc;
+
+    if (slot != CODEC_NO_CONTEXT) bind(contexts_[slot], frame);
+    lastUs_ = frame.timestampUs;
+    return n;
+}
+
+void FrameDecoder::reset() {
+    memset(bound_, 0, sizeof(bound_));
+    lastUs_ = 0;
+}
+
+int FrameDecoder::decode(const uint8_t *in, size_t size, CodecFrame &frame) {
+    const uint8_t *p = in;
+    const uint8_t *end = in + size;
+    bool malformed = false;
+    if (p >= end) return 0;
+
+    uint8_t header = *p++;
+    uint8_t op = header >> 6;
+    uint8_t slot = header & 0x3F;
+
+    if (op == CODEC_OP_LITERAL) {
+        uint64_t delta, idField;
+        if (!getVarint(p, end, delta, malformed) || !getVarint(p, end, idField, malformed)) return malformed ? -1 : 0;
+        if (end - p < 2) return 0;
+        frame.timestampUs = lastUs_ + unzigzag(delta);
+        frame.id = static_cast<uint32_t>(idField >> 1);
+        frame.extended = idField & 1;
+        frame.dlc = *p++;
+        frame.flags = *p++;
+        if (frame.dlc > 8) return -1;
+        if (end - p < frame.dlc) return 0;
+        memset(frame.data, 0, sizeof(frame.data));
+        memcpy(frame.data, p, frame.dlc);
+        p += frame.dlc;
+
+        if (slot != CODEC_NO_CONTEXT) {
+            bind(contexts_[slot], frame);
+            bound_[slot] = true;
+        }
+        lastUs_ = frame.timestampUs;
+        return static_cast<int>(p - in);
+    }
+
+    if (slot == CODEC_NO_CONTEXT || !bound_[slot]) return -1;
+    CodecContext &ctx = contexts_[slot];
+
+    int64_t residual = 0;
+    if (op != CODEC_OP_PREDICTED) {
+        uint64_t value;
+        if (!getVarint(p, end, value, malformed)) return malformed ? -1 : 0;
+        residual = unzigzag(value);
+    }
+
+    uint8_t data[8];
+    predictPayload(ctx, data);
+    memset(data + ctx.dlc, 0, 8 - ctx.dlc);
+    if (op == CODEC_OP_XOR) {
+        if (p >= end) return 0;
+        uint8_t mask = *p++;
+        if (mask >> ctx.dlc) return -1;
+        for (uint8_t i = 0; i < ctx.dlc; i++) {
+            if (!(mask & (1 << i))) continue;
+            if (p >= end) return 0;
+            data[i] ^= *p++;
+        }
+    }
+
+    // Only commit once the whole frame was available
+    frame.timestampUs = predictTime(ctx) + residual;
+    frame.id = ctx.id;
+    frame.extended = ctx.extended;
+    frame.dlc = ctx.dlc;
+    frame.flags = ctx.flags;
+    memcpy(frame.data, data, sizeof(data));
+    advance(ctx, frame.timestampUs, data);
+    lastUs_ = frame.timestampUs;
+    return static_cast<int>(p - in);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Streaming per-ID delta codec for CAN frames, shared by the firmware's
+// compressed capture dumps and the host tools. Each frame is coded against
+// a prediction from the previous frames of the same ID:
+//
+//   header byte: op << 6 | context
+//   OP_PREDICTED  payload and timestamp exactly as predicted
+//   OP_REPEAT     payload as predicted; varint time residual
+//   OP_XOR        varint time residual, mask of mispredicted bytes, then
+//                 actual ^ predicted for each set bit
+//   OP_LITERAL    varint time delta to the previous frame of any ID,
+//                 varint (id << 1 | extended), dlc, flags, dlc data bytes
+//
+// The predicted timestamp is the last one plus a smoothed period, so the
+// residual is just arbitration jitter and fits one varint byte for steady
+// cyclic traffic. The predicted payload is the last one plus a per-byte
+// stride that is only kept once the same byte delta was seen twice in a
+// row: rolling counters then cost nothing, while one-off changes (touch
+// coordinates) are not extrapolated. A literal (re)binds its context slot
+// to the ID; context NO_CONTEXT carries frames for IDs beyond the table
+// without binding. The decoder just follows the slots named in the
+// stream, so it needs no allocation policy.
+//
+// No heap, no exceptions, C++11: the encoder runs on the device.
+
+constexpr uint8_t CODEC_CONTEXTS        = 63;
+constexpr uint8_t CODEC_NO_CONTEXT      = 63;
+constexpr size_t  CODEC_MAX_FRAME_BYTES = 1 + 10 + 5 + 2 + 8;
+
+enum CodecOp : uint8_t {
+    CODEC_OP_PREDICTED = 0,
+    CODEC_OP_REPEAT    = 1,
+    CODEC_OP_XOR       = 2,
+    CODEC_OP_LITERAL   = 3,
+};
+
+struct CodecFrame {
+    int64_t  timestampUs;
+    uint32_t id;
+    bool     extended;
+    uint8_t  dlc;
+    uint8_t  flags;  // opaque to the codec, carried losslessly
+    uint8_t  data[8];
+};
+
+struct CodecContext {
+    int64_t  lastUs;
+    int64_t  periodUs;  // smoothed, 0 until the second frame
+    uint32_t id;
+    bool     extended;
+    uint8_t  dlc;
+    uint8_t  flags;
+    uint8_t  data[8];
+    uint8_t  lastDelta[8];
+    uint8_t  stride[8];
+};
+
+class FrameEncoder {
+public:
+    FrameEncoder() { reset(); }
+
+    // Forget all contexts; the decoder must be reset at the same point
+    void reset();
+
+    // Writes at most CODEC_MAX_FRAME_BYTES to out, returns the byte count
+    size_t encode(const CodecFrame &frame, uint8_t *out);
+
+private:
+    uint8_t contextFor(const CodecFrame &frame);
+
+    CodecContext contexts_[CODEC_CONTEXTS];
+    uint8_t contextCount_;
+    uint8_t slotOf_[0x800];  // 1 + context index for standard IDs, 0 = unbound
+    int64_t lastUs_;
+};
+
+class FrameDecoder {
+public:
+    FrameDecoder() { reset(); }
+
+    void reset();
+
+    // Decodes one frame from [in, in + size). Returns the bytes consumed,
+    // 0 if the input ends mid-frame, or -1 on a malformed stream.
+    int decode(const uint8_t *in, size_t size, CodecFrame &frame);
+
+private:
+    CodecContext contexts_[CODEC_CONTEXTS];
+    bool bound_[CODEC_CONTEXTS];
+    int64_t lastUs_;
+};
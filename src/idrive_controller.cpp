@@ -1,6 +1,12 @@
 #include "idrive_controller.h"
 #include "can_protocol.h"
+#include "capture.h"
+#include "controller_mapping.h"
+#include "latency.h"
+#include "profiler.h"
+#include "trace.h"
 #include "twai_driver.h"
+#include "zbe_mappings.h"
 
 #include <Arduino.h>
 
@@ -8,56 +14,20 @@
 iDriveState state;
 uint8_t debugMode = 0;
 
+static_assert(CONTROLLER_ID == ID_CONTROLLER, "zbe_mappings.h was generated for another controller ID");
+
 namespace {
 
-// --- Knob mapping table ---
-
-struct KnobMapping {
-    const char *label;
-    uint8_t matchValue;
-    bool iDriveState::*pressedField;
-};
-
-constexpr KnobMapping KNOB_MAPPINGS[] = {
-    {"CENTER", 0x01, &iDriveState::knobPressedCenter},
-    {"LEFT",   0xA0, &iDriveState::knobPressedLeft},
-    {"UP",     0x10, &iDriveState::knobPressedUp},
-    {"RIGHT",  0x40, &iDriveState::knobPressedRight},
-    {"DOWN",   0x70, &iDriveState::knobPressedDown},
-};
-
-// --- Button mapping table ---
-
-enum class ButtonState : uint8_t {
-    Released,
-    Pressed,
-    Touched,
-};
-
-struct ButtonDescriptor {
-    const char *label;
-    uint8_t byteIndex;
-    uint8_t pressedValue;
-    uint8_t touchedValue;
-    bool iDriveState::*pressedField;
-    bool iDriveState::*touchedField;
-};
-
-constexpr ButtonDescriptor BUTTON_MAPPINGS[] = {
-    {"BACK",   4, 0x20, 0x80, &iDriveState::backButtonPressed,   &iDriveState::backButtonTouched},
-    {"HOME",   4, 0x04, 0x10, &iDriveState::homeButtonPressed,   &iDriveState::homeButtonTouched},
-    {"COM",    5, 0x08, 0x20, &iDriveState::comButtonPressed,    &iDriveState::comButtonTouched},
-    {"OPTION", 5, 0x01, 0x04, &iDriveState::optionButtonPressed, &iDriveState::optionButtonTouched},
-    {"MEDIA",  6, 0xC1, 0xC4, &iDriveState::mediaButtonPressed,  &iDriveState::mediaButtonTouched},
-    {"NAV",    6, 0xC8, 0xE0, &iDriveState::navButtonPressed,    &iDriveState::navButtonTouched},
-    {"MAP",    7, 0xC1, 0xC4, &iDriveState::mapButtonPressed,    &iDriveState::mapButtonTouched},
-    {"GLOBE",  7, 0xC8, 0xE0, &iDriveState::globeButtonPressed,  &iDriveState::globeButtonTouched},
-};
+// --- Knob / button decode state ---
+
+// Last KNOB_DECODE / BUTTON_DECODE masks; only changed bits are applied
+uint8_t  knobBits   = 0;
+uint32_t buttonBits = 0;
 
 // --- Logging helpers ---
 
 bool shouldLogStateChanges() {
-    return debugMode == 0 || debugMode == 1;
+    return (debugMode == 0 || debugMode == 1) && !captureStreaming();
 }
 
 const char *toStateString(ButtonState bs) {
@@ -68,23 +38,25 @@ const char *toStateString(ButtonState bs) {
     }
 }
 
-void logKnobChange(const char *label, bool isPressed) {
+// The probe was created where the frame's changes were found, so every
+// event from one frame shares its decode stamp
+void logKnobChange(LatencyProbe &latency, const char *label, bool isPressed) {
     if (!shouldLogStateChanges()) return;
+    TraceScope logTrace(TraceEvent::Log, ID_CONTROLLER);
+    latency.enqueued();
     Serial.print("Knob ");
     Serial.println(isPressed ? label : "RELEASED");
+    latency.written();
 }
 
-void logButtonChange(const char *label, ButtonState bs) {
+void logButtonChange(LatencyProbe &latency, const char *label, ButtonState bs) {
     if (!shouldLogStateChanges()) return;
+    TraceScope logTrace(TraceEvent::Log, ID_CONTROLLER);
+    latency.enqueued();
     Serial.print(label);
     Serial.print(" ");
     Serial.println(toStateString(bs));
-}
-
-ButtonState decodeButtonState(uint8_t raw, const ButtonDescriptor &desc) {
-    if (raw == desc.pressedValue) return ButtonState::Pressed;
-    if (raw == desc.touchedValue) return ButtonState::Touched;
-    return ButtonState::Released;
+    latency.written();
 }
 
 // --- Brightness helpers ---
@@ -112,6 +84,7 @@ void logBrightness(uint8_t level) {
 }
 
 void sendBrightnessFrame(uint8_t value) {
+    PROFILE_ZONE("tx_brightness");
     uint8_t payload[1] = {value};
     twai_send(ID_BRIGHTNESS, 1, payload);
 }
@@ -121,33 +94,58 @@ void sendBrightnessFrame(uint8_t value) {
 // --- Public mutation functions ---
 
 void updateKnobStates(uint8_t knobByte) {
-    for (const auto &mapping : KNOB_MAPPINGS) {
-        bool pressed = knobByte == mapping.matchValue;
-        bool &field = state.*(mapping.pressedField);
-        if (field != pressed) {
-            field = pressed;
-            logKnobChange(mapping.label, pressed);
+    PROFILE_ZONE("update_knobs");
+    uint8_t bits = KNOB_DECODE[knobByte];
+    uint8_t changed = bits ^ knobBits;
+    knobBits = bits;
+    if (!changed) return;
+    LatencyProbe latency;
+
+    // Releases before presses: "Knob RELEASED" carries no label, so on a
+    // direct UP -> LEFT change the host must see the release first
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        uint8_t pending = changed & (pass ? bits : static_cast<uint8_t>(~bits));
+        while (pending) {
+            uint8_t i = __builtin_ctz(pending);
+            pending &= pending - 1;
+            const KnobMapping &mapping = KNOB_MAPPINGS[i];
+            bool pressed = pass == 1;
+            state.*(mapping.pressedField) = pressed;
+            captureNoteDecodedEvent();
+            logKnobChange(latency, mapping.label, pressed);
         }
     }
 }
 
 void updateButtonStates(const uint8_t *frameData) {
-    for (const auto &desc : BUTTON_MAPPINGS) {
-        ButtonState bs = decodeButtonState(frameData[desc.byteIndex], desc);
-        bool pressed = bs == ButtonState::Pressed;
-        bool touched = bs == ButtonState::Touched;
-        bool &pressedField = state.*(desc.pressedField);
-        bool &touchedField = state.*(desc.touchedField);
-
-        if (pressedField != pressed || touchedField != touched) {
-            pressedField = pressed;
-            touchedField = touched;
-            logButtonChange(desc.label, bs);
-        }
+    PROFILE_ZONE("update_buttons");
+    uint32_t bits = 0;
+    for (uint8_t slot = 0; slot < sizeof(BUTTON_BYTES); slot++) {
+        bits |= BUTTON_DECODE[slot][frameData[BUTTON_BYTES[slot]]];
+    }
+    uint32_t changed = bits ^ buttonBits;
+    buttonBits = bits;
+    if (!changed) return;
+    LatencyProbe latency;
+
+    // Fold the touched half onto the button index
+    changed = (changed | (changed >> 16)) & 0xFFFF;
+    while (changed) {
+        uint8_t i = __builtin_ctz(changed);
+        changed &= changed - 1;
+        const ButtonDescriptor &desc = BUTTON_MAPPINGS[i];
+        bool pressed = (bits >> i) & 1;
+        bool touched = (bits >> (16 + i)) & 1;
+        state.*(desc.pressedField) = pressed;
+        state.*(desc.touchedField) = touched;
+        captureNoteDecodedEvent();
+        logButtonChange(latency, desc.label, pressed ? ButtonState::Pressed : touched ? ButtonState::Touched
+                                                                                      : ButtonState::Released);
     }
 }
 
 void updateRotation(uint8_t newSequence, uint8_t newEncoder) {
+    PROFILE_ZONE("update_rotation");
     if (newSequence == state.sequenceCounter) {
         state.rotationDirection = 0;
         return;
@@ -160,15 +158,20 @@ void updateRotation(uint8_t newSequence, uint8_t newEncoder) {
         else if (diff < -127) diff += 256;
 
         if (diff != 0) {
+            LatencyProbe latency;
             state.rotationDirection = (diff > 0) ? 1 : -1;
             state.stepPosition += state.rotationDirection;
+            captureNoteDecodedEvent();
 
             if (shouldLogStateChanges()) {
+                TraceScope logTrace(TraceEvent::Log, ID_CONTROLLER);
+                latency.enqueued();
                 Serial.print("Rotation ");
                 Serial.print(state.rotationDirection == 1 ? "CW" : "CCW");
                 Serial.print(" (");
                 Serial.print(state.stepPosition);
                 Serial.println(")");
+                latency.written();
             }
         } else {
             state.rotationDirection = 0;
@@ -0,0 +1,143 @@
+#include "latency.h"
+
+#include <Arduino.h>
+
+namespace {
+
+enum LatencyStage : uint8_t {
+    STAGE_RX_TO_DECODE,
+    STAGE_DECODE_TO_ENQUEUE,
+    STAGE_ENQUEUE_TO_WRITE,
+    STAGE_RX_TO_WRITE,
+    STAGE_WRITE_TO_ACK,
+    STAGE_COUNT,
+};
+
+const char *const STAGE_NAMES[STAGE_COUNT] = {
+    "rx->decode",
+    "decode->enqueue",
+    "enqueue->write",
+    "rx->write",
+    "write->ack",
+};
+
+// Log-linear buckets: 4 sub-buckets per power of two keeps percentile
+// error under ~20% while covering 1 us .. 16 s in 96 counters.
+constexpr uint8_t SUB_BUCKET_BITS = 2;
+constexpr uint8_t SUB_BUCKETS     = 1 << SUB_BUCKET_BITS;
+constexpr uint8_t BUCKET_COUNT    = 24 * SUB_BUCKETS;
+
+struct LatencyHistogram {
+    uint32_t counts[BUCKET_COUNT] = {};
+    uint32_t samples = 0;
+    uint32_t maxUs   = 0;
+};
+
+// Outstanding loopback events waiting for a host ack
+constexpr uint8_t PENDING_ACKS = 16;
+
+struct PendingAck {
+    uint32_t sequence;
+    uint32_t writtenUs;
+};
+
+LatencyHistogram histograms[STAGE_COUNT];
+uint32_t frameRxUs = 0;
+bool loopback = false;
+uint32_t nextSequence = 0;
+PendingAck pending[PENDING_ACKS];
+
+uint8_t bucketFor(uint32_t us) {
+    if (us < SUB_BUCKETS) return us;
+    uint8_t msb = 31 - __builtin_clz(us);
+    uint8_t sub = (us >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    uint16_t bucket = (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+    return (bucket >= BUCKET_COUNT) ? BUCKET_COUNT - 1 : bucket;
+}
+
+// Upper bound (exclusive) of a bucket, used as the percentile estimate
+uint32_t bucketUpperUs(uint8_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket + 1;
+    uint8_t octave = bucket / SUB_BUCKETS - 1;
+    uint8_t sub = bucket % SUB_BUCKETS;
+    return (static_cast<uint32_t>(SUB_BUCKETS + sub + 1)) << octave;
+}
+
+void recordStage(LatencyStage stage, uint32_t us) {
+    LatencyHistogram &h = histograms[stage];
+    h.counts[bucketFor(us)]++;
+    h.samples++;
+    if (us > h.maxUs) h.maxUs = us;
+}
+
+uint32_t percentileUs(const LatencyHistogram &h, uint32_t perMille) {
+    uint32_t target = (static_cast<uint64_t>(h.samples) * perMille + 999) / 1000;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += h.counts[i];
+        if (seen >= target) return bucketUpperUs(i);
+    }
+    return h.maxUs;
+}
+
+}  // namespace
+
+void latencyFrameReceived(uint32_t rxUs) {
+    frameRxUs = rxUs;
+}
+
+LatencyProbe::LatencyProbe() : rxUs_(frameRxUs), decodeUs_(micros()) {}
+
+void LatencyProbe::enqueued() {
+    enqueueUs_ = micros();
+}
+
+void LatencyProbe::written() {
+    uint32_t writtenUs = micros();
+    recordStage(STAGE_RX_TO_DECODE, decodeUs_ - rxUs_);
+    recordStage(STAGE_DECODE_TO_ENQUEUE, enqueueUs_ - decodeUs_);
+    recordStage(STAGE_ENQUEUE_TO_WRITE, writtenUs - enqueueUs_);
+    recordStage(STAGE_RX_TO_WRITE, writtenUs - rxUs_);
+
+    if (!loopback) return;
+
+    uint32_t sequence = nextSequence++;
+    pending[sequence % PENDING_ACKS] = {sequence, writtenUs};
+    Serial.print("LAT ");
+    Serial.println(sequence);
+}
+
+void latencySetLoopback(bool enabled) {
+    loopback = enabled;
+    for (auto &entry : pending) entry = {UINT32_MAX, 0};
+    Serial.print("Latency loopback: ");
+    Serial.println(loopback ? "ON (host must echo !<seq>)" : "OFF");
+}
+
+void latencyAck(uint32_t sequence) {
+    PendingAck &entry = pending[sequence % PENDING_ACKS];
+    if (!loopback || entry.sequence != sequence) return;
+    recordStage(STAGE_WRITE_TO_ACK, micros() - entry.writtenUs);
+    entry.sequence = UINT32_MAX;
+}
+
+void printLatencyStats() {
+    Serial.println("\nInput latency (us):");
+    Serial.printf("  %-16s %8s %7s %7s %7s %7s %8s\n", "stage", "samples", "p50", "p90", "p99", "p99.9", "max");
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+        const LatencyHistogram &h = histograms[i];
+        if (h.samples == 0) continue;
+        Serial.printf("  %-16s %8lu %7lu %7lu %7lu %7lu %8lu\n",
+                      STAGE_NAMES[i],
+                      static_cast<unsigned long>(h.samples),
+                      static_cast<unsigned long>(percentileUs(h, 500)),
+                      static_cast<unsigned long>(percentileUs(h, 900)),
+                      static_cast<unsigned long>(percentileUs(h, 990)),
+                      static_cast<unsigned long>(percentileUs(h, 999)),
+                      static_cast<unsigned long>(h.maxUs));
+    }
+}
+
+void resetLatencyStats() {
+    for (auto &h : histograms) h = LatencyHistogram();
+}
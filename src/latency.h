@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// End-to-end input latency, from a 0x25B frame leaving the TWAI driver to
+// the derived button/knob/rotation line being written to the host.
+//
+//   rx -> decode -> enqueue (line handed to Serial) -> written -> host ack
+//
+// The ack stage only runs in loopback mode: every event line is followed
+// by "LAT <seq>" and the host answers "!<seq>" (see host/tools/latency_probe).
+
+void latencyFrameReceived(uint32_t rxUs);
+
+// Stamps the events derived from one frame; create it where the state
+// change is detected. Each enqueued()/written() pair records one event, so
+// all events of a frame share the decode stamp.
+class LatencyProbe {
+public:
+    LatencyProbe();
+    void enqueued();
+    void written();
+
+private:
+    uint32_t rxUs_;
+    uint32_t decodeUs_;
+    uint32_t enqueueUs_ = 0;
+};
+
+void latencySetLoopback(bool enabled);
+void latencyAck(uint32_t sequence);
+void printLatencyStats();
+void resetLatencyStats();
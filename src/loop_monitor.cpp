@@ -0,0 +1,149 @@
+#include "loop_monitor.h"
+#include "capture.h"
+#include "idrive_controller.h"
+
+#include <Arduino.h>
+
+namespace {
+
+// Bucket 0 holds 0-1 us, bucket n holds [2^n, 2^(n+1)) us; the last bucket
+// absorbs everything above ~8 s.
+constexpr uint8_t  HISTOGRAM_BUCKETS   = 24;
+constexpr uint32_t DEFAULT_DEADLINE_US = 1000;
+
+// What ran during one iteration
+struct LoopActivity {
+    char     command   = 0;
+    bool     frameRx   = false;
+    uint32_t frameId   = 0;
+    bool     keepAlive = false;
+};
+
+struct LoopStats {
+    uint32_t     histogram[HISTOGRAM_BUCKETS] = {};
+    uint32_t     iterations   = 0;
+    uint64_t     totalUs      = 0;
+    uint32_t     worstUs      = 0;
+    LoopActivity worstActivity;
+    uint32_t     deadlineMisses = 0;
+};
+
+LoopStats stats;
+LoopActivity current;
+uint32_t iterationStart = 0;
+uint32_t deadlineUs     = DEFAULT_DEADLINE_US;
+
+uint8_t bucketFor(uint32_t durationUs) {
+    if (durationUs < 2) return 0;
+    uint8_t bucket = 31 - __builtin_clz(durationUs);
+    return (bucket >= HISTOGRAM_BUCKETS) ? HISTOGRAM_BUCKETS - 1 : bucket;
+}
+
+void printActivity(const LoopActivity &activity) {
+    bool any = false;
+    if (activity.command) {
+        Serial.print(" cmd='");
+        Serial.print(activity.command);
+        Serial.print("'");
+        any = true;
+    }
+    if (activity.frameRx) {
+        Serial.print(" rx=0x");
+        Serial.print(activity.frameId, HEX);
+        any = true;
+    }
+    if (activity.keepAlive) {
+        Serial.print(" keepalive");
+        any = true;
+    }
+    if (!any) Serial.print(" idle");
+}
+
+void reportDeadlineMiss(uint32_t durationUs) {
+    if (debugMode < 1 || captureStreaming()) return;
+    Serial.print("LOOP deadline miss: ");
+    Serial.print(durationUs);
+    Serial.print("us");
+    printActivity(current);
+    Serial.println();
+}
+
+}  // namespace
+
+void loopMonitorBegin() {
+    current = LoopActivity();
+    iterationStart = micros();
+}
+
+void loopMonitorEnd() {
+    uint32_t durationUs = micros() - iterationStart;
+
+    stats.histogram[bucketFor(durationUs)]++;
+    stats.iterations++;
+    stats.totalUs += durationUs;
+
+    if (durationUs > stats.worstUs) {
+        stats.worstUs = durationUs;
+        stats.worstActivity = current;
+    }
+
+    if (durationUs > deadlineUs) {
+        stats.deadlineMisses++;
+        reportDeadlineMiss(durationUs);
+    }
+}
+
+void loopMonitorNoteCommand(char cmd) {
+    current.command = cmd;
+}
+
+void loopMonitorNoteFrame(uint32_t id) {
+    current.frameRx = true;
+    current.frameId = id;
+}
+
+void loopMonitorNoteKeepAlive() {
+    current.keepAlive = true;
+}
+
+void loopMonitorSetDeadline(uint32_t newDeadlineUs) {
+    deadlineUs = newDeadlineUs;
+    Serial.print("Loop deadline: ");
+    Serial.print(deadlineUs);
+    Serial.println("us");
+}
+
+void printLoopStats() {
+    Serial.println("\nLoop timing:");
+    Serial.print("  Iterations: ");
+    Serial.println(stats.iterations);
+    if (stats.iterations == 0) return;
+
+    Serial.print("  Mean:       ");
+    Serial.print(static_cast<uint32_t>(stats.totalUs / stats.iterations));
+    Serial.println("us");
+    Serial.print("  Worst:      ");
+    Serial.print(stats.worstUs);
+    Serial.print("us");
+    printActivity(stats.worstActivity);
+    Serial.println();
+    Serial.print("  Deadline:   ");
+    Serial.print(deadlineUs);
+    Serial.print("us, missed ");
+    Serial.println(stats.deadlineMisses);
+
+    // Histogram rows with cumulative percentile so the tail is readable directly
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (stats.histogram[i] == 0) continue;
+        cumulative += stats.histogram[i];
+        Serial.printf("  <%8luus %10lu  %6.2f%%\n",
+                      static_cast<unsigned long>(2UL << i),
+                      static_cast<unsigned long>(stats.histogram[i]),
+                      (cumulative * 100.0) / stats.iterations);
+    }
+}
+
+void resetLoopStats() {
+    stats = LoopStats();
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// Per-iteration timing of loop(). Call loopMonitorBegin() at the top of
+// loop() and loopMonitorEnd() at the bottom; the note functions record what
+// ran in between so the worst iteration can be attributed.
+void loopMonitorBegin();
+void loopMonitorEnd();
+
+void loopMonitorNoteCommand(char cmd);
+void loopMonitorNoteFrame(uint32_t id);
+void loopMonitorNoteKeepAlive();
+
+void loopMonitorSetDeadline(uint32_t deadlineUs);
+void printLoopStats();
+void resetLoopStats();
@@ -5,6 +5,11 @@
 #include "can_rx.h"
 #include "can_tx.h"
 #include "serial_commands.h"
+#include "bus_load.h"
+#include "capture.h"
+#include "cycle_monitor.h"
+#include "loop_monitor.h"
+#include "sniffer.h"
 
 void setup() {
     Serial.begin(115200);
@@ -28,12 +33,28 @@ void setup() {
 }
 
 void loop() {
-    handleSerialCommands();
+    loopMonitorBegin();
+
+    // While a capture dump is being written, commands and periodic reports
+    // wait for CAPTURE END; frames are still received and decoded
+    bool dumping = captureStreaming();
+
+    if (!dumping) handleSerialCommands();
     processCanMessages();
 
     unsigned long now = millis();
 
     if (now - state.lastKeepAliveTime >= KEEPALIVE_INTERVAL_MS) {
         sendKeepAlive();
+        loopMonitorNoteKeepAlive();
     }
+
+    if (!dumping) {
+        updateSnifferDisplay(now);
+        updateCycleMonitor();
+        updateBusLoad();
+    }
+    updateCapture();
+
+    loopMonitorEnd();
 }
@@ -0,0 +1,44 @@
+#include "profiler.h"
+
+#include <Arduino.h>
+
+namespace {
+
+ProfileZoneStats *zoneList = nullptr;
+
+}  // namespace
+
+void profileZoneRegister(ProfileZoneStats &zone) {
+    zone.registered = true;
+    zone.next = zoneList;
+    zoneList = &zone;
+}
+
+void printProfileZones() {
+    if (!PROFILING_ENABLED) {
+        Serial.println("Profiling disabled (build with -DIDRIVE_PROFILING=1)");
+        return;
+    }
+
+    uint32_t cyclesPerUs = ESP.getCpuFreqMHz();
+
+    Serial.println("\nProfile zones (cycles):");
+    Serial.printf("  %-20s %10s %12s %10s %8s\n", "zone", "calls", "avg", "max", "max_us");
+    for (ProfileZoneStats *zone = zoneList; zone; zone = zone->next) {
+        if (zone->calls == 0) continue;
+        Serial.printf("  %-20s %10lu %12lu %10lu %8lu\n",
+                      zone->name,
+                      static_cast<unsigned long>(zone->calls),
+                      static_cast<unsigned long>(zone->totalCycles / zone->calls),
+                      static_cast<unsigned long>(zone->maxCycles),
+                      static_cast<unsigned long>(zone->maxCycles / cyclesPerUs));
+    }
+}
+
+void resetProfileZones() {
+    for (ProfileZoneStats *zone = zoneList; zone; zone = zone->next) {
+        zone->calls = 0;
+        zone->totalCycles = 0;
+        zone->maxCycles = 0;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+
+// Scoped hot-path profiling. Place PROFILE_ZONE("name") at the top of a
+// block; every pass accumulates call count, total and max CPU cycles into a
+// statically allocated record. Build with -DIDRIVE_PROFILING=1 (see the
+// _profile env in platformio.ini) to enable; otherwise zones compile away.
+#ifndef IDRIVE_PROFILING
+#define IDRIVE_PROFILING 0
+#endif
+
+constexpr bool PROFILING_ENABLED = IDRIVE_PROFILING != 0;
+
+struct ProfileZoneStats {
+    constexpr explicit ProfileZoneStats(const char *zoneName) : name(zoneName) {}
+
+    const char       *name;
+    uint32_t          calls       = 0;
+    uint64_t          totalCycles = 0;
+    uint32_t          maxCycles   = 0;
+    bool              registered  = false;
+    ProfileZoneStats *next        = nullptr;
+};
+
+// Links a zone into the dump list on its first pass
+void profileZoneRegister(ProfileZoneStats &zone);
+
+class ProfileZone {
+public:
+    explicit ProfileZone(ProfileZoneStats &zone) : zone_(zone) {
+        if (!PROFILING_ENABLED) return;
+        startCycles_ = ESP.getCycleCount();
+    }
+
+    ~ProfileZone() {
+        if (!PROFILING_ENABLED) return;
+        uint32_t elapsed = ESP.getCycleCount() - startCycles_;
+        if (!zone_.registered) profileZoneRegister(zone_);
+        zone_.calls++;
+        zone_.totalCycles += elapsed;
+        if (elapsed > zone_.maxCycles) zone_.maxCycles = elapsed;
+    }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+    ProfileZoneStats &zone_;
+    uint32_t startCycles_ = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(zoneName)                                                     \
+    static ProfileZoneStats PROFILE_CONCAT(profileZoneStats_, __LINE__)(zoneName); \
+    ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(PROFILE_CONCAT(profileZoneStats_, __LINE__))
+
+void printProfileZones();
+void resetProfileZones();
@@ -1,15 +1,45 @@
 #include "serial_commands.h"
+#include "bit_watch.h"
+#include "bus_load.h"
 #include "can_protocol.h"
+#include "can_rx.h"
 #include "idrive_controller.h"
 #include "can_tx.h"
+#include "capture.h"
+#include "clock_sync.h"
+#include "cycle_monitor.h"
+#include "latency.h"
+#include "loop_monitor.h"
+#include "profiler.h"
+#include "signal_monitor.h"
+#include "sniffer.h"
+#include "trace.h"
 #include "twai_driver.h"
 
 #include <Arduino.h>
 
 namespace {
 
-void cycleDebugMode() {
-    debugMode = (debugMode + 1) % 3;
+constexpr size_t DBC_LINE_LENGTH     = 128;
+constexpr size_t COMMAND_LINE_LENGTH = 2 + DBC_LINE_LENGTH;  // longest is g:<DBC line>
+
+// Input is collected without blocking until a newline, then the whole line
+// is handled; arguments are read from the line, never from Serial
+char commandLine[COMMAND_LINE_LENGTH + 1];
+size_t commandLength = 0;
+bool commandOverflow = false;
+const char *argument = commandLine;
+
+char peekArgument() {
+    return *argument;
+}
+
+char readArgument() {
+    return *argument ? *argument++ : '\0';
+}
+
+void setDebugMode(uint8_t mode) {
+    debugMode = mode;
     static const char *kDescriptions[] = {
         "NORMAL (state changes only)",
         "DEBUG (known packets + state changes)",
@@ -49,13 +79,300 @@ void applyNumericBrightness(char cmd) {
     reportBrightnessShortcut(cmd, level);
 }
 
+// Reads an optional decimal argument that directly follows a command key
+bool readNumericArgument(uint32_t &value) {
+    if (!isDigit(peekArgument())) return false;
+    value = 0;
+    while (isDigit(peekArgument())) value = value * 10 + (readArgument() - '0');
+    return true;
+}
+
+// Reads an optional hex argument (e.g. a CAN ID) that directly follows a command key
+bool readHexArgument(uint32_t &value) {
+    if (!isHexadecimalDigit(peekArgument())) return false;
+    value = 0;
+    while (isHexadecimalDigit(peekArgument())) {
+        char c = readArgument();
+        value = (value << 4) | (isDigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+    }
+    return true;
+}
+
+// Consumes the separator if it is next, so optional trailing fields can be parsed
+bool readSeparator(char separator) {
+    if (peekArgument() != separator) return false;
+    readArgument();
+    return true;
+}
+
+// Reads up to max bytes written as hex pairs; -1 on an odd digit count
+int readHexBytes(uint8_t *out, uint8_t max) {
+    int count = 0;
+    while (isHexadecimalDigit(peekArgument())) {
+        uint32_t pair = 0;
+        for (int digit = 0; digit < 2; digit++) {
+            if (!isHexadecimalDigit(peekArgument())) return -1;
+            char c = readArgument();
+            pair = (pair << 4) | (isDigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+        }
+        if (count == max) return -1;
+        out[count++] = static_cast<uint8_t>(pair);
+    }
+    return count;
+}
+
+// Reads an optional signed 64-bit decimal argument (clock offsets exceed long)
+bool readSignedArgument(int64_t &value) {
+    bool negative = readSeparator('-');
+    if (!isDigit(peekArgument())) return false;
+    value = 0;
+    while (isDigit(peekArgument())) value = value * 10 + (readArgument() - '0');
+    if (negative) value = -value;
+    return true;
+}
+
+void handleDebugModeCommand() {
+    uint32_t mode;
+    if (readNumericArgument(mode)) {
+        setDebugMode(mode > 2 ? 2 : static_cast<uint8_t>(mode));
+        return;
+    }
+    setDebugMode((debugMode + 1) % 3);
+}
+
+// x<id>:<payload> - one standard frame, e.g. x510:0000000000000000
+void handleTransmitCommand() {
+    uint32_t id;
+    uint8_t data[8];
+    int len = -1;
+    if (readHexArgument(id) && readSeparator(':')) len = readHexBytes(data, sizeof(data));
+    if (len < 0 || id > 0x7FF) {
+        Serial.println("Usage: x<id>:<payload> (hex, standard ID, up to 8 bytes), e.g. x510:0000000000000000");
+        return;
+    }
+    bool sent = twai_send(id, static_cast<uint8_t>(len), data);
+    Serial.printf("TX 0x%03lX %s\n", static_cast<unsigned long>(id), sent ? "sent" : "failed");
+}
+
+void handleFrameFilterCommand() {
+    uint32_t id;
+    if (readSeparator('x')) {
+        frameFilterClear();
+    } else if (readHexArgument(id)) {
+        frameFilterToggle(id);
+    } else {
+        printFrameFilter();
+    }
+}
+
+void handleLoopStatsCommand() {
+    uint32_t deadlineUs;
+    if (readNumericArgument(deadlineUs)) {
+        loopMonitorSetDeadline(deadlineUs);
+        return;
+    }
+    printLoopStats();
+    resetLoopStats();
+}
+
+void handleLatencyCommand() {
+    uint32_t loopback;
+    if (readNumericArgument(loopback)) {
+        latencySetLoopback(loopback != 0);
+        return;
+    }
+    printLatencyStats();
+    resetLatencyStats();
+}
+
+void handleLatencyAck() {
+    uint32_t sequence;
+    if (readNumericArgument(sequence)) latencyAck(sequence);
+}
+
+void handleSnifferCommand() {
+    uint32_t intervalMs;
+    if (readNumericArgument(intervalMs)) {
+        snifferSetRefresh(intervalMs);
+        return;
+    }
+    toggleSnifferDisplay();
+}
+
+void handleBitWatchCommand() {
+    uint32_t id;
+    if (readHexArgument(id)) {
+        toggleBitWatch(id);
+        return;
+    }
+    printBitWatch();
+}
+
+void handlePayloadTrigger() {
+    uint32_t id, byteIndex, value, mask = 0xFF;
+    if (!readHexArgument(id) || !readSeparator('.') || !readHexArgument(byteIndex) ||
+        !readSeparator('.') || !readHexArgument(value) || byteIndex > 7) {
+        Serial.println("Usage: cp<id>.<byte>.<value>[.<mask>] (hex), e.g. cp25B.4.20");
+        return;
+    }
+    if (readSeparator('.')) readHexArgument(mask);
+    captureSetPayloadTrigger(id, byteIndex, value, mask);
+}
+
+void handleCaptureWindow() {
+    uint32_t preMs, postMs;
+    if (!readNumericArgument(preMs) || !readSeparator('.') || !readNumericArgument(postMs)) {
+        Serial.println("Usage: cw<pre_ms>.<post_ms>, e.g. cw3000.1000");
+        return;
+    }
+    captureSetWindow(preMs, postMs);
+}
+
+void handleCaptureCommand() {
+    uint32_t id;
+    switch (peekArgument()) {
+        case 'i':
+            readArgument();
+            if (readHexArgument(id)) captureSetIdTrigger(id);
+            break;
+        case 'p':
+            readArgument();
+            handlePayloadTrigger();
+            break;
+        case 'e':
+            readArgument();
+            captureSetEventTrigger(true);
+            break;
+        case 'b':
+            readArgument();
+            captureSetBusErrorTrigger(true);
+            break;
+        case 'w':
+            readArgument();
+            handleCaptureWindow();
+            break;
+        case 'a':
+            readArgument();
+            captureArm();
+            break;
+        case 'x':
+            readArgument();
+            captureDisarm();
+            break;
+        case 'n':
+            readArgument();
+            captureTriggerNow();
+            break;
+        case 'z': {
+            readArgument();
+            uint32_t enabled;
+            if (readNumericArgument(enabled)) captureSetCompression(enabled != 0);
+            break;
+        }
+        default:
+            break;
+    }
+    printCaptureStatus();
+}
+
+void handleCycleMonitorCommand() {
+    uint32_t enabled;
+    if (readNumericArgument(enabled)) {
+        cycleMonitorSetReporting(enabled != 0);
+        return;
+    }
+    printCycleMonitor();
+}
+
+void handleBusLoadCommand() {
+    uint32_t percent;
+    if (readNumericArgument(percent)) {
+        busLoadSetThreshold(percent > 100 ? 100 : percent);
+        return;
+    }
+    printBusLoad();
+}
+
+// g / g1 / g0 / gx / g:<DBC line>
+void handleSignalCommand() {
+    if (readSeparator('x')) {
+        signalMonitorClearUploads();
+        return;
+    }
+    if (readSeparator(':')) {
+        signalMonitorUploadLine(argument);
+        return;
+    }
+    uint32_t enabled;
+    if (readNumericArgument(enabled)) {
+        signalMonitorSetReporting(enabled != 0);
+        return;
+    }
+    printSignalMonitor();
+}
+
+void handleClockSyncCommand(int64_t receivedUs) {
+    uint32_t sequence;
+    if (readNumericArgument(sequence)) {
+        clockSyncPing(sequence, receivedUs);
+        return;
+    }
+
+    int64_t offsetUs, driftPpb, referenceUs;
+    if (readSeparator('=')) {
+        if (readSignedArgument(offsetUs) && readSeparator('.') && readSignedArgument(driftPpb) &&
+            readSeparator('.') && readSignedArgument(referenceUs)) {
+            clockSyncSetMapping(offsetUs, driftPpb, referenceUs);
+        } else {
+            Serial.println("Usage: @=<offset_us>.<drift_ppb>.<ref_device_us>");
+        }
+        return;
+    }
+    printClockSync();
+}
+
+void dumpProfileZones() {
+    printProfileZones();
+    resetProfileZones();
+}
+
 void printHelp() {
     Serial.println("\nCommands:");
     Serial.println("  d     - Cycle debug mode (Normal/Debug/Raw)");
+    Serial.println("  d<n>  - Set debug mode (0 Normal, 1 Debug, 2 Raw)");
+    Serial.println("  f<id> - Add/remove hex CAN ID in the frame print filter");
+    Serial.println("  f/fx  - Show / clear the frame print filter (empty = all IDs)");
     Serial.println("  k     - Send keep-alive (0x510) - automatic every 500ms");
+    Serial.println("  x<id>:<data> - Transmit one frame, hex (e.g. x510:0000000000000000)");
     Serial.println("  w     - Wake ZBE (not yet working via CAN)");
     Serial.println("  +/-   - Adjust brightness");
     Serial.println("  0-9   - Set brightness level");
+    Serial.println("  l     - Print and reset loop timing stats");
+    Serial.println("  l<us> - Set loop deadline in microseconds (e.g. l2000)");
+    Serial.println("  p     - Dump and reset profiling zones (profile builds)");
+    Serial.println("  t     - Dump event trace ring (see host/tools/trace2chrome)");
+    Serial.println("  a     - Print and reset input latency percentiles");
+    Serial.println("  a1/a0 - Latency loopback on/off (host acks with !<seq>)");
+    Serial.println("  s     - Toggle live per-ID traffic table");
+    Serial.println("  s<ms> - Set table refresh interval (s0 = off)");
+    Serial.println("  b<id> - Add/remove bit watch for hex CAN ID (e.g. b0BF)");
+    Serial.println("  b     - Dump bit toggles, min/max per watched ID");
+    Serial.println("  m     - Marker: start a new bit-watch window");
+    Serial.println("  c     - Capture ring status");
+    Serial.println("  ci<id> / cp<id>.<byte>.<val>[.<mask>] / ce / cb");
+    Serial.println("        - Add trigger: ID seen / payload match / decoded event / bus error");
+    Serial.println("  cw<pre>.<post> - Capture window in ms around the trigger");
+    Serial.println("  ca/cx/cn - Arm / disarm and clear triggers / trigger now");
+    Serial.println("  cz1/cz0  - Delta-compressed capture dumps on/off");
+    Serial.println("  y     - Learned cycle times and anomaly counts per ID");
+    Serial.println("  y1/y0 - CYCLE LATE/MISSING/BURST reports on/off");
+    Serial.println("  u     - Bus load over 100ms/1s/10s windows");
+    Serial.println("  u<%>  - Set BUSLOAD HIGH threshold (default 70)");
+    Serial.println("  g     - DBC signal decoder status and last values");
+    Serial.println("  g1/g0 - SIG change reports on/off");
+    Serial.println("  g:<line> / gx - Upload a DBC BO_/SG_ line / drop uploaded signals");
+    Serial.println("  @<n>  - Clock sync ping, replies SYNC <n> <rx_us> <tx_us>");
+    Serial.println("  @=<offset>.<drift_ppb>.<ref> - Set host clock mapping");
     Serial.println("  h     - Help");
     Serial.println("\nDebug Modes:");
     Serial.println("  Normal: State changes only (buttons, knob, rotation)");
@@ -63,6 +380,33 @@ void printHelp() {
     Serial.println("  Raw:    All CAN packets");
 }
 
+// Appends what has arrived without waiting; true once a whole line is in.
+// CR, LF and CRLF all end a line, and the empty lines they leave are
+// skipped, so host tools can terminate every command without drawing an
+// "Unknown" reply. A line that does not fit is dropped and reported.
+bool receiveCommandLine() {
+    while (Serial.available()) {
+        char c = Serial.read();
+        if (c != '\n' && c != '\r') {
+            if (commandLength < COMMAND_LINE_LENGTH) {
+                commandLine[commandLength++] = c;
+            } else {
+                commandOverflow = true;
+            }
+            continue;
+        }
+        if (commandLength == 0 && !commandOverflow) continue;
+        commandLine[commandLength] = '\0';
+        commandLength = 0;
+        argument = commandLine;
+        if (!commandOverflow) return true;
+        commandOverflow = false;
+        bool dbcLine = commandLine[0] == 'g' && commandLine[1] == ':';
+        Serial.println(dbcLine ? "DBC ERROR line too long" : "Command line too long");
+    }
+    return false;
+}
+
 void reportUnknownCommand(char cmd) {
     Serial.print("Unknown: '");
     Serial.print(cmd);
@@ -72,13 +416,20 @@ void reportUnknownCommand(char cmd) {
 }  // namespace
 
 void handleSerialCommands() {
-    if (!Serial.available()) return;
+    if (!receiveCommandLine()) return;
 
-    char cmd = Serial.read();
+    char cmd = readArgument();
+    int64_t receivedUs = deviceTimeUs();
+    loopMonitorNoteCommand(cmd);
+    TraceScope commandTrace(TraceEvent::SerialCommand, 0, cmd);
 
     switch (cmd) {
         case 'd': case 'D':
-            cycleDebugMode();
+            handleDebugModeCommand();
+            break;
+
+        case 'f': case 'F':
+            handleFrameFilterCommand();
             break;
 
         case 'k': case 'K':
@@ -89,6 +440,10 @@ void handleSerialCommands() {
             sendWakeSequence();
             break;
 
+        case 'x': case 'X':
+            handleTransmitCommand();
+            break;
+
         case '+': case '=':
             adjustBrightness(1);
             break;
@@ -102,6 +457,58 @@ void handleSerialCommands() {
             applyNumericBrightness(cmd);
             break;
 
+        case 'l': case 'L':
+            handleLoopStatsCommand();
+            break;
+
+        case 'p': case 'P':
+            dumpProfileZones();
+            break;
+
+        case 't': case 'T':
+            dumpTrace();
+            break;
+
+        case 'a': case 'A':
+            handleLatencyCommand();
+            break;
+
+        case '!':
+            handleLatencyAck();
+            break;
+
+        case 's': case 'S':
+            handleSnifferCommand();
+            break;
+
+        case 'b': case 'B':
+            handleBitWatchCommand();
+            break;
+
+        case 'm': case 'M':
+            bitWatchMarker();
+            break;
+
+        case 'c': case 'C':
+            handleCaptureCommand();
+            break;
+
+        case 'y': case 'Y':
+            handleCycleMonitorCommand();
+            break;
+
+        case 'u': case 'U':
+            handleBusLoadCommand();
+            break;
+
+        case 'g': case 'G':
+            handleSignalCommand();
+            break;
+
+        case '@':
+            handleClockSyncCommand(receivedUs);
+            break;
+
         case 'h': case 'H': case '?':
             printHelp();
             break;
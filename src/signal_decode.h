@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// DBC signal extraction shared by the generated decoders (kcan_signals.h,
+// built from dbc/idrive_kcan.dbc by scripts/dbc_codegen.py), the runtime
+// decoder for DBC lines uploaded over serial, and the host tools.
+//
+// The 8 payload bytes are loaded as one 64-bit word, little-endian for
+// Intel (@1) signals and byte-swapped for Motorola (@0) ones, so every
+// signal is a single shift and mask: no per-bit or per-byte loops and no
+// branches on the layout. Payload pointers must cover 8 bytes; bytes past
+// the DLC read as whatever the receive buffer holds, as in the firmware.
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "payload words assume a little-endian target");
+
+enum class ByteOrder : uint8_t {
+    Intel,     // @1, start bit is the LSB
+    Motorola,  // @0, start bit is the MSB (DBC sawtooth numbering)
+};
+
+struct SignalValueName {
+    uint32_t    value;
+    const char *name;
+};
+
+struct SignalSpec {
+    uint32_t    messageId;
+    const char *message;
+    const char *name;
+    uint8_t     startBit;
+    uint8_t     length;
+    ByteOrder   order;
+    bool        isSigned;
+    float       factor;
+    float       offset;
+    const char *unit;
+    const SignalValueName *values;  // VAL_ table, may be null
+    uint8_t     valueCount;
+};
+
+// Position of the signal's LSB in the payload word
+constexpr uint8_t signalShift(uint8_t startBit, uint8_t length, ByteOrder order) {
+    return order == ByteOrder::Intel
+               ? startBit
+               : static_cast<uint8_t>((7 - startBit / 8) * 8 + startBit % 8 - (length - 1));
+}
+
+constexpr uint64_t signalMask(uint8_t length) {
+    return length >= 64 ? ~uint64_t(0) : (uint64_t(1) << length) - 1;
+}
+
+// Layout check used by the code generator's static_asserts and the
+// runtime parser alike
+constexpr bool signalFits(uint8_t startBit, uint8_t length, ByteOrder order) {
+    return length >= 1 && length <= 64 && startBit < 64 &&
+           (order == ByteOrder::Intel
+                ? startBit + length <= 64
+                : (7 - startBit / 8) * 8 + startBit % 8 + 1 >= length);
+}
+
+// Payload bytes a frame needs for the signal to be fully present (its DLC)
+constexpr uint8_t signalBytes(uint8_t startBit, uint8_t length, ByteOrder order) {
+    return order == ByteOrder::Intel
+               ? static_cast<uint8_t>((startBit + length - 1) / 8 + 1)
+               : static_cast<uint8_t>(8 - signalShift(startBit, length, order) / 8);
+}
+
+inline uint64_t loadPayloadWord(const uint8_t *data, ByteOrder order) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    return order == ByteOrder::Intel ? word : __builtin_bswap64(word);
+}
+
+inline int64_t signExtend(uint64_t raw, uint8_t length) {
+    uint8_t unused = static_cast<uint8_t>(64 - length);
+    return static_cast<int64_t>(raw << unused) >> unused;
+}
+
+// Compile-time layout: the generated decoders are aliases of this
+template <uint8_t START, uint8_t LENGTH, ByteOrder ORDER, bool SIGNED = false>
+struct SignalField {
+    static_assert(signalFits(START, LENGTH, ORDER), "signal runs past the 8-byte payload");
+
+    static constexpr uint8_t SHIFT = signalShift(START, LENGTH, ORDER);
+
+    static uint64_t raw(const uint8_t *data) {
+        return (loadPayloadWord(data, ORDER) >> SHIFT) & signalMask(LENGTH);
+    }
+
+    static int64_t value(const uint8_t *data) {
+        return SIGNED ? signExtend(raw(data), LENGTH) : static_cast<int64_t>(raw(data));
+    }
+};
+
+// Runtime layout: the same arithmetic with the fields read from a spec
+inline uint64_t extractSignalRaw(const SignalSpec &spec, const uint8_t *data) {
+    return (loadPayloadWord(data, spec.order) >> signalShift(spec.startBit, spec.length, spec.order)) &
+           signalMask(spec.length);
+}
+
+inline int64_t extractSignalValue(const SignalSpec &spec, const uint8_t *data) {
+    uint64_t raw = extractSignalRaw(spec, data);
+    return spec.isSigned ? signExtend(raw, spec.length) : static_cast<int64_t>(raw);
+}
+
+inline float signalPhysical(const SignalSpec &spec, int64_t value) {
+    return static_cast<float>(value) * spec.factor + spec.offset;
+}
+
+// VAL_ name for a raw value, nullptr when the table has none
+inline const char *signalValueName(const SignalSpec &spec, uint64_t raw) {
+    for (uint8_t i = 0; i < spec.valueCount; i++) {
+        if (spec.values[i].value == raw) return spec.values[i].name;
+    }
+    return nullptr;
+}
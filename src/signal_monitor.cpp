@@ -0,0 +1,204 @@
+#include "signal_monitor.h"
+#include "capture.h"
+#include "dbc_parse.h"
+#include "kcan_signals.h"
+#include "profiler.h"
+
+#include <Arduino.h>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t MAX_UPLOADED_SIGNALS = 24;
+constexpr uint8_t MAX_DECODERS         = kcan::SIGNAL_COUNT + MAX_UPLOADED_SIGNALS;
+
+// Uploaded specs point into their own name buffers
+struct UploadedSignal {
+    SignalSpec spec;
+    char       message[DBC_NAME_LENGTH];
+    char       name[DBC_NAME_LENGTH];
+    char       unit[DBC_UNIT_LENGTH];
+};
+
+struct Decoder {
+    const SignalSpec *spec;
+    uint8_t  minLength;  // frames shorter than this do not carry the signal
+    bool     seen;
+    uint64_t lastRaw;
+};
+
+UploadedSignal uploaded[MAX_UPLOADED_SIGNALS];
+uint8_t uploadedCount = 0;
+
+DbcMessage pendingMessage;
+bool havePendingMessage = false;
+
+Decoder decoders[MAX_DECODERS];
+uint8_t decoderCount = 0;
+
+bool reporting = false;
+
+bool isUploadedId(uint32_t id) {
+    for (uint8_t i = 0; i < uploadedCount; i++) {
+        if (uploaded[i].spec.messageId == id) return true;
+    }
+    return false;
+}
+
+void addDecoder(const SignalSpec &spec) {
+    Decoder &decoder = decoders[decoderCount++];
+    decoder.spec = &spec;
+    decoder.minLength = signalBytes(spec.startBit, spec.length, spec.order);
+    decoder.seen = false;
+    decoder.lastRaw = 0;
+}
+
+// Uploaded messages shadow the compiled definitions of the same ID
+void rebuildDecoders() {
+    decoderCount = 0;
+    for (const SignalSpec &spec : kcan::SIGNALS) {
+        if (!isUploadedId(spec.messageId)) addDecoder(spec);
+    }
+    for (uint8_t i = 0; i < uploadedCount; i++) addDecoder(uploaded[i].spec);
+}
+
+void removeUploadedId(uint32_t id) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < uploadedCount; i++) {
+        if (uploaded[i].spec.messageId == id) continue;
+        if (kept != i) uploaded[kept] = uploaded[i];
+        kept++;
+    }
+    uploadedCount = kept;
+    // Compaction moved the name buffers
+    for (uint8_t i = 0; i < uploadedCount; i++) {
+        uploaded[i].spec.message = uploaded[i].message;
+        uploaded[i].spec.name = uploaded[i].name;
+        uploaded[i].spec.unit = uploaded[i].unit;
+    }
+}
+
+void addUploadedSignal(const DbcSignal &signal) {
+    UploadedSignal &entry = uploaded[uploadedCount++];
+    memcpy(entry.message, pendingMessage.name, sizeof(entry.message));
+    memcpy(entry.name, signal.name, sizeof(entry.name));
+    memcpy(entry.unit, signal.unit, sizeof(entry.unit));
+
+    SignalSpec &spec = entry.spec;
+    spec.messageId = pendingMessage.id;
+    spec.message = entry.message;
+    spec.name = entry.name;
+    spec.startBit = signal.startBit;
+    spec.length = signal.length;
+    spec.order = signal.order;
+    spec.isSigned = signal.isSigned;
+    spec.factor = signal.factor;
+    spec.offset = signal.offset;
+    spec.unit = entry.unit;
+    spec.values = nullptr;  // VAL_ tables are compiled-in only
+    spec.valueCount = 0;
+}
+
+void printValue(const SignalSpec &spec, uint64_t raw) {
+    int64_t value = spec.isSigned ? signExtend(raw, spec.length) : static_cast<int64_t>(raw);
+    if (spec.factor == 1.0f && spec.offset == 0.0f) {
+        Serial.printf("%lld", static_cast<long long>(value));
+    } else {
+        Serial.printf("%.3f", static_cast<double>(signalPhysical(spec, value)));
+    }
+    if (spec.unit[0]) Serial.printf(" %s", spec.unit);
+    const char *name = signalValueName(spec, raw);
+    if (name) Serial.printf(" (%s)", name);
+}
+
+}  // namespace
+
+void signalMonitorRecord(uint32_t id, uint8_t len, const uint8_t *data) {
+    // Held during a capture dump; changes are reported against the last printed value afterwards
+    if (!reporting || captureStreaming()) return;
+    PROFILE_ZONE("signal_decode");
+    if (decoderCount == 0) rebuildDecoders();
+
+    for (uint8_t i = 0; i < decoderCount; i++) {
+        Decoder &decoder = decoders[i];
+        if (decoder.spec->messageId != id || len < decoder.minLength) continue;
+
+        uint64_t raw = extractSignalRaw(*decoder.spec, data);
+        if (decoder.seen && raw == decoder.lastRaw) continue;
+        decoder.seen = true;
+        decoder.lastRaw = raw;
+
+        Serial.printf("SIG %s.%s = ", decoder.spec->message, decoder.spec->name);
+        printValue(*decoder.spec, raw);
+        Serial.println();
+    }
+}
+
+void signalMonitorSetReporting(bool enabled) {
+    reporting = enabled;
+    // Report every signal's current value once after switching on
+    for (uint8_t i = 0; i < decoderCount; i++) decoders[i].seen = false;
+    Serial.print("Signal reports: ");
+    Serial.println(reporting ? "ON" : "OFF");
+}
+
+void signalMonitorUploadLine(const char *line) {
+    DbcSignal signal;
+    switch (parseDbcLine(line, pendingMessage, signal)) {
+        case DbcLineKind::Message:
+            havePendingMessage = true;
+            removeUploadedId(pendingMessage.id);
+            rebuildDecoders();
+            Serial.printf("DBC BO_ 0x%03lX %s\n", static_cast<unsigned long>(pendingMessage.id),
+                          pendingMessage.name);
+            break;
+        case DbcLineKind::Signal:
+            if (!havePendingMessage) {
+                Serial.println("DBC ERROR SG_ before BO_");
+            } else if (uploadedCount >= MAX_UPLOADED_SIGNALS) {
+                Serial.println("DBC ERROR signal table full");
+            } else {
+                addUploadedSignal(signal);
+                rebuildDecoders();
+                Serial.printf("DBC SG_ %s.%s %u|%u (%u/%u)\n", pendingMessage.name, signal.name,
+                              signal.startBit, signal.length, uploadedCount, MAX_UPLOADED_SIGNALS);
+            }
+            break;
+        case DbcLineKind::Invalid:
+            havePendingMessage = false;
+            Serial.println("DBC ERROR unparsable BO_/SG_ line");
+            break;
+        default:
+            Serial.println("DBC SKIP");
+            break;
+    }
+}
+
+void signalMonitorClearUploads() {
+    uploadedCount = 0;
+    havePendingMessage = false;
+    rebuildDecoders();
+    Serial.println("Uploaded DBC signals cleared");
+}
+
+void printSignalMonitor() {
+    if (decoderCount == 0) rebuildDecoders();
+    Serial.printf("\nSignal decoder: %u compiled, %u uploaded, reports %s\n", kcan::SIGNAL_COUNT, uploadedCount,
+                  reporting ? "ON" : "OFF");
+    Serial.printf("  %-5s %-20s %-12s %-9s %s\n", "ID", "message", "signal", "layout", "last");
+    for (uint8_t i = 0; i < decoderCount; i++) {
+        const Decoder &decoder = decoders[i];
+        const SignalSpec &spec = *decoder.spec;
+        char layout[12];
+        snprintf(layout, sizeof(layout), "%u|%u@%c%c", spec.startBit, spec.length,
+                 spec.order == ByteOrder::Intel ? '1' : '0', spec.isSigned ? '-' : '+');
+        Serial.printf("  %03lX   %-20s %-12s %-9s ", static_cast<unsigned long>(spec.messageId), spec.message,
+                      spec.name, layout);
+        if (decoder.seen) {
+            printValue(spec, decoder.lastRaw);
+        } else {
+            Serial.print("-");
+        }
+        Serial.println();
+    }
+}
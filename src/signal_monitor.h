@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// DBC-driven signal decoder. Starts with the signals compiled in from
+// dbc/idrive_kcan.dbc (kcan_signals.h) and takes further BO_/SG_ lines over
+// serial ('g:<line>'), so a new message can be decoded without reflashing;
+// uploaded definitions replace the compiled ones for the same ID. With
+// reporting on, every change of a decoded signal prints
+//   SIG <message>.<signal> = <value> [unit] [(VAL_ name)]
+void signalMonitorRecord(uint32_t id, uint8_t len, const uint8_t *data);
+
+void signalMonitorSetReporting(bool enabled);
+// Parses one DBC line and acks it with a "DBC ..." line
+void signalMonitorUploadLine(const char *line);
+void signalMonitorClearUploads();
+void printSignalMonitor();
@@ -0,0 +1,163 @@
+#include "sniffer.h"
+
+#include <Arduino.h>
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t STANDARD_ID_SPACE  = 0x800;
+constexpr uint8_t  MAX_TRACKED_IDS    = 128;
+constexpr uint32_t DEFAULT_REFRESH_MS = 1000;
+constexpr uint8_t  JITTER_SHIFT       = 4;  // EMA weight 1/16
+
+struct IdStats {
+    uint16_t id;
+    uint8_t  dlc;
+    uint8_t  changedMask;       // bytes changed since the last refresh
+    uint8_t  data[8];
+    uint32_t count;
+    uint32_t countAtRefresh;
+    uint32_t lastRxUs;
+    uint32_t lastChangeUs;
+    uint32_t minPeriodUs;
+    uint32_t maxPeriodUs;
+    uint64_t periodSumUs;
+    uint32_t jitterUs;          // EMA of |period - mean period|
+};
+
+// slotOf[id] is 1 + index into entries, 0 when the ID has not been seen.
+// The index keeps the lookup direct while only paying RAM for live IDs.
+uint8_t slotOf[STANDARD_ID_SPACE];
+IdStats entries[MAX_TRACKED_IDS];
+uint8_t entryCount = 0;
+uint32_t droppedIds = 0;
+
+bool displayEnabled = false;
+uint32_t refreshIntervalMs = DEFAULT_REFRESH_MS;
+unsigned long lastRefreshMs = 0;
+
+IdStats *entryFor(uint32_t id) {
+    if (id >= STANDARD_ID_SPACE) return nullptr;
+
+    uint8_t slot = slotOf[id];
+    if (slot) return &entries[slot - 1];
+
+    if (entryCount >= MAX_TRACKED_IDS) {
+        droppedIds++;
+        return nullptr;
+    }
+
+    IdStats &entry = entries[entryCount++];
+    entry = IdStats();
+    entry.id = static_cast<uint16_t>(id);
+    entry.minPeriodUs = UINT32_MAX;
+    slotOf[id] = entryCount;
+    return &entry;
+}
+
+void printBytes(const IdStats &entry) {
+    for (uint8_t i = 0; i < entry.dlc; i++) {
+        bool changed = entry.changedMask & (1 << i);
+        if (changed) Serial.print("\033[7m");
+        if (entry.data[i] < 0x10) Serial.print("0");
+        Serial.print(entry.data[i], HEX);
+        if (changed) Serial.print("\033[0m");
+        Serial.print(" ");
+    }
+}
+
+void printTable(unsigned long nowMs, uint32_t elapsedMs) {
+    uint32_t nowUs = micros();
+
+    // Home the cursor and clear so the table redraws in place
+    Serial.print("\033[H\033[2J");
+    Serial.printf("CAN sniffer  t=%lums  ids=%u  dropped=%lu\n",
+                  nowMs, entryCount, static_cast<unsigned long>(droppedIds));
+    Serial.printf("%-5s %9s %7s %9s %9s %9s %8s %9s  %s\n",
+                  "ID", "count", "rate/s", "min_ms", "avg_ms", "max_ms", "jit_ms", "chg_ago", "data");
+
+    for (uint16_t id = 0; id < STANDARD_ID_SPACE; id++) {
+        if (!slotOf[id]) continue;
+        IdStats &entry = entries[slotOf[id] - 1];
+
+        uint32_t windowCount = entry.count - entry.countAtRefresh;
+        uint32_t rate = elapsedMs ? (windowCount * 1000UL + elapsedMs / 2) / elapsedMs : 0;
+        bool havePeriod = entry.count > 1;
+        float avgMs = havePeriod ? (entry.periodSumUs / (entry.count - 1)) / 1000.0f : 0.0f;
+
+        Serial.printf("%03X   %9lu %7lu %9.2f %9.2f %9.2f %8.2f %8.1fs  ",
+                      entry.id,
+                      static_cast<unsigned long>(entry.count),
+                      static_cast<unsigned long>(rate),
+                      havePeriod ? entry.minPeriodUs / 1000.0f : 0.0f,
+                      avgMs,
+                      entry.maxPeriodUs / 1000.0f,
+                      entry.jitterUs / 1000.0f,
+                      (nowUs - entry.lastChangeUs) / 1e6f);
+        printBytes(entry);
+        Serial.println();
+
+        entry.countAtRefresh = entry.count;
+        entry.changedMask = 0;
+    }
+}
+
+}  // namespace
+
+void snifferRecord(uint32_t id, uint8_t len, const uint8_t *data, uint32_t rxUs) {
+    IdStats *entry = entryFor(id);
+    if (!entry) return;
+    if (len > 8) len = 8;
+
+    if (entry->count > 0) {
+        uint32_t period = rxUs - entry->lastRxUs;
+        if (period < entry->minPeriodUs) entry->minPeriodUs = period;
+        if (period > entry->maxPeriodUs) entry->maxPeriodUs = period;
+        entry->periodSumUs += period;
+
+        uint32_t mean = entry->periodSumUs / entry->count;
+        uint32_t deviation = (period > mean) ? period - mean : mean - period;
+        entry->jitterUs += (static_cast<int32_t>(deviation - entry->jitterUs)) >> JITTER_SHIFT;
+    }
+
+    // Compare the payload as one word; per-byte change bits only when it moved
+    uint64_t previous = 0, current = 0;
+    memcpy(&previous, entry->data, 8);
+    uint8_t padded[8] = {};
+    memcpy(padded, data, len);
+    memcpy(&current, padded, 8);
+
+    if (entry->count == 0 || previous != current || entry->dlc != len) {
+        uint64_t diff = previous ^ current;
+        for (uint8_t i = 0; i < 8; i++) {
+            if ((diff >> (i * 8)) & 0xFF) entry->changedMask |= 1 << i;
+        }
+        memcpy(entry->data, padded, 8);
+        entry->dlc = len;
+        entry->lastChangeUs = rxUs;
+    }
+
+    entry->lastRxUs = rxUs;
+    entry->count++;
+}
+
+void updateSnifferDisplay(unsigned long nowMs) {
+    if (!displayEnabled || nowMs - lastRefreshMs < refreshIntervalMs) return;
+    printTable(nowMs, nowMs - lastRefreshMs);
+    lastRefreshMs = nowMs;
+}
+
+void snifferSetRefresh(uint32_t intervalMs) {
+    if (intervalMs == 0) {
+        displayEnabled = false;
+        Serial.println("Sniffer view: OFF");
+        return;
+    }
+    refreshIntervalMs = intervalMs;
+    displayEnabled = true;
+    lastRefreshMs = millis();
+}
+
+void toggleSnifferDisplay() {
+    snifferSetRefresh(displayEnabled ? 0 : refreshIntervalMs);
+}
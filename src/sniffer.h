@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// Per-ID traffic statistics ("cansniffer" view). Every received frame
+// updates its ID's entry in O(1); 's' toggles a live table that redraws in
+// place and highlights bytes that changed since the previous refresh.
+void snifferRecord(uint32_t id, uint8_t len, const uint8_t *data, uint32_t rxUs);
+void updateSnifferDisplay(unsigned long nowMs);
+
+void snifferSetRefresh(uint32_t intervalMs);
+void toggleSnifferDisplay();
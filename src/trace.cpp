@@ -0,0 +1,32 @@
+#include "trace.h"
+
+#include <Arduino.h>
+
+TraceRecord traceRing[TRACE_CAPACITY];
+uint32_t traceHead = 0;
+bool traceEnabled = true;
+
+void dumpTrace() {
+    // Freeze the ring while it is printed so the dump is self-consistent
+    traceEnabled = false;
+
+    uint32_t count = (traceHead < TRACE_CAPACITY) ? traceHead : TRACE_CAPACITY;
+    uint32_t first = traceHead - count;
+
+    Serial.printf("TRACE BEGIN %lu %lu\n",
+                  static_cast<unsigned long>(count),
+                  static_cast<unsigned long>(ESP.getCpuFreqMHz()));
+    for (uint32_t i = 0; i < count; i++) {
+        const TraceRecord &record = traceRing[(first + i) & (TRACE_CAPACITY - 1)];
+        Serial.printf("T %08lX %u %u %03X %lX\n",
+                      static_cast<unsigned long>(record.cycles),
+                      record.event,
+                      record.phase,
+                      record.id,
+                      static_cast<unsigned long>(record.arg));
+    }
+    Serial.println("TRACE END");
+
+    traceHead = 0;
+    traceEnabled = true;
+}
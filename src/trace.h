@@ -0,0 +1,47 @@
+#pragma once
+
+#include "trace_format.h"
+
+#include <Arduino.h>
+#include <cstdint>
+
+// Fixed-size in-RAM event trace. Recording is a cycle-counter read and a
+// 12-byte store into a power-of-two ring; 't' dumps it for trace2chrome.
+constexpr uint16_t TRACE_CAPACITY = 2048;
+
+static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0, "TRACE_CAPACITY must be a power of two");
+
+extern TraceRecord traceRing[TRACE_CAPACITY];
+extern uint32_t traceHead;
+extern bool traceEnabled;
+
+inline void traceRecord(TraceEvent event, TracePhase phase, uint16_t id = 0, uint32_t arg = 0) {
+    if (!traceEnabled) return;
+    TraceRecord &record = traceRing[traceHead++ & (TRACE_CAPACITY - 1)];
+    record.cycles = ESP.getCycleCount();
+    record.event = static_cast<uint8_t>(event);
+    record.phase = static_cast<uint8_t>(phase);
+    record.id = id;
+    record.arg = arg;
+}
+
+// Records a Begin/End pair around a block
+class TraceScope {
+public:
+    TraceScope(TraceEvent event, uint16_t id = 0, uint32_t arg = 0) : event_(event), id_(id) {
+        traceRecord(event_, TracePhase::Begin, id_, arg);
+    }
+
+    ~TraceScope() {
+        traceRecord(event_, TracePhase::End, id_);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    TraceEvent event_;
+    uint16_t id_;
+};
+
+void dumpTrace();
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// Event trace record layout, shared with the host-side trace converter
+// (host/tools/trace2chrome.cpp). Keep both in sync when adding events.
+
+enum class TraceEvent : uint8_t {
+    FrameRx,        // id = CAN ID, arg = DLC
+    Decode,         // id = CAN ID
+    Log,            // id = CAN ID or 0
+    SerialCommand,  // arg = command key
+    FrameTx,        // id = CAN ID, arg = DLC
+    Count,
+};
+
+enum class TracePhase : uint8_t {
+    Instant,
+    Begin,
+    End,
+};
+
+// Timestamps are raw CPU cycle counts (32-bit, wraps every ~26 s at
+// 160 MHz); the dump header carries the clock so the host can unwrap.
+struct TraceRecord {
+    uint32_t cycles;
+    uint8_t  event;
+    uint8_t  phase;
+    uint16_t id;
+    uint32_t arg;
+};
+
+static_assert(sizeof(TraceRecord) == 12, "TraceRecord must stay packed to 12 bytes");
+
+constexpr const char *TRACE_EVENT_NAMES[] = {
+    "frame_rx",
+    "decode",
+    "log",
+    "serial_cmd",
+    "frame_tx",
+};
+
+static_assert(sizeof(TRACE_EVENT_NAMES) / sizeof(TRACE_EVENT_NAMES[0]) ==
+                  static_cast<uint8_t>(TraceEvent::Count),
+              "TRACE_EVENT_NAMES out of sync with TraceEvent");
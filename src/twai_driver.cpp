@@ -1,4 +1,7 @@
 #include "twai_driver.h"
+#include "bus_load.h"
+#include "capture.h"
+#include "trace.h"
 
 #include <Arduino.h>
 #include "driver/twai.h"
@@ -45,6 +48,8 @@ bool twai_init() {
 bool twai_send(uint32_t id, uint8_t len, const uint8_t *data) {
     if (!initialized) return false;
 
+    TraceScope txTrace(TraceEvent::FrameTx, id, len);
+
     twai_message_t message;
     message.identifier = id;
     message.extd = 0;
@@ -55,7 +60,11 @@ bool twai_send(uint32_t id, uint8_t len, const uint8_t *data) {
         message.data[i] = data[i];
     }
 
-    return twai_transmit(&message, pdMS_TO_TICKS(10)) == ESP_OK;
+    if (twai_transmit(&message, pdMS_TO_TICKS(10)) != ESP_OK) return false;
+
+    captureRecord(id, len, data, micros(), true);
+    busLoadRecord(id, len, data);
+    return true;
 }
 
 bool twai_receive(uint32_t *id, uint8_t *len, uint8_t *data) {
@@ -74,6 +83,21 @@ bool twai_receive(uint32_t *id, uint8_t *len, uint8_t *data) {
     return true;
 }
 
+bool twai_get_health(TwaiHealth *health) {
+    if (!initialized) return false;
+
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) != ESP_OK) return false;
+
+    health->busErrors = status.bus_error_count;
+    health->rxMissed = status.rx_missed_count;
+    health->rxOverrun = status.rx_overrun_count;
+    health->txFailed = status.tx_failed_count;
+    health->arbitrationLost = status.arb_lost_count;
+    health->busOff = status.state == TWAI_STATE_BUS_OFF;
+    return true;
+}
+
 void twai_set_silent_mode(bool silent) {
     // TJA1441A/B: HIGH = silent mode
     digitalWrite(SILENT_GPIO, silent ? HIGH : LOW);
@@ -2,7 +2,17 @@
 
 #include <cstdint>
 
+struct TwaiHealth {
+    uint32_t busErrors;
+    uint32_t rxMissed;
+    uint32_t rxOverrun;
+    uint32_t txFailed;
+    uint32_t arbitrationLost;
+    bool     busOff;
+};
+
 bool twai_init();
 bool twai_send(uint32_t id, uint8_t len, const uint8_t *data);
 bool twai_receive(uint32_t *id, uint8_t *len, uint8_t *data);
 void twai_set_silent_mode(bool silent);
+bool twai_get_health(TwaiHealth *health);
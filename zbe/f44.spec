@@ -0,0 +1,82 @@
+# ZBE controller mapping for the F44, transcribed from IDs.txt.
+#
+# scripts/zbe_codegen.py turns this into zbe_mappings.h (KNOB_MAPPINGS,
+# BUTTON_MAPPINGS and the per-byte decode tables) at build time and checks
+# every entry against the captures under it:
+#   - the annotated byte must take exactly the annotated values
+#   - no other byte (except the ignored ones) may change within a block
+#   - values must not collide with another entry on the same byte
+#
+#   controller <id> [ignore=<byte>,...]
+#   knob   <LABEL> byte=<n> pressed=<hex> released=<hex>
+#   button <LABEL> byte=<n> pressed=<hex> touched=<hex> released=<hex>
+#
+# followed by capture lines as logged ("[RAW] ID:0x25B Data: 03 FF ..." or
+# the firmware's "[RAW] 0x25B: 03 FF ..."). Labels map to iDriveState
+# fields: knob UP -> knobPressedUp, button HOME -> homeButtonPressed and
+# homeButtonTouched.
+
+# Byte 0 is the rolling sequence counter
+controller 0x25B ignore=0
+
+knob CENTER byte=3 pressed=01 released=00
+[RAW] ID:0x25B Data: 04 FF 7F 01 00 00 C0 C0
+[RAW] ID:0x25B Data: 05 FF 7F 00 00 00 C0 C0
+
+knob LEFT byte=3 pressed=A0 released=00
+[RAW] ID:0x25B Data: 02 FF 7F A0 00 00 C0 C0
+[RAW] ID:0x25B Data: 03 FF 7F 00 00 00 C0 C0
+
+knob UP byte=3 pressed=10 released=00
+[RAW] ID:0x25B Data: 02 FF 7F 10 00 00 C0 C0
+[RAW] ID:0x25B Data: 03 FF 7F 00 00 00 C0 C0
+
+knob RIGHT byte=3 pressed=40 released=00
+[RAW] ID:0x25B Data: 02 FF 7F 40 00 00 C0 C0
+[RAW] ID:0x25B Data: 03 FF 7F 00 00 00 C0 C0
+
+knob DOWN byte=3 pressed=70 released=00
+[RAW] ID:0x25B Data: 02 FF 7F 70 00 00 C0 C0
+[RAW] ID:0x25B Data: 03 FF 7F 00 00 00 C0 C0
+
+button BACK byte=4 pressed=20 touched=80 released=00
+[RAW] ID:0x25B Data: 03 FF 7F 00 20 00 C0 C0
+[RAW] ID:0x25B Data: 04 FF 7F 00 80 00 C0 C0
+[RAW] ID:0x25B Data: 05 FF 7F 00 00 00 C0 C0
+
+button HOME byte=4 pressed=04 touched=10 released=00
+[RAW] ID:0x25B Data: 33 FF 7F 00 04 00 C0 C0
+[RAW] ID:0x25B Data: 34 FF 7F 00 10 00 C0 C0
+[RAW] ID:0x25B Data: 35 FF 7F 00 00 00 C0 C0
+
+# IDs.txt notes "C0 released"; the captures show 00
+button COM byte=5 pressed=08 touched=20 released=00
+[RAW] ID:0x25B Data: 03 FF 7F 00 00 08 C0 C0
+[RAW] ID:0x25B Data: 04 FF 7F 00 00 20 C0 C0
+[RAW] ID:0x25B Data: 05 FF 7F 00 00 00 C0 C0
+
+button OPTION byte=5 pressed=01 touched=04 released=00
+[RAW] ID:0x25B Data: 03 FF 7F 00 00 01 C0 C0
+[RAW] ID:0x25B Data: 04 FF 7F 00 00 04 C0 C0
+[RAW] ID:0x25B Data: 05 FF 7F 00 00 00 C0 C0
+
+button MEDIA byte=6 pressed=C1 touched=C4 released=C0
+[RAW] ID:0x25B Data: 07 FF 7F 00 00 00 C1 C0
+[RAW] ID:0x25B Data: 08 FF 7F 00 00 00 C4 C0
+[RAW] ID:0x25B Data: 09 FF 7F 00 00 00 C0 C0
+
+button NAV byte=6 pressed=C8 touched=E0 released=C0
+[RAW] ID:0x25B Data: 03 FF 7F 00 00 00 C8 C0
+[RAW] ID:0x25B Data: 04 FF 7F 00 00 00 E0 C0
+[RAW] ID:0x25B Data: 05 FF 7F 00 00 00 C0 C0
+
+button MAP byte=7 pressed=C1 touched=C4 released=C0
+[RAW] ID:0x25B Data: 03 FF 7F 00 00 00 C0 C1
+[RAW] ID:0x25B Data: 04 FF 7F 00 00 00 C0 C4
+[RAW] ID:0x25B Data: 05 FF 7F 00 00 00 C0 C0
+
+# IDs.txt notes "E8 touched"; the captures show E0
+button GLOBE byte=7 pressed=C8 touched=E0 released=C0
+[RAW] ID:0x25B Data: 03 FF 7F 00 00 00 C0 C8
+[RAW] ID:0x25B Data: 04 FF 7F 00 00 00 C0 E0
+[RAW] ID:0x25B Data: 05 FF 7F 00 00 00 C0 C0